@@ -17,8 +17,8 @@
 #define ACCELERATOR_H
 
 #include "Geometry/Shape.h"
+#include "Geometry/TriangleBuffer.h"
 #include "LeafTreatment.h"
-#include <list>
 
 /**
  * @brief Base class for accelerators
@@ -28,9 +28,10 @@ class Accelerator
 
 public:
 	/// Constructors
-    Accelerator() { intersectionChoice = leafTreatment::FIRST; defineLeafFunction(); }
+    Accelerator() : triangles(NULL) { intersectionChoice = leafTreatment::FIRST; defineLeafFunction(); }
     Accelerator(std::vector<Shape*> *_shapes, BBox& _globalBox) : shapes(_shapes),
-																  globalBox(_globalBox)
+																  globalBox(_globalBox),
+																  triangles(NULL)
     {
         intersectionChoice = leafTreatment::FIRST;
 		defineLeafFunction();
@@ -42,6 +43,7 @@ public:
         globalBox = other.globalBox;
         intersectionChoice = other.intersectionChoice;
 		pLeafTreatmentFunction = other.pLeafTreatmentFunction;
+        triangles = other.triangles;
     }
     /// Destructor
     virtual ~Accelerator() { }
@@ -49,10 +51,32 @@ public:
     /// Get/Set the Intersection choice
     leafTreatment::treatment getIntersectionChoice() { return intersectionChoice; }
     void setIntersectionChoice(leafTreatment::treatment _intersectionChoice = leafTreatment::FIRST) { intersectionChoice = _intersectionChoice; defineLeafFunction(); }
+    /// Set the flat storage of the triangles of the shapes (NULL to intersect all the shapes through Shape::getIntersection)
+    void setTriangleBuffer(const TriangleBuffer* _triangles) { triangles = _triangles; }
     /// Build this accelerator
     virtual bool build() { return false; }
     /// Run this accelerator
-    virtual decimal traverse(Ray* r, std::list<Intersection> &result) const { return -1.; }
+    virtual decimal traverse(Ray* r, IntersectionBuffer &result) const { return -1.; }
+    /**
+     * \brief Run this accelerator on a packet of rays (by default, the rays are traversed one at a time)
+     * @param rays Rays of the packet
+     * @param nbRays Number of rays in the packet (at most MAX_PACKET_SIZE)
+     * @param results Intersections found for each ray
+     * @param tmins Value returned by traverse() for each ray
+     */
+    virtual void traversePacket(Ray** rays, unsigned int nbRays, IntersectionBuffer* results, decimal* tmins) const
+    {
+        for (unsigned int i = 0; i < nbRays; i++) { tmins[i] = traverse(rays[i], results[i]); }
+    }
+
+    static const unsigned int MAX_PACKET_SIZE = 16;	//!< Maximal number of rays in a packet
+
+    /// Get the Intersection between a ray and the shape of index i (from the triangle buffer if it holds the shape)
+    bool getIntersection(unsigned int i, Ray& ray, Intersection& inter) const
+    {
+        if (triangles && triangles->contains(i)) { return triangles->getIntersection(i, ray, inter); }
+        return shapes->at(i)->getIntersection(ray, inter);
+    }
 
 protected:
     /// To define leaf function
@@ -78,12 +102,13 @@ protected:
 		}
 	}
 
-	decimal (*pLeafTreatmentFunction) (std::list<Intersection> &, decimal); //!< Pointer to the treatment function of leaf
+	decimal (*pLeafTreatmentFunction) (IntersectionBuffer &, decimal); //!< Pointer to the treatment function of leaf
 
     leafTreatment::treatment intersectionChoice;	//!< Intersection choice
 
     std::vector<Shape*> *shapes;					//!< Vector of pointers to shapes
     BBox globalBox;									//!< Global bounding box
+    const TriangleBuffer* triangles;				//!< Flat storage of the triangles of the shapes (may be NULL)
 };
 
 #endif
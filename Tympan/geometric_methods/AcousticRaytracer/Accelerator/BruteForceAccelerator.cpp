@@ -15,14 +15,14 @@
 
 #include "BruteForceAccelerator.h"
 
-decimal BruteForceAccelerator::traverse(Ray* r, std::list<Intersection> &result) const
+decimal BruteForceAccelerator::traverse(Ray* r, IntersectionBuffer &result) const
 {
 	//For every shape in the scene
     for (unsigned int i = 0; i < shapes->size(); i++)
     {
         Intersection currentI;
         //Check if the ray intersects the shape
-        if (shapes->at(i)->getIntersection(*r, currentI) && currentI.t > 0.0001)
+        if (getIntersection(i, *r, currentI) && currentI.t > 0.0001)
         {
             result.push_back(currentI);
         }
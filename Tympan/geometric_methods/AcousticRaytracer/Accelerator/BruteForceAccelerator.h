@@ -41,6 +41,6 @@ public:
 
     virtual bool build() { return true; }
 
-    virtual decimal traverse(Ray* r, std::list<Intersection> &result) const;
+    virtual decimal traverse(Ray* r, IntersectionBuffer &result) const;
 };
 #endif
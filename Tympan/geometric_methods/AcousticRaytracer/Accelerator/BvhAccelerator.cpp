@@ -15,6 +15,7 @@
 
 #include "BvhAccelerator.h"
 #include <algorithm>
+#include <thread>
 #include <stdint.h>
 
 // BVHAccel Local Declarations
@@ -36,6 +37,7 @@ struct BVHBuildNode
 {
     // BVHBuildNode Public Methods
     BVHBuildNode() { children[0] = children[1] = NULL; }
+    ~BVHBuildNode() { delete children[0]; delete children[1]; }
     void InitLeaf(unsigned int  first, unsigned int n, const BBox& b)
     {
         firstPrimOffset = first;
@@ -78,51 +80,90 @@ struct ComparePoints
     }
 };
 
-
-struct CompareToBucket
+/// Axis aligned bounds accumulated with plain floats (cheaper than BBox::Union which updates the centroid)
+struct BinBounds
 {
-    CompareToBucket(int split, int num, int d, const BBox& b)
-        : centroidBounds(b)
-    { splitBucket = split; nBuckets = num; dim = d; }
-    bool operator()(const BVHPrimitiveInfo& p) const;
-
-    int splitBucket, nBuckets, dim;
-    const BBox& centroidBounds;
+    BinBounds() { reset(); }
+    void reset()
+    {
+        for (int k = 0; k < 3; ++k) { pMin[k] = 1e30f; pMax[k] = -1e30f; }
+    }
+    void grow(const vec3& p0, const vec3& p1)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            pMin[k] = std::min(pMin[k], (float)p0[k]);
+            pMax[k] = std::max(pMax[k], (float)p1[k]);
+        }
+    }
+    void grow(const BinBounds& b)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            pMin[k] = std::min(pMin[k], b.pMin[k]);
+            pMax[k] = std::max(pMax[k], b.pMax[k]);
+        }
+    }
+    float surfaceArea() const
+    {
+        if (pMin[0] > pMax[0]) { return 0.f; }
+        float dx = pMax[0] - pMin[0], dy = pMax[1] - pMin[1], dz = pMax[2] - pMin[2];
+        return 2.f * (dx * dy + dx * dz + dy * dz);
+    }
+    float pMin[3], pMax[3];
 };
 
+/// Number of bins used to evaluate the SAH on each axis
+static const int SAH_BINS = 16;
+/// Cost of a traversal step relative to a primitive intersection
+static const float SAH_TRAVERSAL_COST = .125f;
+/// Beyond this depth the tree is balanced (equal counts) so that the traversal stack (64 entries) can not overflow
+static const unsigned int BVH_MAX_SAH_DEPTH = 32;
+/// Minimal number of primitives of a subtree to build it on another thread
+static const unsigned int BVH_PARALLEL_BUILD_THRESHOLD = 8192;
 
-bool CompareToBucket::operator()(const BVHPrimitiveInfo& p) const
+struct CompareToBin
 {
-    int b = (int)(nBuckets * ((p.centroid[dim] - centroidBounds.pMin[dim]) /
-                        (centroidBounds.pMax[dim] - centroidBounds.pMin[dim])));
-    if (b == nBuckets) { b = nBuckets - 1; }
+    CompareToBin(int split, int d, float _min, float _scale)
+        : splitBin(split), dim(d), cmin(_min), scale(_scale) { }
+    bool operator()(const BVHPrimitiveInfo& p) const
+    {
+        int b = (int)((p.centroid[dim] - cmin) * scale);
+        if (b >= SAH_BINS) { b = SAH_BINS - 1; }
+        return b <= splitBin;
+    }
 
-	return b <= splitBucket;
-}
+    int splitBin, dim;
+    float cmin, scale;
+};
 
+/**
+ * \brief Compact node of the flattened tree (32 bytes, two nodes per cache line).
+ * The children of an interior node are the next node and the node at secondChildOffset.
+ */
 struct LinearBVHNode
 {
-    BBox bounds;
+    float bounds[2][3];               //!< Lower and upper corners of the node bounding box
     union
     {
         uint32_t primitivesOffset;    //!< leaf
         uint32_t secondChildOffset;   //!< interior
     };
 
-    uint8_t nPrimitives;  //!< 0 -> interior node
-    uint8_t axis;         //!< interior node: xyz
-    uint8_t pad[2];       //!< ensure 32 byte total size
+    uint16_t nPrimitives;  //!< 0 -> interior node
+    uint8_t axis;          //!< interior node: xyz
+    uint8_t pad;           //!< ensure 32 byte total size
 };
 
-static inline bool IntersectP(const BBox& bounds, const Ray& ray,
+static inline bool IntersectP(const LinearBVHNode* node, const Ray& ray,
                               const vec3& invDir, const uint32_t dirIsNeg[3])
 {
     // Check for ray intersection against $x$ and $y$ slabs
 
-    float tmin = (bounds[  dirIsNeg[0]].x - ray.getPosition().x) * invDir.x;
-    float tmax = (bounds[1 - dirIsNeg[0]].x - ray.getPosition().x) * invDir.x;
-    float tymin = (bounds[  dirIsNeg[1]].y - ray.getPosition().y) * invDir.y;
-    float tymax = (bounds[1 - dirIsNeg[1]].y - ray.getPosition().y) * invDir.y;
+    float tmin = (node->bounds[  dirIsNeg[0]][0] - ray.getPosition().x) * invDir.x;
+    float tmax = (node->bounds[1 - dirIsNeg[0]][0] - ray.getPosition().x) * invDir.x;
+    float tymin = (node->bounds[  dirIsNeg[1]][1] - ray.getPosition().y) * invDir.y;
+    float tymax = (node->bounds[1 - dirIsNeg[1]][1] - ray.getPosition().y) * invDir.y;
     if ((tmin > tymax) || (tymin > tmax))
     {
         return false;
@@ -131,8 +172,8 @@ static inline bool IntersectP(const BBox& bounds, const Ray& ray,
     if (tymax < tmax) { tmax = tymax; }
 
     // Check for ray intersection against $z$ slab
-    float tzmin = (bounds[  dirIsNeg[2]].z - ray.getPosition().z) * invDir.z;
-    float tzmax = (bounds[1 - dirIsNeg[2]].z - ray.getPosition().z) * invDir.z;
+    float tzmin = (node->bounds[  dirIsNeg[2]][2] - ray.getPosition().z) * invDir.z;
+    float tzmax = (node->bounds[1 - dirIsNeg[2]][2] - ray.getPosition().z) * invDir.z;
     if ((tmin > tzmax) || (tzmin > tmax))
     {
         return false;
@@ -150,7 +191,8 @@ static inline bool IntersectP(const BBox& bounds, const Ray& ray,
 
 // BVHAccel Method Definitions
 BvhAccelerator::BvhAccelerator(std::vector<Shape*>* _initialMesh,
-                               BBox _globalBox, unsigned int maxProf, const string& sm) : Accelerator(_initialMesh, _globalBox)
+                               BBox _globalBox, unsigned int maxProf, const string& sm) : Accelerator(_initialMesh, _globalBox),
+                                                                                          nodes(NULL), nbNodes(0), nbBuildThreads(0)
 {
     maxPrimsInNode = min(255u, maxProf);
 
@@ -170,58 +212,54 @@ BvhAccelerator::BvhAccelerator(std::vector<Shape*>* _initialMesh,
 }
 
 BVHBuildNode* BvhAccelerator::recursiveBuild(std::vector<BVHPrimitiveInfo> &buildData, uint32_t start,
-                                             uint32_t end, uint32_t* totalNodes,
-                                             std::vector< Shape* > &orderedPrims)
+                                             uint32_t end, uint32_t depth, uint32_t* totalNodes,
+                                             unsigned int nbThreads) const
 {
 
     (*totalNodes)++;
     BVHBuildNode* node = new BVHBuildNode();
-    // Compute bounds of all primitives in BVH node
-    BBox bbox;
+    // Compute bounds of all primitives in BVH node and bound of primitive centroids
+    BinBounds bbox, centroidBounds;
     for (uint32_t i = start; i < end; ++i)
     {
-        bbox = bbox.Union(buildData[i].bounds);
+        bbox.grow(buildData[i].bounds.pMin, buildData[i].bounds.pMax);
+        centroidBounds.grow(buildData[i].centroid, buildData[i].centroid);
     }
+    BBox bounds(vec3(bbox.pMin[0], bbox.pMin[1], bbox.pMin[2]), vec3(bbox.pMax[0], bbox.pMax[1], bbox.pMax[2]));
+
+    // The leaves reference the primitives in buildData order, see build()
     uint32_t nPrimitives = end - start;
     if (nPrimitives == 1)
     {
-        // Create leaf _BVHBuildNode_
-        uint32_t firstPrimOffset = orderedPrims.size();
-        for (uint32_t i = start; i < end; ++i)
-        {
-            uint32_t primNum = buildData[i].primitiveNumber;
-            orderedPrims.push_back(primitives.at(primNum));
-        }
-        node->InitLeaf(firstPrimOffset, nPrimitives, bbox);
+        node->InitLeaf(start, nPrimitives, bounds);
+        return node;
     }
-    else
+
+    // Choose split dimension _dim_
+    int dim = 0;
+    for (int k = 1; k < 3; ++k)
     {
-        // Compute bound of primitive centroids, choose split dimension _dim_
-        BBox centroidBounds;
-        for (uint32_t i = start; i < end; ++i)
-        {
-            centroidBounds = centroidBounds.Union(buildData[i].centroid);
-        }
-        int dim = centroidBounds.MaximumExtend();
+        if (centroidBounds.pMax[k] - centroidBounds.pMin[k] > centroidBounds.pMax[dim] - centroidBounds.pMin[dim]) { dim = k; }
+    }
 
-        // Partition primitives into two sets and build children
-        uint32_t mid = (start + end) / 2;
+    // Partition primitives into two sets and build children
+    uint32_t mid = (start + end) / 2;
 
-		if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim])
+    if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim])
+    {
+        // All the centroids are the same: create a leaf, unless it has too many primitives
+        // for a node (then simply split the list in two halves)
+        if (nPrimitives <= maxPrimsInNode)
         {
-            // Create leaf _BVHBuildNode_
-            uint32_t firstPrimOffset = orderedPrims.size();
-            for (uint32_t i = start; i < end; ++i)
-            {
-                uint32_t primNum = buildData[i].primitiveNumber;
-                orderedPrims.push_back(primitives.at(primNum));
-            }
-            node->InitLeaf(firstPrimOffset, nPrimitives, bbox);
+            node->InitLeaf(start, nPrimitives, bounds);
             return node;
         }
-
+    }
+    else
+    {
         // Partition primitives based on _splitMethod_
-        switch (splitMethod)
+        SplitMethod method = (depth < BVH_MAX_SAH_DEPTH) ? splitMethod : SPLIT_EQUAL_COUNTS;
+        switch (method)
         {
             case SPLIT_MIDDLE:
             {
@@ -249,113 +287,138 @@ BVHBuildNode* BvhAccelerator::recursiveBuild(std::vector<BVHPrimitiveInfo> &buil
             }
         case SPLIT_SAH: default:
             {
-                // Partition primitives using approximate SAH
+                // Partition primitives using binned SAH
                 if (nPrimitives <= 4)
                 {
                     // Partition primitives into equally-sized subsets
                     mid = (start + end) / 2;
                     std::nth_element(&buildData[start], &buildData[mid],
                                      &buildData[end - 1] + 1, ComparePoints(dim));
+                    break;
                 }
-                else
+
+                // Evaluate the SAH at each bin boundary of the three axes
+                float minCost = 1e30f;
+                int minCostSplit = -1, minCostDim = dim;
+                float minCostScale = 0.f;
+                for (int axis = 0; axis < 3; ++axis)
                 {
-                    // Allocate _BucketInfo_ for SAH partition buckets
-                    const int nBuckets = 12;
-                    struct BucketInfo
-                    {
-                        BucketInfo() { count = 0; }
-                        int count;
-                        BBox bounds;
-                    };
-                    BucketInfo buckets[nBuckets];
+                    float extent = centroidBounds.pMax[axis] - centroidBounds.pMin[axis];
+                    if (extent <= 0.f) { continue; }
+                    float scale = SAH_BINS / extent;
 
-                    // Initialize _BucketInfo_ for SAH partition buckets
+                    int counts[SAH_BINS] = { 0 };
+                    BinBounds bins[SAH_BINS];
                     for (uint32_t i = start; i < end; ++i)
                     {
-                        int b = (int)(nBuckets *
-                                ((buildData[i].centroid[dim] - centroidBounds.pMin[dim]) /
-                                 (centroidBounds.pMax[dim] - centroidBounds.pMin[dim])));
-                        if (b == nBuckets) { b = nBuckets - 1; }
-                        buckets[b].count++;
-                        buckets[b].bounds = buckets[b].bounds.Union(buildData[i].bounds);
+                        int b = (int)((buildData[i].centroid[axis] - centroidBounds.pMin[axis]) * scale);
+                        if (b >= SAH_BINS) { b = SAH_BINS - 1; }
+                        counts[b]++;
+                        bins[b].grow(buildData[i].bounds.pMin, buildData[i].bounds.pMax);
                     }
 
-                    // Compute costs for splitting after each bucket
-                    float cost[nBuckets - 1];
-                    for (int i = 0; i < nBuckets - 1; ++i)
+                    // Sweep from the right to get the area of the primitives above each boundary, then from the left
+                    float rightArea[SAH_BINS];
+                    int rightCount[SAH_BINS];
+                    BinBounds acc;
+                    int count = 0;
+                    for (int i = SAH_BINS - 1; i > 0; --i)
                     {
-                        BBox b0, b1;
-                        int count0 = 0, count1 = 0;
-                        for (int j = 0; j <= i; ++j)
-                        {
-                            b0 = b0.Union(buckets[j].bounds);
-                            count0 += buckets[j].count;
-                        }
-                        for (int j = i + 1; j < nBuckets; ++j)
-                        {
-                            b1 = b1.Union(buckets[j].bounds);
-                            count1 += buckets[j].count;
-                        }
-                        cost[i] = .125f + (decimal)((count0 * b0.SurfaceArea() + count1 * b1.SurfaceArea()) /
-                                  bbox.SurfaceArea());
+                        acc.grow(bins[i]);
+                        count += counts[i];
+                        rightArea[i] = acc.surfaceArea();
+                        rightCount[i] = count;
                     }
-
-                    // Find bucket to split at that minimizes SAH metric
-                    float minCost = cost[0];
-                    uint32_t minCostSplit = 0;
-                    for (int i = 1; i < nBuckets - 1; ++i)
+                    acc.reset();
+                    count = 0;
+                    for (int i = 0; i < SAH_BINS - 1; ++i)
                     {
-                        if (cost[i] < minCost)
+                        acc.grow(bins[i]);
+                        count += counts[i];
+                        if (count == 0 || rightCount[i + 1] == 0) { continue; }
+                        float cost = count * acc.surfaceArea() + rightCount[i + 1] * rightArea[i + 1];
+                        if (cost < minCost)
                         {
-                            minCost = cost[i];
+                            minCost = cost;
                             minCostSplit = i;
+                            minCostDim = axis;
+                            minCostScale = scale;
                         }
                     }
+                }
 
-                    // Either create leaf or split primitives at selected SAH bucket
-                    if (nPrimitives > maxPrimsInNode ||
-                        minCost < nPrimitives)
-                    {
-                        BVHPrimitiveInfo* pmid = std::partition(&buildData[start],
-                                                                &buildData[end - 1] + 1,
-                                                                CompareToBucket(minCostSplit, nBuckets, dim, centroidBounds));
-                        mid = pmid - &buildData[0];
-                    }
+                float area = bbox.surfaceArea();
+                minCost = SAH_TRAVERSAL_COST + (area > 0.f ? minCost / area : 0.f);
 
-                    else
+                // Either create leaf or split primitives at selected SAH bin
+                if (minCostSplit >= 0 && (nPrimitives > maxPrimsInNode || minCost < nPrimitives))
+                {
+                    dim = minCostDim;
+                    BVHPrimitiveInfo* pmid = std::partition(&buildData[start],
+                                                            &buildData[end - 1] + 1,
+                                                            CompareToBin(minCostSplit, dim, centroidBounds.pMin[dim], minCostScale));
+                    mid = pmid - &buildData[0];
+                    if (mid == start || mid == end)
                     {
-                        // Create leaf _BVHBuildNode_
-                        uint32_t firstPrimOffset = orderedPrims.size();
-                        for (uint32_t i = start; i < end; ++i)
-                        {
-                            uint32_t primNum = buildData[i].primitiveNumber;
-                            orderedPrims.push_back(primitives.at(primNum));
-                        }
-                        node->InitLeaf(firstPrimOffset, nPrimitives, bbox);
-                        return node;
+                        mid = (start + end) / 2;
+                        std::nth_element(&buildData[start], &buildData[mid],
+                                         &buildData[end - 1] + 1, ComparePoints(dim));
                     }
                 }
+                else if (nPrimitives <= maxPrimsInNode)
+                {
+                    node->InitLeaf(start, nPrimitives, bounds);
+                    return node;
+                }
+                else
+                {
+                    mid = (start + end) / 2;
+                    std::nth_element(&buildData[start], &buildData[mid],
+                                     &buildData[end - 1] + 1, ComparePoints(dim));
+                }
                 break;
             }
         }
-        node->InitInterior(dim,
-                           recursiveBuild(buildData, start, mid,
-                                          totalNodes, orderedPrims),
-                           recursiveBuild(buildData, mid, end,
-                                          totalNodes, orderedPrims));
     }
+
+    // Build the children, the first one on another thread if the subtree is large enough.
+    // Both subtrees work on disjoint ranges of buildData, hence the tree does not depend on the number of threads.
+    BVHBuildNode* children[2] = { NULL, NULL };
+    if (nbThreads > 1 && (mid - start) >= BVH_PARALLEL_BUILD_THRESHOLD && (end - mid) >= BVH_PARALLEL_BUILD_THRESHOLD)
+    {
+        uint32_t leftNodes = 0;
+        std::thread worker([&]()
+        {
+            children[0] = recursiveBuild(buildData, start, mid, depth + 1, &leftNodes, nbThreads / 2);
+        });
+        children[1] = recursiveBuild(buildData, mid, end, depth + 1, totalNodes, nbThreads - nbThreads / 2);
+        worker.join();
+        *totalNodes += leftNodes;
+    }
+    else
+    {
+        children[0] = recursiveBuild(buildData, start, mid, depth + 1, totalNodes, nbThreads);
+        children[1] = recursiveBuild(buildData, mid, end, depth + 1, totalNodes, nbThreads);
+    }
+    node->InitInterior(dim, children[0], children[1]);
     return node;
 }
 
 uint32_t BvhAccelerator::flattenBVHTree(BVHBuildNode* node, uint32_t* offset)
 {
     LinearBVHNode* linearNode = &nodes[*offset];
-    linearNode->bounds = node->bounds;
+    for (int k = 0; k < 3; ++k)
+    {
+        linearNode->bounds[0][k] = node->bounds.pMin[k];
+        linearNode->bounds[1][k] = node->bounds.pMax[k];
+    }
+    linearNode->pad = 0;
     uint32_t myOffset = (*offset)++;
     if (node->nPrimitives > 0)
     {
         linearNode->primitivesOffset = node->firstPrimOffset;
         linearNode->nPrimitives = node->nPrimitives;
+        linearNode->axis = 0;
     }
     else
     {
@@ -369,7 +432,7 @@ uint32_t BvhAccelerator::flattenBVHTree(BVHBuildNode* node, uint32_t* offset)
     return myOffset;
 }
 
-decimal BvhAccelerator::traverse(Ray* ray, std::list<Intersection> &result) const
+decimal BvhAccelerator::traverse(Ray* ray, IntersectionBuffer &result) const
 {
     if (!nodes) { return -1.; }
 
@@ -383,7 +446,7 @@ decimal BvhAccelerator::traverse(Ray* ray, std::list<Intersection> &result) cons
     {
         const LinearBVHNode* node = &nodes[nodeNum];
         // Check ray against BVH node
-        if (::IntersectP(node->bounds, ray, invDir, dirIsNeg))
+        if (::IntersectP(node, *ray, invDir, dirIsNeg))
         {
             if (node->nPrimitives > 0)
             {
@@ -394,7 +457,7 @@ decimal BvhAccelerator::traverse(Ray* ray, std::list<Intersection> &result) cons
                 for (uint32_t i = 0; i < node->nPrimitives; ++i)
                 {
                     //PBRT_BVH_INTERSECTION_PRIMITIVE_TEST(const_cast<Primitive *>(primitives[node->primitivesOffset+i].GetPtr()));
-                    if (primitives.at(node->primitivesOffset + i)->getIntersection(*ray, currentIntersection) && currentIntersection.t > 0.0001)
+                    if (getIntersection(primitiveIndices[node->primitivesOffset + i], *ray, currentIntersection) && currentIntersection.t > 0.0001)
                     {
                         //PBRT_BVH_INTERSECTION_PRIMITIVE_HIT(const_cast<Primitive *>(primitives[node->primitivesOffset+i].GetPtr()));
                         result.push_back(currentIntersection);
@@ -436,11 +499,141 @@ decimal BvhAccelerator::traverse(Ray* ray, std::list<Intersection> &result) cons
     return intermin;
 }
 
+void BvhAccelerator::traversePacket(Ray** rays, unsigned int nbRays, IntersectionBuffer* results, decimal* tmins) const
+{
+    // Group the rays by direction octant, the rays of a group visit the nodes in the same order
+    unsigned int octantRays[8][MAX_PACKET_SIZE];
+    unsigned int octantSize[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    for (unsigned int i = 0; i < nbRays; ++i)
+    {
+        tmins[i] = -1.;
+        const vec3& dir = rays[i]->getDirection();
+        vec3 invDir(1.f / dir.x, 1.f / dir.y, 1.f / dir.z);
+        unsigned int octant = (invDir.x < 0) | ((invDir.y < 0) << 1) | ((invDir.z < 0) << 2);
+        octantRays[octant][octantSize[octant]++] = i;
+    }
+
+    if (!nodes) { return; }
+
+    for (unsigned int octant = 0; octant < 8; ++octant)
+    {
+        if (octantSize[octant] > 0)
+        {
+            traverseCoherentPacket(rays, octantRays[octant], octantSize[octant], results, tmins);
+        }
+    }
+}
+
+void BvhAccelerator::traverseCoherentPacket(Ray** rays, const unsigned int* indices, unsigned int nbRays,
+                                            IntersectionBuffer* results, decimal* tmins) const
+{
+    // Structure of arrays copy of the rays, so that the packet vs box test is vectorized
+    decimal orgX[MAX_PACKET_SIZE], orgY[MAX_PACKET_SIZE], orgZ[MAX_PACKET_SIZE];
+    decimal invX[MAX_PACKET_SIZE], invY[MAX_PACKET_SIZE], invZ[MAX_PACKET_SIZE];
+    decimal rayMin[MAX_PACKET_SIZE], rayMax[MAX_PACKET_SIZE];
+    for (unsigned int k = 0; k < nbRays; ++k)
+    {
+        const Ray* ray = rays[indices[k]];
+        orgX[k] = ray->getPosition().x;
+        orgY[k] = ray->getPosition().y;
+        orgZ[k] = ray->getPosition().z;
+        invX[k] = 1.f / ray->getDirection().x;
+        invY[k] = 1.f / ray->getDirection().y;
+        invZ[k] = 1.f / ray->getDirection().z;
+        rayMin[k] = ray->getMint();
+        rayMax[k] = ray->getMaxt();
+    }
+    uint32_t dirIsNeg[3] = { invX[0] < 0, invY[0] < 0, invZ[0] < 0 };
+
+    // Follow the packet through BVH nodes, each stack entry keeps the mask of the rays which reach the node
+    uint32_t todoOffset = 0, nodeNum = 0;
+    uint32_t todo[64], todoMask[64];
+    uint32_t activeMask = (1u << nbRays) - 1;
+    while (true)
+    {
+        const LinearBVHNode* node = &nodes[nodeNum];
+
+        // Check the packet against the BVH node (same computations as IntersectP)
+        decimal bxMin = node->bounds[dirIsNeg[0]][0], bxMax = node->bounds[1 - dirIsNeg[0]][0];
+        decimal byMin = node->bounds[dirIsNeg[1]][1], byMax = node->bounds[1 - dirIsNeg[1]][1];
+        decimal bzMin = node->bounds[dirIsNeg[2]][2], bzMax = node->bounds[1 - dirIsNeg[2]][2];
+        bool hit[MAX_PACKET_SIZE];
+        for (unsigned int k = 0; k < nbRays; ++k)
+        {
+            float tmin = (bxMin - orgX[k]) * invX[k];
+            float tmax = (bxMax - orgX[k]) * invX[k];
+            float tymin = (byMin - orgY[k]) * invY[k];
+            float tymax = (byMax - orgY[k]) * invY[k];
+            bool inside = !((tmin > tymax) || (tymin > tmax));
+            tmin = (tymin > tmin) ? tymin : tmin;
+            tmax = (tymax < tmax) ? tymax : tmax;
+            float tzmin = (bzMin - orgZ[k]) * invZ[k];
+            float tzmax = (bzMax - orgZ[k]) * invZ[k];
+            inside = inside && !((tmin > tzmax) || (tzmin > tmax));
+            tmin = (tzmin > tmin) ? tzmin : tmin;
+            tmax = (tzmax < tmax) ? tzmax : tmax;
+            hit[k] = inside && (tmin < rayMax[k]) && (tmax > rayMin[k]);
+        }
+        uint32_t hitMask = 0;
+        for (unsigned int k = 0; k < nbRays; ++k)
+        {
+            if (hit[k]) { hitMask |= (1u << k); }
+        }
+        hitMask &= activeMask;
+
+        if (hitMask && node->nPrimitives > 0)
+        {
+            // Intersect each ray of the packet reaching the leaf with its primitives
+            for (unsigned int k = 0; k < nbRays; ++k)
+            {
+                if (!(hitMask & (1u << k))) { continue; }
+
+                Ray* ray = rays[indices[k]];
+                IntersectionBuffer& result = results[indices[k]];
+                decimal& intermin = tmins[indices[k]];
+                Intersection currentIntersection;
+                for (uint32_t i = 0; i < node->nPrimitives; ++i)
+                {
+                    if (getIntersection(primitiveIndices[node->primitivesOffset + i], *ray, currentIntersection) && currentIntersection.t > 0.0001)
+                    {
+                        result.push_back(currentIntersection);
+                        intermin = (*pLeafTreatmentFunction) (result, intermin);
+                    }
+                }
+            }
+        }
+        else if (hitMask)
+        {
+            // Put far BVH node on _todo_ stack, advance to near node
+            if (dirIsNeg[node->axis])
+            {
+                todo[todoOffset] = nodeNum + 1;
+                nodeNum = node->secondChildOffset;
+            }
+            else
+            {
+                todo[todoOffset] = node->secondChildOffset;
+                nodeNum = nodeNum + 1;
+            }
+            todoMask[todoOffset++] = hitMask;
+            activeMask = hitMask;
+            continue;
+        }
+
+        if (todoOffset == 0) { break; }
+        --todoOffset;
+        nodeNum = todo[todoOffset];
+        activeMask = todoMask[todoOffset];
+    }
+}
+
 bool BvhAccelerator::build()
 {
+    free(nodes);
+    nodes = NULL;
+    nbNodes = 0;
     if (shapes->size() == 0)
     {
-        nodes = NULL;
         return false;
     }
 
@@ -454,14 +647,19 @@ bool BvhAccelerator::build()
     }
 
     // Recursively build BVH tree for primitives
-    //MemoryArena buildArena;
+    unsigned int nbThreads = nbBuildThreads ? nbBuildThreads : std::thread::hardware_concurrency();
     uint32_t totalNodes = 0;
-    std::vector<Shape* > orderedPrims;
-    orderedPrims.reserve(shapes->size());
     BVHBuildNode* root = recursiveBuild(buildData, 0,
-                                        primitives.size(), &totalNodes,
-                                        orderedPrims);
-    primitives.swap(orderedPrims);
+                                        buildData.size(), 0, &totalNodes,
+                                        nbThreads);
+
+    // Each leaf references a range of buildData, which is now the primitives order
+    primitiveIndices.resize(buildData.size());
+    for (uint32_t i = 0; i < buildData.size(); ++i)
+    {
+        primitiveIndices[i] = buildData[i].primitiveNumber;
+        primitives[i] = shapes->at(primitiveIndices[i]);
+    }
 
     // Compute representation of depth-first traversal of BVH tree
     nodes = (LinearBVHNode*)malloc(totalNodes * sizeof(LinearBVHNode));
@@ -471,6 +669,8 @@ bool BvhAccelerator::build()
     }
     uint32_t offset = 0;
     flattenBVHTree(root, &offset);
+    nbNodes = totalNodes;
+    delete root;
 
     return true;
 }
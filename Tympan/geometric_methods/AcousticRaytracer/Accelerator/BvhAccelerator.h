@@ -41,7 +41,14 @@ public:
 
     virtual bool build();
 
-    virtual decimal traverse(Ray* r, std::list<Intersection> &result) const;
+    virtual decimal traverse(Ray* r, IntersectionBuffer &result) const;
+
+    /**
+     * \brief Run this accelerator on a packet of rays
+     * The rays are grouped by direction octant and each group traverses the tree as a whole: a node
+     * is visited once for all the rays which reach it. Each ray gets the same result as with traverse().
+     */
+    virtual void traversePacket(Ray** rays, unsigned int nbRays, IntersectionBuffer* results, decimal* tmins) const;
 
     /// Set maximal depth
     void setMaxProfondeur(int _maxProfondeur) { maxProfondeur = _maxProfondeur; }
@@ -51,6 +58,10 @@ public:
     void setMaxPrimPerLeaf(int _maxPrimPerLeaf) { maxPrimPerLeaf = _maxPrimPerLeaf; }
     /// Get maximal primitives per leaf
     int getMaxPrimPerLeaf() { return maxPrimPerLeaf; }
+    /// Set the number of threads building the tree (0 means the number of hardware threads)
+    void setNbBuildThreads(unsigned int _nbBuildThreads) { nbBuildThreads = _nbBuildThreads; }
+    /// Get the number of nodes of the tree (once built)
+    unsigned int getNbNodes() const { return nbNodes; }
     /// Get the vector of bounding boxes
     std::vector<BBox>& getBBox() { return tableBox; }
 
@@ -64,17 +75,27 @@ public:
 */
 protected:
     // BVHAccel Private Methods
+    /**
+     * \brief Build the subtree of the primitives buildData[start, end[ (reordered so that each leaf references a range)
+     * The subtrees of large nodes are built in parallel by nbThreads threads.
+     */
     BVHBuildNode* recursiveBuild(std::vector<BVHPrimitiveInfo> &buildData, unsigned int start, unsigned int end,
-                                 unsigned int* totalNodes, std::vector<Shape* > &orderedPrims);
+                                 unsigned int depth, unsigned int* totalNodes, unsigned int nbThreads) const;
     unsigned int flattenBVHTree(BVHBuildNode* node, unsigned int* offset);
+    /// Traverse the tree with rays having all the same direction octant (indices[] of the rays in the packet)
+    void traverseCoherentPacket(Ray** rays, const unsigned int* indices, unsigned int nbRays,
+                                IntersectionBuffer* results, decimal* tmins) const;
 
     // BVHAccel Private Data
     unsigned int maxPrimsInNode;	//!< Maximal primitives in node
     enum SplitMethod { SPLIT_MIDDLE, SPLIT_EQUAL_COUNTS, SPLIT_SAH };
     SplitMethod splitMethod;	//!< Split method
     LinearBVHNode* nodes;		//!< Nodes list
+    unsigned int nbNodes;		//!< Number of nodes
+    unsigned int nbBuildThreads;	//!< Number of threads building the tree (0: number of hardware threads)
 
     std::vector<Shape*> primitives; //!< Pointer to all the shapes (different from initialMesh) as it is reordered
+    std::vector<unsigned int> primitiveIndices; //!< Index in initialMesh of each primitive (same order as primitives)
     BBox globalBox;			//!< Global bounding box
 
     std::vector<BBox> tableBox; //!< Bounding boxes vector
@@ -72,12 +72,12 @@ bool GridAccelerator::build()
                     if (!voxels[o])
                     {
                         // Allocate new voxel and store primitive in it
-                        voxels[o] = new Voxel(primitives.at(i));
+                        voxels[o] = new Voxel(i);
                     }
                     else
                     {
                         // Add primitive to already-allocated voxel
-                        voxels[o]->AddPrimitive(primitives.at(i));
+                        voxels[o]->AddPrimitive(i);
                     }
                 }
     }
@@ -85,7 +85,7 @@ bool GridAccelerator::build()
     return true;
 }
 
-decimal GridAccelerator::traverse(Ray* r, std::list<Intersection> &result) const
+decimal GridAccelerator::traverse(Ray* r, IntersectionBuffer &result) const
 {
     decimal rayT;
     decimal intermin = -1.;
@@ -135,7 +135,7 @@ decimal GridAccelerator::traverse(Ray* r, std::list<Intersection> &result) const
         Voxel* voxel = voxels[offset(Pos[0], Pos[1], Pos[2])];
         if (voxel != NULL)
         {
-            voxel->Intersect(r, result, intermin, intersectionChoice);
+            voxel->Intersect(r, result, intermin, intersectionChoice, this);
         }
 
         // Advance to next voxel
@@ -160,7 +160,7 @@ decimal GridAccelerator::traverse(Ray* r, std::list<Intersection> &result) const
     return intermin;
 }
 
-bool Voxel::Intersect(Ray* ray, std::list<Intersection> &result, decimal& intermin, leafTreatment::treatment choice)
+bool Voxel::Intersect(Ray* ray, IntersectionBuffer &result, decimal& intermin, leafTreatment::treatment choice, const Accelerator* accelerator)
 {
 
     // Loop over primitives in voxel and find intersections
@@ -168,9 +168,8 @@ bool Voxel::Intersect(Ray* ray, std::list<Intersection> &result, decimal& interm
 
     for (uint32_t i = 0; i < primitives.size(); ++i)
     {
-        Shape* prim = primitives[i];
         Intersection currentIntersection;
-        if (prim->getIntersection(*ray, currentIntersection) && currentIntersection.t > 0.0001)
+        if (accelerator->getIntersection(primitives[i], *ray, currentIntersection) && currentIntersection.t > 0.0001)
         {
             hitSomething = true;
             result.push_back(currentIntersection);
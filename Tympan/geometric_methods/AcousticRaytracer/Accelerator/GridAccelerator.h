@@ -33,18 +33,18 @@ struct Voxel
     /// Default constructor
     Voxel() { allCanIntersect = true; }
     /// Constructor
-    Voxel(Shape* op)
+    Voxel(unsigned int op)
     {
         allCanIntersect = true;
         primitives.push_back(op);
     }
-    void AddPrimitive(Shape* prim)
+    void AddPrimitive(unsigned int prim)
     {
         primitives.push_back(prim);
     }
-    bool Intersect(Ray* ray, std::list<Intersection> &result, decimal& intermin, leafTreatment::treatment choice);
+    bool Intersect(Ray* ray, IntersectionBuffer &result, decimal& intermin, leafTreatment::treatment choice, const Accelerator* accelerator);
 private:
-    std::vector< Shape* > primitives; //!< Vector containing the primitives
+    std::vector<unsigned int> primitives; //!< Vector containing the indices of the primitives
     bool allCanIntersect;	//!< Flag not used
 };
 
@@ -68,7 +68,7 @@ public:
 
     virtual bool build();
 
-    virtual decimal traverse(Ray* r, std::list<Intersection> &result) const;
+    virtual decimal traverse(Ray* r, IntersectionBuffer &result) const;
     /// Set maximal depth
     void setMaxProfondeur(int _maxProfondeur) { maxProfondeur = _maxProfondeur; }
     /// Get maximal depth
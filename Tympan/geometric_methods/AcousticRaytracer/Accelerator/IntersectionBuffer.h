@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef INTERSECTION_BUFFER_H
+#define INTERSECTION_BUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+
+#include "Geometry/Shape.h"
+
+/**
+ * \brief Contiguous list of intersections used by the accelerators and the leaf treatments
+ *
+ * The first INLINE_CAPACITY intersections are stored inside the object, the following ones on the heap.
+ * clear() keeps the allocated memory, so a buffer owned by the caller (one per engine, hence per thread)
+ * can be reused for each ray without any allocation.
+ */
+class IntersectionBuffer
+{
+
+public:
+    typedef Intersection* iterator;
+    typedef const Intersection* const_iterator;
+
+    static const unsigned int INLINE_CAPACITY = 8; //!< Number of intersections stored without allocation
+
+    /// Constructor
+    IntersectionBuffer() : data(inlineData), count(0), capacity(INLINE_CAPACITY) { }
+    /// Copy constructor
+    IntersectionBuffer(const IntersectionBuffer& other) : data(inlineData), count(0), capacity(INLINE_CAPACITY)
+    {
+        *this = other;
+    }
+    /// Destructor
+    ~IntersectionBuffer() { if (data != inlineData) { delete [] data; } }
+    /// Assignment operator
+    IntersectionBuffer& operator=(const IntersectionBuffer& other)
+    {
+        if (this != &other)
+        {
+            reserve(other.count);
+            std::copy(other.begin(), other.end(), data);
+            count = other.count;
+        }
+        return *this;
+    }
+
+    /// Iterators
+    iterator begin() { return data; }
+    iterator end() { return data + count; }
+    const_iterator begin() const { return data; }
+    const_iterator end() const { return data + count; }
+
+    /// Number of intersections
+    size_t size() const { return count; }
+    /// Return true if there is no intersection
+    bool empty() const { return count == 0; }
+    /// Remove all the intersections (the memory is kept for a next use)
+    void clear() { count = 0; }
+
+    /// Access to the intersections
+    Intersection& operator[](size_t i) { return data[i]; }
+    const Intersection& operator[](size_t i) const { return data[i]; }
+    Intersection& front() { return data[0]; }
+    Intersection& back() { return data[count - 1]; }
+
+    /// Add an intersection at the end
+    void push_back(const Intersection& inter)
+    {
+        if (count == capacity) { reserve(2 * capacity); }
+        data[count++] = inter;
+    }
+    /// Remove an intersection and return an iterator on the next one (the order is kept)
+    iterator erase(iterator it)
+    {
+        std::copy(it + 1, end(), it);
+        count--;
+        return it;
+    }
+    /// Sort the intersections (stable, as std::list::sort)
+    template <class Compare>
+    void sort(Compare comp) { std::stable_sort(begin(), end(), comp); }
+
+    /// Exchange the content of two buffers
+    void swap(IntersectionBuffer& other)
+    {
+        if (data != inlineData && other.data != other.inlineData)
+        {
+            std::swap(data, other.data);
+            std::swap(count, other.count);
+            std::swap(capacity, other.capacity);
+            return;
+        }
+        IntersectionBuffer tmp(*this);
+        *this = other;
+        other = tmp;
+    }
+
+    /// Make room for n intersections
+    void reserve(size_t n)
+    {
+        if (n <= capacity) { return; }
+        Intersection* newData = new Intersection[n];
+        std::copy(begin(), end(), newData);
+        if (data != inlineData) { delete [] data; }
+        data = newData;
+        capacity = n;
+    }
+
+private:
+    Intersection inlineData[INLINE_CAPACITY];   //!< Storage of the first intersections
+    Intersection* data;                         //!< Storage in use (inlineData or heap)
+    size_t count;                               //!< Number of intersections
+    size_t capacity;                            //!< Capacity of the storage in use
+};
+
+#endif
@@ -174,7 +174,7 @@ void KdtreeAccelerator::generateMidKdTree(int currentProfondeur, BBox& localBox,
     generateMidKdTree(currentProfondeur + 1, secondBox, n1, prims1);
 }
 
-decimal KdtreeAccelerator::traverse(Ray* r, std::list<Intersection> &result) const
+decimal KdtreeAccelerator::traverse(Ray* r, IntersectionBuffer &result) const
 {
 
     decimal tmin, tmax, intermin = -1.;
@@ -245,11 +245,10 @@ decimal KdtreeAccelerator::traverse(Ray* r, std::list<Intersection> &result) con
             unsigned int nPrimitives = node->getNbPrimitives();
             if (nPrimitives == 1)
             {
-                Shape* prim = initialMesh->at(node->getFirstIndex());
                 // Check one primitive inside leaf node
 
                 Intersection currentIntersection;
-                if (prim->getIntersection(*r, currentIntersection) && currentIntersection.t > 0.0001)
+                if (getIntersection(node->getFirstIndex(), *r, currentIntersection) && currentIntersection.t > 0.0001)
                 {
                     result.push_back(currentIntersection);
 //                    intermin = leafTreatment::keepFunction(intersectionChoice, result, intermin);
@@ -261,12 +260,10 @@ decimal KdtreeAccelerator::traverse(Ray* r, std::list<Intersection> &result) con
                 unsigned int* prims = node->getPrims();
                 for (unsigned int i = 0; i < nPrimitives; i++)
                 {
-                    Shape* prim = initialMesh->at(prims[i]);
-
                     // Check one primitive inside leaf node
 
                     Intersection currentIntersection;
-                    if (prim->getIntersection(*r, currentIntersection) && currentIntersection.t > 0.0001)
+                    if (getIntersection(prims[i], *r, currentIntersection) && currentIntersection.t > 0.0001)
                     {
                         result.push_back(currentIntersection);
                         //intermin = leafTreatment::keepFunction(intersectionChoice, result, intermin);
@@ -128,7 +128,7 @@ public:
 
     virtual bool build();
 
-    virtual decimal traverse(Ray* r, std::list<Intersection> &result) const;
+    virtual decimal traverse(Ray* r, IntersectionBuffer &result) const;
 
     /// Set maximal depth
     void setMaxProfondeur(int _maxProfondeur) { maxProfondeur = _maxProfondeur; }
@@ -19,7 +19,7 @@
 namespace leafTreatment
 {
 
-decimal keepFunction(treatment choice, std::list<Intersection> &currentIntersections, decimal currentTmin)
+decimal keepFunction(treatment choice, IntersectionBuffer &currentIntersections, decimal currentTmin)
 {
     //std::cout<<"Il faut filtrer "<<currentIntersections.size()<<" intersections."<<std::endl;
     switch (choice)
@@ -42,16 +42,16 @@ decimal keepFunction(treatment choice, std::list<Intersection> &currentIntersect
     }
 }
 
-decimal keepFirst(std::list<Intersection> &currentIntersections, decimal currentTmin)
+decimal keepFirst(IntersectionBuffer &currentIntersections, decimal currentTmin)
 {
     if (currentIntersections.empty()) { return currentTmin; }
 
     //Set the max tmin to currentTmin
     decimal tmin = currentTmin;
-    std::list<Intersection>::iterator firstInter = currentIntersections.end();
+    IntersectionBuffer::iterator firstInter = currentIntersections.end();
 
     //Browse through all intersections found
-    for (std::list<Intersection>::iterator it = currentIntersections.begin(); it != currentIntersections.end(); it++)
+    for (IntersectionBuffer::iterator it = currentIntersections.begin(); it != currentIntersections.end(); it++)
     {
         //Check if the current intersection happens before the closest one we found so far in term of tmin
         if (tmin < 0. || it->t <= tmin)
@@ -76,7 +76,7 @@ decimal keepFirst(std::list<Intersection> &currentIntersections, decimal current
     return tmin;
 }
 
-decimal keepAllBeforeTriangle(std::list<Intersection> &currentIntersections, decimal currentTmin)
+decimal keepAllBeforeTriangle(IntersectionBuffer &currentIntersections, decimal currentTmin)
 {
     if (currentIntersections.empty()) { return currentTmin; }
 
@@ -84,7 +84,7 @@ decimal keepAllBeforeTriangle(std::list<Intersection> &currentIntersections, dec
     decimal tmin = currentTmin;
 
     //Find the tmin of the first intersection with a triangle
-    for (std::list<Intersection>::iterator it = currentIntersections.begin(); it != currentIntersections.end(); it++)
+    for (IntersectionBuffer::iterator it = currentIntersections.begin(); it != currentIntersections.end(); it++)
     {
         Triangle* triangle = dynamic_cast<Triangle*>(it->p);
         if (triangle && (tmin < 0. || it->t < tmin))
@@ -93,12 +93,12 @@ decimal keepAllBeforeTriangle(std::list<Intersection> &currentIntersections, dec
         }
     }
     
-    std::list<Intersection>::iterator it = currentIntersections.begin();
+    IntersectionBuffer::iterator it = currentIntersections.begin();
     //Erase all intersections that happen after tmin
     while(it != currentIntersections.end())
     {
         if (tmin > 0. && it->t > tmin)
-           currentIntersections.erase(it++);
+           it = currentIntersections.erase(it);
         else
            it++;
     
@@ -107,7 +107,7 @@ decimal keepAllBeforeTriangle(std::list<Intersection> &currentIntersections, dec
     return tmin;
 }
 
-decimal keepAllBeforeVisible(std::list<Intersection> &currentIntersections, decimal currentTmin)
+decimal keepAllBeforeVisible(IntersectionBuffer &currentIntersections, decimal currentTmin)
 {
     if (currentIntersections.empty()) { return currentTmin; }
 
@@ -115,7 +115,7 @@ decimal keepAllBeforeVisible(std::list<Intersection> &currentIntersections, deci
     decimal tmin = currentTmin;
 
     //Find the tmin of the first intersection with a visible shape
-    for (std::list<Intersection>::iterator it = currentIntersections.begin(); it != currentIntersections.end(); it++)
+    for (IntersectionBuffer::iterator it = currentIntersections.begin(); it != currentIntersections.end(); it++)
     {
         if (it->p->isVisible() && (tmin < 0. || it->t < tmin))
         {
@@ -124,12 +124,12 @@ decimal keepAllBeforeVisible(std::list<Intersection> &currentIntersections, deci
     }
 
 
-    std::list<Intersection>::iterator it = currentIntersections.begin();
+    IntersectionBuffer::iterator it = currentIntersections.begin();
     //Erase all intersections that happen after tmin
     while(it != currentIntersections.end())
     {
         if (tmin > 0. && it->t > tmin)
-            currentIntersections.erase(it++);
+            it = currentIntersections.erase(it);
         else
            it++;
     }
@@ -137,7 +137,7 @@ decimal keepAllBeforeVisible(std::list<Intersection> &currentIntersections, deci
     return tmin;
 }
 
-decimal keepAll(std::list<Intersection> &currentIntersections, decimal currentTmin)
+decimal keepAll(IntersectionBuffer &currentIntersections, decimal currentTmin)
 {
     if (currentIntersections.empty()) { return currentTmin; }
 
@@ -145,7 +145,7 @@ decimal keepAll(std::list<Intersection> &currentIntersections, decimal currentTm
     decimal tmin = currentTmin;
 
     //Find the tmin of the first intersection
-    for (std::list<Intersection>::iterator it = currentIntersections.begin(); it != currentIntersections.end(); it++)
+    for (IntersectionBuffer::iterator it = currentIntersections.begin(); it != currentIntersections.end(); it++)
     {
         if (tmin < 0. || it->t <= tmin)
         {
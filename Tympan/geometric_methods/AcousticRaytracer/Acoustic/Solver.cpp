@@ -125,7 +125,11 @@ bool BasicSolver::valideIntersection(Ray* r, Intersection* inter)
     }
 
 #ifdef _ALLOW_TARGETING_
-    if (isValid && AcousticRaytracerConfiguration::get()->EnableFullTargets) { ValidRay::appendDirectionToEvent(r->events.back(), targetManager); }
+    if (isValid && AcousticRaytracerConfiguration::get()->EnableFullTargets)
+    {
+        std::lock_guard<std::mutex> lock(targetMutex);
+        ValidRay::appendDirectionToEvent(r->events.back(), targetManager);
+    }
 #endif //_ALLOW_TARGETING_
 
     return (isValid); //(isValid && selectorManagerIntersection.appendData(r));
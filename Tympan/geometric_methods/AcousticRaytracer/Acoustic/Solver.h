@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <deque>
+#include <mutex>
 
 #include "Geometry/Scene.h"
 #include "Ray/Ray.h"
@@ -81,6 +82,8 @@ public:
     * \return Return true if the validation is done
     * \warning The validation functions should agree with the primitives types in the Scene. The unsupported primitives types should throw an
     * exception if not handled by the simulation.
+    * \warning This function is called concurrently by the workers of the ParallelDefaultEngine: it must be thread-safe
+    * (only the ray and the intersection given belong to the calling thread).
     */
     virtual bool valideIntersection(Ray* r, Intersection* inter);
 
@@ -108,6 +111,9 @@ public:
     deque<Ray*>* getDebugRays() { return &debug_rays;}
     //vector<Ray*>* getDebugRays() { return &debug_rays;}
 
+    /// Return the number of rays rejected by each Selector type (none by default)
+    virtual std::map<std::string, unsigned long long> getSelectorRejections() const { return std::map<std::string, unsigned long long>(); }
+
     /// End the operations
     virtual void finish();
     /// Delete the valid rays array
@@ -122,6 +128,10 @@ public:
 protected:
     deque<Ray*> valid_rays;    //!< Rays list which are validated by the solver
     deque<Ray*> debug_rays;    //!< Rays list which are invalidated by the solver
+
+#ifdef _ALLOW_TARGETING_
+    std::mutex targetMutex;    //!< Serializes the uses of the target manager in valideIntersection()
+#endif //_ALLOW_TARGETING_
 };
 
 class BasicSolver : public Solver
@@ -151,6 +161,8 @@ public:
 
     //virtual void clean();
 
+    virtual std::map<std::string, unsigned long long> getSelectorRejections() const { return selectorManagerValidation.getRejections(); }
+
     bool _useFresnelArea; //!< Flag to use Fresnel weighting
 
 
@@ -13,6 +13,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <boost/make_shared.hpp>
 #include "Engine/AcousticRaytracerConfiguration.h"
 #include "Geometry/Cylindre.h"
 #include "Geometry/Sphere.h"
@@ -24,8 +25,8 @@
 bool ValidRay::validRayWithDoNothingEvent(Ray *r, Intersection* inter)
 {
 	vec3 impact = r->getPosition() + r->getDirection() * inter->t;
-	DoNothing *newEvent = new DoNothing(impact, r->getDirection(), inter->p);
-	boost::shared_ptr<Event> SPEv(newEvent);
+	boost::shared_ptr<Event> SPEv = boost::make_shared<DoNothing>(impact, r->getDirection(), inter->p);
+	DoNothing* newEvent = static_cast<DoNothing*>(SPEv.get());
 
     vec3 newDir;
 	//Check if the event can provide a response (should always be true in the case of a newly created DoNothing event)
@@ -56,8 +57,8 @@ bool ValidRay::validTriangleWithSpecularReflexion(Ray* r, Intersection* inter)
 		return false;
 	}
 
-	SpecularReflexion* newEvent = new SpecularReflexion(impact, r->getDirection(), inter->p);
-	boost::shared_ptr<Event> SPEv(newEvent);
+	boost::shared_ptr<Event> SPEv = boost::make_shared<SpecularReflexion>(impact, r->getDirection(), inter->p);
+	SpecularReflexion* newEvent = static_cast<SpecularReflexion*>(SPEv.get());
 
     vec3 newDir;
 
@@ -206,8 +207,8 @@ bool ValidRay::validCylindreWithDiffraction(Ray* r, Intersection* inter)
 // Create a diffraction event
     vec3 from = realImpact - r->getPosition();
     from.normalize();
-	Diffraction* newEvent = new Diffraction(realImpact, from, (Cylindre*)(inter->p));
-	boost::shared_ptr<Event> SPEv(newEvent);
+	boost::shared_ptr<Event> SPEv = boost::make_shared<Diffraction>(realImpact, from, (Cylindre*)(inter->p));
+	Diffraction* newEvent = static_cast<Diffraction*>(SPEv.get());
 
 // Define the number of rays to throw
 	unsigned int diff_nb_rays = 0;
@@ -22,7 +22,10 @@ AcousticRaytracerConfiguration::AcousticRaytracerConfiguration()
     NbRaysPerSource = 400000;
     Discretization = 2;
     Accelerator = 3;
+    ReceptorAccelerator = 1;
     MaxTreeDepth = 12;
+    NbThreads = 0;
+    RayPacketSize = 8;
     NbRayWithDiffraction = 0;
     MaxProfondeur = 10;
     MaxReflexion = 6;
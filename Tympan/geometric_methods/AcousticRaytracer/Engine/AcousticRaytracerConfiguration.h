@@ -32,7 +32,10 @@ public:
     unsigned int NbRaysPerSource; //!< Number of rays per source for the Sampler
     unsigned int Discretization; //!< Sampler choice with 0: RandomSphericSampler, 1: UniformSphericSampler, 2: UniformSphericSampler2, 3: Latitude2DSampler
     unsigned int Accelerator; //!< Accelerator choice with 0: BruteForceAccelerator, 1: GridAccelerator, 2: BvhAccelerator, 3: KdtreeAccelerator
+    unsigned int ReceptorAccelerator; //!< Accelerator used to find the receptors hit by the rays (same choices as Accelerator)
     unsigned int MaxTreeDepth; //!< BvhAccelerator Accelerator option (Maximal tree depth)
+    unsigned int NbThreads; //!< Number of threads used by the ParallelDefaultEngine (0: number of hardware threads)
+    unsigned int RayPacketSize; //!< Number of rays from the sources traced together by the DefaultEngine (1: one at a time, at most Accelerator::MAX_PACKET_SIZE)
     unsigned int NbRayWithDiffraction; //!< Number of rays to throw during diffraction
     unsigned int MaxProfondeur; //!< Maximal number of events for ray validation in ANIME3D solver
     unsigned int MaxReflexion; //!< Maximal reflection events
@@ -17,10 +17,13 @@
 #include <list>
 #include <algorithm>
 #include <vector>
+#include <random>
+#include <chrono>
 
 #include "Geometry/mathlib.h"
 #include "Acoustic/Event.h"
 #include "Ray/Ray.h"
+#include "AcousticRaytracerConfiguration.h"
 #include "DefaultEngine.h"
 
 /*struct CompareVec
@@ -65,6 +68,7 @@ bool DefaultEngine::process()
     //QTime time;
     //time.start();
     nbRayonsTraites = 0;
+    nbIntersections = 0;
 
     //Throw ray from every source to every receptor
 	initialReceptorTargeting();
@@ -75,7 +79,7 @@ bool DefaultEngine::process()
         //Empty stack => we generate a new ray from the sources
         if (pile_traitement.empty())
         {
-            Ray* newRay = genRay();
+            Ray* newRay = nextTracedRay();
             if (newRay)
             {
                 
@@ -151,6 +155,47 @@ Ray* DefaultEngine::genRay()
     return (Ray*)NULL;
 }
 
+Ray* DefaultEngine::nextTracedRay()
+{
+    if (packetIndex == packet.size())
+    {
+        // Generate and trace a new packet of rays. The identifiers of the rays are given when they
+        // are processed, so that they are the same as when the rays are generated one at a time.
+        unsigned int packetSize = AcousticRaytracerConfiguration::get()->RayPacketSize;
+        if (packetSize > Accelerator::MAX_PACKET_SIZE) { packetSize = Accelerator::MAX_PACKET_SIZE; }
+        if (packetSize == 0) { packetSize = 1; }
+        unsigned long long int firstId = rayCounter;
+
+        packet.clear();
+        fillPacket(packetSize);
+        rayCounter = firstId;
+        packetIndex = 0;
+
+        if (packet.empty()) { return (Ray*)NULL; }
+
+        packetPrims.resize(packet.size());
+        for (size_t i = 0; i < packet.size(); i++) { packetPrims[i].clear(); }
+        packetTmins.assign(packet.size(), -1.);
+        scene->getAccelerator()->traversePacket(&packet[0], packet.size(), &packetPrims[0], &packetTmins[0]);
+    }
+
+    tracedRay = packet[packetIndex++];
+    tracedRay->setConstructId ( rayCounter );
+    rayCounter++;
+
+    return tracedRay;
+}
+
+void DefaultEngine::fillPacket(unsigned int packetSize)
+{
+    while (packet.size() < packetSize)
+    {
+        Ray* newRay = genRay();
+        if (!newRay) { break; }
+        packet.push_back(newRay);
+    }
+}
+
 bool DefaultEngine::traitementRay(Ray* r, std::list<validRay> &result)
 {
     nbRayonsTraites++; //Number of rays processed during the simulation
@@ -169,10 +214,21 @@ bool DefaultEngine::traitementRay(Ray* r, std::list<validRay> &result)
 
 	//Get the solver's accelerating structure
     Accelerator* accelerator = scene->getAccelerator();
-    std::list<Intersection> foundPrims;
+    foundPrims.clear();
 
-    // Find intersections with the scene's primitives
-    tmin =  accelerator->traverse(r, foundPrims);
+    // Find intersections with the scene's primitives (unless the ray has already been traced with its packet)
+    if (r == tracedRay)
+    {
+        foundPrims.swap(packetPrims[packetIndex - 1]);
+        tmin = packetTmins[packetIndex - 1];
+        tracedRay = NULL;
+    }
+    else
+    {
+        tmin = accelerator->traverse(r, foundPrims);
+    }
+
+    nbIntersections += foundPrims.size();
 
     // Check for intersections with receptors (and pass the ray to the selector manager for validation if it hits a receptor)
     searchForReceptor(tmin, r);
@@ -189,7 +245,7 @@ bool DefaultEngine::traitementRay(Ray* r, std::list<validRay> &result)
     
 	}else{
 	//if some intersections have been found, iterate through them and test their validity
-		for (std::list<Intersection,std::allocator<Intersection>>::iterator it=foundPrims.begin();it != foundPrims.end();it++){
+		for (IntersectionBuffer::iterator it=foundPrims.begin();it != foundPrims.end();it++){
 
 			bool valide=false;
 			Intersection *inter = NULL;
@@ -223,45 +279,46 @@ bool DefaultEngine::traitementRay(Ray* r, std::list<validRay> &result)
     return true;
 }
 
-void DefaultEngine::runStructureBenchmark()
+BenchmarkResult DefaultEngine::runStructureBenchmark(unsigned int nbRays, unsigned int seed)
 {
-
-    unsigned int nbVec = 1000000;
-
-    //Generation du buffer de vecteur
+    BenchmarkResult result;
     BBox sceneBox = scene->getGlobalBox();
-    /*std::vector<vec3> buffer = std::vector<vec3>(2*nbVec);
-    for(unsigned int i = 0; i < nbVec; i++){
-        vec3 newDir = vec3((double)rand() / (double)RAND_MAX, (double)rand() / (double)RAND_MAX, (double)rand() / (double)RAND_MAX);
-        newDir.normalize();
-        buffer.push_back(newDir);
-        vec3 newPos = vec3(((double)rand() / (double)RAND_MAX) * (sceneBox.pMax.x - sceneBox.pMin.x) + sceneBox.pMin.x,
-                            ((double)rand() / (double)RAND_MAX) * (sceneBox.pMax.y - sceneBox.pMin.y) + sceneBox.pMin.y,
-                            ((double)rand() / (double)RAND_MAX) * (sceneBox.pMax.z - sceneBox.pMin.z) + sceneBox.pMin.z);
-        buffer.push_back(newPos);
-    }*/
+    Accelerator* accel = scene->getAccelerator();
+    if (!accel) { return result; }
+
+    // Generation du buffer de rayons (hors mesure) : origines dans la boite de la scene,
+    // directions uniformes sur la sphere, tirees avec une graine fixee
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<decimal> unit(0., 1.);
+    std::vector<vec3> positions(nbRays), directions(nbRays);
+    for (unsigned int i = 0; i < nbRays; i++)
+    {
+        positions[i] = vec3(unit(generator) * (sceneBox.pMax.x - sceneBox.pMin.x) + sceneBox.pMin.x,
+                            unit(generator) * (sceneBox.pMax.y - sceneBox.pMin.y) + sceneBox.pMin.y,
+                            unit(generator) * (sceneBox.pMax.z - sceneBox.pMin.z) + sceneBox.pMin.z);
+        decimal z = 2. * unit(generator) - 1.;
+        decimal phi = static_cast<decimal>(2. * M_PI) * unit(generator);
+        decimal r = sqrt(std::max(static_cast<decimal>(0.), 1 - z * z));
+        directions[i] = vec3(r * cos(phi), r * sin(phi), z);
+    }
 
-    //QTime time;
-    //time.start();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-    for (unsigned int i = 0; i < nbVec; i++)
+    for (unsigned int i = 0; i < nbRays; i++)
     {
         Ray r;
         r.setMint ( 0.00001f);
         r.setMaxt ( 10000.);
-        r.setDirection ( vec3((decimal)rand() / (decimal)RAND_MAX, (decimal)rand() / (decimal)RAND_MAX, (decimal)rand() / (decimal)RAND_MAX) );
-        r.getDirection().normalize();
-        r.setPosition ( vec3(((decimal)rand() / (decimal)RAND_MAX) * (sceneBox.pMax.x - sceneBox.pMin.x) + sceneBox.pMin.x,
-                          ((decimal)rand() / (decimal)RAND_MAX) * (sceneBox.pMax.y - sceneBox.pMin.y) + sceneBox.pMin.y,
-                          ((decimal)rand() / (decimal)RAND_MAX) * (sceneBox.pMax.z - sceneBox.pMin.z) + sceneBox.pMin.z));
-        Accelerator* accel = scene->getAccelerator();
-        std::list<Intersection> foundPrims;
+        r.setDirection ( directions[i] );
+        r.setPosition ( positions[i] );
+        foundPrims.clear();
         accel->traverse(&r, foundPrims);
+        result.nbIntersections += foundPrims.size();
+        if (!foundPrims.empty()) { result.nbHits++; }
     }
 
-    //int totalTime = time.elapsed();
-    //std::cout << "Fin du benchmark." << std::endl;
-    //std::cout << "Nombre de rayons traites : " << nbVec << std::endl;
-    //std::cout << "Temps ecoule : " << totalTime << " ms." << std::endl;
-    //std::cout << "Vitesse de traitement : " << nbVec / totalTime << " rays/ms." << std::endl;
+    result.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.nbRays = nbRays;
+
+    return result;
 }
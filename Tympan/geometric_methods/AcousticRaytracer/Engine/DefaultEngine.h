@@ -18,22 +18,24 @@
 
 #include "Engine.h"
 #include <stack>
+#include <list>
 
 /**
  * \brief Default Engine class
  */
 class DefaultEngine : public Engine
 {
-#ifdef TEST_ACCELERATION_RECEPTORS
 public:
 	/// Constructors
-    DefaultEngine() : Engine() { nbRayonsTraites = 0;}
+    DefaultEngine() : Engine(), packetIndex(0), tracedRay(NULL) { nbRayonsTraites = 0; nbIntersections = 0; }
 
     DefaultEngine(Scene* _scene, std::vector<Source> *_sources, Solver* _solver, Scene *_recepteurs)
-        : Engine(_scene, _sources, _solver, _recepteurs) {  }    
+        : Engine(_scene, _sources, _solver, _recepteurs), packetIndex(0), tracedRay(NULL) { nbRayonsTraites = 0; nbIntersections = 0; }    
     /// Copy constructor
-    DefaultEngine(const DefaultEngine& other)
+    DefaultEngine(const DefaultEngine& other) : packetIndex(0), tracedRay(NULL)
     {
+        nbRayonsTraites = 0;
+        nbIntersections = 0;
         scene = other.scene;
         sources = other.sources;
         solver = other.solver;
@@ -44,10 +46,13 @@ public:
 
     virtual bool process();
 
-    virtual void runStructureBenchmark();
+    virtual BenchmarkResult runStructureBenchmark(unsigned int nbRays = 1000000, unsigned int seed = 0);
 
     Ray* genRay();                                                  //!< Create rays from the sources
 
+    unsigned long long int getNbRayonsTraites() const { return nbRayonsTraites; } //!< Number of rays treated by the last process()
+    unsigned long long int getNbIntersections() const { return nbIntersections; } //!< Number of intersections found by the last process()
+
 
 protected:
     /**
@@ -60,14 +65,14 @@ protected:
 	{
         //Get the receptors' accelerating structure
         Accelerator* accelerator = recepteurs->getAccelerator();
-        std::list<Intersection> foundPrims;
+        receptorPrims.clear();
 
         //Find intersections with receptors
-        accelerator->traverse(r, foundPrims);
-        std::list<Intersection>::iterator iter;
+        accelerator->traverse(r, receptorPrims);
+        IntersectionBuffer::iterator iter;
 
         //For each found intersections
-        for (iter=foundPrims.begin(); iter != foundPrims.end(); iter++)
+        for (iter=receptorPrims.begin(); iter != receptorPrims.end(); iter++)
         {
 
             Intersection its = (*iter);
@@ -93,7 +98,7 @@ protected:
 				valide_ray->computeLongueur();
 
 				//Add the ray to the solver's list of valid rays
-				solver->valideRayon(valide_ray);
+				transmitValidRay(valide_ray);
             }            
         }
     }
@@ -124,83 +129,14 @@ protected:
 			}
 		}	
 	}
-#else
-public:
-    DefaultEngine() : Engine() { nbRayonsTraites = 0;}
-
-    DefaultEngine(Scene* _scene, std::vector<Source> *_sources, Solver* _solver, std::vector<Recepteur> *_recepteurs)
-        : Engine(_scene, _sources, _solver, _recepteurs) {  }
-
-    DefaultEngine(const DefaultEngine& other)
-    {
-        scene = other.scene;
-        sources = other.sources;
-        solver = other.solver;
-        recepteurs = other.recepteurs;
-    }
-
-    virtual ~DefaultEngine() { }
-
-    virtual bool process();
-
-    virtual void runStructureBenchmark();
-    
-    Ray* genRay();                                                  //!< Create rays from the sources
-
-
 protected :
-    void searchForReceptor(const decimal &tmin, Ray *r)
-	{
-		for (unsigned int i = 0; i < recepteurs->size(); i++)
-		{
-			Intersection result;
-			//if the ray hits a receptor before traveling tmin
-			if (recepteurs->at(i).intersectionRecepteur(r->position, r->direction, tmin, result))
-			{
-				
-				// Create a copy of the ray
-				Ray* valide_ray = new Ray(r);
-				valide_ray->setConstructId (rayCounter);
-
-				rayCounter++;
-
-				// Set the ray's receptor
-				valide_ray->setRecepteur ( dynamic_cast<Recepteur*>(its.p));
-
-				//Compute the final position of the ray based on its direction and the distance traveled
-				valide_ray->setFinalPosition ( valide_ray->getPosition() + valide_ray->getDirection() * result.t);
-				valide_ray->computeLongueur();
-
-				//Add the ray to the solver's list of valid rays
-				solver->valideRayon(valide_ray);
-			}
-		}
-	}
+	/**
+	 * \brief Hand a ray which has reached a receptor over to the solver
+	 * (overloaded by ParallelDefaultEngine to serialize the accesses to the solver)
+	 * @param r Valid ray
+	 */
+	virtual void transmitValidRay(Ray *r) { solver->valideRayon(r); }
 
-	void initialReceptorTargeting()
-	{
-		for (vector<Source>::iterator itsource = sources->begin(); itsource != sources->end(); itsource++)
-		{
-			for (vector<Recepteur>::iterator itrecp = recepteurs->begin(); itrecp != recepteurs->end(); itrecp++)
-			{
-				Ray* new_ray = new Ray();
-				new_ray->constructId = rayCounter;
-				rayCounter++;
-				new_ray->source = (&(*itsource));
-				new_ray->position = itsource->getPosition();
-				vec3 psource = itsource->getPosition();
-				vec3 precp = itrecp->getPosition();
-				new_ray->direction = precp - psource;
-				new_ray->direction.normalize();
-				new_ray->mint = 0.;
-				new_ray->maxt = 10000.;
-				if(itsource->getSampler()->isAcceptableSample(direction))
-					pile_traitement.push(new_ray);
-			}
-		}	
-	}
-#endif
-protected :
 	/**
 	 * \brief Copy a ray and use its last event to generate a response to use as the copy's direction
 	 * (used to handle the generation of rays by diffraction events)
@@ -230,9 +166,33 @@ protected :
       */
     virtual bool traitementRay(Ray* r, std::list<validRay> &result);
 
+	/**
+	 * \brief Get a new ray from the sources, already traced through the accelerator. The rays are generated
+	 * and traced by packets of AcousticRaytracerConfiguration::RayPacketSize rays (see Accelerator::traversePacket)
+	 * @return The ray or NULL if the sources have generated all their rays
+	 */
+	Ray* nextTracedRay();
+
+	/**
+	 * \brief Generate the rays of a new packet from the sources (overloaded by ParallelDefaultEngine
+	 * to share the sources between the workers)
+	 * @param packetSize Maximal number of rays to append to packet
+	 */
+	virtual void fillPacket(unsigned int packetSize);
+
     std::stack< Ray*, std::deque <Ray*> > pile_traitement;			//!< Treatment stack containing the rays to treat
 
+    IntersectionBuffer foundPrims;									//!< Intersections of the current ray with the scene (reused for each ray)
+    IntersectionBuffer receptorPrims;								//!< Intersections of the current ray with the receptors (reused for each ray)
+
+    std::vector<Ray*> packet;										//!< Rays generated from the sources and traced together
+    std::vector< IntersectionBuffer > packetPrims;				//!< Intersections found for each ray of the packet
+    std::vector<decimal> packetTmins;								//!< Value returned by the accelerator for each ray of the packet
+    unsigned int packetIndex;										//!< Index in the packet of the next ray to process
+    Ray* tracedRay;													//!< Ray returned by nextTracedRay() and not processed yet
+
     unsigned long long int nbRayonsTraites;							//!< Treated rays number
+    unsigned long long int nbIntersections;							//!< Intersections found by the accelerator for the treated rays
 };
 
 #endif
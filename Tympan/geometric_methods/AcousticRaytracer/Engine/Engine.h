@@ -21,14 +21,25 @@
 #include "Acoustic/Solver.h"
 #include "Acoustic/Recepteur.h"
 
-#define TEST_ACCELERATION_RECEPTORS
-
 typedef struct _validRay
 {
     Ray* r;     //!< Pointer to a ray. Should not be NULL
     bool valid; //!< Boolean set to True if the ray is validated, which means an event occurs.
 } validRay;
 
+/**
+ * \brief Figures measured by Engine::runStructureBenchmark()
+ */
+struct BenchmarkResult
+{
+    BenchmarkResult() : nbRays(0), nbIntersections(0), nbHits(0), elapsed(0.) { }
+
+    unsigned long long int nbRays;          //!< Number of rays traversed
+    unsigned long long int nbIntersections; //!< Number of intersections returned by the accelerator
+    unsigned long long int nbHits;          //!< Number of rays with at least one intersection
+    double elapsed;                         //!< Traversal time (s)
+};
+
 /**
  * \brief Base class for engines (DefaultEngine, ParallelDefaultEngine,...)
  */
@@ -36,7 +47,6 @@ class Engine
 {
 
 public:
-#ifdef TEST_ACCELERATION_RECEPTORS
 	/// Default constructor
     Engine() : scene(NULL), sources(NULL), recepteurs(NULL), solver(NULL), rayCounter(0) { }
     /// Constructor
@@ -71,7 +81,12 @@ public:
 
     virtual bool process() { return false;} //!< If implemented, process and return true if success
 
-    virtual void runStructureBenchmark() {} //!< If implemented, run a benchmark for the engine
+    /*!
+     * \brief If implemented, run a benchmark of the scene accelerator
+     * \param nbRays Number of random rays traversed
+     * \param seed Seed of the random ray generator, so that runs are reproducible
+     */
+    virtual BenchmarkResult runStructureBenchmark(unsigned int nbRays = 1000000, unsigned int seed = 0) { return BenchmarkResult(); }
 
     virtual unsigned long long int getRayCounter(){ return rayCounter;} 
 
@@ -82,49 +97,5 @@ protected:
     Solver* solver;					//!< Pointer to the solver
 
     unsigned long long int rayCounter; //!< Ray counter
-#else
-    Engine() : scene(NULL), sources(NULL), recepteurs(NULL), solver(NULL), rayCounter(0) { }
-
-    Engine(Scene* _scene, std::vector<Source> *_sources, Solver* _solver, std::vector<Recepteur> *_recepteurs)
-    {
-        scene = _scene;
-        sources = _sources;
-        solver = _solver;
-        recepteurs = _recepteurs;
-        rayCounter = 0;
-    }
-
-    Engine(const Engine& other)
-    {
-        scene = other.scene;
-        sources = other.sources;
-        solver = other.solver;
-        recepteurs = other.recepteurs;
-        rayCounter = other.rayCounter;
-    }
-
-    virtual ~Engine() { }
-
-    Scene* getScene() { return scene; }
-    void setScene(Scene* _scene) { scene = _scene; }
-
-    std::vector<Source>* getSources() { return sources; }
-    void setSources(std::vector<Source> *_sources) { sources = _sources; }
-
-    Solver* getSolver() { return solver; }
-    void setSolver(Solver* _solver) { solver = _solver; }
-
-    virtual bool process() { return false;}
-
-    virtual void runStructureBenchmark() {}
-
-protected:
-    Scene* scene;
-    std::vector<Source> *sources;
-    std::vector<Recepteur> *recepteurs;
-    Solver* solver;
-
-    unsigned long long int rayCounter;
-#endif
 };
 #endif
@@ -13,9 +13,175 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <thread>
+
+#include "Geometry/mathlib.h"
+#include "Ray/Ray.h"
 #include "ParallelDefaultEngine.h"
 
+// Number of rays a worker buffers before handing them over to the solver
+static const std::size_t WORKER_BUFFER_SIZE = 256;
+
+// Size of the ray identifiers range owned by each worker
+static const unsigned long long int WORKER_ID_RANGE = 1ULL << 40;
+
 bool ParallelDefaultEngine::process()
 {
-    return false;
+    unsigned int nbWorkers = nbThreads ? nbThreads : std::thread::hardware_concurrency();
+
+    // Nothing to share: process the rays the sequential way
+    if (nbWorkers <= 1)
+    {
+        return DefaultEngine::process();
+    }
+
+    nbRayonsTraites = 0;
+    nbIntersections = 0;
+
+    //Throw ray from every source to every receptor (identifiers taken in the master range)
+    initialReceptorTargeting();
+
+    // Create the workers, each one with its own rays stack and identifiers range
+    std::vector<ParallelDefaultEngine*> workers;
+    for (unsigned int i = 0; i < nbWorkers; i++)
+    {
+        ParallelDefaultEngine* worker = new ParallelDefaultEngine(*this);
+        worker->master = this;
+        worker->rayCounter = (i + 1) * WORKER_ID_RANGE;
+        workers.push_back(worker);
+    }
+
+    // Deal the initial rays between the workers
+    for (unsigned int i = 0; !pile_traitement.empty(); i++)
+    {
+        workers[i % nbWorkers]->pile_traitement.push(pile_traitement.top());
+        pile_traitement.pop();
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < nbWorkers; i++)
+    {
+        threads.push_back(std::thread(&ParallelDefaultEngine::run, workers[i]));
+    }
+
+    for (unsigned int i = 0; i < nbWorkers; i++)
+    {
+        threads[i].join();
+        nbRayonsTraites += workers[i]->nbRayonsTraites;
+        nbIntersections += workers[i]->nbIntersections;
+        delete workers[i];
+    }
+
+    solver->finish();
+
+    return true;
+}
+
+void ParallelDefaultEngine::run()
+{
+    nbRayonsTraites = 0;
+    nbIntersections = 0;
+
+    //Loop until the stack of rays is empty and the sources cannot generate more rays
+    while (1)
+    {
+        //Empty stack => we get a new ray from the sources (traced with the packet of this worker)
+        if (pile_traitement.empty())
+        {
+            Ray* newRay = nextTracedRay();
+            if (!newRay)
+            {
+                break;
+            }
+
+            pile_traitement.push(newRay);
+        }
+        else
+        {
+            Ray* current_ray = pile_traitement.top();
+            pile_traitement.pop();
+
+            std::list<validRay> result;
+
+            //Process the current ray and put the resulting rays in result
+            traitementRay(current_ray, result);
+
+            for (std::list<validRay>::iterator it = result.begin(); it != result.end(); it++)
+            {
+                if (!it->valid)
+                {
+                    invalidBuffer.push_back(it->r);
+                    if (invalidBuffer.size() >= WORKER_BUFFER_SIZE)
+                    {
+                        flush();
+                    }
+                }
+                else
+                {
+                    //The ray is valid (but has yet to hit a receptor) => put it back in the stack for further processing
+                    pile_traitement.push(it->r);
+                }
+            }
+        }
+    }
+
+    flush();
+}
+
+void ParallelDefaultEngine::fillPacket(unsigned int packetSize)
+{
+    // The master engine does not trace rays by itself
+    if (!master)
+    {
+        DefaultEngine::fillPacket(packetSize);
+        return;
+    }
+
+    // The identifiers given by the master are replaced by the worker's ones in nextTracedRay()
+    std::lock_guard<std::mutex> lock(master->sourcesMutex);
+    while (packet.size() < packetSize)
+    {
+        Ray* newRay = master->genRay();
+        if (!newRay) { break; }
+        packet.push_back(newRay);
+    }
+}
+
+void ParallelDefaultEngine::transmitValidRay(Ray* r)
+{
+    // The master engine does not trace rays by itself
+    if (!master)
+    {
+        DefaultEngine::transmitValidRay(r);
+        return;
+    }
+
+    validBuffer.push_back(r);
+    if (validBuffer.size() >= WORKER_BUFFER_SIZE)
+    {
+        flush();
+    }
+}
+
+void ParallelDefaultEngine::flush()
+{
+    if ( validBuffer.empty() && invalidBuffer.empty() )
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(master->solverMutex);
+
+    for (std::vector<Ray*>::iterator it = validBuffer.begin(); it != validBuffer.end(); it++)
+    {
+        solver->valideRayon(*it);
+    }
+    validBuffer.clear();
+
+    //Invalid rays are deleted or kept in the debug_rays list if the KeepDebugRay option is set to true
+    for (std::vector<Ray*>::iterator it = invalidBuffer.begin(); it != invalidBuffer.end(); it++)
+    {
+        solver->invalidRayon(*it);
+    }
+    invalidBuffer.clear();
 }
@@ -16,59 +16,65 @@
 #ifndef PARALLEL_DEFAULT_ENGINE_H
 #define PARALLEL_DEFAULT_ENGINE_H
 
+#include <vector>
+#include <mutex>
+
 #include "DefaultEngine.h"
+#include "AcousticRaytracerConfiguration.h"
 
 /**
  * \brief Parallel default engine class
+ *
+ * The rays are processed in the same way as with the DefaultEngine but by several worker threads.
+ * Each worker owns its rays stack, its packet of traced rays and a range of ray identifiers. Workers
+ * take a new packet of rays from the sources (shared, protected by a mutex) when their stack is empty
+ * and trace it through the accelerator. Rays reaching a receptor and invalid rays are buffered by each
+ * worker and handed over to the solver in batches under a lock. Solver::valideIntersection() is called
+ * by the workers concurrently, so it must be thread-safe.
  */
-#ifdef TEST_ACCELERATION_RECEPTORS
-class ParallelDefaultEngine : public Engine
+class ParallelDefaultEngine : public DefaultEngine
 {
 
 public:
     /// Default constructor
-    ParallelDefaultEngine() : Engine() { }
+    ParallelDefaultEngine() : DefaultEngine(), nbThreads(0), master(NULL) { }
     /// Constructor
     ParallelDefaultEngine(Scene* _scene, std::vector<Source> *_sources, Solver* _solver, Scene *_recepteurs)
-        : Engine(_scene, _sources, _solver, _recepteurs) {  }
+        : DefaultEngine(_scene, _sources, _solver, _recepteurs),
+          nbThreads(AcousticRaytracerConfiguration::get()->NbThreads), master(NULL) {  }
     /// Copy constructor
-    ParallelDefaultEngine(const ParallelDefaultEngine& other)
+    ParallelDefaultEngine(const ParallelDefaultEngine& other) : DefaultEngine(other)
     {
-        scene = other.scene;
-        sources = other.sources;
-        solver = other.solver;
-        recepteurs = other.recepteurs;
+        nbThreads = other.nbThreads;
+        master = NULL;
     }
     /// Destructor
     virtual ~ParallelDefaultEngine() { }
 
     virtual bool process();
 
-};
-#else
-class ParallelDefaultEngine : public Engine
-{
-
-public:
+    /// Set the number of worker threads (0 means the number of hardware threads)
+    void setNbThreads(unsigned int _nbThreads) { nbThreads = _nbThreads; }
+    /// Get the number of worker threads (0 means the number of hardware threads)
+    unsigned int getNbThreads() const { return nbThreads; }
 
-    ParallelDefaultEngine() : Engine() { }
+protected:
+    /// Buffer the valid ray, it will be handed over to the solver by flush()
+    virtual void transmitValidRay(Ray* r);
 
-    ParallelDefaultEngine(Scene* _scene, std::vector<Source> *_sources, Solver* _solver, std::vector<Recepteur> *_recepteurs)
-        : Engine(_scene, _sources, _solver, _recepteurs) {  }
+    /// Generate the rays of a new packet from the sources of the master engine (thread-safe)
+    virtual void fillPacket(unsigned int packetSize);
 
-    ParallelDefaultEngine(const ParallelDefaultEngine& other)
-    {
-        scene = other.scene;
-        sources = other.sources;
-        solver = other.solver;
-        recepteurs = other.recepteurs;
-    }
+    void run();                         //!< Worker loop: process rays until the stack is empty and the sources are exhausted
+    void flush();                       //!< Hand the buffered valid and invalid rays over to the solver
 
-    virtual ~ParallelDefaultEngine() { }
+    unsigned int nbThreads;             //!< Number of worker threads (0 means the number of hardware threads)
+    ParallelDefaultEngine* master;      //!< Engine which has spawned this worker (NULL for the master engine)
 
-    virtual bool process();
+    std::vector<Ray*> validBuffer;      //!< Valid rays waiting to be handed over to the solver
+    std::vector<Ray*> invalidBuffer;    //!< Invalid rays waiting to be handed over to the solver
 
+    std::mutex sourcesMutex;            //!< Protects the sources (samplers) and the master ray counter
+    std::mutex solverMutex;             //!< Protects the accesses to the solver
 };
-
-#endif //TEST_ACCELERATION_RECEPTORS
 #endif
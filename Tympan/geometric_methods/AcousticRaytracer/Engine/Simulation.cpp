@@ -17,6 +17,7 @@
 void Simulation::clean()
 {
     scene.clean();
+    receptors_landscape.clean();
 
     // Nettoyage des sources et des recepteurs
     sources.clear();
@@ -24,13 +25,13 @@ void Simulation::clean()
 
     compteurSource = 0;
     compteurRecepteur = 0;
+
+    // Rays of the previous simulation are gone
+    Ray::releasePoolMemory();
 }
 
-#ifdef TEST_ACCELERATION_RECEPTORS
-bool Simulation::launchSimulation()
+void Simulation::createEngine()
 {
-    ss << "Lancement de la simulation." << std::endl;
-    if (solver) { solver->clean(); }
     if (engine) { delete engine; }
     // Create the engine from engineC enum
     switch (engineC)
@@ -45,27 +46,19 @@ bool Simulation::launchSimulation()
             engine = new DefaultEngine(&scene, &sources, solver, &receptors_landscape);
             break;
     }
-    return engine->process();
 }
-#else
+
 bool Simulation::launchSimulation()
 {
+    ss << "Lancement de la simulation." << std::endl;
     if (solver) { solver->clean(); }
-    if (engine) { delete engine; }
-    switch (engineC)
-    {
-        case DEFAULT:
-            engine = new DefaultEngine(&scene, &sources, solver, &recepteurs);
-            break;
-        case PARALLELDEFAULT:
-            engine = new ParallelDefaultEngine(&scene, &sources, solver, &recepteurs);
-            break;
-        default:
-            engine = new DefaultEngine(&scene, &sources, solver, &recepteurs);
-            break;
-    }
-
+    createEngine();
     return engine->process();
 }
-#endif //TEST_ACCELERATION_RECEPTORS
+
+BenchmarkResult Simulation::runBenchmark(unsigned int nbRays, unsigned int seed)
+{
+    createEngine();
+    return engine->runStructureBenchmark(nbRays, seed);
+}
 
@@ -64,7 +64,7 @@ public:
         *configuration = *other.configuration;
     }
     /// Destructor
-    virtual ~Simulation() { }
+    virtual ~Simulation() { Ray::releasePoolMemory(); }
 
     /*!
     * \fn Scene* getScene()
@@ -73,13 +73,11 @@ public:
     */
     Scene* getScene() { return &scene; }
 
-#ifdef TEST_ACCELERATION_RECEPTORS
     /*!
      * \fn Scene* get_receptors_landscape();
      * \brief Return the geometric distribution of receptors
      */
     Scene* get_receptors_landscape() { return &receptors_landscape; }
-#endif
 
     /*!
     * \fn void setSolver(Solver *_solver)
@@ -137,11 +135,9 @@ public:
     void addRecepteur(Recepteur& r) { 
         recepteurs.push_back(r); 
         recepteurs.back().setId(compteurRecepteur);
-#ifdef TEST_ACCELERATION_RECEPTORS
 		Recepteur* rcpt=new Recepteur(r);
 		rcpt->setId(compteurRecepteur);
         receptors_landscape.addShape(rcpt);
-#endif
         compteurRecepteur++;
     }
     /*!
@@ -161,16 +157,22 @@ public:
     /// Get the configuration
     AcousticRaytracerConfiguration* getConfiguration() { return configuration; }
 
-//    void runBenchmark() { engine = new DefaultEngine(&scene, &sources, solver, &recepteurs); engine->runStructureBenchmark(); }
+    /*!
+    * \brief Run the structure benchmark of the selected engine on the scene (which should be finished)
+    * \param nbRays Number of random rays traversed
+    * \param seed Seed of the random ray generator
+    */
+    BenchmarkResult runBenchmark(unsigned int nbRays = 1000000, unsigned int seed = 0);
 
 
 
 
 protected:
+    /// Create the engine selected by setEngine()
+    void createEngine();
+
     Scene scene; 						//!< Description of the geometry in an accelerated structure
-#ifdef TEST_ACCELERATION_RECEPTORS
     Scene receptors_landscape; 			//!< Geometric distribution of receptors
-#endif
 
     Solver* solver;             		//!< Pointer to a solver (acoustic method)
     MaterialManager* materialManager;	//!< Pointer to a MaterialManager object
@@ -35,15 +35,16 @@ void Scene::clean()
         delete shapes.at(i);
     }
     shapes.clear();
+    triangles.clear();
     registeredVertices.clear();
     vertices.clear();
     globalBox.isNull = true;
     compteurPrimitive = 0;
     compteurFace=0;
-    if (accelerator) { delete accelerator; }
+    if (accelerator) { delete accelerator; accelerator = NULL; }
 }
 
-bool Scene::finish(int accelerator_id/* = 3*/, leafTreatment::treatment _intersectionChoice/* = leafTreatment::FIRST*/)
+bool Scene::finish(int accelerator_id/* = 3*/, leafTreatment::treatment _intersectionChoice/* = leafTreatment::FIRST*/, int nbBuildThreads/* = -1*/)
 {
 
     ss << "La scene comporte " << vertices.size() << " vertex." << std::endl;
@@ -52,6 +53,8 @@ bool Scene::finish(int accelerator_id/* = 3*/, leafTreatment::treatment _interse
         ss << "(" << vertices.at(i).x << "," << vertices.at(i).y << "," << vertices.at(i).z << ")" << std::endl;
     }
     ss << "La scene comporte " << shapes.size() << " shapes." << std::endl;
+    // The scene may be finished again with another accelerator
+    if (accelerator) { delete accelerator; }
     switch (accelerator_id)
     {
         case 0 :
@@ -61,10 +64,15 @@ bool Scene::finish(int accelerator_id/* = 3*/, leafTreatment::treatment _interse
             accelerator = new GridAccelerator(&shapes, globalBox);
             break;
         case 2 :
-            accelerator = new BvhAccelerator(&shapes, globalBox,
-                                             AcousticRaytracerConfiguration::get()->MaxTreeDepth,
-                                             "middle");
+        {
+            // Binned SAH BVH built in parallel
+            BvhAccelerator* bvh = new BvhAccelerator(&shapes, globalBox,
+                                                     AcousticRaytracerConfiguration::get()->MaxTreeDepth,
+                                                     "sah");
+            bvh->setNbBuildThreads(nbBuildThreads >= 0 ? nbBuildThreads : AcousticRaytracerConfiguration::get()->NbThreads);
+            accelerator = bvh;
             break;
+        }
         case 3 :
             accelerator = new KdtreeAccelerator(&shapes, globalBox);
             break;
@@ -75,6 +83,10 @@ bool Scene::finish(int accelerator_id/* = 3*/, leafTreatment::treatment _interse
 
     accelerator->setIntersectionChoice(_intersectionChoice);
 
+    // The accelerator intersects the triangles through their flat storage
+    triangles.build(shapes);
+    accelerator->setTriangleBuffer(&triangles);
+
     return accelerator->build();
 }
 
@@ -19,6 +19,7 @@
 #include <vector>
 #include "Accelerator/Accelerator.h"
 #include "Shape.h"
+#include "TriangleBuffer.h"
 
 /**
  * \struct compVec
@@ -81,14 +82,18 @@ public:
     const std::vector<vec3>* getVertices() const { return &vertices; }
     /// Return all the shapes of a specific type
     std::vector<Shape*> getShapes(int shape_type);
+    /// Return the flat storage of the triangles (filled by finish())
+    const TriangleBuffer* getTriangleBuffer() const { return &triangles; }
 
     /**
      * @brief Build the selected accelerator on the scene
      * @param accelerator_id Accelerator id
      * @param _intersectionChoice Intersection choice
+     * @param nbBuildThreads Number of threads building the BVH (0: number of hardware threads,
+     * -1: AcousticRaytracerConfiguration::NbThreads)
      * @return True if succeeds, false if not
      */
-    bool finish(int accelerator_id = 3, leafTreatment::treatment _intersectionChoice = leafTreatment::FIRST);
+    bool finish(int accelerator_id = 3, leafTreatment::treatment _intersectionChoice = leafTreatment::FIRST, int nbBuildThreads = -1);
 
     /**
      * @brief Get the index of a vertex in the vertices array
@@ -139,6 +144,7 @@ protected:
     std::vector<Shape*> shapes;									//!< Array of pointers to the shapes
     BBox globalBox;												//!< Bounding box of the Scene
     Accelerator* accelerator;									//!< Pointer to the accelerator
+    TriangleBuffer triangles;									//!< Flat storage of the triangles used by the accelerator
 
     std::vector<vec3> vertices;                             	//!< All the vertices used by the different shapes
     std::map<vec3, unsigned int, compVec> registeredVertices; 	//!< Association between a vertex and his index in vertices
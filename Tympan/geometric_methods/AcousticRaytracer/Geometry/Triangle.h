@@ -47,6 +47,13 @@ public:
     void setNormal(const vec3& _normal) { normal = _normal; }
     virtual vec3 getNormal(const vec3 pos = vec3()) { return normal;}
 
+    /// Get the first vertex
+    const vec3& getOrigin() const { return p; }
+    /// Get the vector to reach the second vertex
+    const vec3& getU() const { return u; }
+    /// Get the vector to reach the third vertex
+    const vec3& getV() const { return v; }
+
     /// Uncommented method cause not used
     virtual bool sample(decimal density, std::vector<vec3>& samples);
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "Triangle.h"
+#include "TriangleBuffer.h"
+
+static inline void copyVec3(const vec3& v, decimal* dest)
+{
+    dest[0] = v.x;
+    dest[1] = v.y;
+    dest[2] = v.z;
+}
+
+void TriangleBuffer::build(const std::vector<Shape*>& _shapes)
+{
+    clear();
+
+    triangles.resize(_shapes.size());
+    shapes.assign(_shapes.size(), (Shape*)NULL);
+
+    for (size_t i = 0; i < _shapes.size(); i++)
+    {
+        if (_shapes[i]->form() != TRIANGLE) { continue; }
+
+        Triangle* triangle = static_cast<Triangle*>(_shapes[i]);
+        vec3 n;
+        n.cross(triangle->getU(), triangle->getV());
+
+        TriangleData& data = triangles[i];
+        copyVec3(triangle->getOrigin(), data.p);
+        copyVec3(triangle->getU(), data.u);
+        copyVec3(triangle->getV(), data.v);
+        copyVec3(n, data.n);
+        copyVec3(triangle->getNormal(), data.normal);
+        shapes[i] = triangle;
+    }
+}
+
+void TriangleBuffer::clear()
+{
+    std::vector<TriangleData>().swap(triangles);
+    std::vector<Shape*>().swap(shapes);
+}
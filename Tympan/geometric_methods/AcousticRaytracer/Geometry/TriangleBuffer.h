@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef TRIANGLE_BUFFER_H
+#define TRIANGLE_BUFFER_H
+
+#include <vector>
+
+#include "Shape.h"
+
+/**
+ * \brief Flat storage of the triangles of a list of shapes
+ *
+ * The triangles are stored with their first vertex, their edges and their normals in one contiguous array of
+ * compact records (one cache line per triangle), indexed as the shapes in the list. The accelerators use it to
+ * intersect the triangles without virtual calls, the Shape pointers being only kept to fill the Intersection.
+ */
+class TriangleBuffer
+{
+
+public:
+    /// Constructor
+    TriangleBuffer() { }
+    /// Destructor
+    ~TriangleBuffer() { }
+
+    /// Fill the buffer with the triangles of a list of shapes (the other shapes are not stored)
+    void build(const std::vector<Shape*>& shapes);
+    /// Clear all arrays
+    void clear();
+
+    /// Return true if the shape of index i in the list is stored in the buffer
+    bool contains(unsigned int i) const { return (i < shapes.size()) && (shapes[i] != NULL); }
+
+    /**
+     * @brief Get the Intersection between a ray and a triangle (same result as Triangle::getIntersection)
+     * @param i Index of the triangle in the list of shapes
+     * @param ray The ray
+     * @param inter [out] The intersection
+     * @return True if the ray intersects the triangle
+     */
+    bool getIntersection(unsigned int i, const Ray& ray, Intersection& inter) const
+    {
+        const TriangleData& triangle = triangles[i];
+
+        vec3 directeur = ray.getDirection();
+        directeur.normalize();
+        if (directeur.dot(vec3(triangle.normal)) > 0.)
+        {
+            return false;
+        }
+
+        vec3 u(triangle.u);
+        vec3 v(triangle.v);
+        vec3 n(triangle.n);
+        vec3 otr = Vector_r(ray.getPosition(), vec3(triangle.p));
+        double ir, iu, iv;
+        vec3 temp;
+
+        ir = -(n.dot(otr)) / (n.dot(directeur));
+        temp.cross(otr, v);
+        iu = (temp.dot(directeur)) / (n.dot(directeur));
+        temp.cross(u, otr);
+        iv = (temp.dot(directeur)) / (n.dot(directeur));
+
+        if (iu >= -0.00001 && iu <= 1.00001 && iv >= -0.00001 && iv <= 1.00001 && ir >= -0.00001 && iu + iv <= 1.00001)
+        {
+            inter.t = (decimal)ir;
+            inter.p = shapes[i];
+            inter.forme = TRIANGLE;
+            return true;
+        }
+        return false;
+    }
+
+protected:
+    /// Data of a triangle used by the intersection test
+    struct TriangleData
+    {
+        decimal p[3];       //!< First vertex
+        decimal u[3];       //!< Vector to reach the second vertex
+        decimal v[3];       //!< Vector to reach the third vertex
+        decimal n[3];       //!< Cross product u^v
+        decimal normal[3];  //!< Unit normal
+    };
+
+    std::vector<TriangleData> triangles;    //!< Triangles (the entries of the other shapes are unused)
+    std::vector<Shape*> shapes;             //!< Triangles of the list (NULL for the other shapes)
+};
+
+#endif
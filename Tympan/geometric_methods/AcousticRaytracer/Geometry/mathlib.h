@@ -47,7 +47,7 @@ namespace core_mathlib
 
 typedef float decimal;
 
-typedef unsigned int bitSet; /*!< used to manage set of elements*/
+typedef unsigned long long bitSet; /*!< used to manage set of elements (64 bits)*/
 
 #ifndef EPSILON_4 // was BARELY_EPSILON before
 #define EPSILON_4           (decimal)0.0001 // 10e-4
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef EVENT_HISTORY_H
+#define EVENT_HISTORY_H
+
+#include <cassert>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "Acoustic/Event.h"
+
+/**
+ * \brief Copy-on-write list of the events encountered by a ray
+ *
+ * Copying an EventHistory only shares its storage, so that branching a ray costs a single
+ * reference count increment whatever the number of events. The storage is duplicated the
+ * first time a shared history is modified (push_back, set, pop_back, erase). The events themselves
+ * were already shared between the copies of a ray, hence the elements are only handed out
+ * as const references: the events may be modified, not replaced.
+ */
+class EventHistory
+{
+public:
+    typedef boost::shared_ptr<Event> value_type;
+    typedef std::vector<value_type> container;
+    typedef container::size_type size_type;
+    typedef container::const_iterator iterator;
+    typedef container::const_iterator const_iterator;
+    typedef container::const_reverse_iterator reverse_iterator;
+    typedef container::const_reverse_iterator const_reverse_iterator;
+
+    /// Number of events
+    size_type size() const { return data ? data->size() : 0; }
+    /// True if the ray has no events
+    bool empty() const { return size() == 0; }
+
+    const value_type& at(size_type i) const { return storage().at(i); }
+    /// Event at position i (i < size(), not checked in release builds)
+    const value_type& operator[](size_type i) const { assert(i < size()); return (*data)[i]; }
+    /// First event (the history must not be empty)
+    const value_type& front() const { assert(!empty()); return data->front(); }
+    /// Last event (the history must not be empty)
+    const value_type& back() const { assert(!empty()); return data->back(); }
+
+    const_iterator begin() const { return data ? data->begin() : const_iterator(); }
+    const_iterator end() const { return data ? data->end() : const_iterator(); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    /// Append an event (duplicates the storage if it is shared with another ray)
+    void push_back(const value_type& ev)
+    {
+        detach(size() + 1);
+        data->push_back(ev);
+    }
+
+    /// Replace the event at position i (duplicates the storage if it is shared with another ray)
+    void set(size_type i, const value_type& ev)
+    {
+        detach(size());
+        data->at(i) = ev;
+    }
+
+    /// Remove the last event (duplicates the storage if it is shared with another ray)
+    void pop_back()
+    {
+        detach(size());
+        data->pop_back();
+    }
+
+    /// Remove the event at pos and return an iterator to the next one
+    iterator erase(iterator pos)
+    {
+        size_type i = pos - begin();
+        detach(size());
+        return data->erase(data->begin() + i);
+    }
+
+    /// Remove all the events (the storage shared with other rays is left untouched)
+    void clear() { data.reset(); }
+
+    /// True if the storage is shared with another history (mainly for testing purpose)
+    bool isShared() const { return data && !data.unique(); }
+
+private:
+    const container& storage() const
+    {
+        static const container noEvents;
+        return data ? *data : noEvents;
+    }
+
+    /// Make sure the storage is owned by this history only, reserving room for capacity events
+    void detach(size_type capacity)
+    {
+        if (!data)
+        {
+            data = boost::make_shared<container>();
+            data->reserve(capacity);
+        }
+        else if (!data.unique())
+        {
+            boost::shared_ptr<container> copy = boost::make_shared<container>();
+            copy->reserve(capacity);
+            copy->assign(data->begin(), data->end());
+            data.swap(copy);
+        }
+    }
+
+    boost::shared_ptr<container> data;  //!< Storage, possibly shared with the copies of the ray
+};
+
+#endif
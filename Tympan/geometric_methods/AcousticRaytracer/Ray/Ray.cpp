@@ -15,12 +15,157 @@
 
 #include <cassert>
 #include <vector>
+#include <new>
+#include <mutex>
 #include "Geometry/mathlib.h"
 #include "Geometry/Cylindre.h"
 #include "Acoustic/Event.h"
 #include "Acoustic/Recepteur.h"
 #include "Ray.h"
 
+namespace
+{
+    /// Link between the free blocks of the pool, stored in the blocks themselves
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    const std::size_t RAY_SLAB_SIZE = 256;      //!< Number of rays allocated at once by the pool
+    const std::size_t RAY_CACHE_BATCH = 64;     //!< Number of blocks moved at once between a thread cache and the shared pool
+    const std::size_t RAY_BLOCK_ALIGN = 16;
+    const std::size_t RAY_BLOCK_SIZE = (sizeof(Ray) + RAY_BLOCK_ALIGN - 1) / RAY_BLOCK_ALIGN * RAY_BLOCK_ALIGN;
+
+    /// Blocks shared by all the threads. The slabs are released by Ray::releasePoolMemory() when no
+    /// ray is alive any more, and at the end of the program.
+    struct SharedRayPool
+    {
+        SharedRayPool() : freeList(NULL), nbFree(0) { }
+        ~SharedRayPool() { releaseSlabs(); }
+
+        void releaseSlabs()
+        {
+            for (std::size_t i = 0; i < slabs.size(); i++) { ::operator delete(slabs[i]); }
+            slabs.clear();
+            freeList = NULL;
+            nbFree = 0;
+        }
+
+        std::mutex mutex;
+        FreeBlock* freeList;
+        std::size_t nbFree;
+        std::vector<char*> slabs;
+    };
+
+    SharedRayPool& sharedRayPool()
+    {
+        static SharedRayPool pool;
+        return pool;
+    }
+
+    /// Move nb blocks from the list from (holding nbFrom blocks) to the list to
+    void moveBlocks(FreeBlock*& from, std::size_t& nbFrom, FreeBlock*& to, std::size_t& nbTo, std::size_t nb)
+    {
+        for (std::size_t i = 0; i < nb && from; i++)
+        {
+            FreeBlock* block = from;
+            from = block->next;
+            block->next = to;
+            to = block;
+            nbFrom--;
+            nbTo++;
+        }
+    }
+
+    /**
+     * \brief Free blocks owned by a thread. Allocations and releases do not need any lock as long as
+     * the cache is neither empty nor too large, blocks are exchanged with the shared pool by batches.
+     */
+    struct RayCache
+    {
+        RayCache() : freeList(NULL), nbFree(0) { }
+        ~RayCache()
+        {
+            SharedRayPool& pool = sharedRayPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            moveBlocks(freeList, nbFree, pool.freeList, pool.nbFree, nbFree);
+        }
+
+        void* allocate()
+        {
+            if (!freeList) { refill(); }
+            FreeBlock* block = freeList;
+            freeList = block->next;
+            nbFree--;
+            return block;
+        }
+
+        void release(void* p)
+        {
+            FreeBlock* block = static_cast<FreeBlock*>(p);
+            block->next = freeList;
+            freeList = block;
+            nbFree++;
+
+            // A thread which deletes many rays (typically the solver) gives the blocks back to the others
+            if (nbFree > 2 * RAY_CACHE_BATCH)
+            {
+                SharedRayPool& pool = sharedRayPool();
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                moveBlocks(freeList, nbFree, pool.freeList, pool.nbFree, RAY_CACHE_BATCH);
+            }
+        }
+
+        void refill()
+        {
+            SharedRayPool& pool = sharedRayPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (pool.nbFree == 0)
+            {
+                char* slab = static_cast<char*>(::operator new(RAY_SLAB_SIZE * RAY_BLOCK_SIZE));
+                pool.slabs.push_back(slab);
+                for (std::size_t i = 0; i < RAY_SLAB_SIZE; i++)
+                {
+                    FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + i * RAY_BLOCK_SIZE);
+                    block->next = pool.freeList;
+                    pool.freeList = block;
+                }
+                pool.nbFree += RAY_SLAB_SIZE;
+            }
+            moveBlocks(pool.freeList, pool.nbFree, freeList, nbFree, RAY_CACHE_BATCH);
+        }
+
+        FreeBlock* freeList;
+        std::size_t nbFree;
+    };
+
+    thread_local RayCache rayCache;
+}
+
+void Ray::releasePoolMemory()
+{
+    SharedRayPool& pool = sharedRayPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    moveBlocks(rayCache.freeList, rayCache.nbFree, pool.freeList, pool.nbFree, rayCache.nbFree);
+
+    // The blocks still held by other threads or by living rays are missing from the pool
+    if (pool.nbFree == pool.slabs.size() * RAY_SLAB_SIZE) { pool.releaseSlabs(); }
+}
+
+void* Ray::operator new(std::size_t size)
+{
+    // Classes derived from Ray do not fit in the blocks
+    if (size != sizeof(Ray)) { return ::operator new(size); }
+    return rayCache.allocate();
+}
+
+void Ray::operator delete(void* p, std::size_t size)
+{
+    if (!p) { return; }
+    if (size != sizeof(Ray)) { ::operator delete(p); return; }
+    rayCache.release(p);
+}
+
 void Ray::computeLongueur()
 {
     if (source == NULL)
@@ -78,7 +223,7 @@ decimal Ray::computeEventsSequenceLength()
 
 	if ( events.size() == 0 ) { return 0; }
 
-	std::vector< boost::shared_ptr<Event> > :: iterator iter = events.begin();
+	EventHistory::const_iterator iter = events.begin();
 
 	vec3 previous = (*iter)->getPosition();
 	vec3 current(0., 0., 0.);
@@ -187,7 +332,7 @@ decimal Ray::computePertinentLength(const vec3& ref, const vec3& lastPos, vec3&
                 {
                     
                     // Get the last event (begining of the reverse iterator)
-                    std::vector< boost::shared_ptr<Event> >::reverse_iterator rit = events.rbegin();
+                    EventHistory::const_reverse_iterator rit = events.rbegin();
                     // Get the position of the lastEvent
                     previous = (*rit)->getPosition();
 
@@ -220,7 +365,7 @@ Base* Ray::getLastPertinentEventOrSource(typeevent evType)
 {
     Base* res = (Base*) source;
 
-    for (std::vector< boost::shared_ptr<Event> > :: iterator iter = events.begin(); iter != events.end(); ++iter)
+    for (EventHistory::const_iterator iter = events.begin(); iter != events.end(); ++iter)
     {
 		if ( (*iter)->getType() == evType ) { res = (Base*) ( (*iter).get() ); }
     }
@@ -231,27 +376,39 @@ Base* Ray::getLastPertinentEventOrSource(typeevent evType)
 std::vector<unsigned int> Ray::getFaceHistory()
 {
     vector<unsigned int> result;
-    result.push_back(source->getId());
+    getFaceHistory(result);
+    return result;
+}
+
+std::vector<unsigned int> Ray::getPrimitiveHistory()
+{
+    vector<unsigned int> result;
+    getPrimitiveHistory(result);
+    return result;
+}
+
+void Ray::getFaceHistory(std::vector<unsigned int>& history)
+{
+    history.clear();
+    history.push_back(source->getId());
     for (unsigned int i = 0; i < events.size(); i++)
     {
-        result.push_back(events.at(i)->getShape()->getFaceId());
+        history.push_back(events.at(i)->getShape()->getFaceId());
     }
 
-    result.push_back(((Recepteur*)recepteur)->getId());
-    return result;
+    history.push_back(((Recepteur*)recepteur)->getId());
 }
 
-std::vector<unsigned int> Ray::getPrimitiveHistory()
+void Ray::getPrimitiveHistory(std::vector<unsigned int>& history)
 {
-    vector<unsigned int> result;
-    result.push_back(source->getId());
+    history.clear();
+    history.push_back(source->getId());
     for (unsigned int i = 0; i < events.size(); i++)
     {
-        result.push_back(events.at(i)->getShape()->getPrimitiveId());
+        history.push_back(events.at(i)->getShape()->getPrimitiveId());
     }
 
-    result.push_back(((Recepteur*)recepteur)->getId());
-    return result;
+    history.push_back(((Recepteur*)recepteur)->getId());
 }
 
 decimal Ray::getThickness( const decimal& distance, bool diffraction)
@@ -17,6 +17,7 @@
 #define RAY_H
 
 #include <memory>
+#include <cstddef>
 #include <boost/shared_ptr.hpp>
 
 #include "Base.h"
@@ -24,16 +25,17 @@
 #include "Acoustic/Source.h"
 #include "Acoustic/Event.h"
 #include "Acoustic/Diffraction.h"
+#include "EventHistory.h"
 
 using namespace std;
 
 
 typedef std::pair<bitSet, bitSet> signature;
 /**
- * \brief : Describes a ray by a pair of unsigned int. The first one gives the source number (in the range 0-4095)
- *         and the receptor number (in the range 0-1048576) as a bit field.
+ * \brief : Describes a ray by a pair of 64-bit bitSet. The first one gives the source number (32 high bits)
+ *         and the receptor number (32 low bits) as a bit field, so any unsigned int id fits.
  *         The second one describes the sequences of events by their types (user could decide what 1 represent, may be REFLEXION
- *         or DIFFRACTION)
+ *         or DIFFRACTION), up to 64 events.
  */
 class Ray : public Base
 {
@@ -59,10 +61,7 @@ public:
         source = other.source;
         recepteur = other.recepteur;
         constructId = other.constructId;
-        for (unsigned int i = 0; i < other.events.size(); i++)
-        {
-            events.push_back(other.events.at(i));
-        }
+        events = other.events; // Shared until one of the rays gets a new event
 
         nbDiffraction = other.nbDiffraction;
         nbReflexion = other.nbReflexion;
@@ -79,10 +78,7 @@ public:
         source = other->source;
         recepteur = other->recepteur;
         constructId = other->constructId;
-        for (unsigned int i = 0; i < other->events.size(); i++)
-        {
-            events.push_back(other->events.at(i));
-        }
+        events = other->events; // Shared until one of the rays gets a new event
 
         nbDiffraction = other->nbDiffraction;
         nbReflexion = other->nbReflexion;
@@ -93,6 +89,13 @@ public:
     /// Destructor
     virtual ~Ray() { }
 
+    /// Rays are allocated from a pool of fixed size blocks (see Ray.cpp)
+    static void* operator new(std::size_t size);
+    /// Give the block back to the pool
+    static void operator delete(void* p, std::size_t size);
+    /// Give the memory of the pool back to the system if no ray is alive (blocks cached by other running threads prevent it)
+    static void releasePoolMemory();
+
 	/*!
 	 * \fn decimal computeEventsSequenceLength()
 	 * \brief Compute the length of the sequence of events
@@ -173,18 +176,18 @@ public:
     unsigned int getNbEvents() const { return nbDiffraction + nbReflexion; }
 
     /*!
-    * \fn std::vector<boost::shared_ptr<Event> >* getEvents()
+    * \fn EventHistory* getEvents()
     * \brief Return the events array encountered by the ray
     * \return Events array encountered by the ray.
     */
-    std::vector<boost::shared_ptr<Event> >* getEvents() { return &events; }
+    EventHistory* getEvents() { return &events; }
 
     /*!
-    * \fn const std::vector<boost::shared_ptr<Event> >* getEvents() const
+    * \fn const EventHistory* getEvents() const
     * \brief Return the events array encountered by the ray
     * \return Events array encountered by the ray.
     */
-    const std::vector<boost::shared_ptr<Event> >* getEvents() const { return &events; }
+    const EventHistory* getEvents() const { return &events; }
 
     /**
      * \fn getFaceHistory()
@@ -198,6 +201,18 @@ public:
      */
     vector<unsigned int> getPrimitiveHistory();
 
+    /**
+     * \fn void getFaceHistory(vector<unsigned int>& history)
+     * \brief Fill history with the faces id encountered by the ray (reuses its storage)
+     */
+    void getFaceHistory(vector<unsigned int>& history);
+
+    /**
+     * \fn void getPrimitiveHistory(vector<unsigned int>& history)
+     * \brief Fill history with the primitives id encountered by the ray (reuses its storage)
+     */
+    void getPrimitiveHistory(vector<unsigned int>& history);
+
     /*!
     * \fn Source* getSource()
     * \brief Return the ray source
@@ -238,13 +253,24 @@ public:
      */
     inline bitSet getSRBitSet(const unsigned int& source_id, const unsigned int& receptor_id)
     {
-        // The source id is stored in 12 bits, receptor is stored in 20 bits
-        assert((source_id < 4096) && (receptor_id < 1048576));
+        // The source id is stored in the 32 high bits, receptor in the 32 low bits
         bitSet SR = source_id;
-        SR = SR << 20;
+        SR = SR << 32;
         return SR += receptor_id;
     }
 
+    /*!
+     * \fn unsigned int getSourceId(const bitSet& SR);
+     * \brief Return the source id stored in a bitSet built by getSRBitSet()
+     */
+    static inline unsigned int getSourceId(const bitSet& SR) { return static_cast<unsigned int>(SR >> 32); }
+
+    /*!
+     * \fn unsigned int getReceptorId(const bitSet& SR);
+     * \brief Return the receptor id stored in a bitSet built by getSRBitSet()
+     */
+    static inline unsigned int getReceptorId(const bitSet& SR) { return static_cast<unsigned int>(SR & 0xFFFFFFFFULL); }
+
     /*!
      * \fn bitSet getEventsBitSet(const typeevent& typeEv);
      * \brief Compute the bitSet associated with a list of events of type evType
@@ -450,7 +476,7 @@ protected:
     unsigned int nbDiffraction;                 //!< Diffractions number for the ray
     decimal cumulDistance;                      //!< Cumulative length since last valid reflexion
     decimal cumulDelta;                         //!< Cumulative difference by the ray computed at each step
-    std::vector<boost::shared_ptr<Event>> events; //!< Events list for the ray
+    EventHistory events;                        //!< Events list for the ray (copy-on-write)
 
 };
 
@@ -40,10 +40,10 @@ public :
 
     virtual SELECTOR_RESPOND canBeInserted(T* r, unsigned long long& replace)
     {
-        vector< boost::shared_ptr<Event> > *events = r->getEvents();
+        EventHistory *events = r->getEvents();
 		if (events->size() == 0) { return SELECTOR_ACCEPT; }
 
-		vector< boost::shared_ptr<Event> >::iterator it = events->begin();
+		EventHistory::iterator it = events->begin();
 		while(it != events->end())
 		{
 			if ( (*it)->getType() == NOTHING )
@@ -61,10 +61,10 @@ public :
     virtual void insert(T* r) { return; }
     virtual bool insertWithTest(T* r)
     {
-         vector< boost::shared_ptr<Event> > *events = r->getEvents();
+         EventHistory *events = r->getEvents();
 		if (events->size() == 0) { return true; }
 
-		vector< boost::shared_ptr<Event> >::iterator it = events->begin();
+		EventHistory::iterator it = events->begin();
 		while(it != events->end())
 		{
 			if ( (*it)->getType() == NOTHING )
@@ -39,7 +39,7 @@ public :
 
     virtual SELECTOR_RESPOND canBeInserted(T* r, unsigned long long& replace)
     {
-        vector<boost::shared_ptr<Event> >* events = r->getEvents();
+        EventHistory* events = r->getEvents();
 
         if (events->size() < 2) { return SELECTOR_ACCEPT; }
 
@@ -77,7 +77,7 @@ public :
 	
     virtual bool insertWithTest(T* r)
     {
-        vector<boost::shared_ptr<Event> >* events = r->getEvents();
+        EventHistory* events = r->getEvents();
 
         if (events->size() < 2) { return true; }
 
@@ -37,7 +37,7 @@ public :
 
     virtual SELECTOR_RESPOND canBeInserted(T* r, unsigned long long& replace)
     {
-        vector< boost::shared_ptr<Event> > *events = r->getEvents();
+        EventHistory *events = r->getEvents();
 		if (events->size() == 0) { return SELECTOR_ACCEPT; }
 
 
@@ -52,7 +52,7 @@ public :
 		vec3 current_pos = origin;
 
 		// Iterate other the list of events in REVERSE order
-		vector< boost::shared_ptr<Event> >::reverse_iterator rit = events->rbegin();
+		EventHistory::reverse_iterator rit = events->rbegin();
 		while(rit != events->rend())
 		{
 			cumul_distance += (*rit)->getPosition().distance(current_pos);
@@ -109,7 +109,7 @@ public :
 
     virtual bool insertWithTest(T* r)
     {
-        vector< boost::shared_ptr<Event> > *events = r->getEvents();
+        EventHistory *events = r->getEvents();
 		
 		if (events->size() == 0) { return true; }
 
@@ -124,7 +124,7 @@ public :
 		vec3 current_pos = origin;
 
 		// Iterate other the list of events in REVERSE order
-		vector< boost::shared_ptr<Event> >::reverse_iterator rit = events->rbegin();
+		EventHistory::reverse_iterator rit = events->rbegin();
 		while(rit != events->rend())
 		{
 			cumul_distance += (*rit)->getPosition().distance(current_pos);
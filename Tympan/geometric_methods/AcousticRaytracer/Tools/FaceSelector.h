@@ -17,7 +17,7 @@
 #define FACE_SELECTOR
 
 #include "Selector.h"
-#include <map>
+#include "HistoryTable.h"
 #include <vector>
 
 
@@ -67,35 +67,22 @@ public:
 
     virtual SELECTOR_RESPOND canBeInserted(T* r, unsigned long long& replace)
     {
-        typename std::map<std::vector<unsigned int>, T*, CompareToKey>::iterator it;
-        std::vector<unsigned int> path;
-
         //Get the history according to the TYPEHISTORY selected
-        switch (modeHistory)
-        {
-            case HISTORY_FACE :
-                path = r->getFaceHistory();
-                break;
-            case HISTORY_PRIMITIVE :
-                path = r->getPrimitiveHistory();
-                break;
-            default:
-                path = r->getFaceHistory();
-                break;
-        }
+        unsigned long long hash = computeHistory(r);
 
-		it = selectedPath.find(path); // search for an equivalent history among the histories of already selected rays
+        // search for an equivalent history among the histories of already selected rays
+        typename HistoryTable<T*>::Entry* entry = selectedPath.find(history, hash);
 
         // if there already is a ray with the same history
-		if (it != selectedPath.end())
+        if (entry)
         {
             r->computeLongueur();
             double currentDistance = r->getLongueur();
             // if current ray has a shorter length than the already selected one
-            if (currentDistance < it->second->getLongueur())
+            if (currentDistance < entry->value->getLongueur())
             {
                 //replace the older ray by the new one
-                replace = it->second->getConstructId();
+                replace = entry->value->getConstructId();
                 return SELECTOR_REPLACE;
             }
             else
@@ -109,36 +96,21 @@ public:
 
     virtual void insert(T* r)
     {
-        typename std::map<std::vector<unsigned int>, T*, CompareToKey>::iterator it;
-        std::vector<unsigned int> path;
-        switch (modeHistory)
-        {
-            case HISTORY_FACE :
-                path = r->getFaceHistory();
-                break;
-            case HISTORY_PRIMITIVE :
-                path = r->getPrimitiveHistory();
-                break;
-            default:
-                path = r->getFaceHistory();
-                break;
-        }
-
-       
-        it = selectedPath.find(path); // search for an equivalent history among the histories of already selected rays
+        unsigned long long hash = computeHistory(r);
+        typename HistoryTable<T*>::Entry* entry = selectedPath.find(history, hash); // search for an equivalent history among the histories of already selected rays
         r->computeLongueur();
 
         // if there already is a ray with the same history
-        if (it != selectedPath.end()) 
+        if (entry) 
         {
-            it->second = r;
+            entry->value = r;
 
             return;
         }
         else
         {
             // if none of the already selected rays has the same history than r, then add the ray and its hsitory to selectedPath
-            selectedPath.insert(std::pair<std::vector<unsigned int>, T*>(path, r));
+            selectedPath.insert(history, hash, r);
         }
 
 		return ;
@@ -146,31 +118,17 @@ public:
 
     virtual bool insertWithTest(T* r)
     {
-        typename std::map<std::vector<unsigned int>, T*, CompareToKey>::iterator it;
-        std::vector<unsigned int> path;
-        switch (modeHistory)
-        {
-            case HISTORY_FACE :
-                path = r->getFaceHistory();
-                break;
-            case HISTORY_PRIMITIVE :
-                path = r->getPrimitiveHistory();
-                break;
-            default:
-                path = r->getFaceHistory();
-                break;
-        }
-
-		it = selectedPath.find(path); // search for an equivalent history among the histories of already selected rays
+        unsigned long long hash = computeHistory(r);
+        typename HistoryTable<T*>::Entry* entry = selectedPath.find(history, hash); // search for an equivalent history among the histories of already selected rays
         r->computeLongueur();
         double currentDistance = r->getLongueur();
 
         // if there already is a ray with the same history
-        if (it != selectedPath.end())
+        if (entry)
         {
-            if (currentDistance < it->second->getLongueur())
+            if (currentDistance < entry->value->getLongueur())
             {
-                it->second = r;
+                entry->value = r;
                 return true;
             }
             else
@@ -181,7 +139,7 @@ public:
         else
         {
             // if none of the already selected rays has the same history than r, then add the ray and its hsitory to selectedPath
-            selectedPath.insert(std::pair<std::vector<unsigned int>, T*>(path, r));
+            selectedPath.insert(history, hash, r);
             return true;
         }
     }
@@ -194,7 +152,26 @@ public:
 	}
 
 protected:
-    std::map<std::vector<unsigned int>, T*, CompareToKey> selectedPath; //!< Histories of all selected rays so far
+    /// Fill history with the history of r according to the TYPEHISTORY selected and return its hash
+    unsigned long long computeHistory(T* r)
+    {
+        switch (modeHistory)
+        {
+            case HISTORY_FACE :
+                r->getFaceHistory(history);
+                break;
+            case HISTORY_PRIMITIVE :
+                r->getPrimitiveHistory(history);
+                break;
+            default:
+                r->getFaceHistory(history);
+                break;
+        }
+        return HistoryTable<T*>::hashOf(history);
+    }
+
+    HistoryTable<T*> selectedPath; //!< Histories of all selected rays so far
+    std::vector<unsigned int> history; //!< History of the last ray tested (storage reused from ray to ray)
     TYPEHISTORY modeHistory;	//!< TYPEHISTORY used by this Selector (by default, HISTORY_FACE)
 };
 
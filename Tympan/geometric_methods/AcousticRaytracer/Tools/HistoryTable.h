@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef HISTORY_TABLE_H
+#define HISTORY_TABLE_H
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * \brief Hash table of ray histories (arrays of ids) using open addressing
+ *
+ * The histories are hashed with a rolling 64-bit hash and stored with their
+ * hash in a linear probing table (at most half full). A lookup compares the
+ * whole history only when the hashes are equal, so hash collisions are
+ * resolved exactly. Entries are never removed, only cleared all at once.
+ */
+template<typename T>
+class HistoryTable
+{
+public:
+    /// Entry of the table
+    struct Entry
+    {
+        Entry() : hash(0), value(), used(false) {}
+        unsigned long long hash;            //!< Hash of the history
+        std::vector<unsigned int> history;  //!< History
+        T value;                            //!< Value associated to the history
+        bool used;                          //!< False for an empty slot
+    };
+
+    /// Constructor
+    HistoryTable() : nbEntries(0) {}
+
+    /// Rolling 64-bit hash of a history
+    static unsigned long long hashOf(const std::vector<unsigned int>& history)
+    {
+        unsigned long long h = 14695981039346656037ULL; // FNV-1a on the ids
+        for (size_t i = 0; i < history.size(); i++)
+        {
+            h = (h ^ history[i]) * 1099511628211ULL;
+        }
+        // Final mix so that the low bits (used as slot index) depend on all the ids
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /// Return the entry of a history (NULL if not found)
+    Entry* find(const std::vector<unsigned int>& history, unsigned long long hash)
+    {
+        if (slots.empty()) { return NULL; }
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash & mask; slots[i].used; i = (i + 1) & mask)
+        {
+            if (slots[i].hash == hash && slots[i].history == history) { return &slots[i]; }
+        }
+        return NULL;
+    }
+
+    /// Add a history which is not in the table yet and return its entry
+    Entry* insert(const std::vector<unsigned int>& history, unsigned long long hash, const T& value)
+    {
+        if (2 * (nbEntries + 1) > slots.size()) { grow(); }
+        Entry* entry = &slots[freeSlot(hash)];
+        entry->hash = hash;
+        entry->history = history;
+        entry->value = value;
+        entry->used = true;
+        nbEntries++;
+        return entry;
+    }
+
+    /// Number of histories in the table
+    size_t size() const { return nbEntries; }
+
+    /// Remove all the histories
+    void clear() { slots.clear(); nbEntries = 0; }
+
+private:
+    /// First empty slot for a hash
+    size_t freeSlot(unsigned long long hash) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = hash & mask;
+        while (slots[i].used) { i = (i + 1) & mask; }
+        return i;
+    }
+
+    /// Double the number of slots (power of 2) and move the entries
+    void grow()
+    {
+        std::vector<Entry> old;
+        old.swap(slots);
+        slots.resize(old.empty() ? 64 : 2 * old.size());
+        for (size_t i = 0; i < old.size(); i++)
+        {
+            if (!old[i].used) { continue; }
+            Entry& entry = slots[freeSlot(old[i].hash)];
+            entry.hash = old[i].hash;
+            entry.history.swap(old[i].history);
+            entry.value = old[i].value;
+            entry.used = true;
+        }
+    }
+
+    std::vector<Entry> slots;   //!< Slots (size is 0 or a power of 2)
+    size_t nbEntries;           //!< Number of used slots
+};
+
+#endif // HISTORY_TABLE_H
@@ -86,7 +86,7 @@ public :
         if (!acceptGround){
 			
 			//loop on evets
-			std::vector<boost::shared_ptr<Event> >* tabEvent = r->getEvents();
+			EventHistory* tabEvent = r->getEvents();
 			for(unsigned int i=0;i<tabEvent->size();i++){
 
 				//check if the ith event is a reflexion on the ground
@@ -142,7 +142,7 @@ public :
         if (!acceptGround){
 			
 			//loop on evets
-			std::vector<boost::shared_ptr<Event> >* tabEvent = r->getEvents();
+			EventHistory* tabEvent = r->getEvents();
 			for(unsigned int i=0;i<tabEvent->size();i++){
 
 				//check if the ith event is a reflexion on the ground
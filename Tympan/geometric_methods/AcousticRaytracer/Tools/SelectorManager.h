@@ -18,6 +18,8 @@
 
 #include "Selector.h"
 #include <vector>
+#include <map>
+#include <string>
 
 
 
@@ -49,7 +51,7 @@ public:
     /// Return true if this may be deleted
     bool isDeletable() { return deletable; }
     /// Add a Selector to the list
-    void addSelector(Selector<T> *selector) { selectors.push_back(selector); }
+    void addSelector(Selector<T> *selector) { selectors.push_back(selector); rejections.push_back(0); }
     /// Return the Selector's list
     std::vector<Selector<T>*>& getSelectors() const { return selectors; }
     /// Reset all the Selector and clear the local data
@@ -57,9 +59,11 @@ public:
     {
         for (unsigned int i = 0; i < selectors.size(); i++)
         {
+            if (i < rejections.size() && rejections[i]) { pastRejections[selectors.at(i)->getSelectorName()] += rejections[i]; }
             selectors.at(i)->reset();
         }
         selectors.clear();
+        rejections.clear();
 
         if ( !isDeletable() )
         {
@@ -88,6 +92,8 @@ public:
             switch (selectors.at(i)->canBeInserted(data, oldData))
             {
                 case SELECTOR_REJECT:
+                    if (i >= rejections.size()) { rejections.resize(selectors.size(), 0); }
+                    rejections[i]++;
                     if (deletable)
                     {
                         delete data;
@@ -113,7 +119,6 @@ public:
         for (unsigned int i = 0; i < dataToReplace.size(); i++)
         {
             typename std::map<unsigned long long, T*>::iterator it = selectedData.find(dataToReplace.at(i));
-            it = selectedData.find(dataToReplace.at(i));
             if (it != selectedData.end())
             {
                 T* previousData = it->second;
@@ -144,6 +149,16 @@ public:
     }
     /// Get the selected data
     std::map<unsigned long long, T*>& getSelectedData() { return selectedData; }
+    /// Get the number of data rejected by each Selector type (kept by reset())
+    std::map<std::string, unsigned long long> getRejections() const
+    {
+        std::map<std::string, unsigned long long> byName(pastRejections);
+        for (unsigned int i = 0; i < selectors.size() && i < rejections.size(); i++)
+        {
+            if (rejections[i]) { byName[selectors.at(i)->getSelectorName()] += rejections[i]; }
+        }
+        return byName;
+    }
 
 protected:
     bool deletable;										//!< Flag to know if a data may be deleted if rejected (by default, yes)
@@ -151,6 +166,8 @@ protected:
 
     std::map<unsigned long long, T*> selectedData;		//!< Contains accepted data (rays)
     std::map<unsigned long long, T*> rejectedData;		//!< Contains rejected data (rays) if deletable set to false
+    std::vector<unsigned long long> rejections;			//!< Number of data rejected by each Selector (same index)
+    std::map<std::string, unsigned long long> pastRejections;	//!< Number of data rejected by each Selector type before the last reset()
 
 };
 
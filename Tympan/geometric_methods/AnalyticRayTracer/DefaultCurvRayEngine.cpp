@@ -100,7 +100,7 @@ bool DefaultCurvRayEngine::traitementRay(Ray* r, std::list<validRay> &result)
 
 	//Recuperation des structures acceleratrices pour le Solver
     Accelerator* accelerator = scene->getAccelerator();
-    std::list<Intersection> foundPrims;
+    IntersectionBuffer foundPrims;
 	
 	while ( true )
 	{
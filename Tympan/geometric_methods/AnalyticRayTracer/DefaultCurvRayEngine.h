@@ -22,7 +22,6 @@
 /**
  * \brief Engine for analytical ray curve tracing
  */
-#ifdef TEST_ACCELERATION_RECEPTORS
 class DefaultCurvRayEngine : public DefaultEngine
 {
 
@@ -55,31 +54,5 @@ protected:
      */
     virtual bool traitementRay(Ray* r, std::list<validRay> &result);
 };
-#else
-class DefaultCurvRayEngine : public DefaultEngine
-{
-
-public:
-    DefaultCurvRayEngine() : DefaultEngine() {}
-
-    DefaultCurvRayEngine(Scene* _scene, std::vector<Source> *_sources, Solver* _solver, std::vector<Recepteur> *_recepteurs)
-        : DefaultEngine(_scene, _sources, _solver, _recepteurs) {  }
-
-    DefaultCurvRayEngine(const DefaultCurvRayEngine& other)
-    {
-        scene = other.scene;
-        sources = other.sources;
-        solver = other.solver;
-        recepteurs = other.recepteurs;
-    }
-
-    virtual ~DefaultCurvRayEngine() { }
-
-    virtual bool process();
-
-protected:
-    virtual bool traitementRay(Ray* r, std::list<validRay> &result);
-};
-#endif
 
 #endif //_CURV_RAY
@@ -14,6 +14,11 @@
 */
 
 
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include "Tympan/core/exceptions.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Geometry/Sampler.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Geometry/Latitude2DSampler.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Geometry/Longitude2DSampler.h"
@@ -25,7 +30,8 @@
 #include "RayCourb.h"
 #include "Lancer.h"
 
-Lancer::Lancer() : sources(std::vector<vec3>()), recepteurs(std::vector<vec3>()),_weather(NULL), _sampler(NULL), h(0.001f), TMax(3.0f), temps(std::vector<decimal>()), dmax(1000.f), nbRay(20)
+Lancer::Lancer() : sources(std::vector<vec3>()), recepteurs(std::vector<vec3>()),_weather(NULL), _sampler(NULL), h(0.001f), TMax(3.0f), temps(std::vector<decimal>()), dmax(1000.f), nbRay(20), nbThreads(1),
+    adaptiveStep(false), tolerance(0.001f), nbIntegrationSteps(0)
 {
     _weather = new meteoLin();
     initialAngleTheta = 0.0;                /*!<  angle de tir initial selon theta */
@@ -49,6 +55,10 @@ Lancer::Lancer(Lancer& L)
     temps = L.temps;
     dmax = L.dmax;
     nbRay = L.nbRay;
+    nbThreads = L.nbThreads;
+    adaptiveStep = L.adaptiveStep;
+    tolerance = L.tolerance;
+    nbIntegrationSteps = L.nbIntegrationSteps;
     MatRes = L.MatRes;
 
     initialAngleTheta = L.initialAngleTheta;
@@ -112,17 +122,22 @@ void Lancer::purgeMatRes()
 }
 
 Step Lancer::EqRay(const Step& y0)                       // Fonction definissant le probleme a resoudre
+{
+    return EqRay(linear_weather(), y0);
+}
+
+Step Lancer::EqRay(const meteoLin& weather, const Step& y0)
 {
     Step y;
     vec3 n;
 
     // calcul des variables de celerite et de son gradient, de la vitesse du vent et de sa derive
     vec3 Dc = vec3();
-    decimal c = (decimal)dynamic_cast<meteoLin*>(_weather)->cTemp(y0.pos, Dc);
+    decimal c = (decimal)weather.cTemp(y0.pos, Dc);
 
     //map<pair<int, int>, decimal> Jv;
-    const array< array<double, 3>, 3 >& Jv = dynamic_cast<meteoLin*>(_weather)->getJacobMatrix();
-    vec3 v = dynamic_cast<meteoLin*>(_weather)->cWind(y0.pos);
+    const array< array<double, 3>, 3 >& Jv = weather.getJacobMatrix();
+    vec3 v = weather.cWind(y0.pos);
 
     // definition de s (normale normalisee selon la celerite effective) et de Omega
     vec3 s = y0.norm;
@@ -148,6 +163,13 @@ Step Lancer::EqRay(const Step& y0)                       // Fonction definissant
 
 
 RayCourb Lancer::RK4(const Step& y0)
+{
+    RayCourb y;
+    RK4(linear_weather(), y0, y);
+    return y;
+}
+
+unsigned int Lancer::RK4(const meteoLin& weather, const Step& y0, RayCourb& y)
 {
     /*
     Pour une source donnee, a chaque pas de temps :
@@ -162,7 +184,6 @@ RayCourb Lancer::RK4(const Step& y0)
 
     decimal travel_length = 0.;
 
-    RayCourb y;
     y.setSize(temps.size() + 10);
 
     /* on definit deux vectors : un  "actuel" et un "suivant" car la methode de Runge-Kutta est une methode de resolution explicite a un pas de temps */
@@ -181,7 +202,7 @@ RayCourb Lancer::RK4(const Step& y0)
         // Car on parcourt les objets dans l'ordre ou ils sont ranges mais il se peut qu'un objet A plus pres du point considere se trouve apres un objet B plus loin
         // et quand on boucle, si on sort des la premiere intersection, la reponse sera l'intersection avec B alors que dans la realite, c'est avec l'objet A qu'il y a une intersection.
 
-        ySuiv = compute_next_step(yAct);
+        ySuiv = compute_next_step(weather, yAct);
 
         // Recherche des intersections
         intersection(cpt_tps, y, yAct, ySuiv);
@@ -196,7 +217,225 @@ RayCourb Lancer::RK4(const Step& y0)
         cpt_tps++;
     }
 
-    return y;
+    return cpt_tps;
+}
+
+/*!
+ * \brief Step of the Dormand-Prince 5(4) method and its dense output
+ *
+ * Coefficients from Dormand & Prince (1980), continuous extension of order 4
+ * from Shampine (1986).
+ */
+class DenseStep
+{
+public:
+    DenseStep(const meteoLin& weather) : _weather(weather), _h(0.) {}
+
+    /// Compute the step of length h from y0 (k[0] is the derivative at y0), return the error estimate
+    double compute(const Step& y0, double h, decimal dmax)
+    {
+        static const double a[6][6] =
+        {
+            { 1. / 5. },
+            { 3. / 40., 9. / 40. },
+            { 44. / 45., -56. / 15., 32. / 9. },
+            { 19372. / 6561., -25360. / 2187., 64448. / 6561., -212. / 729. },
+            { 9017. / 3168., -355. / 33., 46732. / 5247., 49. / 176., -5103. / 18656. },
+            { 35. / 384., 0., 500. / 1113., 125. / 192., -2187. / 6784., 11. / 84. }
+        };
+        static const double e[7] = { 71. / 57600., 0., -71. / 16695., 71. / 1920., -17253. / 339200., 22. / 525., -1. / 40. };
+
+        _y0 = y0;
+        _h = h;
+        for (int s = 0; s < 6; s++)
+        {
+            Step y = combine(a[s], s + 1);
+            if (s == 5) { _y1 = y; }
+            k[s + 1] = Lancer::EqRay(_weather, y);
+        }
+
+        // Deviation of the position, and of the direction at the distance dmax
+        Step err = combine(e, 7, false);
+        double errDirection = _y1.norm.length() > 0. ? err.norm.length() / _y1.norm.length() * dmax : 0.;
+        return std::max<double>(err.pos.length(), errDirection);
+    }
+
+    /// Interpolated ray at the fraction theta of the step
+    Step at(double theta) const
+    {
+        static const double bi[7][4] =
+        {
+            { 1., -183. / 64., 37. / 12., -145. / 128. },
+            { 0., 0., 0., 0. },
+            { 0., 1500. / 371., -1000. / 159., 1000. / 371. },
+            { 0., -125. / 32., 125. / 12., -375. / 64. },
+            { 0., 9477. / 3392., -729. / 106., 25515. / 6784. },
+            { 0., -11. / 7., 11. / 3., -55. / 28. },
+            { 0., 3. / 2., -4., 5. / 2. }
+        };
+
+        if (theta >= 1.) { return _y1; }
+
+        double b[7];
+        for (int i = 0; i < 7; i++)
+        {
+            b[i] = theta * (bi[i][0] + theta * (bi[i][1] + theta * (bi[i][2] + theta * bi[i][3])));
+        }
+        return combine(b, 7);
+    }
+
+    const Step& start() const { return _y0; } //!< Ray at the start of the step
+    const Step& end() const { return _y1; }   //!< Ray at the end of the step
+    double length() const { return _h; }    //!< Time length of the step
+
+    Step k[7]; //!< Derivatives at the stages (k[6] is the derivative at the end of the step)
+
+private:
+    /// y0 + h * sum(coef[i] * k[i]) (or without y0)
+    Step combine(const double* coef, int n, bool fromY0 = true) const
+    {
+        Step sum;
+        for (int i = 0; i < n; i++)
+        {
+            if (coef[i] != 0.) { sum = sum + k[i] * (decimal)(coef[i] * _h); }
+        }
+        return fromY0 ? _y0 + sum : sum;
+    }
+
+    const meteoLin& _weather;
+    double _h;
+    Step _y0;
+    Step _y1;
+};
+
+unsigned int Lancer::DP45(const meteoLin& weather, const Step& y0, RayCourb& y)
+{
+    /*
+    Le pas de temps est adapte pour que l'erreur locale reste inferieure a la tolerance.
+    Les points du rayon sont interpoles tous les h comme pour RK4 ; une reflexion remplace
+    le point suivant par le point d'intersection exact du rayon interpole avec la face.
+    */
+
+    const double hMin = h * 1e-3;
+    const double tEnd = h * temps.size(); // Instant du dernier point (comme RK4)
+    decimal travel_length = 0.;
+
+    y.setSize(temps.size() + 10);
+    y.etapes.push_back(y0);
+
+    DenseStep step(weather);
+    step.k[0] = EqRay(weather, y0);
+    Step yAct(y0);
+    double t = 0.;
+    double hs = h;
+    unsigned int nbSteps = 0;
+    unsigned int next = 1; // Indice du prochain point du rayon (instant next * h)
+
+    while ((next <= temps.size()) && (travel_length < dmax) && (t < tEnd))
+    {
+        hs = std::min(hs, tEnd - t);
+        double err = step.compute(yAct, hs, dmax) / tolerance;
+        nbSteps++;
+
+        if ((err > 1.) && (hs > hMin))
+        {
+            // Pas rejete
+            hs = std::max(hMin, hs * std::max(0.2, 0.9 * pow(err, -0.2)));
+            continue;
+        }
+
+        double theta = 1.;
+        int face = -1;
+        vec3 normal;
+        bool reflexion = findCrossing(step, theta, face, normal);
+        double tStop = t + theta * hs;
+
+        // Points du rayon avant la fin du pas (ou avant la reflexion)
+        while ((next <= temps.size()) && (travel_length < dmax) &&
+               (reflexion ? (next * h < tStop) : (next * h <= tStop)))
+        {
+            Step ySuiv = step.at((next * h - t) / hs);
+            travel_length += ySuiv.pos.distance(y.etapes.back().pos);
+            y.etapes.push_back(ySuiv);
+            next++;
+        }
+
+        if (reflexion)
+        {
+            if ((next > temps.size()) || (travel_length >= dmax)) { break; }
+
+            Step ySuiv = step.at(theta);
+            y.nbReflex++;
+            y.position.push_back(static_cast<int>(y.etapes.size()) - 1);
+            y.rencontre.insert(pair<int, int>(static_cast<int>(y.etapes.size()) - 1, face));
+
+            // Meme formule que Lancer::intersection pour la normale du rayon reflechi
+            decimal cos_angle = (-normal) * (ySuiv.norm / ySuiv.norm.length());
+            ySuiv.norm = ySuiv.norm + normal * ySuiv.norm.length() * cos_angle * 2.;
+
+            travel_length += ySuiv.pos.distance(y.etapes.back().pos);
+            y.etapes.push_back(ySuiv);
+            next++;
+
+            yAct = ySuiv;
+            step.k[0] = EqRay(weather, yAct);
+        }
+        else
+        {
+            yAct = step.end();
+            step.k[0] = step.k[6]; // First Same As Last
+        }
+        t = tStop;
+
+        hs *= err > 0. ? std::min(5., std::max(0.2, 0.9 * pow(err, -0.2))) : 5.;
+        hs = std::max(hs, hMin);
+    }
+
+    return nbSteps;
+}
+
+bool Lancer::findCrossing(const DenseStep& step, double& theta, int& face, vec3& normal) const
+{
+    const Step& y0 = step.start();
+    const Step& y1 = step.end();
+    bool found = false;
+
+    for (unsigned int r = 0; r < _plan.size(); ++r)
+    {
+        const vec3* A = _plan[r];
+        vec3 n = vec3(A[0], A[1]) ^ vec3(A[0], A[2]);
+        n = n / n.length();
+
+        // Le rayon doit passer du cote exterieur au cote interieur de la face
+        double d0 = vec3(A[0], y0.pos) * n;
+        double d1 = vec3(A[0], y1.pos) * n;
+        if ((d0 <= 0.) || (d1 > 0.)) { continue; }
+
+        // Recherche par dichotomie de l'instant du croisement sur le rayon interpole
+        double lo = 0., hi = 1.;
+        for (int i = 0; i < 40; i++)
+        {
+            double mid = 0.5 * (lo + hi);
+            if (vec3(A[0], step.at(mid).pos) * n > 0.) { lo = mid; } else { hi = mid; }
+        }
+        if (found && (hi >= theta)) { continue; }
+
+        // Le point doit etre dans la face
+        vec3 P = step.at(hi).pos;
+        if ( ((vec3(A[0], A[1]) ^ vec3(A[0], P)) * n < 0.) ||
+             ((vec3(A[1], A[2]) ^ vec3(A[1], P)) * n < 0.) ||
+             ((vec3(A[2], A[0]) ^ vec3(A[2], P)) * n < 0.) )
+        {
+            continue;
+        }
+
+        theta = hi;
+        face = static_cast<int>(r);
+        normal = n;
+        found = true;
+    }
+
+    return found;
 }
 
 void Lancer::RemplirMat()
@@ -204,27 +443,63 @@ void Lancer::RemplirMat()
     /* Methode pour remplir la matrice des resultats.*/
 
     assert(nbRay > 0);  // on verifie que l'on souhaite bien lancer au moins un rayon.
-    vec3 grad, s0, n0;
-    //map< pair<int, int>, decimal > jacob;
-    Step y0;
+    const meteoLin* weather = &linear_weather();
+
+    unsigned int nbWorkers = nbThreads ? nbThreads : std::thread::hardware_concurrency();
+    nbWorkers = std::max(1u, std::min(nbWorkers, nbRay));
 
     RayCourb* tab = NULL;
+    vector<Step> y0(nbRay);
+    vector<unsigned int> nbSteps(nbRay);
+    nbIntegrationSteps = 0;
 
     for (unsigned int ns = 0; ns < sources.size(); ++ns)
     {
         vec3& source = sources[ns];
-        y0.pos = source;
-        tab = new RayCourb[nbRay];
+        vec3 grad;
+        const double c = weather->cTemp(source, grad);
+        const vec3 v = weather->cWind(source);
 
+        // Le sampler n'est pas partage entre les threads : les directions sont tirees a l'avance
         for (unsigned int k = 0; k < nbRay; ++k)
         {
-            n0 = _sampler->getSample();
+            vec3 n0 = _sampler->getSample();
+            y0[k].pos = source;
+            y0[k].norm = n0 / (decimal)(c + (v * n0));
+        }
+
+        tab = new RayCourb[nbRay];
 
-            s0 = n0 / (decimal)((dynamic_cast<meteoLin*>(_weather)->cTemp(source, grad) + (dynamic_cast<meteoLin*>(_weather)->cWind(source) * n0)));
-            y0.norm = s0;
+        // on resoud l'equation par la methode de runge-kutta (d'ordre 4 ou a pas adaptatif), chaque thread ayant ses rayons
+        std::function<void(unsigned int, unsigned int)> shoot = [this, weather, tab, &y0, &nbSteps](unsigned int first, unsigned int last)
+        {
+            for (unsigned int k = first; k < last; ++k)
+            {
+                nbSteps[k] = adaptiveStep ? DP45(*weather, y0[k], tab[k]) : RK4(*weather, y0[k], tab[k]);
+            }
+        };
 
-            // on resoud l'equation par la methode de runge-kutta d'ordre 4
-            tab[k] = RK4(y0);
+        if (nbWorkers == 1)
+        {
+            shoot(0, nbRay);
+        }
+        else
+        {
+            vector<std::thread> threads;
+            const unsigned int chunk = (nbRay + nbWorkers - 1) / nbWorkers;
+            for (unsigned int first = 0; first < nbRay; first += chunk)
+            {
+                threads.push_back(std::thread(shoot, first, std::min(first + chunk, nbRay)));
+            }
+            for (size_t t = 0; t < threads.size(); t++)
+            {
+                threads[t].join();
+            }
+        }
+
+        for (unsigned int k = 0; k < nbRay; ++k)
+        {
+            nbIntegrationSteps += nbSteps[k];
         }
 
         MatRes.push_back(tab);
@@ -235,14 +510,30 @@ void Lancer::RemplirMat()
     if (wantOutFile) { save(); }
 }
 
+const meteoLin& Lancer::linear_weather() const
+{
+    // L'equation eikonale n'est resolue que pour une meteo lineaire
+    const meteoLin* weather = dynamic_cast<const meteoLin*>(_weather);
+    if (!weather)
+    {
+        throw tympan::invalid_data("The curved rays need a linear weather (meteoLin)") << tympan_source_loc;
+    }
+    return *weather;
+}
+
 Step Lancer::compute_next_step(const Step& current_step)
+{
+    return compute_next_step(linear_weather(), current_step);
+}
+
+Step Lancer::compute_next_step(const meteoLin& weather, const Step& current_step) const
 {
     Step k1, k2, k3, k4;
 
-    k1 = EqRay(current_step) * h;
-    k2 = EqRay(current_step + k1 * 0.5) * h;
-    k3 = EqRay(current_step + k2 * 0.5) * h;
-    k4 = EqRay(current_step + k3) * h;
+    k1 = EqRay(weather, current_step) * h;
+    k2 = EqRay(weather, current_step + k1 * 0.5) * h;
+    k3 = EqRay(weather, current_step + k2 * 0.5) * h;
+    k4 = EqRay(weather, current_step + k3) * h;
 
     return current_step + ((k1 + k2 * 2.f + k3 * 2.f + k4) * (1.f / 6.f));
 }
@@ -497,8 +788,8 @@ void Lancer::save()
 {
     // on sauvegarde nos resultats dans un fichier .txt.
     ostringstream nom_var;
-    nom_var << "MatRes_C" << dynamic_cast<meteoLin*>(_weather)->getGradC()
-            << "_V" << dynamic_cast<meteoLin*>(_weather)->getGradV()
+    nom_var << "MatRes_C" << linear_weather().getGradC()
+            << "_V" << linear_weather().getGradV()
             << "_D" << dmax
             << ".txt" << ends;
 
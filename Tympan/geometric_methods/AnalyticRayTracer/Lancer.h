@@ -30,6 +30,8 @@ using namespace std;
 class RayCourb;
 class Sampler;
 class meteo;
+class meteoLin;
+class DenseStep;
 
 /*! \class Lancer
 * \brief Describes analytical ray curve tracing
@@ -69,6 +71,18 @@ public:
     /// Set the discretization step
     void setTimeStep(const decimal& tt) { h = tt; }
 
+    /// Set the number of threads shooting the rays (0 for all the cores)
+    void setNbThreads(const unsigned int& nb) { nbThreads = nb; }
+
+    /// Integrate the rays with an adaptive time step (Dormand-Prince 5(4)) instead of the fixed step RK4
+    void setAdaptiveStep(const bool& adaptive) { adaptiveStep = adaptive; }
+
+    /// Set the error allowed per step of the adaptive integration (in meters)
+    void setTolerance(const decimal& tol) { tolerance = tol; }
+
+    /// Number of integration steps computed by the last run (accepted and rejected)
+    unsigned long getNbIntegrationSteps() const { return nbIntegrationSteps; }
+
     /// Add a triangle to the geometry
     void setTriangle(vec3* triangle) { _plan.push_back(triangle); }
 
@@ -85,6 +99,9 @@ public:
     */
     Step EqRay(const Step& y0);
 
+    /// Eikonal equation with a linear weather (no virtual call nor cast)
+    static Step EqRay(const meteoLin& weather, const Step& y0);
+
     /*!
     * \brief Compute the intersection point between a plane and a line
     * \param [in] S Source
@@ -106,7 +123,13 @@ public:
     */
     RayCourb RK4(const Step& y0);
 
-    /// Fill the MatRes matrix containing the ray curves
+    /*!
+    * \brief Fill the MatRes matrix containing the ray curves
+    *
+    * The directions are drawn from the sampler in sequence, then the rays of
+    * a source are shared between nbThreads threads (each ray is independent).
+    * The rays are integrated by RK4 or, if adaptiveStep is set, by DP45.
+    */
     void RemplirMat();
 
     /// Run the calculation
@@ -138,9 +161,38 @@ private :
     /// Save rays to a file
     void save();
 
+    /// Return the weather, which must be a meteoLin (throw tympan::invalid_data otherwise)
+    const meteoLin& linear_weather() const;
+
     /// Compute next step taking account of the weather
     Step compute_next_step(const Step& current_step);
 
+    /// Next step of the fourth order Runge-Kutta algorithm with a linear weather
+    Step compute_next_step(const meteoLin& weather, const Step& current_step) const;
+
+    /// Fourth order Runge-Kutta algorithm filling the ray y (thread safe), return the number of steps
+    unsigned int RK4(const meteoLin& weather, const Step& y0, RayCourb& y);
+
+    /*!
+    * \brief Dormand-Prince 5(4) algorithm with step size control filling the ray y (thread safe)
+    *
+    * The local error (position, and direction over dmax) is kept below tolerance.
+    * The points of the ray are interpolated (dense output) every h as with RK4,
+    * and a reflection happens at the exact crossing of the interpolated ray with
+    * a face. Return the number of steps (accepted and rejected).
+    */
+    unsigned int DP45(const meteoLin& weather, const Step& y0, RayCourb& y);
+
+    /*!
+    * \brief Find the first face crossed by the ray during an adaptive step
+    * \param [in] step Interpolation of the ray over the step
+    * \param [out] theta Fraction of the step where the face is crossed
+    * \param [out] face Index of the face
+    * \param [out] normal Exterior normal of the face
+    * \return True if a face is crossed from its exterior side
+    */
+    bool findCrossing(const DenseStep& step, double& theta, int& face, vec3& normal) const;
+
 
 public :
     vector<vec3> sources;           //!< Sources vector
@@ -159,6 +211,10 @@ public :
     decimal finalAnglePhi;          //!< Final shot angle according phi
 
     unsigned int nbRay;             //!< Launched rays number
+    unsigned int nbThreads;         //!< Number of threads shooting the rays (0: all the cores)
+    bool adaptiveStep;              //!< True to integrate the rays with DP45
+    decimal tolerance;              //!< Error allowed per step of DP45 (in meters)
+    unsigned long nbIntegrationSteps; //!< Number of integration steps computed by the last run
     unsigned int _launchType;       //!< Launch type with 1:horizontal / 2:vertical / 3:spherical / 4:file
     bool wantOutFile;               //!< True if an output file is wanted
     string ray_fileName;            //!< Filename of file containing angles of rays
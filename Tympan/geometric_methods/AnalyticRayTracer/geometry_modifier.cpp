@@ -15,6 +15,9 @@
 
 
 
+#include <cmath>
+#include <algorithm>
+
 #include "geometry_modifier.h"
 #include "Tympan/models/common/delaunay_maker.h"
 #include "Tympan/models/common/triangle.h"
@@ -50,29 +53,194 @@ void geometry_modifier_z_correction::buildNappe(const Lancer& shot)
     QList<OPoint3D> Liste_vertex = oDelaunayMaker.getVertex(); /*!< Liste des vertex de la triangulation */
 
     append_triangles_to_scene(Liste_vertex, Liste_triangles);
+
+    // 3- La nappe est aussi conservee comme champ de hauteur 2D
+    _nappe_vertices.clear();
+    _nappe_triangles.clear();
+    for (int i = 0; i < Liste_vertex.size(); i++)
+    {
+        _nappe_vertices.push_back( OPoint3Dtovec3( Liste_vertex.at(i) ) );
+    }
+    for (int i = 0; i < Liste_triangles.size(); i++)
+    {
+        _nappe_triangles.push_back( Liste_triangles.at(i)._p1 );
+        _nappe_triangles.push_back( Liste_triangles.at(i)._p2 );
+        _nappe_triangles.push_back( Liste_triangles.at(i)._p3 );
+    }
+
+    build_height_field();
 }
 
 vec3 geometry_modifier_z_correction::fonction_h(const vec3& P)
 {
-    double h = compute_h(P);
+    int hint = -1;
+    double h = compute_h(P, hint);
 
     return vec3(P.x, P.y, P.z + h);
 }
 
 vec3 geometry_modifier_z_correction::fonction_h_inverse(const vec3& P)
 {
-    double h = compute_h(P);
+    int hint = -1;
+    double h = compute_h(P, hint);
 
     return vec3(P.x, P.y, P.z - h);
 }
 
-double geometry_modifier_z_correction::compute_h(const vec3& P)
+void geometry_modifier_z_correction::fonction_h_points(std::vector<vec3>& points)
+{
+    // Les points successifs sont voisins : on part du dernier triangle trouve
+    int hint = -1;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].z += compute_h(points[i], hint);
+    }
+}
+
+void geometry_modifier_z_correction::fonction_h_inverse_points(std::vector<vec3>& points)
+{
+    int hint = -1;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i].z -= compute_h(points[i], hint);
+    }
+}
+
+void geometry_modifier_z_correction::build_height_field()
+{
+    _grid_nx = _grid_ny = 0;
+    _cell_start.clear();
+    _cell_triangles.clear();
+
+    unsigned int nbTriangles = _nappe_triangles.size() / 3;
+    if ( (nbTriangles == 0) || _nappe_vertices.empty() ) { return; }
+
+    // Boite englobante de la nappe dans le plan XY
+    double xmin = _nappe_vertices[0].x, xmax = xmin;
+    double ymin = _nappe_vertices[0].y, ymax = ymin;
+    for (size_t i = 1; i < _nappe_vertices.size(); i++)
+    {
+        xmin = std::min(xmin, static_cast<double>(_nappe_vertices[i].x));
+        xmax = std::max(xmax, static_cast<double>(_nappe_vertices[i].x));
+        ymin = std::min(ymin, static_cast<double>(_nappe_vertices[i].y));
+        ymax = std::max(ymax, static_cast<double>(_nappe_vertices[i].y));
+    }
+
+    // Environ un triangle par cellule, cellules a peu pres carrees
+    const unsigned int maxCells = 2048;
+    double width = std::max(xmax - xmin, 1.e-6);
+    double depth = std::max(ymax - ymin, 1.e-6);
+    double nx = std::ceil( std::sqrt(nbTriangles * width / depth) );
+    _grid_nx = static_cast<unsigned int>( std::min( std::max(nx, 1.), static_cast<double>(maxCells) ) );
+    double ny = std::ceil( static_cast<double>(nbTriangles) / _grid_nx );
+    _grid_ny = static_cast<unsigned int>( std::min( std::max(ny, 1.), static_cast<double>(maxCells) ) );
+    _grid_x0 = xmin;
+    _grid_y0 = ymin;
+    _grid_dx = width / _grid_nx;
+    _grid_dy = depth / _grid_ny;
+
+    // Rangement des triangles dans les cellules recouvertes par leur boite englobante
+    std::vector<unsigned int> cellRange(4 * nbTriangles);
+    _cell_start.assign(_grid_nx * _grid_ny + 1, 0);
+    for (unsigned int t = 0; t < nbTriangles; t++)
+    {
+        const vec3& a = _nappe_vertices[ _nappe_triangles[3 * t] ];
+        const vec3& b = _nappe_vertices[ _nappe_triangles[3 * t + 1] ];
+        const vec3& c = _nappe_vertices[ _nappe_triangles[3 * t + 2] ];
+        double txmin = std::min(a.x, std::min(b.x, c.x)), txmax = std::max(a.x, std::max(b.x, c.x));
+        double tymin = std::min(a.y, std::min(b.y, c.y)), tymax = std::max(a.y, std::max(b.y, c.y));
+
+        unsigned int* range = &cellRange[4 * t];
+        range[0] = std::min( static_cast<unsigned int>( std::max( (txmin - _grid_x0) / _grid_dx, 0. ) ), _grid_nx - 1 );
+        range[1] = std::min( static_cast<unsigned int>( std::max( (txmax - _grid_x0) / _grid_dx, 0. ) ), _grid_nx - 1 );
+        range[2] = std::min( static_cast<unsigned int>( std::max( (tymin - _grid_y0) / _grid_dy, 0. ) ), _grid_ny - 1 );
+        range[3] = std::min( static_cast<unsigned int>( std::max( (tymax - _grid_y0) / _grid_dy, 0. ) ), _grid_ny - 1 );
+
+        for (unsigned int j = range[2]; j <= range[3]; j++)
+            for (unsigned int i = range[0]; i <= range[1]; i++)
+            {
+                _cell_start[j * _grid_nx + i + 1]++;
+            }
+    }
+
+    for (size_t k = 1; k < _cell_start.size(); k++)
+    {
+        _cell_start[k] += _cell_start[k - 1];
+    }
+
+    _cell_triangles.resize(_cell_start.back());
+    std::vector<unsigned int> fill(_cell_start.begin(), _cell_start.end() - 1);
+    for (unsigned int t = 0; t < nbTriangles; t++)
+    {
+        const unsigned int* range = &cellRange[4 * t];
+        for (unsigned int j = range[2]; j <= range[3]; j++)
+            for (unsigned int i = range[0]; i <= range[1]; i++)
+            {
+                _cell_triangles[ fill[j * _grid_nx + i]++ ] = t;
+            }
+    }
+}
+
+bool geometry_modifier_z_correction::height_in_triangle(unsigned int t, double x, double y, double& h) const
+{
+    const vec3& a = _nappe_vertices[ _nappe_triangles[3 * t] ];
+    const vec3& b = _nappe_vertices[ _nappe_triangles[3 * t + 1] ];
+    const vec3& c = _nappe_vertices[ _nappe_triangles[3 * t + 2] ];
+
+    // Coordonnees barycentriques de (x, y) dans le triangle projete sur le plan XY
+    double det = (b.y - c.y) * (a.x - c.x) + (c.x - b.x) * (a.y - c.y);
+    if (std::fabs(det) < 1.e-12) { return false; }
+
+    double l1 = ( (b.y - c.y) * (x - c.x) + (c.x - b.x) * (y - c.y) ) / det;
+    double l2 = ( (c.y - a.y) * (x - c.x) + (a.x - c.x) * (y - c.y) ) / det;
+    double l3 = 1. - l1 - l2;
+
+    const double eps = -1.e-9;
+    if ( (l1 < eps) || (l2 < eps) || (l3 < eps) ) { return false; }
+
+    h = l1 * a.z + l2 * b.z + l3 * c.z;
+    return true;
+}
+
+double geometry_modifier_z_correction::compute_h(const vec3& P, int& hint) const
+{
+    double h = 0.;
+
+    // Le dernier triangle trouve contient souvent le point suivant
+    if ( (hint >= 0) && height_in_triangle(hint, P.x, P.y, h) ) { return h; }
+
+    if (_grid_nx > 0)
+    {
+        double u = (P.x - _grid_x0) / _grid_dx;
+        double v = (P.y - _grid_y0) / _grid_dy;
+        if ( (u >= 0.) && (v >= 0.) && (u <= _grid_nx) && (v <= _grid_ny) )
+        {
+            unsigned int i = std::min(static_cast<unsigned int>(u), _grid_nx - 1);
+            unsigned int j = std::min(static_cast<unsigned int>(v), _grid_ny - 1);
+            unsigned int cell = j * _grid_nx + i;
+            for (unsigned int k = _cell_start[cell]; k < _cell_start[cell + 1]; k++)
+            {
+                unsigned int t = _cell_triangles[k];
+                if ( height_in_triangle(t, P.x, P.y, h) )
+                {
+                    hint = static_cast<int>(t);
+                    return h;
+                }
+            }
+        }
+    }
+
+    // Hors de la nappe : lancer de rayon vertical
+    return compute_h_by_ray(P);
+}
+
+double geometry_modifier_z_correction::compute_h_by_ray(const vec3& P) const
 {
     double offset = 2000.;
     vec3 origine(P.x, P.y, (P.z + offset) );
     Ray ray1( origine, vec3(0., 0., -1.) );
 
-    std::list<Intersection> LI;
+    IntersectionBuffer LI;
     return (P.z + offset) - static_cast<double>( _scene->getAccelerator()->traverse( &ray1, LI ) );
 }
 
@@ -19,6 +19,7 @@
 #include <qlist.h>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "Tympan/models/common/3d.h"
 #include "Tympan/models/common/triangle.h"
@@ -60,6 +61,24 @@ public:
     */
     virtual vec3 fonction_h_inverse(const vec3& P) = 0;
 
+    /*!
+    * \brief Point transformation applied in place to an array of points
+    * \param points Points to transform
+    */
+    virtual void fonction_h_points(std::vector<vec3>& points)
+    {
+        for (size_t i = 0; i < points.size(); i++) { points[i] = fonction_h(points[i]); }
+    }
+
+    /*!
+    * \brief Inverse point transformation applied in place to an array of points
+    * \param points Points to transform back
+    */
+    virtual void fonction_h_inverse_points(std::vector<vec3>& points)
+    {
+        for (size_t i = 0; i < points.size(); i++) { points[i] = fonction_h_inverse(points[i]); }
+    }
+
     /// Export to a file
     virtual void save_to_file(std::string fileName) = 0;
 
@@ -84,6 +103,10 @@ public:
 
     virtual vec3 fonction_h_inverse(const vec3& P) { return P; }
 
+    virtual void fonction_h_points(std::vector<vec3>& points) {}
+
+    virtual void fonction_h_inverse_points(std::vector<vec3>& points) {}
+
     virtual void save_to_file(std::string fileName) {}
 };
 
@@ -95,7 +118,9 @@ class geometry_modifier_z_correction :
 public:
 
     /// Constructor
-    geometry_modifier_z_correction() : _scene( std::unique_ptr<Scene>( new Scene() ) ) {}
+    geometry_modifier_z_correction() : _scene( std::unique_ptr<Scene>( new Scene() ) ),
+                                       _grid_x0(0.), _grid_y0(0.), _grid_dx(1.), _grid_dy(1.),
+                                       _grid_nx(0), _grid_ny(0) {}
 
     /// Destructor
     ~geometry_modifier_z_correction() {}
@@ -106,6 +131,10 @@ public:
 
     virtual vec3 fonction_h_inverse(const vec3& P);
 
+    virtual void fonction_h_points(std::vector<vec3>& points);
+
+    virtual void fonction_h_inverse_points(std::vector<vec3>& points);
+
     virtual void clear() {}
 
     virtual void save_to_file(std::string fileName) { _scene->export_to_ply(fileName); }
@@ -115,9 +144,30 @@ public:
 
 private :
     void append_triangles_to_scene(QList<OPoint3D>& Liste_vertex, QList<OTriangle>& Liste_triangles);
-    double compute_h(const vec3& P);
+    /*!
+     * \brief Build the 2D bucket grid over the nappe triangles, used by compute_h
+     */
+    void build_height_field();
+    /*!
+     * \brief Height of the nappe above point P
+     * \param P Point
+     * \param hint Index of the last triangle found, tested first and updated (-1 if none)
+     */
+    double compute_h(const vec3& P, int& hint) const;
+    /// Height of the nappe at (x, y) inside triangle t, false if (x, y) is out of it
+    bool height_in_triangle(unsigned int t, double x, double y, double& h) const;
+    /// Height of the nappe found with a vertical ray cast (used out of the height field)
+    double compute_h_by_ray(const vec3& P) const;
 
     std::unique_ptr<Scene> _scene;      //!< Support de la structure acceleratrice pour la nappe
+
+    std::vector<vec3> _nappe_vertices;              //!< Vertices of the nappe
+    std::vector<unsigned int> _nappe_triangles;     //!< Vertex indices of the nappe triangles (3 per triangle)
+    double _grid_x0, _grid_y0;                      //!< Lower corner of the height field grid
+    double _grid_dx, _grid_dy;                      //!< Size of a grid cell
+    unsigned int _grid_nx, _grid_ny;                //!< Number of grid cells along x and y
+    std::vector<unsigned int> _cell_start;          //!< Offset of each cell in _cell_triangles (nx*ny+1 values)
+    std::vector<unsigned int> _cell_triangles;      //!< Triangles overlapping each cell
 };
 
 #endif //__GEOMETRY_MODIFIER_H
@@ -16,33 +16,6 @@
 #include "meteoLin.h"
 
 
-double meteoLin::cTemp(const vec3& P, vec3& grad) const
-{
-
-    // calcul de la celerite
-    decimal c = (decimal)(grad_C * P.z + c0);
-
-    // calcul du gradient
-    grad.z = (decimal)grad_C;
-
-    return c;
-};
-
-vec3 meteoLin::cWind(const vec3& P) const
-{
-    // calcul du vent : on a une fonction lineaire fonction de la coordonnee z du point
-    vec3 v;
-
-    const double& DVx = jacob_matrix[0][2];
-    const double& DVy = jacob_matrix[1][2];
-
-    v.x = (decimal)(DVx * P.z);
-    v.y = (decimal)(DVy * P.z);
-    v.z = 0;
-
-    return v;
-}
-
 void meteoLin::init()
 {
 
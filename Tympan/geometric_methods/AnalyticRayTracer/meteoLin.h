@@ -77,7 +77,7 @@ public:
      * \fn const double** getJacobMatrix()
      * \brief Get the jacobian matrix
      */
-    virtual const array< array<double, 3>, 3 >&  getJacobMatrix() { return jacob_matrix; }
+    virtual const array< array<double, 3>, 3 >&  getJacobMatrix() const { return jacob_matrix; }
 
     /// Initialize the Jacobian matrix
     virtual void init();
@@ -89,4 +89,32 @@ private:
     array< array<double, 3>, 3 > jacob_matrix; //!< Jacobian matrix
 };
 
+// cTemp and cWind are called several times per integration step of each curved ray: inlined
+inline double meteoLin::cTemp(const vec3& P, vec3& grad) const
+{
+
+    // calcul de la celerite
+    decimal c = (decimal)(grad_C * P.z + c0);
+
+    // calcul du gradient
+    grad.z = (decimal)grad_C;
+
+    return c;
+}
+
+inline vec3 meteoLin::cWind(const vec3& P) const
+{
+    // calcul du vent : on a une fonction lineaire fonction de la coordonnee z du point
+    vec3 v;
+
+    const double& DVx = jacob_matrix[0][2];
+    const double& DVy = jacob_matrix[1][2];
+
+    v.x = (decimal)(DVx * P.z);
+    v.y = (decimal)(DVy * P.z);
+    v.z = 0;
+
+    return v;
+}
+
 #endif //__METEO_LIN_H
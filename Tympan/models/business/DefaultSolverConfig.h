@@ -21,15 +21,18 @@ const char * DEFAULT_SOLVER_CONFIG ="[ACOUSTICRAYTRACER]\n"
 "NbRayWithDiffraction=0\n"
 "NbRaysPerSource=100000\n"
 "RayTracingOrder=0\n"
+"ReceptorAccelerator=1\n"
 "SizeReceiver=2.0\n"
 "UsePathDifValidation=False\n"
 "UsePostFilters=True\n"
 "UseSol=True\n"
 "[ANALYTICRAYTRACER]\n"
+"AnalyticAdaptiveStep=False\n"
 "AnalyticDMax=3000.0\n"
 "AnalyticH=0.1\n"
 "AnalyticNbRay=20\n"
 "AnalyticTMax=10.0\n"
+"AnalyticTolerance=0.001\n"
 "CurveRaySampler=1\n"
 "FinalAnglePhi=360.0\n"
 "FinalAngleTheta=0.0\n"
@@ -49,11 +52,13 @@ const char * DEFAULT_SOLVER_CONFIG ="[ACOUSTICRAYTRACER]\n"
 "DebugUseFermatSelector=True\n"
 "[DEFAULTSOLVER]\n"
 "AngleFavorable=45\n"
+"AttenuationCacheTolerance=0.0\n"
 "DSWindDirection=0\n"
 "H1parameter=10.0\n"
 "ModSummation=False\n"
 "NbThreads=4\n"
 "PropaConditions=0\n"
+"UseAttenuationCache=False\n"
 "UseLateralDiffraction=True\n"
 "UseRealGround=True\n"
 "UseReflection=True\n"
@@ -56,10 +56,8 @@ acoustic_event::acoustic_event(const acoustic_event& ev)
 
 acoustic_event::~acoustic_event()
 {
-    if(previous) delete previous;
-    if(next) delete next;
-    if(endEvent) delete endEvent;
-
+    // previous, next and endEvent are events of the same path: they are
+    // deleted by the path
 }
 
 acoustic_event& acoustic_event::operator=(const acoustic_event& other)
@@ -355,11 +353,10 @@ double acoustic_path::lengthCorrection(acoustic_event* ev1, const acoustic_event
 
     // Calculation with h for each event
     // Useful for lengths & angles
-    for (size_t i = 0; i < tabPoint.size(); i++)
-    {
-        OPoint3D& point = tabPoint[i];
-        point = vec3toOPoint3D( transformer->fonction_h_inverse( OPoint3Dtovec3(point) ) );
-    }
+    std::vector<vec3> points(tabPoint.size());
+    for (size_t i = 0; i < tabPoint.size(); i++) { points[i] = OPoint3Dtovec3(tabPoint[i]); }
+    transformer->fonction_h_inverse_points(points);
+    for (size_t i = 0; i < tabPoint.size(); i++) { tabPoint[i] = vec3toOPoint3D(points[i]); }
 
     for (size_t i = 0; i < tabPoint.size() - 1; i++)
     {
@@ -398,11 +395,10 @@ void acoustic_path::angleCompute(IGeometryModifier* transformer)
 
 void acoustic_path::eventPosCompute(IGeometryModifier* transformer)
 {
-    for (unsigned i = 0; i < _events.size(); i++)
-    {
-        OPoint3D& point = _events[i]->pos;
-        point = vec3toOPoint3D( transformer->fonction_h_inverse( OPoint3Dtovec3(point) ) );
-    }
+    std::vector<vec3> points(_events.size());
+    for (unsigned i = 0; i < _events.size(); i++) { points[i] = OPoint3Dtovec3(_events[i]->pos); }
+    transformer->fonction_h_inverse_points(points);
+    for (unsigned i = 0; i < _events.size(); i++) { _events[i]->pos = vec3toOPoint3D(points[i]); }
 }
 
 double acoustic_path::angleCorrection(const acoustic_event* ev1,
@@ -434,9 +430,8 @@ void acoustic_path::tyRayCorrection(IGeometryModifier* transformer)
 
     std::vector<int> listIndex = getIndexOfEvents(TYREFRACTION);
 
-    for (unsigned int i = 0 ; i < listIndex.size() ; i++)
-    {
-        OPoint3D& point = _events[ listIndex[i] ]->pos;
-        point = vec3toOPoint3D( transformer->fonction_h_inverse( OPoint3Dtovec3(point) ) );
-    }
+    std::vector<vec3> points(listIndex.size());
+    for (unsigned int i = 0 ; i < listIndex.size() ; i++) { points[i] = OPoint3Dtovec3(_events[ listIndex[i] ]->pos); }
+    transformer->fonction_h_inverse_points(points);
+    for (unsigned int i = 0 ; i < listIndex.size() ; i++) { _events[ listIndex[i] ]->pos = vec3toOPoint3D(points[i]); }
 }
@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "acoustic_path_columns.h"
+
+namespace
+{
+
+const char PATHS_MAGIC[4] = {'T', 'Y', 'R', 'P'};
+const uint32_t PATHS_VERSION = 2;
+const uint32_t PATHS_QUANTIZED = 1;
+
+template <class T> void write_array(std::ostream& stream, const T* values, size_t nb)
+{
+    stream.write(reinterpret_cast<const char*>(values), nb * sizeof(T));
+}
+
+template <class T> bool read_array(std::istream& stream, T* values, size_t nb)
+{
+    stream.read(reinterpret_cast<char*>(values), nb * sizeof(T));
+    return stream.good();
+}
+
+/// Size of an array padded to the next multiple of 8 bytes
+uint64_t padded(uint64_t size)
+{
+    return (size + 7) / 8 * 8;
+}
+
+/// Write an array followed by the padding to the next multiple of 8 bytes
+template <class T> void write_padded_array(std::ostream& stream, const T* values, size_t nb)
+{
+    const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    write_array(stream, values, nb);
+    stream.write(zeros, padded(nb * sizeof(T)) - nb * sizeof(T));
+}
+
+/// Read an array and skip the padding to the next multiple of 8 bytes
+template <class T> bool read_padded_array(std::istream& stream, T* values, size_t nb)
+{
+    if (!read_array(stream, values, nb)) { return false; }
+    stream.ignore(padded(nb * sizeof(T)) - nb * sizeof(T));
+    return stream.good();
+}
+
+} // namespace
+
+AcousticPathColumns::AcousticPathColumns()
+{
+    _offsets.push_back(0);
+}
+
+void AcousticPathColumns::append(acoustic_path& path)
+{
+    const tab_acoustic_events& events = path.getEvents();
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        _types.push_back(events[i]->type);
+        _faces.push_back(events[i]->idFace1);
+        _positions.push_back(events[i]->pos._x);
+        _positions.push_back(events[i]->pos._y);
+        _positions.push_back(events[i]->pos._z);
+    }
+    _sources.push_back(path.getSource_idx());
+    _receptors.push_back(path.getRecepteur_idx());
+    _offsets.push_back(_types.size());
+}
+
+void AcousticPathColumns::append(const tab_acoustic_path& paths)
+{
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        append(*paths[i]);
+    }
+}
+
+void AcousticPathColumns::clear()
+{
+    _offsets.assign(1, 0);
+    _sources.clear();
+    _receptors.clear();
+    _types.clear();
+    _faces.clear();
+    _positions.clear();
+}
+
+acoustic_path* AcousticPathColumns::make_path(size_t i) const
+{
+    acoustic_path* path = new acoustic_path();
+    for (uint64_t e = _offsets[i]; e < _offsets[i + 1]; e++)
+    {
+        acoustic_event* event = new acoustic_event(OPoint3D(_positions[3 * e], _positions[3 * e + 1], _positions[3 * e + 2]));
+        event->type = static_cast<ACOUSTIC_EVENT_TYPES>(_types[e]);
+        event->idFace1 = _faces[e];
+        path->addEvent(event);
+    }
+    path->setSource(_sources[i]);
+    path->setRecepteur(_receptors[i]);
+    return path;
+}
+
+bool AcousticPathColumns::write(const std::string& file_name, double quantum) const
+{
+    std::ofstream stream(file_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!write(stream, quantum)) { return false; }
+    stream.flush();
+    return stream.good();
+}
+
+bool AcousticPathColumns::write(std::ostream& stream, double quantum) const
+{
+    const uint64_t nbPaths = nb_paths();
+    const uint64_t nbEvents = nb_events();
+
+    // Quantized positions are relative to the lower corner of the events
+    double origin[3] = {0., 0., 0.};
+    std::vector<int32_t> quantized;
+    if (quantum > 0.)
+    {
+        double extent[3] = {0., 0., 0.};
+        for (int k = 0; k < 3; k++)
+        {
+            if (nbEvents == 0) { break; }
+            origin[k] = _positions[k];
+            double top = _positions[k];
+            for (size_t e = 1; e < nbEvents; e++)
+            {
+                origin[k] = std::min(origin[k], _positions[3 * e + k]);
+                top = std::max(top, _positions[3 * e + k]);
+            }
+            extent[k] = top - origin[k];
+            if (extent[k] / quantum > std::numeric_limits<int32_t>::max()) { return false; }
+        }
+
+        quantized.resize(_positions.size());
+        for (size_t i = 0; i < _positions.size(); i++)
+        {
+            quantized[i] = static_cast<int32_t>(std::floor((_positions[i] - origin[i % 3]) / quantum + 0.5));
+        }
+    }
+
+    const uint32_t header[3] = {PATHS_VERSION, quantum > 0. ? PATHS_QUANTIZED : 0, 0};
+    stream.write(PATHS_MAGIC, sizeof(PATHS_MAGIC));
+    write_array(stream, header, 3);
+    write_array(stream, &nbPaths, 1);
+    write_array(stream, &nbEvents, 1);
+    write_array(stream, origin, 3);
+    const double step = quantum > 0. ? quantum : 0.;
+    write_array(stream, &step, 1);
+
+    write_array(stream, _offsets.data(), _offsets.size());
+    write_padded_array(stream, _sources.data(), _sources.size());
+    write_padded_array(stream, _receptors.data(), _receptors.size());
+    write_padded_array(stream, _types.data(), _types.size());
+    write_padded_array(stream, _faces.data(), _faces.size());
+    if (quantum > 0.)
+    {
+        write_padded_array(stream, quantized.data(), quantized.size());
+    }
+    else
+    {
+        write_array(stream, _positions.data(), _positions.size());
+    }
+
+    return stream.good();
+}
+
+bool AcousticPathColumns::read(const std::string& file_name)
+{
+    std::ifstream stream(file_name.c_str(), std::ios::in | std::ios::binary);
+    return read(stream);
+}
+
+bool AcousticPathColumns::read(std::istream& stream)
+{
+    clear();
+
+    char magic[sizeof(PATHS_MAGIC)];
+    uint32_t header[3];
+    uint64_t nbPaths, nbEvents;
+    double origin[3], quantum;
+    stream.read(magic, sizeof(magic));
+    if ( !stream.good() || (std::memcmp(magic, PATHS_MAGIC, sizeof(magic)) != 0) ) { return false; }
+    if ( !read_array(stream, header, 3) || (header[0] != PATHS_VERSION) ) { return false; }
+    if ( !read_array(stream, &nbPaths, 1) || !read_array(stream, &nbEvents, 1) ) { return false; }
+    if ( !read_array(stream, origin, 3) || !read_array(stream, &quantum, 1) ) { return false; }
+
+    // Check the size left in the stream before allocating the columns
+    const std::streamoff start = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    const uint64_t size = static_cast<uint64_t>(stream.tellg() - start);
+    stream.seekg(start);
+    if ( (nbPaths > size / 8) || (nbEvents > size / 8) ) { return false; }
+    const uint64_t positionsSize = (header[1] & PATHS_QUANTIZED) ? padded(12 * nbEvents) : 24 * nbEvents;
+    if (size < 8 * (nbPaths + 1) + 2 * padded(4 * nbPaths) + 2 * padded(4 * nbEvents) + positionsSize)
+    {
+        return false;
+    }
+
+    _offsets.resize(nbPaths + 1);
+    _sources.resize(nbPaths);
+    _receptors.resize(nbPaths);
+    _types.resize(nbEvents);
+    _faces.resize(nbEvents);
+    _positions.resize(3 * nbEvents);
+    bool ok = read_array(stream, _offsets.data(), _offsets.size()) &&
+              read_padded_array(stream, _sources.data(), _sources.size()) &&
+              read_padded_array(stream, _receptors.data(), _receptors.size()) &&
+              read_padded_array(stream, _types.data(), _types.size()) &&
+              read_padded_array(stream, _faces.data(), _faces.size());
+    if (ok && (header[1] & PATHS_QUANTIZED))
+    {
+        std::vector<int32_t> quantized(_positions.size());
+        ok = read_padded_array(stream, quantized.data(), quantized.size());
+        for (size_t i = 0; ok && (i < quantized.size()); i++)
+        {
+            _positions[i] = origin[i % 3] + quantum * quantized[i];
+        }
+    }
+    else if (ok)
+    {
+        ok = read_array(stream, _positions.data(), _positions.size());
+    }
+
+    // The offsets must describe the events arrays
+    ok = ok && (_offsets[0] == 0) && (_offsets[nbPaths] == nbEvents);
+    for (size_t i = 0; ok && (i < nbPaths); i++)
+    {
+        ok = _offsets[i] <= _offsets[i + 1];
+    }
+
+    if (!ok) { clear(); }
+    return ok;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef TY_MC_ACOUSTIC_PATH_COLUMNS
+#define TY_MC_ACOUSTIC_PATH_COLUMNS
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+
+#include "Tympan/models/common/acoustic_path.h"
+
+/*!
+* \class AcousticPathColumns
+* \brief Compact columnar storage of acoustic paths
+*
+* The events of all the paths are stored in contiguous arrays (type, face,
+* position), the events of the path i being in [offsets[i], offsets[i+1]).
+* An acoustic_path costs one heap allocation per event: the columns are used
+* to keep or export a large number of rays (for visual QA for example).
+*
+* File format (little endian, each array padded with zeros to a multiple of
+* 8 bytes so that every array starts on 8 bytes):
+* - header (64 bytes): magic "TYRP", uint32 version, uint32 flags (1 if the
+*   positions are quantized), uint32 (unused), uint64 number of paths,
+*   uint64 number of events, 3 doubles origin, double quantum;
+* - uint64 offsets[nb_paths + 1];
+* - uint32 sources[nb_paths], uint32 receptors[nb_paths];
+* - int32 types[nb_events], int32 faces[nb_events];
+* - positions[nb_events][3]: doubles, or int32 when quantized
+*   (position = origin + quantum * value).
+* The arrays can be memory mapped with tympan.models.rays.RaysFile. The same
+* block is embedded in the files written by tympan::BinaryResultSink.
+*/
+class AcousticPathColumns
+{
+public:
+    /// Default constructor
+    AcousticPathColumns();
+
+    /// Append a path (it is not modified nor deleted)
+    void append(acoustic_path& path);
+
+    /// Append a list of paths
+    void append(const tab_acoustic_path& paths);
+
+    /// Remove all the paths
+    void clear();
+
+    size_t nb_paths() const { return _sources.size(); } //!< Number of paths
+    size_t nb_events() const { return _types.size(); }  //!< Number of events of all the paths
+
+    /// Build the path i (the caller owns it)
+    acoustic_path* make_path(size_t i) const;
+
+    const std::vector<uint64_t>& offsets() const { return _offsets; }   //!< First event of each path (and end)
+    const std::vector<uint32_t>& sources() const { return _sources; }   //!< Source index of each path
+    const std::vector<uint32_t>& receptors() const { return _receptors; } //!< Receptor index of each path
+    const std::vector<int32_t>& types() const { return _types; }        //!< Type of each event
+    const std::vector<int32_t>& faces() const { return _faces; }        //!< Face of each event (idFace1)
+    const std::vector<double>& positions() const { return _positions; } //!< x, y, z of each event
+
+    /*!
+    * \fn bool write(const std::string& file_name, double quantum = 0.) const
+    * \brief Write the columns to a file
+    * \param quantum Step of the quantized positions (not quantized if 0)
+    * \return false if the file can not be written or if the extent of the
+    *         positions is too large for the quantum
+    */
+    bool write(const std::string& file_name, double quantum = 0.) const;
+
+    /// Write the columns (same block as in a file) at the position of a stream
+    bool write(std::ostream& stream, double quantum = 0.) const;
+
+    /// Replace the columns by the content of a file (false on error)
+    bool read(const std::string& file_name);
+
+    /// Replace the columns by the block at the position of a stream (false on error)
+    bool read(std::istream& stream);
+
+private:
+    std::vector<uint64_t> _offsets;
+    std::vector<uint32_t> _sources;
+    std::vector<uint32_t> _receptors;
+    std::vector<int32_t> _types;
+    std::vector<int32_t> _faces;
+    std::vector<double> _positions;
+};
+
+#endif // TY_MC_ACOUSTIC_PATH_COLUMNS
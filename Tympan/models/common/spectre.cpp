@@ -18,6 +18,7 @@
 #include <algorithm>
 
 #include "Tympan/models/common/mathlib.h"
+#include "Tympan/models/common/spectrum_kernels.h"
 #include "spectre.h"
 
 
@@ -138,10 +139,7 @@ OSpectre OSpectre::operator * (const OSpectre& spectre) const
 {
     OSpectre s;
     s._etat = _etat; s._type = _type; // Recopie de l'empreinte du spectre
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] * spectre._module[i];
-    }
+    tympan::spectrum_mul(_module, spectre._module, s._module);
     return s;
 }
 
@@ -149,10 +147,7 @@ OSpectre OSpectre::operator * (const double& coefficient) const
 {
     OSpectre s;
     s._etat = _etat; s._type = _type; // Recopie de l'empreinte du spectre
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] * coefficient;
-    }
+    tympan::spectrum_mul(_module, coefficient, s._module);
     return s;
 }
 
@@ -160,10 +155,7 @@ OSpectre OSpectre::operator + (const double& valeur) const
 {
     OSpectre s;
     s._etat = _etat; s._type = _type; // Recopie de l'empreinte du spectre
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] + valeur;
-    }
+    tympan::spectrum_add(_module, valeur, s._module);
     return s;
 }
 
@@ -171,10 +163,7 @@ OSpectre OSpectre::operator + (const OSpectre& spectre) const
 {
     OSpectre s;
     s._etat = _etat; s._type = _type; // Recopie de l'empreinte du spectre
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] + spectre._module[i];
-    }
+    tympan::spectrum_add(_module, spectre._module, s._module);
     return s;
 }
 
@@ -182,10 +171,7 @@ OSpectre OSpectre::operator - (const OSpectre& spectre) const
 {
     OSpectre s;
     s._etat = _etat; s._type = _type; // Recopie de l'empreinte du spectre
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] - spectre._module[i];
-    }
+    tympan::spectrum_sub(_module, spectre._module, s._module);
     return s;
 }
 
@@ -244,7 +230,6 @@ OSpectre OSpectre::toDB() const
         s = *this;
         return s;
     }
-    unsigned int i;
     s._type = _type; // Recopie du type
     double coef = 1.0;
     switch (_type)
@@ -260,18 +245,8 @@ OSpectre OSpectre::toDB() const
             coef = 1.0;
             break;
     }
-    double dBVal = 0.0;
-    for (i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-		// avoid -infinite result
-		double val = _module[i];
-		if(val < EPSILON_15){
-			val = EPSILON_15;
-		}
-
-        dBVal = 10.0 * log10( (val) / coef );
-        s._module[i] = dBVal    ;
-    }
+    // avoid -infinite result: values floored to EPSILON_15
+    tympan::spectrum_to_dB(_module, coef, EPSILON_15, s._module);
     s._etat = SPECTRE_ETAT_DB;   // Etat explicite dB
     return s;
 }
@@ -285,7 +260,6 @@ OSpectre OSpectre::toGPhy() const
 
         return s;
     }
-    unsigned int i;
     double coef = 1.0;
     s._type = _type; // Recopie du type
     switch (_type)
@@ -301,12 +275,7 @@ OSpectre OSpectre::toGPhy() const
             coef = 1.0;
             break;
     }
-    double powVal = 0.0;
-    for (i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        powVal = pow(10.0, this->_module[i] / 10.0) * coef;
-        s._module[i] = powVal;
-    }
+    tympan::spectrum_to_linear(_module, coef, s._module);
     s._etat = SPECTRE_ETAT_LIN;   // Etat explicite Grandeur physique
     return s;
 }
@@ -316,10 +285,7 @@ OSpectre OSpectre::sum(const OSpectre& spectre) const
     OSpectre s;
     s._etat = _etat; s._type = _type; // Recopie de l'empreinte du spectre
 
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] + spectre._module[i];
-    }
+    tympan::spectrum_add(_module, spectre._module, s._module);
     return s;
 }
 
@@ -338,10 +304,7 @@ OSpectre OSpectre::sum(const double& valeur) const
     OSpectre s;
     // Recopie de l'empreinte du spectre
     s._etat = _etat; s._type = _type;
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] + valeur;
-    }
+    tympan::spectrum_add(_module, valeur, s._module);
     return s;
 }
 
@@ -361,10 +324,7 @@ OSpectre OSpectre::subst(const OSpectre& spectre) const
     OSpectre s;
     // Recopie de l'empreinte du spectre
     s._etat = _etat; s._type = _type;
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] - spectre._module[i];
-    }
+    tympan::spectrum_sub(_module, spectre._module, s._module);
     return s;
 }
 
@@ -373,10 +333,7 @@ OSpectre OSpectre::subst(const double& valeur) const
     OSpectre s;
     // Recopie de l'empreinte du spectre
     s._etat = _etat; s._type = _type;
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] - valeur;
-    }
+    tympan::spectrum_add(_module, -valeur, s._module);
     return s;
 }
 
@@ -385,10 +342,7 @@ OSpectre OSpectre::mult(const OSpectre& spectre) const
     OSpectre s;
     // Recopie de l'empreinte du spectre
     s._etat = _etat; s._type = _type;
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] * spectre._module[i];
-    }
+    tympan::spectrum_mul(_module, spectre._module, s._module);
     return s;
 }
 
@@ -397,10 +351,7 @@ OSpectre OSpectre::mult(const double& coefficient) const
     OSpectre s;
     // Recopie de l'empreinte du spectre
     s._etat = _etat; s._type = _type;
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = this->_module[i] * coefficient;
-    }
+    tympan::spectrum_mul(_module, coefficient, s._module);
     return s;
 }
 
@@ -500,17 +451,9 @@ OSpectre OSpectre::log(const double& base) const
     OSpectre s;
     // Recopie de l'empreinte du spectre
     s._etat = _etat; s._type = _type;
-    double logBase = ::log(base);
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    if (!tympan::spectrum_log(_module, base, s._module))
     {
-        if (_module[i] <= 0.0)
-        {
-            s._module[i] = 1E20;
-            s._valid = false ;
-            break;
-        }
-
-        s._module[i] = ::log(_module[i]) / logBase;
+        s._valid = false ;
     }
     return s;
 }
@@ -539,10 +482,7 @@ OSpectre OSpectre::exp(const double coef)
     OSpectre s;
     // Recopie de l'empreinte du spectre
     s._etat = _etat; s._type = _type;
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = ::exp(coef * _module[i]);
-    }
+    tympan::spectrum_exp(_module, coef, s._module);
     return s;
 }
 
@@ -1039,11 +979,7 @@ OSpectreComplex OSpectreComplex::operator * (const OSpectreComplex& spectre) con
     // Recopie de l'empreinte du spectre
     s._etat = _etat;
     s._type = _type;
-    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
-    {
-        s._module[i] = _module[i] * spectre._module[i];
-        s._phase[i] = _phase[i] + spectre._phase[i];
-    }
+    tympan::spectrum_complex_mul(_module, _phase, spectre._module, spectre._phase, s._module, s._phase);
     return s;
 }
 
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef TY_MC_SPECTRUM_KERNELS
+#define TY_MC_SPECTRUM_KERNELS
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "Tympan/models/common/spectre.h"
+
+/**
+ * \file spectrum_kernels.h
+ * \brief Kernels working on the TY_SPECTRE_DEFAULT_NB_ELMT band values of a spectrum.
+ *
+ * The kernels read and write plain arrays of band values (OSpectre::getTabValReel(),
+ * OSpectreComplex::getTabValImag() or tympan::SpectrumValues) and do not care
+ * about the type, state or validity of the spectra. Add, subtract, multiply,
+ * divide, square root and clamp kernels use AVX2 when the code is compiled for
+ * it (TYMPAN_USE_AVX2), the results being the same as with the scalar loops
+ * (no fused multiply-add, IEEE division and square root).
+ */
+
+namespace tympan
+{
+
+/// Number of band values handled by the vectorized part of the kernels
+static const unsigned int SPECTRUM_SIMD_NB_ELMT = TY_SPECTRE_DEFAULT_NB_ELMT & ~3u;
+
+/**
+ * \brief Fixed-size, aligned band values of a spectrum.
+ *
+ * Plain value type (no virtual functions, no type, state or validity fields)
+ * used as an accumulator in the solvers' inner loops.
+ */
+struct alignas(32) SpectrumValues
+{
+    double v[TY_SPECTRE_DEFAULT_NB_ELMT];
+
+    /// Values are not initialized
+    SpectrumValues() {}
+    /// All the values set to value
+    explicit SpectrumValues(double value)
+    {
+        for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { v[i] = value; }
+    }
+    /// Copy of the (module) values of a spectrum
+    explicit SpectrumValues(const OSpectre& spectrum)
+    {
+        const double* values = spectrum.getTabValReel();
+        for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { v[i] = values[i]; }
+    }
+
+    /// Copy the values into the (module) values of a spectrum
+    void store(OSpectre& spectrum) const
+    {
+        double* values = spectrum.getTabValReel();
+        for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { values[i] = v[i]; }
+    }
+
+    double* data() { return v; }
+    const double* data() const { return v; }
+    double& operator[](unsigned int i) { return v[i]; }
+    double operator[](unsigned int i) const { return v[i]; }
+};
+
+/// out = a + b
+inline void spectrum_add(const double* a, const double* b, double* out)
+{
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    for (; i < SPECTRUM_SIMD_NB_ELMT; i += 4)
+    {
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+#endif
+    for (; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { out[i] = a[i] + b[i]; }
+}
+
+/// out = a + value
+inline void spectrum_add(const double* a, double value, double* out)
+{
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    const __m256d vvalue = _mm256_set1_pd(value);
+    for (; i < SPECTRUM_SIMD_NB_ELMT; i += 4)
+    {
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), vvalue));
+    }
+#endif
+    for (; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { out[i] = a[i] + value; }
+}
+
+/// out = a - b
+inline void spectrum_sub(const double* a, const double* b, double* out)
+{
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    for (; i < SPECTRUM_SIMD_NB_ELMT; i += 4)
+    {
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+#endif
+    for (; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { out[i] = a[i] - b[i]; }
+}
+
+/// out = a * b
+inline void spectrum_mul(const double* a, const double* b, double* out)
+{
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    for (; i < SPECTRUM_SIMD_NB_ELMT; i += 4)
+    {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+#endif
+    for (; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { out[i] = a[i] * b[i]; }
+}
+
+/// out = a * coef
+inline void spectrum_mul(const double* a, double coef, double* out)
+{
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    const __m256d vcoef = _mm256_set1_pd(coef);
+    for (; i < SPECTRUM_SIMD_NB_ELMT; i += 4)
+    {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), vcoef));
+    }
+#endif
+    for (; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { out[i] = a[i] * coef; }
+}
+
+/// acc = acc + a * b
+inline void spectrum_add_product(double* acc, const double* a, const double* b)
+{
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    for (; i < SPECTRUM_SIMD_NB_ELMT; i += 4)
+    {
+        __m256d prod = _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        _mm256_storeu_pd(acc + i, _mm256_add_pd(_mm256_loadu_pd(acc + i), prod));
+    }
+#endif
+    for (; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { acc[i] = acc[i] + a[i] * b[i]; }
+}
+
+/// out = a / b (b values must not be zero)
+inline void spectrum_div(const double* a, const double* b, double* out)
+{
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    for (; i < SPECTRUM_SIMD_NB_ELMT; i += 4)
+    {
+        _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+#endif
+    for (; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { out[i] = a[i] / b[i]; }
+}
+
+/// out = sqrt(a) (a values must not be negative)
+inline void spectrum_sqrt(const double* a, double* out)
+{
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    for (; i < SPECTRUM_SIMD_NB_ELMT; i += 4)
+    {
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(a + i)));
+    }
+#endif
+    for (; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { out[i] = std::sqrt(a[i]); }
+}
+
+/// out = min(max(a, low), high), with a per band upper bound
+inline void spectrum_clamp(const double* a, double low, const double* high, double* out)
+{
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    const __m256d vlow = _mm256_set1_pd(low);
+    for (; i < SPECTRUM_SIMD_NB_ELMT; i += 4)
+    {
+        __m256d val = _mm256_max_pd(_mm256_loadu_pd(a + i), vlow);
+        _mm256_storeu_pd(out + i, _mm256_min_pd(val, _mm256_loadu_pd(high + i)));
+    }
+#endif
+    for (; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        const double val = a[i] < low ? low : a[i];
+        out[i] = val > high[i] ? high[i] : val;
+    }
+}
+
+/// Product of two module/phase complex spectra: modules multiplied, phases added
+inline void spectrum_complex_mul(const double* mod_a, const double* phase_a,
+                                 const double* mod_b, const double* phase_b,
+                                 double* mod_out, double* phase_out)
+{
+    spectrum_mul(mod_a, mod_b, mod_out);
+    spectrum_add(phase_a, phase_b, phase_out);
+}
+
+/// Add (module * coef) exp(j phase) to the complex spectrum (re, im) stored in cartesian form
+inline void spectrum_add_polar(double* re, double* im, const double* mod, const double* phase,
+                               const double* coef)
+{
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        const double m = mod[i] * coef[i];
+        re[i] += m * std::cos(phase[i]);
+        im[i] += m * std::sin(phase[i]);
+    }
+}
+
+/// out = re * re + im * im (square of the module of a cartesian complex spectrum)
+inline void spectrum_norm2(const double* re, const double* im, double* out)
+{
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        out[i] = re[i] * re[i] + im[i] * im[i];
+    }
+}
+
+/// out = exp(coef * a), e.g. the coherence factor exp(-cst * L * L * K2) with coef = -cst * L * L
+inline void spectrum_exp(const double* a, double coef, double* out)
+{
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { out[i] = std::exp(coef * a[i]); }
+}
+
+/// out = log(a) / log(base), false if a value is not strictly positive (computation stopped)
+inline bool spectrum_log(const double* a, double base, double* out)
+{
+    const double logBase = std::log(base);
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        if (a[i] <= 0.0) { out[i] = 1E20; return false; }
+        out[i] = std::log(a[i]) / logBase;
+    }
+    return true;
+}
+
+/// out = 10 log10(max(a, floor) / ref) (linear values to dB)
+inline void spectrum_to_dB(const double* a, double ref, double floor, double* out)
+{
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        const double val = a[i] < floor ? floor : a[i];
+        out[i] = 10.0 * std::log10(val / ref);
+    }
+}
+
+/// out = 10^(a / 10) * ref (dB to linear values)
+inline void spectrum_to_linear(const double* a, double ref, double* out)
+{
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        out[i] = std::pow(10.0, a[i] / 10.0) * ref;
+    }
+}
+
+} // namespace tympan
+
+#endif // TY_MC_SPECTRUM_KERNELS
@@ -1,85 +1,159 @@
 
+#include <algorithm>
+#include <cassert>
+
 #include "Tympan/models/common/spectrum_matrix.h"
 
 namespace tympan
 {
     SpectrumMatrix::SpectrumMatrix(size_t nb_receptors,size_t nb_sources)
-        : _nb_sources(nb_sources)
+        : _nb_receptors(0), _nb_sources(0)
     {
         resize(nb_receptors, nb_sources);
     }
 
-    SpectrumMatrix::SpectrumMatrix() : _nb_sources(0) {}
+    SpectrumMatrix::SpectrumMatrix() : _nb_receptors(0), _nb_sources(0) {}
 
     SpectrumMatrix::SpectrumMatrix(const SpectrumMatrix& matrix)
+        : data(matrix.data),
+          _nb_receptors(matrix._nb_receptors),
+          _nb_sources(matrix._nb_sources)
     {
-        // Build matrix
-        resize(matrix.data.size(), matrix._nb_sources);
-        // number of sources
-        _nb_sources = matrix._nb_sources;
-        // Copy spectra
-        for (size_t i = 0; i < data.size(); i++)
-        {
-            for(size_t j = 0; j < _nb_sources; j++)
-            {
-                data[i][j] = matrix.data[i][j];
-            }
-        }
     }
 
-     void SpectrumMatrix::resize(size_t nb_receptors, size_t nb_sources)
-     {
-        _nb_sources = nb_sources;
-
-        if(data.size() > 0){
-            data.clear();
-        }
-
-        data.reserve(nb_receptors);
-
+    Spectrum SpectrumMatrix::null_spectrum()
+    {
         Spectrum nullSpectrum(0);
         nullSpectrum.setType(SPECTRE_TYPE_LP);
         nullSpectrum.setEtat(SPECTRE_ETAT_LIN);
+        return nullSpectrum;
+    }
 
-        for (size_t i = 0; i < nb_receptors; i++)
-        {
-            data.push_back(std::vector<Spectrum>(nb_sources, nullSpectrum));
-        }
+     void SpectrumMatrix::resize(size_t nb_receptors, size_t nb_sources)
+     {
+        _nb_receptors = nb_receptors;
+        _nb_sources = nb_sources;
+
+        // A single allocation for the whole matrix
+        data.assign(nb_receptors * nb_sources, null_spectrum());
 
-        assert(data.size()==nb_receptors);
+        assert(data.size() == nb_receptors * nb_sources);
      }
 
     const Spectrum& SpectrumMatrix::operator()(size_t receptor_idx, size_t sources_idx) const
     {
         assert(receptor_idx < nb_receptors());
         assert(sources_idx < nb_sources());
-        return data[receptor_idx][sources_idx];
+        return data[receptor_idx * _nb_sources + sources_idx];
     }
 
     Spectrum& SpectrumMatrix::operator()(size_t receptor_idx, size_t sources_idx)
     {
         assert(receptor_idx < nb_receptors());
         assert(sources_idx < nb_sources());
-        return data[receptor_idx][sources_idx];
+        return data[receptor_idx * _nb_sources + sources_idx];
     }
 
     void SpectrumMatrix::setSpectre(size_t receptor_idx, size_t sources_idx, Spectrum spectrum)
+    {
+        (*this)(receptor_idx, sources_idx) = spectrum;
+    }
+
+    const Spectrum* SpectrumMatrix::receptor_row(size_t receptor_idx) const
     {
         assert(receptor_idx < nb_receptors());
-        assert(sources_idx < nb_sources());
-        data[receptor_idx][sources_idx] = spectrum;
+        return data.empty() ? NULL : &data[receptor_idx * _nb_sources];
     }
 
-    const std::vector<Spectrum>& SpectrumMatrix::by_receptor(size_t receptor_idx) const
+    Spectrum* SpectrumMatrix::receptor_row(size_t receptor_idx)
     {
         assert(receptor_idx < nb_receptors());
-        return data[receptor_idx];
+        return data.empty() ? NULL : &data[receptor_idx * _nb_sources];
+    }
+
+    std::vector<Spectrum> SpectrumMatrix::by_receptor(size_t receptor_idx) const
+    {
+        const Spectrum* row = receptor_row(receptor_idx);
+        return std::vector<Spectrum>(row, row + _nb_sources);
+    }
+
+    std::vector<Spectrum> SpectrumMatrix::by_source(size_t sources_idx) const
+    {
+        assert(sources_idx < nb_sources());
+        std::vector<Spectrum> column;
+        column.reserve(_nb_receptors);
+        for (size_t i = 0; i < _nb_receptors; i++)
+        {
+            column.push_back(data[i * _nb_sources + sources_idx]);
+        }
+        return column;
+    }
+
+    std::vector<double> SpectrumMatrix::by_band(size_t band_idx) const
+    {
+        assert(band_idx < TY_SPECTRE_DEFAULT_NB_ELMT);
+        std::vector<double> band(data.size());
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            band[i] = data[i].getTabValReel()[band_idx];
+        }
+        return band;
+    }
+
+    Spectrum SpectrumMatrix::sum_sources(size_t receptor_idx) const
+    {
+        // Energetic sum: the spectra are expected to be in linear state
+        Spectrum cumul = null_spectrum();
+        double* cumul_values = cumul.getTabValReel();
+        const Spectrum* row = receptor_row(receptor_idx);
+        for (size_t j = 0; j < _nb_sources; j++)
+        {
+            const double* values = row[j].getTabValReel();
+            for (unsigned int k = 0; k < TY_SPECTRE_DEFAULT_NB_ELMT; k++)
+            {
+                cumul_values[k] += values[k];
+            }
+        }
+        return cumul;
+    }
+
+    std::vector<Spectrum> SpectrumMatrix::sum_sources() const
+    {
+        std::vector<Spectrum> sums;
+        sums.reserve(_nb_receptors);
+        for (size_t i = 0; i < _nb_receptors; i++)
+        {
+            sums.push_back(sum_sources(i));
+        }
+        return sums;
+    }
+
+    void SpectrumMatrix::to_dB()
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            if (data[i].getEtat() != SPECTRE_ETAT_DB)
+            {
+                data[i] = data[i].toDB();
+            }
+        }
+    }
+
+    void SpectrumMatrix::to_linear()
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            if (data[i].getEtat() != SPECTRE_ETAT_LIN)
+            {
+                data[i] = data[i].toGPhy();
+            }
+        }
     }
 
     void SpectrumMatrix::clearReceptor(size_t receptor_idx)
     {
-        assert(receptor_idx < nb_receptors());
-        data[receptor_idx].clear();
+        Spectrum* row = receptor_row(receptor_idx);
+        std::fill(row, row + _nb_sources, null_spectrum());
     }
 }
 
@@ -14,12 +14,16 @@ typedef OSpectre Spectrum;
  * \brief Spectrum matrix N*M used to store results.
  * N is the number of receptors.
  * M is the number of sources.
+ *
+ * The spectra are stored in a single contiguous buffer, receptor by receptor
+ * (row-major order): the spectra of a receptor are adjacent in memory and the
+ * values of a frequency band are found at a constant stride.
  */
 class SpectrumMatrix
 {
 public:
 
-    typedef std::vector<std::vector<Spectrum> > impl_matrix_t;
+    typedef std::vector<Spectrum> impl_matrix_t;
 
     /// Default constructor
     SpectrumMatrix();
@@ -33,7 +37,7 @@ public:
     /// Number of columns (sources) of the matrix
     size_t nb_sources()   const { return _nb_sources; };
     /// Number of rows (receptors) of the matrix
-    size_t nb_receptors() const { return data.size(); };
+    size_t nb_receptors() const { return _nb_receptors; };
 
     /// operator()
     const Spectrum& operator()(size_t receptor_idx, size_t sources_idx) const;
@@ -41,22 +45,44 @@ public:
     /// Set a Spectrum into the matrix
     void setSpectre(size_t receptor_idx, size_t sources_idx, Spectrum spectrum);
 
-    /// Return a vector of Spectrum for a receptor
-    const std::vector<Spectrum>& by_receptor(size_t receptor_idx) const;
+    /// Return the nb_sources() contiguous spectra of a receptor
+    const Spectrum* receptor_row(size_t receptor_idx) const;
+    Spectrum* receptor_row(size_t receptor_idx);
 
-    /// Clear the matrix for the a given receptor
+    /// Return a vector of Spectrum for a receptor
+    std::vector<Spectrum> by_receptor(size_t receptor_idx) const;
+    /// Return a vector of Spectrum for a source (one per receptor)
+    std::vector<Spectrum> by_source(size_t sources_idx) const;
+    /// Return the values of a frequency band, receptor by receptor (N*M values)
+    std::vector<double> by_band(size_t band_idx) const;
+
+    /// Sum the spectra of all the sources for a receptor
+    Spectrum sum_sources(size_t receptor_idx) const;
+    /// Sum the spectra of all the sources, for each receptor
+    std::vector<Spectrum> sum_sources() const;
+
+    /// Convert all the spectra of the matrix to dB
+    void to_dB();
+    /// Convert all the spectra of the matrix to physical (linear) values
+    void to_linear();
+
+    /// Reset the spectra of a given receptor to null spectra
     void clearReceptor(size_t receptor_idx);
 
     /// Clear the matrix
-    void clear() {data.clear(); };
+    void clear() { data.clear(); _nb_receptors = 0; _nb_sources = 0; };
 
     /// Resize the matrix (data is cleared)
     void resize(size_t nb_receptors, size_t nb_sources);
 
 protected:
-    impl_matrix_t data;	//!< Matrix
+    /// Spectrum used to fill the matrix (LP type, linear state, zero values)
+    static Spectrum null_spectrum();
+
+    impl_matrix_t data;	//!< Matrix (row-major order)
 
 private:
+    size_t _nb_receptors;
     size_t _nb_sources;
 
 }; // class SpectrumMatrix
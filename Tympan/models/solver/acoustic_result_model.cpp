@@ -6,16 +6,255 @@
 * \author Laura Médioni <laura.medioni@logilab.fr>
 */
 
+#include <cstdint>
+#include <cstring>
+
 #include "acoustic_result_model.hpp"
 
 
 namespace tympan
 {
 
+    /// Magic number and version of the files written by BinaryResultSink
+    static const char BINARY_RESULTS_MAGIC[4] = {'T', 'Y', 'R', 'S'};
+    static const uint32_t BINARY_RESULTS_VERSION = 2;
+
+    /// Kinds of records of the files written by BinaryResultSink
+    enum BinaryResultRecord
+    {
+        RECORD_END = 0,
+        RECORD_SPECTRUM = 1,
+        RECORD_PATHS = 2
+    };
+
+    template <class T> static void write_value(std::ostream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T> static bool read_value(std::istream& stream, T& value)
+    {
+        stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return stream.good();
+    }
+
+    BinaryResultSink::BinaryResultSink(const string& file_name, bool keep_paths_) :
+        stream(file_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc),
+        keep_paths(keep_paths_),
+        written_spectra(0),
+        written_paths(0)
+    {
+    }
+
+    BinaryResultSink::~BinaryResultSink()
+    {
+    }
+
+    void BinaryResultSink::begin(size_t nb_receptors, size_t nb_sources)
+    {
+        stream.write(BINARY_RESULTS_MAGIC, sizeof(BINARY_RESULTS_MAGIC));
+        write_value(stream, BINARY_RESULTS_VERSION);
+        write_value(stream, static_cast<uint64_t>(nb_receptors));
+        write_value(stream, static_cast<uint64_t>(nb_sources));
+        write_value(stream, static_cast<uint32_t>(TY_SPECTRE_DEFAULT_NB_ELMT));
+    }
+
+    void BinaryResultSink::push_spectrum(receptor_idx receptor, source_idx source, const Spectrum& spectrum)
+    {
+        write_value(stream, static_cast<uint8_t>(RECORD_SPECTRUM));
+        write_value(stream, static_cast<uint64_t>(receptor));
+        write_value(stream, static_cast<uint64_t>(source));
+        write_value(stream, static_cast<int32_t>(spectrum.getEtat()));
+        write_value(stream, static_cast<int32_t>(spectrum.getType()));
+        stream.write(reinterpret_cast<const char*>(spectrum.getTabValReel()),
+                     TY_SPECTRE_DEFAULT_NB_ELMT * sizeof(double));
+        written_spectra++;
+    }
+
+    void BinaryResultSink::push_path(acoustic_path* path)
+    {
+        if (keep_paths)
+        {
+            paths.append(*path);
+            written_paths++;
+            if (paths.nb_paths() >= PATHS_PER_RECORD) { write_paths(); }
+        }
+        delete path;
+    }
+
+    void BinaryResultSink::write_paths()
+    {
+        if (paths.nb_paths() == 0) { return; }
+        write_value(stream, static_cast<uint8_t>(RECORD_PATHS));
+        paths.write(stream);
+        paths.clear();
+    }
+
+    void BinaryResultSink::end()
+    {
+        write_paths();
+        write_value(stream, static_cast<uint8_t>(RECORD_END));
+        stream.flush();
+    }
+
+    bool read_binary_results(const string& file_name, SpectrumMatrix& matrix, tab_acoustic_path* paths)
+    {
+        std::ifstream stream(file_name.c_str(), std::ios::in | std::ios::binary);
+
+        char magic[sizeof(BINARY_RESULTS_MAGIC)];
+        uint32_t version, nb_bands;
+        uint64_t nb_receptors, nb_sources;
+        stream.read(magic, sizeof(magic));
+        if ( !stream.good() || (std::memcmp(magic, BINARY_RESULTS_MAGIC, sizeof(magic)) != 0) ) { return false; }
+        if ( !read_value(stream, version) || (version != BINARY_RESULTS_VERSION) ) { return false; }
+        if ( !read_value(stream, nb_receptors) || !read_value(stream, nb_sources) ) { return false; }
+        if ( !read_value(stream, nb_bands) || (nb_bands != TY_SPECTRE_DEFAULT_NB_ELMT) ) { return false; }
+
+        matrix.resize(nb_receptors, nb_sources);
+
+        uint8_t kind;
+        while (read_value(stream, kind))
+        {
+            if (kind == RECORD_END) { return true; }
+
+            if (kind == RECORD_SPECTRUM)
+            {
+                uint64_t first, second;
+                int32_t etat, type;
+                if ( !read_value(stream, first) || !read_value(stream, second) ) { return false; }
+                if ( !read_value(stream, etat) || !read_value(stream, type) ) { return false; }
+                if ( (first >= nb_receptors) || (second >= nb_sources) ) { return false; }
+
+                Spectrum& spectrum = matrix(first, second);
+                stream.read(reinterpret_cast<char*>(spectrum.getTabValReel()), nb_bands * sizeof(double));
+                spectrum.setEtat(static_cast<TYSpectreEtat>(etat));
+                spectrum.setType(static_cast<TYSpectreType>(type));
+                if (!stream.good()) { return false; }
+            }
+            else if (kind == RECORD_PATHS)
+            {
+                AcousticPathColumns columns;
+                if (!columns.read(stream)) { return false; }
+
+                for (size_t i = 0; paths && (i < columns.nb_paths()); i++)
+                {
+                    paths->push_back(columns.make_path(i));
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return false; // No end record
+    }
+
     AcousticResultModel::~AcousticResultModel()
     {
     };
 
+    void AcousticResultModel::begin(size_t nb_receptors, size_t nb_sources, size_t nb_slots)
+    {
+        path_slots.clear();
+        if (!sink) { path_slots.resize(nb_slots); }
+
+        if (sink)
+        {
+            acoustic_data.resize(0, 0);
+            sink->begin(nb_receptors, nb_sources);
+        }
+        else
+        {
+            acoustic_data.resize(nb_receptors, nb_sources);
+        }
+    }
+
+    void AcousticResultModel::push_spectrum(receptor_idx receptor, source_idx source, const Spectrum& spectrum)
+    {
+        if (sink)
+        {
+            std::lock_guard<std::mutex> lock(sink_mutex);
+            sink->push_spectrum(receptor, source, spectrum);
+        }
+        else
+        {
+            // Each couple is pushed once: no concurrent access to a cell
+            acoustic_data(receptor, source) = spectrum;
+        }
+    }
+
+    void AcousticResultModel::push_path(acoustic_path* path)
+    {
+        std::lock_guard<std::mutex> lock(sink_mutex);
+        if (sink)
+        {
+            sink->push_path(path);
+        }
+        else
+        {
+            path_data.push_back(path);
+        }
+    }
+
+    void AcousticResultModel::push_paths(size_t slot, std::vector<acoustic_path*>& paths)
+    {
+        if (sink)
+        {
+            std::lock_guard<std::mutex> lock(sink_mutex);
+            for (size_t i = 0; i < paths.size(); i++)
+            {
+                sink->push_path(paths[i]);
+            }
+        }
+        else if (slot < path_slots.size())
+        {
+            // Each slot is written by a single producer: no concurrent access
+            tab_acoustic_path& dest = path_slots[slot];
+            dest.insert(dest.end(), paths.begin(), paths.end());
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(sink_mutex);
+            path_data.insert(path_data.end(), paths.begin(), paths.end());
+        }
+        paths.clear();
+    }
+
+    void AcousticResultModel::flush_path_data()
+    {
+        std::lock_guard<std::mutex> lock(sink_mutex);
+        if (!sink) { return; }
+
+        for (size_t i = 0; i < path_data.size(); i++)
+        {
+            sink->push_path(path_data[i]);
+        }
+        path_data.clear();
+    }
+
+    void AcousticResultModel::end()
+    {
+        for (size_t i = 0; i < path_slots.size(); i++)
+        {
+            path_data.insert(path_data.end(), path_slots[i].begin(), path_slots[i].end());
+        }
+        path_slots.clear();
+
+        if (sink)
+        {
+            std::lock_guard<std::mutex> lock(sink_mutex);
+            sink->end();
+        }
+    }
+
+    bool AcousticResultModel::export_path_data(const string& file_name, double quantum) const
+    {
+        AcousticPathColumns columns;
+        columns.append(path_data);
+        return columns.write(file_name, quantum);
+    }
+
     std::unique_ptr<AcousticResultModel> make_AcousticResultModel()
     { return std::unique_ptr<AcousticResultModel>(new AcousticResultModel()); }
 
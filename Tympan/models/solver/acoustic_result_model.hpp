@@ -11,16 +11,110 @@
 #define TYMPAN__ACOUSTIC_RESULT_MODEL_H__INCLUDED
 
 #include <memory>
+#include <mutex>
+#include <fstream>
 
 #include "Tympan/models/common/spectrum_matrix.h"
 #include "Tympan/models/common/acoustic_path.h"
+#include "Tympan/models/common/acoustic_path_columns.h"
 #include "data_model_common.hpp"
 #include "entities.hpp"
+#include "solver_stats.hpp"
 
 namespace tympan
 {
+/**
+ * @brief Receives the results of a solver as soon as they are computed
+ *
+ * A sink set on the AcousticResultModel replaces the in memory storage of the
+ * results, so that the solvers do not need to keep them until the end of the
+ * computation. The calls are serialized by the AcousticResultModel.
+ */
+class ResultSink
+{
+public:
+    virtual ~ResultSink() {} //!< Destructor
+
+    /// Called before the first result of a computation
+    virtual void begin(size_t nb_receptors, size_t nb_sources) {}
+
+    /// Spectrum of a source at a receptor (each couple is pushed once)
+    virtual void push_spectrum(receptor_idx receptor, source_idx source, const Spectrum& spectrum) = 0;
+
+    /// Acoustic path kept by the solver: the sink takes its ownership
+    virtual void push_path(acoustic_path* path) = 0;
+
+    /// Called after the last result of a computation
+    virtual void end() {}
+};
+
+typedef shared_ptr<ResultSink> result_sink_ptr_t;
+
+/**
+ * @brief Sink streaming the results to a binary file
+ *
+ * The file starts with a header (magic "TYRS", version, number of receptors,
+ * sources and frequency bands) followed by records in the order they are pushed:
+ * - spectrum : receptor and source indices, state, type and band values;
+ * - paths : a block of AcousticPathColumns (same layout as the rays files
+ *   exported by AcousticResultModel::export_path_data);
+ * - end of computation.
+ * The paths are gathered in columns and deleted as they are pushed, the
+ * columns being written every PATHS_PER_RECORD paths and at the end.
+ * Use read_binary_results() to load a file.
+ */
+class BinaryResultSink: public ResultSink
+{
+public:
+    /**
+     * @brief Constructor
+     * @param file_name Path of the file to write
+     * @param keep_paths Write the paths (otherwise they are only deleted)
+     */
+    BinaryResultSink(const string& file_name, bool keep_paths = true);
+    virtual ~BinaryResultSink(); //!< Destructor
+
+    bool good() const { return stream.good(); } //!< False after an error on the file
+
+    virtual void begin(size_t nb_receptors, size_t nb_sources);
+    virtual void push_spectrum(receptor_idx receptor, source_idx source, const Spectrum& spectrum);
+    virtual void push_path(acoustic_path* path);
+    virtual void end();
+
+    size_t nb_spectra() const { return written_spectra; } //!< Number of spectra written
+    size_t nb_paths() const { return written_paths; }     //!< Number of paths written
+
+    static const size_t PATHS_PER_RECORD = 4096; //!< Number of paths of a full paths record
+
+protected:
+    void write_paths(); //!< Write the pending paths as a record and clear them
+
+    std::ofstream stream;   //!< Output file
+    AcousticPathColumns paths; //!< Paths pushed since the last paths record
+    bool keep_paths;        //!< Flag to write the paths
+    size_t written_spectra; //!< Number of spectra written
+    size_t written_paths;   //!< Number of paths written
+};
+
+/**
+ * @brief Load a file written by a BinaryResultSink
+ * @param file_name Path of the file
+ * @param matrix Resized and filled with the spectra
+ * @param paths If not NULL, the paths are appended (and owned by the caller)
+ * @return false if the file can not be read or is not complete
+ */
+bool read_binary_results(const string& file_name, SpectrumMatrix& matrix, tab_acoustic_path* paths = NULL);
+
 /**
  * @brief Contains the results of the model solved
+ *
+ * The solvers push their results as they are computed: they are stored in the
+ * spectrum matrix and the paths array unless a ResultSink is set.
+ *
+ * Parallel producers (the tasks of a solver) push their paths to their own
+ * slot; without sink the slots are appended to the paths array in slot order
+ * by end(), so that the paths order does not depend on the order the
+ * producers finish in. With a sink the paths are streamed as they come.
  */
 class AcousticResultModel
 {
@@ -32,10 +126,47 @@ public:
     SpectrumMatrix& get_data() { return acoustic_data; } //!< Return the results matrix
     tab_acoustic_path& get_path_data() { return path_data; } //!< Return the array of the acoustic paths
 
+    void set_sink(result_sink_ptr_t sink_) { sink = sink_; } //!< Stream the results to sink (NULL to store them)
+    ResultSink* get_sink() const { return sink.get(); }     //!< Return the sink (NULL if the results are stored)
+
+    SolverStats& get_stats() { return stats; } //!< Return the timings and counters of the solver run
+
+    /// Start a computation: size the results matrix (and nb_slots path slots) or begin the sink
+    void begin(size_t nb_receptors, size_t nb_sources, size_t nb_slots = 0);
+
+    /// Store a spectrum or push it to the sink (thread safe)
+    void push_spectrum(receptor_idx receptor, source_idx source, const Spectrum& spectrum);
+
+    /// Store a path or push it to the sink (thread safe)
+    void push_path(acoustic_path* path);
+
+    /// Store the paths of a producer in its slot or push them to the sink (thread safe, paths is emptied)
+    void push_paths(size_t slot, std::vector<acoustic_path*>& paths);
+
+    /// Push the paths of the paths array to the sink (nothing without sink)
+    void flush_path_data();
+
+    /// End a computation: append the path slots to the paths array in order, end the sink
+    void end();
+
+    /**
+     * @brief Export the paths array to a columnar binary file
+     * @param file_name Path of the file (see AcousticPathColumns for the format)
+     * @param quantum Step of the quantized positions (not quantized if 0)
+     * @return false if the file can not be written
+     */
+    bool export_path_data(const string& file_name, double quantum = 0.) const;
+
 protected: // data members
 
     SpectrumMatrix acoustic_data;  //!< Matrix of the spectrum results
     tab_acoustic_path path_data;   //!< Array of the acoustic paths
+    std::vector<tab_acoustic_path> path_slots; //!< Paths of each producer, waiting for end()
+
+    result_sink_ptr_t sink;        //!< Optional destination of the results
+    std::mutex sink_mutex;         //!< Serialize the calls to the sink and the paths array
+
+    SolverStats stats;             //!< Timings and counters filled by the solver
 
 };  // class AcousticResultModel
 
@@ -37,6 +37,7 @@ SolverConfiguration::SolverConfiguration()
     MaxLength=5000;
     SizeReceiver=10.;
     Accelerator=3; // XXX 3 for ANIME3D Solver?
+    ReceptorAccelerator=1;
     MaxTreeDepth=12;
     AngleDiffMin=5.;
     CylindreThick=0.5f;
@@ -65,6 +66,8 @@ SolverConfiguration::SolverConfiguration()
     AnalyticNbRay = 20;
     AnalyticTMax = 10.;
     AnalyticH = 0.1;
+    AnalyticAdaptiveStep = false;
+    AnalyticTolerance = 0.001;
     AnalyticDMax = 3000;
 
     AnalyticTypeTransfo = 1;
@@ -81,6 +84,8 @@ SolverConfiguration::SolverConfiguration()
 
     H1parameter = 10.;
     ModSummation = false;
+    UseAttenuationCache = false;
+    AttenuationCacheTolerance = 0.;
 
     UseMeteo = false;
     //OverSampleD = 0;
@@ -34,6 +34,7 @@ public:
     float MaxLength;			//!< LengthSelector Selector option (maximal length)
     float SizeReceiver;
     int Accelerator;			//!< Accelerator choice with 0: BruteForceAccelerator, 1: GridAccelerator, 2: BvhAccelerator, 3: KdtreeAccelerator
+    int ReceptorAccelerator;	//!< Accelerator used for the receptors (same choices as Accelerator)
     int MaxTreeDepth;			//!< BvhAccelerator Accelerator option (Maximal tree depth)
     float AngleDiffMin;			//!< Minimal angle (other PI) between two face to allow building of a diffraction cylinder
     float CylindreThick;		//!< Diffraction cylinder diameter
@@ -59,6 +60,8 @@ public:
     int AnalyticNbRay;			//!< Rays number to launch for the curve ray sampler
     double AnalyticTMax;		//!< The maximal propagation time for the curve ray sampler
     double AnalyticH;			//!< The propagation time step for the curve ray sampler
+    bool AnalyticAdaptiveStep;	//!< Flag to integrate the curve rays with an adaptive time step
+    double AnalyticTolerance;	//!< Error allowed per step of the adaptive integration (in meters)
     double AnalyticDMax;		//!< The maximal distance for the curve ray sampler
 
     int AnalyticTypeTransfo;	//!< Type of geometry modifier used (only one for the moment: geometry_modifier_z_correction)
@@ -68,7 +71,7 @@ public:
     bool showScene;				//!< Flag to export Scene in order to visualize it
 
     float MinSRDistance;		//!< Not used
-    int NbThreads;				//!< Number of threads used by TYSolver
+    int NbThreads;				//!< Number of threads used by TYSolver and by the ANIME3D ray tracing
     bool UseRealGround;			//!< Flag to model ground into the acoustic model
     //bool UseVegetation;
     bool UseScreen;				//!< Not used
@@ -81,6 +84,8 @@ public:
 
     float H1parameter;			//!< Multiplicative coefficient for the additional reflections if PropaConditions is true
     bool ModSummation;			//!< Flag to activate in the acoustic model a calculation with interference
+    bool UseAttenuationCache;	//!< Flag to reuse the attenuation spectra computed by the acoustic model
+    float AttenuationCacheTolerance;	//!< Relative tolerance on the distances and angles of the attenuation cache (0 : exact)
 
     bool UseMeteo;				//!< Flag to use weather data in the calculation
     bool UseFresnelArea;		//!< Flag to use Fresnel area in the acoustic model for ANIME3D solver
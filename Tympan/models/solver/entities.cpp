@@ -49,9 +49,9 @@ namespace tympan
 
 	ComplexSpectrum AcousticGroundMaterial::get_absorption (double incidence_angle, double length)
 	{
-		ComplexSpectrum Zs, Rp, W, Fw, Q;
+		ComplexSpectrum Zs, Zf, Rp, W, Fw, Q;
 		computeZs(incidence_angle, Zc, Zs);
-		computeZf(incidence_angle, Zs);
+		computeZf(incidence_angle, Zs, Zf);
 		computeRp(incidence_angle, Zf, Rp);
 		computeW(incidence_angle, length, Zf, W);
 		computeFw(W, Fw);
@@ -127,7 +127,7 @@ namespace tympan
 		}
 	}
 
-	void AcousticGroundMaterial::computeZf(double angle, ComplexSpectrum Zs)
+	void AcousticGroundMaterial::computeZf(double angle, ComplexSpectrum Zs, ComplexSpectrum& Zf)
 	{
 		double k0_value, k_value, intv_a, intv_b;
 		size_t size = Zf.getNbValues();
@@ -96,7 +96,7 @@ protected:
     void computeZc(); //!< Compute characteristic impedance
     void computeK();  //!< Compute wave number
     void computeZs(double angle, ComplexSpectrum Z, ComplexSpectrum& spectrum); //!< Compute specific impedance
-	void computeZf(double angle, ComplexSpectrum Zs); //!< Compute effective impedance in rough ground
+	void computeZf(double angle, ComplexSpectrum Zs, ComplexSpectrum& Zf); //!< Compute effective impedance in rough ground
     void computeRp(double angle, const ComplexSpectrum& Zs, ComplexSpectrum& Rp);  //!< Compute reflection coefficient for plane waves
     void computeW(double angle, double length, const ComplexSpectrum& Zs, ComplexSpectrum &W); //!< Compute numeric distance
     void computeFw(ComplexSpectrum localW, ComplexSpectrum& Fw); //!< Compute function of numeric distance
@@ -133,7 +133,6 @@ protected :
 
     ComplexSpectrum Zc; //!< Characteristic impedance
     ComplexSpectrum K;  //!< Wave number
-	ComplexSpectrum Zf; //!< Effective impedance
 };
 
 // -------------------
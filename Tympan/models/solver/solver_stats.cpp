@@ -0,0 +1,77 @@
+/**
+ * \file solver_stats.cpp
+ * \brief Timings and counters of a solver run
+ */
+
+#include "solver_stats.hpp"
+
+namespace tympan
+{
+
+void SolverStats::add_time(const std::string& phase, double seconds)
+{
+    if (!enabled) { return; }
+    std::lock_guard<std::mutex> lock(mutex);
+    phase_times[phase] += seconds;
+}
+
+void SolverStats::add_count(const std::string& counter, unsigned long long n)
+{
+    if (!enabled) { return; }
+    std::lock_guard<std::mutex> lock(mutex);
+    counters[counter] += n;
+}
+
+double SolverStats::time(const std::string& phase) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, double>::const_iterator it = phase_times.find(phase);
+    return it != phase_times.end() ? it->second : 0.;
+}
+
+unsigned long long SolverStats::count(const std::string& counter) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, unsigned long long>::const_iterator it = counters.find(counter);
+    return it != counters.end() ? it->second : 0;
+}
+
+std::map<std::string, double> SolverStats::times() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return phase_times;
+}
+
+std::map<std::string, unsigned long long> SolverStats::counts() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void SolverStats::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    phase_times.clear();
+    counters.clear();
+}
+
+ScopedTimer::ScopedTimer(SolverStats* stats_, const char* phase_) :
+    stats(stats_ && stats_->is_enabled() ? stats_ : NULL), phase(phase_)
+{
+    if (stats) { start = std::chrono::steady_clock::now(); }
+}
+
+ScopedTimer::ScopedTimer(SolverStats& stats_, const char* phase_) :
+    stats(stats_.is_enabled() ? &stats_ : NULL), phase(phase_)
+{
+    if (stats) { start = std::chrono::steady_clock::now(); }
+}
+
+void ScopedTimer::stop()
+{
+    if (!stats) { return; }
+    stats->add_time(phase, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    stats = NULL;
+}
+
+} // namespace tympan
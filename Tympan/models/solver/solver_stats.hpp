@@ -0,0 +1,81 @@
+/**
+ * \file solver_stats.hpp
+ * \brief Timings and counters of a solver run
+ */
+
+#ifndef TYMPAN__SOLVER_STATS_H__INCLUDED
+#define TYMPAN__SOLVER_STATS_H__INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace tympan
+{
+/**
+ * @brief Time spent in each phase of a solver run and event counters
+ *
+ * The updates are thread safe. The time of a phase run by several threads is
+ * the sum of the times of the threads. Hot loops should count locally and
+ * add their counts once (per task for instance). When disabled, the updates
+ * return at once.
+ */
+class SolverStats
+{
+public:
+    SolverStats() : enabled(true) {} //!< Constructor (enabled)
+
+    void set_enabled(bool enabled_) { enabled = enabled_; } //!< Enable or disable the updates
+    bool is_enabled() const { return enabled; }             //!< True if the updates are recorded
+
+    /// Add seconds to the time of a phase
+    void add_time(const std::string& phase, double seconds);
+
+    /// Add n to a counter
+    void add_count(const std::string& counter, unsigned long long n = 1);
+
+    double time(const std::string& phase) const;              //!< Time of a phase (0 if unknown)
+    unsigned long long count(const std::string& counter) const; //!< Value of a counter (0 if unknown)
+
+    std::map<std::string, double> times() const;              //!< Time of all the phases
+    std::map<std::string, unsigned long long> counts() const; //!< Value of all the counters
+
+    void clear(); //!< Reset the times and the counters
+
+protected:
+    std::atomic<bool> enabled;                           //!< Flag to record the updates
+    mutable std::mutex mutex;                            //!< Protects the maps
+    std::map<std::string, double> phase_times;           //!< Seconds spent per phase
+    std::map<std::string, unsigned long long> counters;  //!< Counters
+};
+
+/**
+ * @brief Add the time spent in a scope to a phase of a SolverStats
+ */
+class ScopedTimer
+{
+public:
+    /// Start timing the phase (nothing is done if stats is NULL or disabled)
+    ScopedTimer(SolverStats* stats_, const char* phase_);
+    /// Start timing the phase
+    ScopedTimer(SolverStats& stats_, const char* phase_);
+    /// Stop timing
+    ~ScopedTimer() { stop(); }
+
+    /// Add the elapsed time to the phase (only once)
+    void stop();
+
+private:
+    ScopedTimer(const ScopedTimer&);
+    ScopedTimer& operator=(const ScopedTimer&);
+
+    SolverStats* stats;                             //!< Destination (NULL when not timing)
+    const char* phase;                              //!< Name of the phase
+    std::chrono::steady_clock::time_point start;    //!< Start time
+};
+
+} // namespace tympan
+
+#endif // TYMPAN__SOLVER_STATS_H__INCLUDED
@@ -13,16 +13,55 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <algorithm>
+#include <functional>
+#include <thread>
+
 #include "Tympan/models/common/3d.h"
 #include "Tympan/models/common/acoustic_path.h"
+#include "Tympan/models/common/spectrum_kernels.h"
 #include "Tympan/models/solver/config.h"
 #include "Tympan/models/solver/acoustic_problem_model.hpp"
 #include "Tympan/solvers/ANIME3DSolver/TYANIME3DSolver.h"
 #include "TYANIME3DAcousticModel.h"
 
+/// Minimal number of source-receptor couples given to a thread
+static const size_t ANIME3D_MIN_PAIRS_PER_THREAD = 64;
+/// Minimal number of rays given to a thread
+static const size_t ANIME3D_MIN_RAYS_PER_THREAD = 256;
+
+/**
+ * \brief Share the items [0, nbItems) between NbThreads threads (all the cores when 0)
+ * \param work Called once per thread with its own range [first, last) of items
+ */
+static void parallel_for(size_t nbItems, size_t minItemsPerThread,
+                         const std::function<void(size_t, size_t)>& work)
+{
+    int configThreads = tympan::SolverConfiguration::get()->NbThreads;
+    unsigned int nbThreads = configThreads > 0 ? configThreads : std::thread::hardware_concurrency();
+    nbThreads = std::max(1u, std::min<unsigned int>(nbThreads, nbItems / minItemsPerThread));
+
+    if (nbThreads == 1)
+    {
+        work(0, nbItems);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    size_t chunk = (nbItems + nbThreads - 1) / nbThreads;
+    for (size_t first = 0; first < nbItems; first += chunk)
+    {
+        threads.push_back(std::thread(work, first, std::min(first + chunk, nbItems)));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+}
+
 
 TYANIME3DAcousticModel::TYANIME3DAcousticModel( tab_acoustic_path& tabRayons,
-                                                TYStructSurfIntersect* tabStruct,
+                                                TYANIME3DStructSurfIntersect* tabStruct,
                                                 const tympan::AcousticProblemModel& aproblem,
                                                 AtmosphericConditions& atmos) :
     _tabTYRays(tabRayons),
@@ -57,149 +96,143 @@ void TYANIME3DAcousticModel::ComputeAbsAtm()
 {
     for (int i = 0; i < _nbRays; i++)
     {
-        _absAtm[i] = OSpectreComplex( _atmos.compute_length_absorption( _tabTYRays[i]->getLength() ) );
+        ComputeRayAbsAtm(i);
     }
 }
 
+void TYANIME3DAcousticModel::ComputeRayAbsAtm(int i)
+{
+    _absAtm[i] = OSpectreComplex( _atmos.compute_length_absorption( _tabTYRays[i]->getLength() ) );
+}
+
 void TYANIME3DAcousticModel::ComputeAbsRefl()
 {
-    double angle = 0.0, rd = 0.0, rr = 0.0; // incidence angle of acoustic wave, lenght for events computation
+    for (int i = 0; i < _nbRays; i++) // boucle sur les rayons
+    {
+        ComputeRayAbsRefl(i);
+    }
+}
+
+void TYANIME3DAcousticModel::ComputeRayAbsRefl(int i)
+{
+    double angle = 0.0, rr = 0.0; // incidence angle of acoustic wave, lenght for events computation
     int reflIndice = 0;
-    
-    acoustic_path* ray = NULL;
 
     OPoint3D Prefl, Pprec, Psuiv;    //pt de reflexion, pt precedent et suivant
 
-    OTabDouble tabPondFresnel;      // tableau des ponderations de Fresnel
-    TabPoint3D triangleCentre;    // Contains all triangles centres
-
     OSpectreComplex spectreAbs;
-    OSpectreComplex zero = OSpectreComplex(OSpectre(1.0));
     OSpectreComplex one = OSpectreComplex(OSpectre(1.0));
-    OSpectreComplex prod;
-    OSpectreComplex sum;
-    OSpectreComplex prod1;
-    OSpectreComplex sum1;
-    OSpectreComplex pond;
+    OSpectreComplex prod = one;
 
-    for (int i = 0; i < _nbRays; i++) // boucle sur les rayons
-    {
-        ray = _tabTYRays[i];
-        std::vector<int> tabRefl = ray->getIndexOfEvents(TYREFLEXION | TYREFLEXIONSOL);
-
-        // Initialisation des spectres
-        prod = one;
-        sum = zero;
-        sum1 = zero;
-        pond = zero;
+    acoustic_path* ray = _tabTYRays[i];
+    std::vector<int> tabRefl = ray->getIndexOfEvents(TYREFLEXION | TYREFLEXIONSOL);
 
-        for (size_t j = 0; j < tabRefl.size(); j++)
-        {
-            reflIndice = tabRefl[j];
+    for (size_t j = 0; j < tabRefl.size(); j++)
+    {
+        reflIndice = tabRefl[j];
 
-            Prefl = ray->getEvents().at(reflIndice)->pos;
-            Pprec = ray->getEvents().at(reflIndice)->previous->pos;
-            Psuiv = ray->getEvents().at(reflIndice)->next->pos;
-            angle = ray->getEvents().at(reflIndice)->angle;
+        Prefl = ray->getEvents().at(reflIndice)->pos;
+        Pprec = ray->getEvents().at(reflIndice)->previous->pos;
+        Psuiv = ray->getEvents().at(reflIndice)->next->pos;
+        angle = ray->getEvents().at(reflIndice)->angle;
 
-            // Longueur du trajet reflechi
-            rd = ray->getEvents().at(reflIndice)->distPrevNext;
-            // Longueur du trajet direct
-            rr = Pprec.distFrom(Prefl) + Prefl.distFrom(Psuiv);
+        // Longueur du trajet direct
+        rr = Pprec.distFrom(Prefl) + Prefl.distFrom(Psuiv);
 
-            std::cout << "Position de la reflexion : X = " << Prefl._x << " Y = " << Prefl._y << " Z = " << Prefl._z << std::endl;
-            std::cout << "Angle d'incidence du rayon = " << angle << std::endl;
-            std::cout << "Longueur du rayon direct = " << rd << std::endl;
-            std::cout << "Longueur du rayon reflechi = " << rr << std::endl;
+        // Initialisation des spectres
+        spectreAbs = OSpectreComplex(OSpectre(0.0));
 
-            // Initialisation des spectres
-            spectreAbs = OSpectreComplex(OSpectre(0.0));
 
+        if (_useFresnelArea) // Avec ponderation de Fresnel
+        {
+            //if (ray->getEvents().at(reflIndice)->type == TYREFLEXIONSOL)
+            //{
+            //    std::cout << "We start using Fresnel Area on the ground" << std::endl;
 
-            if (_useFresnelArea) // Avec ponderation de Fresnel
-            {
-                //if (ray->getEvents().at(reflIndice)->type == TYREFLEXIONSOL)
-                //{
-                //    std::cout << "We start using Fresnel Area on the ground" << std::endl;
+            //    triangleCentre.clear();
+            //    tabPondFresnel.clear();
+            //    tabPondFresnel = ComputeFresnelWeighting(angle, Pprec, Prefl, Psuiv, rayNbr, reflIndice, triangleCentre);  // calcul des ponderations de Frenel
+            //    nbFacesFresnel = tabPondFresnel.size();  // nbr de triangles dans le zone de Fresnel
 
-                //    triangleCentre.clear();
-                //    tabPondFresnel.clear();
-                //    tabPondFresnel = ComputeFresnelWeighting(angle, Pprec, Prefl, Psuiv, rayNbr, reflIndice, triangleCentre);  // calcul des ponderations de Frenel
-                //    nbFacesFresnel = tabPondFresnel.size();  // nbr de triangles dans le zone de Fresnel
+            //    std::cout << "il y a N ponderations : " << nbFacesFresnel << std::endl;
 
-                //    std::cout << "il y a N ponderations : " << nbFacesFresnel << std::endl;
+            //    sum = zero;
 
-                //    sum = zero;
+            //    for (int k = 0; k < nbFacesFresnel; k++)
+            //    {
+            //        // boucle sur les faces = intersection plan de l'objet intersecte / ellipsoide de Fresnel
+            //        pSol = _topo->terrainAt(triangleCentre[k])->getSol();
+            //        pSol->calculNombreDOnde(_atmos);
 
-                //    for (int k = 0; k < nbFacesFresnel; k++)
-                //    {
-                //        // boucle sur les faces = intersection plan de l'objet intersecte / ellipsoide de Fresnel
-                //        pSol = _topo->terrainAt(triangleCentre[k])->getSol();
-                //        pSol->calculNombreDOnde(_atmos);
+            //        std::cout << "sol n : " << k << "resistivite = " << pSol->getResistivite() << std::endl;
 
-                //        std::cout << "sol n : " << k << "resistivite = " << pSol->getResistivite() << std::endl;
+            //        spectreAbs = pSol->abso(angle, rr, _atmos);
+            //        // TO DO : S'assurer que la somme des pondrations de Fresnel gale 1
+            //        pond = spectreAbs * tabPondFresnel[k];
+            //        sum = sum + pond; // calcul du coeff de reflexion moy en ponderant avec les materiaux
+            //    }
 
-                //        spectreAbs = pSol->abso(angle, rr, _atmos);
-                //        // TO DO : S'assurer que la somme des pondrations de Fresnel gale 1
-                //        pond = spectreAbs * tabPondFresnel[k];
-                //        sum = sum + pond; // calcul du coeff de reflexion moy en ponderant avec les materiaux
-                //    }
+            //    prod = prod * sum * (rd / rr);
+            //}
+            //else // Reflexion sur une construction
+            //{
+            //    std::cout << "We start using Fresnel Area on a building" << std::endl;
 
-                //    prod = prod * sum * (rd / rr);
-                //}
-                //else // Reflexion sur une construction
-                //{
-                //    std::cout << "We start using Fresnel Area on a building" << std::endl;
+            //    triangleCentre.clear();
+            //    tabPondFresnel = ComputeFresnelWeighting(angle, Pprec, Prefl, Psuiv, rayNbr, reflIndice, triangleCentre);  // calcul des ponderations de Frenel
+            //    nbFacesFresnel = tabPondFresnel.size();  // nbr de triangles dans le zone de Fresnel
 
-                //    triangleCentre.clear();
-                //    tabPondFresnel = ComputeFresnelWeighting(angle, Pprec, Prefl, Psuiv, rayNbr, reflIndice, triangleCentre);  // calcul des ponderations de Frenel
-                //    nbFacesFresnel = tabPondFresnel.size();  // nbr de triangles dans le zone de Fresnel
+            //    std::cout << "il y a N ponderations : " << nbFacesFresnel << std::endl;
 
-                //    std::cout << "il y a N ponderations : " << nbFacesFresnel << std::endl;
+            //    sum = zero;
 
-                //    sum = zero;
+            //    for (int k = 0; k < nbFacesFresnel; k++)
+            //    {
+            //        // boucle sur les faces = intersection plan de l'objet intersecte / ellipsoide de Fresnel
+            //        pond = spectreAbs * tabPondFresnel[k];
+            //        sum = sum + pond;   // calcul du coeff de reflexion moy en ponderant avec les materiaux
+            //    }
+            //    prod = prod * sum;
+            //}
 
-                //    for (int k = 0; k < nbFacesFresnel; k++)
-                //    {
-                //        // boucle sur les faces = intersection plan de l'objet intersecte / ellipsoide de Fresnel
-                //        pond = spectreAbs * tabPondFresnel[k];
-                //        sum = sum + pond;   // calcul du coeff de reflexion moy en ponderant avec les materiaux
-                //    }
-                //    prod = prod * sum;
-                //}
+            //std::cout << "End of Fresnel Area" << std::endl;
+        }
+        else // not use Fresnel Area
+        {
+            // Cas particulier d'une reflexion sur le sol
+            if (ray->getEvents().at(reflIndice)->type == TYREFLEXIONSOL)
+            {
+                unsigned int index_face = ray->getEvents().at(reflIndice)->idFace1;
+                tympan::AcousticGroundMaterial *material = dynamic_cast<tympan::AcousticGroundMaterial*>( _tabSurfIntersect[index_face].material );
+                assert(material);
 
-                //std::cout << "End of Fresnel Area" << std::endl;
+                spectreAbs = material->get_absorption(angle, rr);
             }
-            else // not use Fresnel Area
+            else
             {
-                // Cas particulier d'une reflexion sur le sol
-                std::cout << "We are not using Fresnel Area on the ground" << std::endl;
-                if (ray->getEvents().at(reflIndice)->type == TYREFLEXIONSOL)
-                {
-                    unsigned int index_face = ray->getEvents().at(reflIndice)->idFace1;
-                    tympan::AcousticGroundMaterial *material = dynamic_cast<tympan::AcousticGroundMaterial*>( _tabSurfIntersect[index_face].material );
-                    assert(material);
-
-                    spectreAbs = material->get_absorption(angle, rr);
-                }
-                else
-                {
-                    unsigned int index_face = ray->getEvents().at(reflIndice)->idFace1;
-                    tympan::AcousticBuildingMaterial *material = dynamic_cast<tympan::AcousticBuildingMaterial*>( _tabSurfIntersect[index_face].material );
-                    assert(material);
-
-                    spectreAbs = material->get_absorption(angle, rr);
-                }
-                // ATTENTION ! : Il semble qu'on ne tienne compte que d'une seule reflexion : La derniere.
-                prod = spectreAbs;
+                unsigned int index_face = ray->getEvents().at(reflIndice)->idFace1;
+                tympan::AcousticBuildingMaterial *material = dynamic_cast<tympan::AcousticBuildingMaterial*>( _tabSurfIntersect[index_face].material );
+                assert(material);
+
+                spectreAbs = material->get_absorption(angle, rr);
             }
+            // ATTENTION ! : Il semble qu'on ne tienne compte que d'une seule reflexion : La derniere.
+            prod = spectreAbs;
         }
-
-        _absRefl[i] = prod;
     }
+
+    _absRefl[i] = prod;
 }
 
 void TYANIME3DAcousticModel::ComputeAbsDiff()
+{
+    for (int i = 0; i < _nbRays; i++) // boucle sur les rayons
+    {
+        ComputeRayAbsDiff(i);
+    }
+}
+
+void TYANIME3DAcousticModel::ComputeRayAbsDiff(int i)
 {
     // Delta = diffrence de marche
     // precDiff = distance entre l'evenement precedent et la diffraction
@@ -230,53 +263,46 @@ void TYANIME3DAcousticModel::ComputeAbsDiff()
 
     OVector3D vDiffPrec, vDiffSuiv, n1, n2, normal;
 
-    acoustic_path* currentRay = NULL;
-
-    for (int i = 0; i < _nbRays; i++) // boucle sur les rayons
-    {
-        currentRay = _tabTYRays[i];
+    acoustic_path* currentRay = _tabTYRays[i];
 
-        prod = OSpectreComplex(OSpectre(1.0));
+    std::vector<int> tabDiff = currentRay->getIndexOfEvents(TYDIFFRACTION); // gets a vector where diff occur
 
-        std::vector<int> tabDiff = currentRay->getIndexOfEvents(TYDIFFRACTION); // gets a vector where diff occur
-
-        for (size_t j = 0; j < tabDiff.size(); j++)
+    for (size_t j = 0; j < tabDiff.size(); j++)
+    {
+        diffIdx = tabDiff[j]; // Index de l'evenement diffraction courant
+        acoustic_event* currentEv = currentRay->getEvents().at(diffIdx); // Evenement courant
+
+        precDiff = currentEv->previous->distNextEvent; // Distance de l'venement prcedent  la diffraction
+        diffEnd = currentEv->distEndEvent; // de la diffraction  l'vnement pertinent suivant (recepteur ou reflexion)
+        precEnd = currentEv->previous->distEndEvent; // Chemin sans diffraction
+
+        vDiffPrec = OVector3D(currentEv->pos, currentEv->previous->pos);
+        vDiffSuiv = OVector3D(currentEv->pos, currentEv->next->pos);
+        n1 = _tabSurfIntersect[ currentEv->idFace1 ].normal; // normale de la 1ere face
+        n2 = _tabSurfIntersect[ currentEv->idFace2 ].normal; // normale de la 2e face
+        normal = n1 + n2; // somme des normales
+        
+        // Because we only deal with diffraction in shadow zone, "signe" is set to 1
+        signe = 1; 
+
+        delta = signe * (precDiff + diffEnd - precEnd);
+        kDelta = _K * delta;
+        nbF = _lambda.invMult(2.0 * delta);   // 2 * delta / lambda
+
+        if (true) // DTn 20131220 pour forcer l'operation( delta > ( _lambda.div(20) ).valMax() )
         {
-            diffIdx = tabDiff[j]; // Index de l'evenement diffraction courant
-            acoustic_event* currentEv = currentRay->getEvents().at(diffIdx); // Evenement courant
-
-            precDiff = currentEv->previous->distNextEvent; // Distance de l'venement prcedent  la diffraction
-            diffEnd = currentEv->distEndEvent; // de la diffraction  l'vnement pertinent suivant (recepteur ou reflexion)
-            precEnd = currentEv->previous->distEndEvent; // Chemin sans diffraction
-
-            vDiffPrec = OVector3D(currentEv->pos, currentEv->previous->pos);
-            vDiffSuiv = OVector3D(currentEv->pos, currentEv->next->pos);
-            n1 = _tabSurfIntersect[ currentEv->idFace1 ].normal; // normale de la 1ere face
-            n2 = _tabSurfIntersect[ currentEv->idFace2 ].normal; // normale de la 2e face
-            normal = n1 + n2; // somme des normales
-            
-            // Because we only deal with diffraction in shadow zone, "signe" is set to 1
-            signe = 1; 
-
-            delta = signe * (precDiff + diffEnd - precEnd);
-            kDelta = _K * delta;
-            nbF = _lambda.invMult(2.0 * delta);   // 2 * delta / lambda
-
-            if (true) // DTn 20131220 pour forcer l'operation( delta > ( _lambda.div(20) ).valMax() )
-            {
-                mod = (((nbF * 20.0 + 3.0)).sqrt()).inv(); // 1 / sqrt(20 * nbF + 3)
-            }
-            else
-            {
-                mod = 1;
-            }
-
-            absArrete = OSpectreComplex(mod, kDelta);// (1 / sqrt(20 * nbF + 3)) exp(j * k * delta)
-            prod = prod * absArrete;
+            mod = (((nbF * 20.0 + 3.0)).sqrt()).inv(); // 1 / sqrt(20 * nbF + 3)
+        }
+        else
+        {
+            mod = 1;
         }
 
-        _absDiff[i] = prod;
+        absArrete = OSpectreComplex(mod, kDelta);// (1 / sqrt(20 * nbF + 3)) exp(j * k * delta)
+        prod = prod * absArrete;
     }
+
+    _absDiff[i] = prod;
 }
 
 /*
@@ -591,6 +617,14 @@ std::vector<OTriangle> TYANIME3DAcousticModel::ComputeTriangulation(const TYTabP
 */
 
 void TYANIME3DAcousticModel::ComputePressionAcoustEff()
+{
+    for (int i = 0; i < _nbRays; i++) // boucle sur les rayons
+    {
+        ComputeRayPressionAcoustEff(i);
+    }
+}
+
+void TYANIME3DAcousticModel::ComputeRayPressionAcoustEff(int i)
 {
     OSpectre phase; // phase du nombre complexe _pressAcoustEff[i] pour chq i
     OSpectre mod;   // module du nombre complexe _pressAcoustEff[i] pour chq i
@@ -605,56 +639,134 @@ void TYANIME3DAcousticModel::ComputePressionAcoustEff()
     OSpectreComplex prodAbs; // produit des differentes absorptions
     double totalRayLength; // Computes the total ray length including reflections only (diffractions are not included)
 
-    for (int i = 0; i < _nbRays; i++) // boucle sur les rayons
-    {
-        totalRayLength = 0.0; // Computes the total ray length including reflections only (diffractions are not included)
+    totalRayLength = 0.0; // Computes the total ray length including reflections only (diffractions are not included)
+
+    const tympan::AcousticSource& source = _aproblem.source( _tabTYRays[i]->getSource_idx() );
+
+    //--------------------------------------
+
+    totalRayLength = _tabTYRays[i]->getLength();
+
+    c1 = 4.0 * M_PI * totalRayLength * totalRayLength;
+
+    S  = _tabTYRays[i]->getEvents().at(0)->pos;
+    P0 = _tabTYRays[i]->getEvents().at(1)->pos;
+    seg = OSegment3D(S, P0);
 
-        const tympan::AcousticSource& source = _aproblem.source( _tabTYRays[i]->getSource_idx() );
+    OVector3D vec(S, P0);
+    double length = S.distFrom(P0);
 
-        //--------------------------------------
+    directivite = source.directivity->lwAdjustment(vec, length);
+    wSource = source.spectrum.toGPhy();
 
-        totalRayLength = _tabTYRays[i]->getLength();
+    prodAbs = _absAtm[i] * _absRefl[i] * _absDiff[i];
 
-        c1 = 4.0 * M_PI * totalRayLength * totalRayLength;
+    // module = dir * W * rhoC / (4 * PI * R) * produit (reflex, diffraction, atmos)
+    mod = ((directivite * wSource * rhoc) * (1. / c1)).sqrt() * prodAbs.getModule();
+    // phase = exp(j K *L)
+    phase = _K.mult(_tabTYRays[i]->getLength()) + prodAbs.getPhase();
+
+    _pressAcoustEff[i] = OSpectreComplex(mod, phase);
+}
+
+void TYANIME3DAcousticModel::ComputeRaysAcousticModel(int first, int last)
+{
+    for (int i = first; i < last; i++)
+    {
+        ComputeRayAbsAtm(i);
+        ComputeRayAbsRefl(i);
+        ComputeRayAbsDiff(i);
+        ComputeRayPressionAcoustEff(i);
+    }
+}
+
+void TYANIME3DAcousticModel::SortRaysByPair(int nbSources, int nbRecepteurs,
+                                            std::vector<size_t>& pairOffsets,
+                                            std::vector<int>& pairRays) const
+{
+    const size_t nbPairs = static_cast<size_t>(nbSources) * nbRecepteurs;
+    pairOffsets.assign(nbPairs + 1, 0);
+
+    // Couple index of each ray (nbPairs if the ray matches no couple)
+    std::vector<size_t> rayPair(_nbRays, nbPairs);
+    for (int k = 0; k < _nbRays; k++)
+    {
+        const unsigned int source_id = _tabTYRays[k]->getSource_idx();
+        const unsigned int receptor_id = _tabTYRays[k]->getRecepteur_idx();
+        if ( (source_id < static_cast<unsigned int>(nbSources)) &&
+             (receptor_id < static_cast<unsigned int>(nbRecepteurs)) )
+        {
+            rayPair[k] = static_cast<size_t>(source_id) * nbRecepteurs + receptor_id;
+            pairOffsets[rayPair[k] + 1]++;
+        }
+    }
 
-        S  = _tabTYRays[i]->getEvents().at(0)->pos;
-        P0 = _tabTYRays[i]->getEvents().at(1)->pos;
-        seg = OSegment3D(S, P0);
+    for (size_t p = 0; p < nbPairs; p++)
+    {
+        pairOffsets[p + 1] += pairOffsets[p];
+    }
 
-        OVector3D vec(S, P0);
-        double length = S.distFrom(P0);
+    // Stable counting sort: the rays of a couple keep their original order
+    pairRays.resize(pairOffsets[nbPairs]);
+    std::vector<size_t> next(pairOffsets.begin(), pairOffsets.end() - 1);
+    for (int k = 0; k < _nbRays; k++)
+    {
+        if (rayPair[k] < nbPairs)
+        {
+            pairRays[next[rayPair[k]]++] = k;
+        }
+    }
+}
 
-        directivite = source.directivity->lwAdjustment(vec, length);
-        wSource = source.spectrum.toGPhy();
+OSpectreComplex TYANIME3DAcousticModel::ComputePressionAcoustPair(const int* rays, size_t nbRays,
+                                                                  const OSpectre& K2, double cst,
+                                                                  int forceC) const
+{
+    // The partial sums are computed on the band values: the coherent sum is
+    // accumulated in cartesian form (no conversion to module/phase per ray)
+    tympan::SpectrumValues sumRe(0.0), sumIm(0.0); // somme partielle coherente
+    tympan::SpectrumValues sum2(0.0);              // somme partielle incoherente
+    tympan::SpectrumValues C(forceC == 1 ? 1.0 : 0.0); // facteur de coherence
+    const double* k2 = K2.getTabValReel();
+    double totalRayLength;
 
-        prodAbs = _absAtm[i] * _absRefl[i] * _absDiff[i];
+    for (size_t n = 0; n < nbRays; n++) // boucle sur les rayons allant de la source au recepteur
+    {
+        const int k = rays[n];
+        const OSpectreComplex& pressure = _pressAcoustEff[k];
+        const double* mod = pressure.getTabValReel();
 
-        // module = dir * W * rhoC / (4 * PI * R) * produit (reflex, diffraction, atmos)
-        mod = ((directivite * wSource * rhoc) * (1. / c1)).sqrt() * prodAbs.getModule();
-        // phase = exp(j K *L)
-        phase = _K.mult(_tabTYRays[i]->getLength()) + prodAbs.getPhase();
+        if ( (forceC != 0) && (forceC != 1) ) // 0 : as energetic, 1 : as interference in defaultSolver
+        {
+            totalRayLength = _tabTYRays[k]->getLength();
+            // C = exp(-K2 * L * L * cst)
+            tympan::spectrum_exp(k2, -totalRayLength * totalRayLength * cst, C.data());
+        }
 
-        _pressAcoustEff[i] = OSpectreComplex(mod, phase);
+        tympan::spectrum_add_polar(sumRe.data(), sumIm.data(), mod, pressure.getTabValImag(), C.data());
+        for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+        {
+            sum2[i] += mod[i] * mod[i] * (1.0 - C[i] * C[i]);
+        }
     }
+
+    // Be carefull sum of p!= p of sum
+    OSpectreComplex total = OSpectreComplex(OSpectre::getEmptyLinSpectre());
+    tympan::spectrum_norm2(sumRe.data(), sumIm.data(), total.getTabValReel());
+    tympan::spectrum_add(total.getTabValReel(), sum2.data(), total.getTabValReel());
+    return total;
 }
 
 OTab2DSpectreComplex TYANIME3DAcousticModel::ComputePressionAcoustTotalLevel()
 {
-    OSpectre C;         // facteur de coherence et son carre
-    OSpectre un = OSpectre(1.0);
-    OSpectreComplex zero = OSpectreComplex(0.0, 0.0);
-    OSpectreComplex sum1;   //somme partielle
-    OSpectreComplex sum3;
-    OSpectre sum2;          //somme partielle
-    OSpectre mod;           // module et module au carre
     const OSpectre K2 = _K * _K;            // nombre d'onde au carre
 
     tympan::LPSolverConfiguration config = tympan::SolverConfiguration::get();
     float incerRel = config->Anime3DSigma;  // incertitude relative sur la taille du rayon au carree
+    const int forceC = config->Anime3DForceC;
 
     // constante pour la definition du facteur de coherence
     double cst = (pow(2., 1. / 6.) - pow(2., -1. / 6.)) * (pow(2., 1. / 6.) - pow(2., -1. / 6.)) / 3.0 + incerRel * incerRel;
-    double totalRayLength;
 
     const int nbSources    = _aproblem.nsources();           // nbr de sources de la scene
     const int nbRecepteurs = _aproblem.nreceptors();         // nbr de recepteurs de la scene
@@ -666,61 +778,37 @@ OTab2DSpectreComplex TYANIME3DAcousticModel::ComputePressionAcoustTotalLevel()
         tabPressionAcoust[i].resize(nbRecepteurs);
     }
 
-    for (int i = 0; i < nbSources; i++) // boucle sur les sources
-    {
-        for (int j = 0; j < nbRecepteurs; j++) // boucle sur les recepteurs
-        {
-            sum1 = zero;
-            sum2 = zero;
-            sum3 = zero;
+    // Rays grouped by source-receptor couple (couple i * nbRecepteurs + j
+    // owns pairRays[pairOffsets[p]] to pairRays[pairOffsets[p + 1] - 1])
+    std::vector<size_t> pairOffsets;
+    std::vector<int> pairRays;
+    SortRaysByPair(nbSources, nbRecepteurs, pairOffsets, pairRays);
 
-            for (int k = 0; k < _nbRays; k++) // boucle sur les rayons allant de la source au recepteur
-            {
-                const unsigned int source_id = _tabTYRays[k]->getSource_idx();
-                const unsigned int receptor_id = _tabTYRays[k]->getRecepteur_idx();
-
-                if ( (source_id == i ) && (receptor_id == j) )
-                {
-                    totalRayLength = _tabTYRays[k]->getLength();
-                    mod = (_pressAcoustEff[k]).getModule();
-
-                    switch(config->Anime3DForceC)
-                    {
-                    case 0 : 
-                        C = 0.; // as energetic in defaultSolver
-                        break;
-                    case 1 : 
-                        C = 1.; // as "interference in defaultSolver
-                        break;
-                    default:
-                        C = (K2 * totalRayLength * totalRayLength * (-1) * cst).exp();
-                    }
-
-                    sum3 = _pressAcoustEff[k] * C;
-                    sum1 = sum1 + sum3;
-                    sum2 = sum2 + mod * mod * (un - C * C);
-                }
-            }
+    const size_t nbPairs = static_cast<size_t>(nbSources) * nbRecepteurs;
+    const int* rays = pairRays.empty() ? NULL : &pairRays[0];
 
-            // Be carefull sum of p!= p of sum
-            sum1 = sum1.getModule() * sum1.getModule();
-            tabPressionAcoust[i][j] = sum1 + sum2;
+    // The couples are independent: share them between the threads
+    parallel_for(nbPairs, ANIME3D_MIN_PAIRS_PER_THREAD, [&](size_t first, size_t last)
+    {
+        for (size_t p = first; p < last; p++)
+        {
+            tabPressionAcoust[p / nbRecepteurs][p % nbRecepteurs] =
+                ComputePressionAcoustPair(rays + pairOffsets[p], pairOffsets[p + 1] - pairOffsets[p],
+                                          K2, cst, forceC);
         }
-    }
+    });
 
     return tabPressionAcoust;
 }
 
 OTab2DSpectreComplex TYANIME3DAcousticModel::ComputeAcousticModel()
 {
-
-    ComputeAbsAtm();// Absorption atmosphrique pour tous les rayons
-
-    ComputeAbsRefl(); // Absorption par reflexion pour tous les rayons
-
-    ComputeAbsDiff(); // Attnuation par diffraction pour tous les rayons
-
-    ComputePressionAcoustEff(); // Pression acoustique efficace pour tous les rayons
+    // Absorptions (atmosphere, reflexion, diffraction) et pression acoustique
+    // efficace : les rayons sont independants, ils sont repartis entre les threads
+    parallel_for(_nbRays, ANIME3D_MIN_RAYS_PER_THREAD, [this](size_t first, size_t last)
+    {
+        ComputeRaysAcousticModel(static_cast<int>(first), static_cast<int>(last));
+    });
 
     return ComputePressionAcoustTotalLevel(); // Pression acoustique totale pour tous les couples source-recepteur
 }
@@ -58,7 +58,7 @@ public:
      * \param atmos Atmospheric conditions object
      */
     TYANIME3DAcousticModel( tab_acoustic_path& tabRayons, 
-                            TYStructSurfIntersect* tabStruct,
+                            TYANIME3DStructSurfIntersect* tabStruct,
                             const tympan::AcousticProblemModel& aproblem,
                             AtmosphericConditions& atmos);
 
@@ -77,12 +77,28 @@ public:
      */
     void ComputePressionAcoustEff();
 
+    /**
+     * \fn void ComputeRaysAcousticModel(int first, int last)
+     * \brief Calculation of the absorptions and of the effective acoustic pressure of the rays [first, last)
+     * \brief (a single pass per ray, the rays being independent)
+     */
+    void ComputeRaysAcousticModel(int first, int last);
+
     /**
      *\fn  void ComputePressionAcoustTotalLevel()
      *\brief Calculation of the total quadratic pressure for a source/receptor - calculation with partial coherence form
      */
     OTab2DSpectreComplex ComputePressionAcoustTotalLevel();
 
+    /**
+     * \fn void SortRaysByPair(int nbSources, int nbRecepteurs, std::vector<size_t>& pairOffsets, std::vector<int>& pairRays) const
+     * \brief Group the rays by source-receptor couple (compressed index)
+     * \param pairOffsets Offsets in pairRays of the rays of each couple (source * nbRecepteurs + receptor), nbSources * nbRecepteurs + 1 values
+     * \param pairRays Ray indices sorted by couple, in their original order within a couple
+     */
+    void SortRaysByPair(int nbSources, int nbRecepteurs,
+                        std::vector<size_t>& pairOffsets, std::vector<int>& pairRays) const;
+
 
 protected:
 
@@ -91,12 +107,16 @@ protected:
      * \brief Calculation of the atmospheric absorption
      */
     void ComputeAbsAtm();
+    /// Calculation of the atmospheric absorption of the ray i
+    void ComputeRayAbsAtm(int i);
 
     /**
      * \fn void ComputeAbsRefl(TYCalcul & calcul, TYSiteNode & site)
      * \brief Calculation of the absorption by reflection
      */
     void ComputeAbsRefl();
+    /// Calculation of the absorption by reflection of the ray i
+    void ComputeRayAbsRefl(int i);
 
     // * \fn OBox2 ComputeFresnelArea(double angle, OPoint3D Pprec, OPoint3D Prefl, OPoint3D Psuiv, int rayNbr, int reflIndice)
     // * \brief Calculation of triangles in the Fresnel area
@@ -119,6 +139,10 @@ protected:
     * \brief Calculation of absorption by diffraction
     */
     void ComputeAbsDiff();
+    /// Calculation of the absorption by diffraction of the ray i
+    void ComputeRayAbsDiff(int i);
+    /// Calculation of the effective acoustic pressure of the ray i
+    void ComputeRayPressionAcoustEff(int i);
 
 
 
@@ -129,6 +153,13 @@ private :
      */
     OSpectre computeFc(const double& dd, const double& dr);
 
+    /*
+     * \fn OSpectreComplex ComputePressionAcoustPair(const int* rays, size_t nbRays, const OSpectre& K2, double cst, int forceC) const
+     * \brief compute the total quadratic pressure of the given rays of a source-receptor couple
+     */
+    OSpectreComplex ComputePressionAcoustPair(const int* rays, size_t nbRays,
+                                              const OSpectre& K2, double cst, int forceC) const;
+
 protected :
 
     // Test : vector de triangles
@@ -154,7 +185,7 @@ protected :
     /// Array of all TYMPAN rays
     tab_acoustic_path& _tabTYRays;
 
-    TYStructSurfIntersect* _tabSurfIntersect; //!< Array containing all the informations relative to a site geometry and associated material to each face
+    TYANIME3DStructSurfIntersect* _tabSurfIntersect; //!< Array containing all the informations relative to a site geometry and associated material to each face
 
     // Triangles list of the topography
     // TYTabLPPolygon _listeTrianglesBox;
@@ -20,6 +20,7 @@ using std::vector;
 #include "Tympan/models/common/atmospheric_conditions.h"
 #include "Tympan/models/solver/config.h"
 #include "Tympan/models/solver/acoustic_problem_model.hpp"
+#include "Tympan/models/solver/solver_stats.hpp"
 #include "Tympan/geometric_methods/AnalyticRayTracer/meteoLin.h"
 #include "Tympan/geometric_methods/AnalyticRayTracer/Lancer.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Tools/FaceSelector.h"
@@ -42,7 +43,7 @@ using std::vector;
 #include "TYANIME3DSolver.h"
 #include "TYANIME3DConversionTools.h"
 
-TYANIME3DAcousticPathFinder::TYANIME3DAcousticPathFinder(   TYStructSurfIntersect* tabPolygon, 
+TYANIME3DAcousticPathFinder::TYANIME3DAcousticPathFinder(   TYANIME3DStructSurfIntersect* tabPolygon, 
                                                             const size_t& tabPolygonSize,
                                                             const tympan::AcousticProblemModel& aproblem_, 
                                                             tab_acoustic_path& tabTYRays,
@@ -51,7 +52,8 @@ TYANIME3DAcousticPathFinder::TYANIME3DAcousticPathFinder(   TYStructSurfIntersec
     _tabPolygonSize(tabPolygonSize),  
     _tabTYRays(tabTYRays),
     _atmos(atmos),
-    _aproblem(aproblem_)
+    _aproblem(aproblem_),
+    _stats(NULL)
 {
 }
 
@@ -73,6 +75,8 @@ bool TYANIME3DAcousticPathFinder::exec()
 	vector<tympan::VolumeFaceDirectivity*> directivities;
     unsigned int sens = getTabsSAndR(sources, recepteurs,directivities);
 
+    tympan::ScopedTimer sceneTimer(_stats, "scene_build");
+
     // Create geometry transformer
     build_geometry_transformer( sources );
 
@@ -88,18 +92,25 @@ bool TYANIME3DAcousticPathFinder::exec()
     //Une fois la scene convertie, on peut la post-traiter (ajouter de l'information : arretes de diffractions par ex)
     _rayTracing.getSolver()->postTreatmentScene(_rayTracing.getScene(), _rayTracing.getSources(), _rayTracing.getRecepteurs());
 
-    _rayTracing.getScene()->finish(tympan::SolverConfiguration::get()->Accelerator);
+    _rayTracing.getScene()->finish(tympan::SolverConfiguration::get()->Accelerator, leafTreatment::FIRST, tympan::SolverConfiguration::get()->NbThreads);
 
-#ifdef TEST_ACCELERATION_RECEPTORS
-    _rayTracing.get_receptors_landscape()->finish(1, leafTreatment::ALL); // Using grid accelerator
-#endif
+    _rayTracing.get_receptors_landscape()->finish(tympan::SolverConfiguration::get()->ReceptorAccelerator, leafTreatment::ALL);
+    sceneTimer.stop();
 
     ////////////////////////////////////
     // Propagation des rayons
     ////////////////////////////////////
 
-    _rayTracing.setEngine(); //DEFAULT
-    _rayTracing.launchSimulation();          //Traitement monothread
+    // Traitement multithread si plusieurs threads sont demandes
+    unsigned int nbThreads = static_cast<unsigned int>(tympan::SolverConfiguration::get()->NbThreads);
+    AcousticRaytracerConfiguration::get()->NbThreads = nbThreads;
+    _rayTracing.setEngine(nbThreads > 1 ? PARALLELDEFAULT : DEFAULT);
+    {
+        tympan::ScopedTimer timer(_stats, "ray_tracing");
+        _rayTracing.launchSimulation();
+    }
+
+    tympan::ScopedTimer postTimer(_stats, "acoustic_post_processing");
 
     // This function creates TYRays from Rays .
     convert_Rays_to_acoustic_path(sens);
@@ -403,6 +414,9 @@ void TYANIME3DAcousticPathFinder::build_geometry_transformer( const vector<vec3>
         CurveRayShot.setTMax(config->AnalyticTMax);
         CurveRayShot.setTimeStep(config->AnalyticH); // Propagation time step
         CurveRayShot.setNbRay(config->AnalyticNbRay);
+        CurveRayShot.setNbThreads(config->NbThreads > 0 ? config->NbThreads : 0);
+        CurveRayShot.setAdaptiveStep(config->AnalyticAdaptiveStep);
+        CurveRayShot.setTolerance(config->AnalyticTolerance);
         dynamic_cast<meteoLin*>(CurveRayShot._weather)->setGradC(config->AnalyticGradC);
         dynamic_cast<meteoLin*>(CurveRayShot._weather)->setGradV(config->AnalyticGradV);
         CurveRayShot._weather->setWindAngle(config->WindDirection);
@@ -434,7 +448,9 @@ void TYANIME3DAcousticPathFinder::configure_raytracer()
     raytracer_config->NbRaysPerSource = solver_config->NbRaysPerSource;
     raytracer_config->Discretization = solver_config->Discretization;
     raytracer_config->Accelerator = solver_config->Accelerator;
+    raytracer_config->ReceptorAccelerator = solver_config->ReceptorAccelerator;
     raytracer_config->MaxTreeDepth = solver_config->MaxTreeDepth;
+    raytracer_config->NbThreads = solver_config->NbThreads;
     raytracer_config->MaxProfondeur = solver_config->MaxProfondeur;
     raytracer_config->MaxReflexion = solver_config->MaxReflexion;
     raytracer_config->UseSol = solver_config->UseSol;
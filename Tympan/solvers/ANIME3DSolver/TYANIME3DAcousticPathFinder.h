@@ -21,6 +21,7 @@
 #include "Tympan/geometric_methods/AcousticRaytracer/Engine/Simulation.h"
 
 class AtmosphericConditions;
+namespace tympan { class SolverStats; }
 
 /**
  * \class TYANIME3DAcousticPathFinder
@@ -29,7 +30,7 @@ class AtmosphericConditions;
 class TYANIME3DAcousticPathFinder
 {
 public:
-    //TYANIME3DAcousticPathFinder(    TYStructSurfIntersect* tabPolygon, 
+    //TYANIME3DAcousticPathFinder(    TYANIME3DStructSurfIntersect* tabPolygon, 
     //                                const size_t& tabPolygonSize, 
     //                                TYTabSourcePonctuelleGeoNode& tabSources, 
     //                                TYTabPointCalculGeoNode& tabRecepteurs,
@@ -43,7 +44,7 @@ public:
      * \param tabTYRays Array containing the acoustic paths for the rays
      * \param atmos Atmospheric conditions object
      */
-    TYANIME3DAcousticPathFinder(    TYStructSurfIntersect* tabPolygon, 
+    TYANIME3DAcousticPathFinder(    TYANIME3DStructSurfIntersect* tabPolygon, 
                                     const size_t& tabPolygonSize, 
                                     const tympan::AcousticProblemModel& aproblem_,
                                     tab_acoustic_path& tabTYRays,
@@ -61,6 +62,9 @@ public:
     /// Get the geometry modifier
     IGeometryModifier* get_geometry_modifier() { return transformer.get(); }
 
+    /// Set the statistics updated by exec() with its phase times (NULL to disable)
+    void set_stats(tympan::SolverStats* stats) { _stats = stats; }
+
 private :
     /*!
      * \fn unsigned int getTabsSAndR(const TYSite& site, TYCalcul& calcul, vector<OCoord3D>& sources, vector<OCoord3D>& recepteurs)
@@ -120,7 +124,7 @@ private:
     std::unique_ptr<IGeometryModifier> transformer;
 
     /// Array containing all the informations relative to a site geometry and associated material to each face
-    TYStructSurfIntersect* _tabPolygon;
+    TYANIME3DStructSurfIntersect* _tabPolygon;
 
     /// Polygons number in _tabPolygon
     const size_t& _tabPolygonSize;
@@ -132,6 +136,9 @@ private:
     AtmosphericConditions& _atmos;
 
     const tympan::AcousticProblemModel& _aproblem;
+
+    /// Statistics updated by exec() (may be NULL)
+    tympan::SolverStats* _stats;
 };
 
 #endif // __TYANIME3DACOUSTICPATHFINDER__
@@ -27,7 +27,7 @@ TYANIME3DFaceSelector::~TYANIME3DFaceSelector()
 
 }
 
-bool TYANIME3DFaceSelector::exec(TYStructSurfIntersect *&tabPolygon, size_t& tabPolygonSize)
+bool TYANIME3DFaceSelector::exec(TYANIME3DStructSurfIntersect *&tabPolygon, size_t& tabPolygonSize)
 {
     bool bRet = buildCalcStruct(tabPolygon, tabPolygonSize);
     //bRet &= triangulateConcavePolygon(tabPolygon, tabPolygonSize);
@@ -35,13 +35,13 @@ bool TYANIME3DFaceSelector::exec(TYStructSurfIntersect *&tabPolygon, size_t& tab
     return bRet;
 }
 
-bool TYANIME3DFaceSelector::buildCalcStruct(TYStructSurfIntersect *&tabPolygon, size_t& tabPolygonSize)
+bool TYANIME3DFaceSelector::buildCalcStruct(TYANIME3DStructSurfIntersect *&tabPolygon, size_t& tabPolygonSize)
 {
     const tympan::nodes_pool_t& nodes = aproblem.nodes(); 
     const tympan::triangle_pool_t& triangles = aproblem.triangles();
 
     tabPolygonSize = triangles.size();
-    tabPolygon = new TYStructSurfIntersect[triangles.size()];
+    tabPolygon = new TYANIME3DStructSurfIntersect[triangles.size()];
 
     for (unsigned int i=0; i<triangles.size(); i++)
     {
@@ -32,16 +32,16 @@ public:
     virtual ~TYANIME3DFaceSelector();
 
     /*!
-     * \fn bool exec(TYStructSurfIntersect* tabPolygon, unsigned int& tabPolygonSize);
+     * \fn bool exec(TYANIME3DStructSurfIntersect* tabPolygon, unsigned int& tabPolygonSize);
      * \brief Build list of faces
      * \param tabPolygon Array containing the polygons
      * \param tabPolygonSize Size of the tabPolygon array
      * \return true
      */
-    bool exec(TYStructSurfIntersect *&tabPolygon, size_t& tabPolygonSize);
+    bool exec(TYANIME3DStructSurfIntersect *&tabPolygon, size_t& tabPolygonSize);
 
 private :
-    bool buildCalcStruct(TYStructSurfIntersect *&tabPolygon, size_t& tabPolygonSize);
+    bool buildCalcStruct(TYANIME3DStructSurfIntersect *&tabPolygon, size_t& tabPolygonSize);
 
 protected :
     const tympan::AcousticProblemModel& aproblem; //!< Reference to the acoustic problem
@@ -57,7 +57,7 @@ bool TYANIME3DRayTracerSolverAdapter::postTreatmentScene(Scene* scene, std::vect
 
 bool TYANIME3DRayTracerSolverAdapter::valideIntersection(Ray* r, Intersection* inter)
 {
-    tympan::LPSolverConfiguration config = tympan::SolverConfiguration::get();
+    const tympan::SolverConfiguration* config = _config;
     if (r->getEvents()->size() > static_cast<unsigned int>(config->MaxProfondeur)) { return false; }
 
     bool isValid = false;
@@ -79,7 +79,11 @@ bool TYANIME3DRayTracerSolverAdapter::valideIntersection(Ray* r, Intersection* i
     }
 
 #ifdef _ALLOW_TARGETING_
-    if (isValid && config->EnableFullTargets) { ValidRay::appendDirectionToEvent(r->events.back(), targetManager); }
+    if (isValid && config->EnableFullTargets)
+    {
+        std::lock_guard<std::mutex> lock(targetMutex);
+        ValidRay::appendDirectionToEvent(r->events.back(), targetManager);
+    }
 #endif //_ALLOW_TARGETING_
 
     return (isValid); 
@@ -100,7 +104,7 @@ bool TYANIME3DRayTracerSolverAdapter::valideRayon(Ray* r)
 
 bool TYANIME3DRayTracerSolverAdapter::invalidRayon(Ray* r)
 {
-    if (!tympan::SolverConfiguration::get()->KeepDebugRay)
+    if (!_config->KeepDebugRay)
     {
         delete r;
 		r = NULL;
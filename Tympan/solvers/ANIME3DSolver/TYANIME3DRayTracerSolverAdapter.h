@@ -18,6 +18,7 @@
 
 #include "Tympan/geometric_methods/AcousticRaytracer/Tools/SelectorManager.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Acoustic/Solver.h"
+#include "Tympan/models/solver/config.h"
 
 /**
 * \brief API class to run the ray tracer for the ANIME3D solver
@@ -26,6 +27,9 @@ class TYANIME3DRayTracerSolverAdapter : public Solver
 {
 
 public:
+    /// Constructor
+    TYANIME3DRayTracerSolverAdapter() : _config(tympan::SolverConfiguration::get()) { }
+
     virtual bool postTreatmentScene(Scene* scene, std::vector<Source>& sources, std::vector<Recepteur>& recepteurs);
 
     //virtual double leafTreatment(KdTree *kdtree, BVH* bvh, Ray *r, vector<struct Isect> &primitives);
@@ -55,10 +59,16 @@ public:
 
     //virtual void clean();
 
+    virtual std::map<std::string, unsigned long long> getSelectorRejections() const { return selectorManagerValidation.getRejections(); }
+
     bool _useFresnelArea; //!< Flag to use Fresnel weighting
 
 
 protected:
+    /// Solver configuration, kept here so that the ray tracing threads
+    /// don't copy the (not thread-safe) reference counted singleton
+    tympan::LPSolverConfiguration _config;
+
     SelectorManager<Ray> selectorManagerIntersection;
     SelectorManager<Ray> selectorManagerValidation;
 
@@ -24,6 +24,7 @@
 #include "Tympan/models/solver/config.h"
 #include "Tympan/models/solver/acoustic_problem_model.hpp"
 #include "Tympan/models/solver/acoustic_result_model.hpp"
+#include "Tympan/geometric_methods/AcousticRaytracer/Engine/DefaultEngine.h"
 #include "Tympan/solvers/ANIME3DSolver/TYANIME3DAcousticModel.h"
 #include "Tympan/solvers/ANIME3DSolver/TYANIME3DAcousticPathFinder.h"
 #include "Tympan/solvers/ANIME3DSolver/TYANIME3DFaceSelector.h"
@@ -63,6 +64,10 @@ bool TYANIME3DSolver::solve(const tympan::AcousticProblemModel& aproblem,
 {
     tympan::SolverConfiguration::set(configuration);
     tympan::LPSolverConfiguration config = tympan::SolverConfiguration::get();
+    // Les statistiques ne portent que sur ce calcul
+    tympan::SolverStats& stats = aresult.get_stats();
+    stats.clear();
+    tympan::ScopedTimer solveTimer(stats, "solve");
     // Recupration (once for all) des sources et des rcepteurs
     init();
 
@@ -71,13 +76,31 @@ bool TYANIME3DSolver::solve(const tympan::AcousticProblemModel& aproblem,
 
     // Construction de la liste des faces utilise pour le calcul
     TYANIME3DFaceSelector fs(aproblem);
+    tympan::ScopedTimer faceTimer(stats, "face_selection");
     bool bRet = fs.exec(_tabPolygon, _tabPolygonSize);
+    faceTimer.stop();
     if (!bRet) { return false; }
+    stats.add_count("faces_selected", _tabPolygonSize);
 
     // Ray tracing computation
     TYANIME3DAcousticPathFinder apf(_tabPolygon, _tabPolygonSize, aproblem, tabRays, *_pAtmos);
+    apf.set_stats(&stats);
     if ( !apf.exec() ) { return false; }
 
+    // Compteurs du lancer de rayons
+    DefaultEngine* engine = dynamic_cast<DefaultEngine*>(apf.getRayTracer().getEngine());
+    if (engine)
+    {
+        stats.add_count("rays_traced", engine->getNbRayonsTraites());
+        stats.add_count("intersections", engine->getNbIntersections());
+    }
+    stats.add_count("valid_rays", tabRays.size());
+    const std::map<std::string, unsigned long long> rejections = apf.getRayTracer().getSolver()->getSelectorRejections();
+    for (std::map<std::string, unsigned long long>::const_iterator it = rejections.begin(); it != rejections.end(); ++it)
+    {
+        stats.add_count("selector_rejections/" + it->first, it->second);
+    }
+
 #ifndef __ONLY_RAYS__
 
     ////////////////////////////////////////////////////////////
@@ -88,11 +111,14 @@ bool TYANIME3DSolver::solve(const tympan::AcousticProblemModel& aproblem,
     TYANIME3DAcousticModel aam(tabRays, _tabPolygon, aproblem, *_pAtmos);
 
     // calcul de la matrice de pression totale pour chaque couple (S,R)
+    tympan::ScopedTimer modelTimer(stats, "acoustic_model");
     OTab2DSpectreComplex tabSpectre = aam.ComputeAcousticModel();
+    modelTimer.stop();
     OSpectre sLP; // spectre de pression pour chaque couple (S,R)
 
-    tympan::SpectrumMatrix& matrix = aresult.get_data();
-    matrix.resize(aproblem.nreceptors(), aproblem.nsources());
+    tympan::ScopedTimer exportTimer(stats, "result_export");
+
+    aresult.begin(aproblem.nreceptors(), aproblem.nsources());
 
     for (int i = 0; i < static_cast<int>(aproblem.nsources()); i++) // boucle sur les sources
     {
@@ -101,14 +127,16 @@ bool TYANIME3DSolver::solve(const tympan::AcousticProblemModel& aproblem,
             tabSpectre[i][j].setEtat(SPECTRE_ETAT_LIN);
             tabSpectre[i][j].setType(SPECTRE_TYPE_LP);
 
-            matrix(j, i) = tabSpectre[i][j];
+            aresult.push_spectrum(j, i, tabSpectre[i][j]);
         }
     }
 
+    exportTimer.stop();
+
 #else
 
-    tympan::SpectrumMatrix& matrix = aresult.get_data();
-    matrix.resize(aproblem.nreceptors(), aproblem.nsources());
+    tympan::ScopedTimer exportTimer(stats, "result_export");
+    aresult.begin(aproblem.nreceptors(), aproblem.nsources());
 
     size_t nb_srcs = aproblem.nsources();
     size_t nb_rcpt = aproblem.nreceptors();
@@ -120,10 +148,12 @@ bool TYANIME3DSolver::solve(const tympan::AcousticProblemModel& aproblem,
             tympan::Spectrum sLP;
             sLP.setType(SPECTRE_TYPE_LP);
 
-            matrix(j, i) = sLP;
+            aresult.push_spectrum(j, i, sLP);
         }
     }
 
+    exportTimer.stop();
+
 #endif //__ONLY_RAYS__
 
     // Do not keep rays (for a noise map for example)
@@ -132,12 +162,20 @@ bool TYANIME3DSolver::solve(const tympan::AcousticProblemModel& aproblem,
     // Curve rays (as in meteo field) if meteo is activated
 	if (config->UseMeteo)
     {
+        tympan::ScopedTimer timer(stats, "acoustic_post_processing");
         for (unsigned int i = 0; i < tabRays.size(); i++)
         {
             tabRays[i]->tyRayCorrection( apf.get_geometry_modifier() );
         }
     }
 
+    // Rays are pushed to the result sink (if any) once corrected
+    {
+        tympan::ScopedTimer timer(stats, "result_export");
+        aresult.flush_path_data();
+        aresult.end();
+    }
+
     if (config->showScene)
     {
         apf.get_geometry_modifier()->save_to_file("computed_nappe.ply");
@@ -34,13 +34,13 @@ class TYANIME3DFaceSelector;
 class Lancer;
 
 /**
-* \struct TYStructSurfIntersect
+* \struct TYANIME3DStructSurfIntersect
 * Structure storing all the informations in Tympan in a format easily convertible.
 * Informations idFace, idBuilding, idEtage, spectreAbsoMat, G are not mandatory.
 * It is also possible to add informations to answer to a specific need for a new acoustic method
 * For instance : the developer might choose to keep resistivity instead of G coefficient.
 */
-struct TYStructSurfIntersect
+struct TYANIME3DStructSurfIntersect
 {
     OMatrix matInv;                         //!< Inverse matrix used for the infrastructure faces
     TabPoint3D tabPoint;                    //!< Points array used during the pre-selection
@@ -99,7 +99,7 @@ public:
 
 protected:
 
-    TYStructSurfIntersect* _tabPolygon; //!< Array containing all the informations relative to a site geometry and associated material to each face
+    TYANIME3DStructSurfIntersect* _tabPolygon; //!< Array containing all the informations relative to a site geometry and associated material to each face
 
     size_t _tabPolygonSize; //!< Array size of _tabPolygon
 
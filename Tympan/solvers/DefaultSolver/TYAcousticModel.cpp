@@ -20,6 +20,7 @@
 #include "Tympan/core/defines.h"
 #include "Tympan/models/solver/config.h"
 #include "Tympan/models/common/plan.h"
+#include "Tympan/models/common/spectrum_kernels.h"
 #include "Tympan/solvers/DefaultSolver/TYTrajet.h"
 #include "Tympan/solvers/DefaultSolver/TYSolver.h"
 #include "Tympan/models/common/mathlib.h"
@@ -65,12 +66,21 @@ void TYAcousticModel::init()
     _lambda = OSpectre::getLambda(pSolverAtmos->compute_c());
     // Coefficient multiplicateur pour le calcul des reflexions supplementaires en condition favorable
     _paramH = config->H1parameter;
+    // Memorisation des spectres d'attenuation (les spectres dependent de l'atmosphere courante)
+    _attenuationCache.setEnabled(config->UseAttenuationCache);
+    _attenuationCache.setTolerance(config->AttenuationCacheTolerance);
+    _attenuationCache.clear();
 }
 
 
+void TYAcousticModel::initSourceData(const tympan::AcousticSource& source, TYSourceData& sourceData) const
+{
+    sourceData.groundDistance = groundDistance(source.position);
+}
+
 void TYAcousticModel::compute(  const std::deque<TYSIntersection>& tabIntersect, TYTrajet& trajet, 
                                 TabPoint3D& ptsTop, TabPoint3D& ptsLeft,
-                                TabPoint3D& ptsRight )
+                                TabPoint3D& ptsRight, const TYSourceData* sourceData )
 {
     bool vertical = true, horizontal = false;
 
@@ -109,19 +119,23 @@ void TYAcousticModel::compute(  const std::deque<TYSIntersection>& tabIntersect,
 
     TYTabChemin& tabChemins = trajet.getChemins();
 
+    // Pente moyenne sur le trajet source-recepteur, commune a tous les chemins
+    OSegment3D penteMoyenne;
+    meanSlope(rayon, penteMoyenne, sourceData);
+
     // Calcul des parcours lateraux
     // 1. Vertical
-    computeCheminsAvecEcran(rayon, source, ptsTop, vertical, tabChemins, distance, conditionFav);
+    computeCheminsAvecEcran(rayon, source, ptsTop, vertical, tabChemins, distance, conditionFav, &penteMoyenne);
 
     // 2. Horizontal gauche
-    computeCheminsAvecEcran(rayon, source, ptsLeft, horizontal, tabChemins, distance, conditionFav);
+    computeCheminsAvecEcran(rayon, source, ptsLeft, horizontal, tabChemins, distance, conditionFav, &penteMoyenne);
 
     // 3. Horizontal droite
-    computeCheminsAvecEcran(rayon, source, ptsRight, horizontal, tabChemins, distance, conditionFav);
+    computeCheminsAvecEcran(rayon, source, ptsRight, horizontal, tabChemins, distance, conditionFav, &penteMoyenne);
 
     if (tabChemins.size() == 0)
     {
-        computeCheminSansEcran(rayon, source, tabChemins, distance, conditionFav);
+        computeCheminSansEcran(rayon, source, tabChemins, distance, conditionFav, &penteMoyenne);
     }
 
     // Calcul des reflexions si necessaire
@@ -130,7 +144,7 @@ void TYAcousticModel::compute(  const std::deque<TYSIntersection>& tabIntersect,
     // On calcule systematiquement le chemin a plat sans obstacle
     // pour limiter l'effet d'ecran a basse frequence
     TYTabChemin& tabCheminsSansEcran = trajet.getCheminsDirect();
-    computeCheminAPlat(rayon, source, tabCheminsSansEcran, distance);
+    computeCheminAPlat(rayon, source, tabCheminsSansEcran, distance, &penteMoyenne);
 
     // Calcul la pression cumulee de tous les chemins au point de reception du trajet
     solve(trajet);
@@ -140,13 +154,15 @@ void TYAcousticModel::compute(  const std::deque<TYSIntersection>& tabIntersect,
     tabCheminsSansEcran.clear();
 }
 
-void TYAcousticModel::computeCheminAPlat(const OSegment3D& rayon, const tympan::AcousticSource& source, TYTabChemin& TabChemins, double distance) const
+void TYAcousticModel::computeCheminAPlat(const OSegment3D& rayon, const tympan::AcousticSource& source, TYTabChemin& TabChemins, double distance,
+                                         const OSegment3D* penteCalculee) const
 {
     TYTabEtape tabEtapes;
 
     // Calcul de la pente moyenne sur le trajet source-recepteur
     OSegment3D penteMoyenne;
-    meanSlope(rayon, penteMoyenne);
+    if (penteCalculee) { penteMoyenne = *penteCalculee; }
+    else { meanSlope(rayon, penteMoyenne); }
 
     // Etape directe Source-Recepteur
     TYEtape etape1;
@@ -161,7 +177,7 @@ void TYAcousticModel::computeCheminAPlat(const OSegment3D& rayon, const tympan::
     tabEtapes.push_back(etape1);    // Ajout de l'etape directe
     chemin1.setLongueur(distance);  // Dans ce cas, la longueur = la distance source/recepteur
     chemin1.setDistance(distance);
-    chemin1.calcAttenuation(tabEtapes, *pSolverAtmos);
+    chemin1.calcAttenuation(tabEtapes, *pSolverAtmos, &_attenuationCache);
 
     TabChemins.push_back(chemin1);
     tabEtapes.clear(); // Vide le tableau des etapes
@@ -225,13 +241,14 @@ void TYAcousticModel::computeCheminAPlat(const OSegment3D& rayon, const tympan::
 
     chemin2.setLongueur(rr);
     chemin2.setDistance(distance);
-    chemin2.calcAttenuation(tabEtapes, *pSolverAtmos);
+    chemin2.calcAttenuation(tabEtapes, *pSolverAtmos, &_attenuationCache);
     TabChemins.push_back(chemin2);
 
     tabEtapes.clear(); // Vide le tableau des etapes
 }
 
-void TYAcousticModel::computeCheminSansEcran(const OSegment3D& rayon, const tympan::AcousticSource& source, TYTabChemin& TabChemin, double distance, bool conditionFav) const
+void TYAcousticModel::computeCheminSansEcran(const OSegment3D& rayon, const tympan::AcousticSource& source, TYTabChemin& TabChemin, double distance, bool conditionFav,
+                                             const OSegment3D* penteCalculee) const
 {
     /*
         LE CALCUL POUR UN TRAJET SANS OBSTACLE COMPORTE UN CHEMIN DIRECT
@@ -244,7 +261,8 @@ void TYAcousticModel::computeCheminSansEcran(const OSegment3D& rayon, const tymp
 
     // Calcul de la pente moyenne sur le trajet source-recepteur
     OSegment3D penteMoyenne;
-    meanSlope(rayon, penteMoyenne);
+    if (penteCalculee) { penteMoyenne = *penteCalculee; }
+    else { meanSlope(rayon, penteMoyenne); }
 
 
     // 1. Conditions homogenes sans vegetation
@@ -257,7 +275,7 @@ void TYAcousticModel::computeCheminSansEcran(const OSegment3D& rayon, const tymp
     tabEtapes.push_back(Etapes[0]); // Ajout de l'etape directe
     chemin.setLongueur(distance);  // Dans ce cas, la longueur = la distance source/recepteur
     chemin.setDistance(distance);
-    chemin.calcAttenuation(tabEtapes, *pSolverAtmos);
+    chemin.calcAttenuation(tabEtapes, *pSolverAtmos, &_attenuationCache);
     TabChemin.push_back(chemin) ; // (4) Ajout du chemin dans le tableau des chemins de la frequence
 
     tabEtapes.clear(); // Vide le tableau des etapes
@@ -268,7 +286,7 @@ void TYAcousticModel::computeCheminSansEcran(const OSegment3D& rayon, const tymp
     tabEtapes.push_back(Etapes[2]); // Ajout de l'etape apres reflexion
     chemin.setLongueur(rr);
     chemin.setDistance(distance);
-    chemin.calcAttenuation(tabEtapes, *pSolverAtmos);
+    chemin.calcAttenuation(tabEtapes, *pSolverAtmos, &_attenuationCache);
     TabChemin.push_back(chemin);
 
     tabEtapes.clear(); // Vide le tableau des etapes
@@ -371,7 +389,7 @@ void TYAcousticModel::computeCheminSansEcran(const OSegment3D& rayon, const tymp
             // Ajout du premier chemin au trajet
             chemin.setLongueur(rr);
             chemin.setDistance(distance);
-            chemin.calcAttenuation(tabEtapes, *pSolverAtmos);
+            chemin.calcAttenuation(tabEtapes, *pSolverAtmos, &_attenuationCache);
             TabChemin.push_back(chemin) ; // (2) Ajout du chemin dans le tableau des chemins de la frequence
 
             tabEtapes.clear(); // On s'assure que le tableau des etapes est vide
@@ -430,7 +448,7 @@ void TYAcousticModel::computeCheminSansEcran(const OSegment3D& rayon, const tymp
             // Ajout du deuxieme chemin
             chemin.setDistance(distance);
             chemin.setLongueur(rr);
-            chemin.calcAttenuation(tabEtapes, *pSolverAtmos);
+            chemin.calcAttenuation(tabEtapes, *pSolverAtmos, &_attenuationCache);
             TabChemin.push_back(chemin) ; // (3) Ajout du chemin dans le tableau des chemins de la frequence
             tabEtapes.clear();
             Etapes.clear();
@@ -440,7 +458,8 @@ void TYAcousticModel::computeCheminSansEcran(const OSegment3D& rayon, const tymp
 }
 
 
-bool TYAcousticModel::computeCheminsAvecEcran(const OSegment3D& rayon, const tympan::AcousticSource& source, const TabPoint3D& pts, const bool vertical, TYTabChemin& TabChemins, double distance, bool conditionFav) const
+bool TYAcousticModel::computeCheminsAvecEcran(const OSegment3D& rayon, const tympan::AcousticSource& source, const TabPoint3D& pts, const bool vertical, TYTabChemin& TabChemins, double distance, bool conditionFav,
+                                              const OSegment3D* penteCalculee) const
 {
     /* ============================================================================================================
         07/03/2005 : Suppression du calcul ddes pentes moyennes avant et apres l'obstacle.
@@ -468,7 +487,8 @@ bool TYAcousticModel::computeCheminsAvecEcran(const OSegment3D& rayon, const tym
     double longNoReflex = 0.0;
 
     //// Calcul de la pente moyenne sur le trajet source-recepteur
-    meanSlope(rayon, penteMoyenneTotale);
+    if (penteCalculee) { penteMoyenneTotale = *penteCalculee; }
+    else { meanSlope(rayon, penteMoyenneTotale); }
 
     //                              /*--- AVANT L'OBSTACLE ---*/
 
@@ -579,22 +599,22 @@ bool TYAcousticModel::computeCheminsAvecEcran(const OSegment3D& rayon, const tym
 
     // Chemin reflexion au sol avant et apres l'obstacle
     chemin.setLongueur(longTwoReflex);
-    chemin.calcAttenuation(tabTwoReflex, *pSolverAtmos);
+    chemin.calcAttenuation(tabTwoReflex, *pSolverAtmos, &_attenuationCache);
     TabChemins.push_back(chemin);
 
     // Chemin avec une reflexion avant
     chemin.setLongueur(longOneReflexBefore);
-    chemin.calcAttenuation(tabOneReflexBefore, *pSolverAtmos);
+    chemin.calcAttenuation(tabOneReflexBefore, *pSolverAtmos, &_attenuationCache);
     TabChemins.push_back(chemin);
 
     // Chemin avec une reflexion apres
     chemin.setLongueur(longOneReflexAfter);
-    chemin.calcAttenuation(tabOneReflexAfter, *pSolverAtmos);
+    chemin.calcAttenuation(tabOneReflexAfter, *pSolverAtmos, &_attenuationCache);
     TabChemins.push_back(chemin);
 
     //Chemin sans reflexion sur le sol
     chemin.setLongueur(longNoReflex);
-    chemin.calcAttenuation(tabNoReflex, *pSolverAtmos);
+    chemin.calcAttenuation(tabNoReflex, *pSolverAtmos, &_attenuationCache);
     TabChemins.push_back(chemin);
 
     tabTwoReflex.clear();
@@ -922,7 +942,7 @@ void TYAcousticModel::computeCheminReflexion(   const std::deque<TYSIntersection
                 Chemin.setType(CHEMIN_REFLEX);
                 Chemin.setLongueur(rr);
                 Chemin.setDistance(distance);
-                Chemin.calcAttenuation(tabEtapes, *pSolverAtmos);
+                Chemin.calcAttenuation(tabEtapes, *pSolverAtmos, &_attenuationCache);
 
                 TabChemins.push_back(Chemin); // Mise en place du chemin dans la table des chemins
                 tabEtapes.clear();
@@ -938,7 +958,6 @@ OSpectre TYAcousticModel::calculC(const double& epaisseur) const
     // C = (1 + (5*lambda/epaisseur)i) / (1/3 + (5*lambda/epaisseur)i)
 
     OSpectre C = OSpectre::getEmptyLinSpectre();
-    OSpectre opLambda;
 
     if (epaisseur < 1.0E-2)
     {
@@ -947,12 +966,14 @@ OSpectre TYAcousticModel::calculC(const double& epaisseur) const
     else
     {
         const double unTiers = 1.0 / 3.0;
+        tympan::SpectrumValues opLambda, denominateur;
 
-        opLambda = _lambda.mult(5.0 / epaisseur); // (5*lambda/e)
-        opLambda = opLambda.mult(opLambda); // (5*lambda/e)i
+        tympan::spectrum_mul(_lambda.getTabValReel(), 5.0 / epaisseur, opLambda.data()); // (5*lambda/e)
+        tympan::spectrum_mul(opLambda.data(), opLambda.data(), opLambda.data()); // (5*lambda/e)i
 
-        C = opLambda.sum(1.0); // 1 + (5*lambda/e)i
-        C = C.div(opLambda.sum(unTiers)); // (1 + (5*lambda/e)i) / (1/3 + (5*lambda/epaisseur)i)
+        tympan::spectrum_add(opLambda.data(), 1.0, C.getTabValReel()); // 1 + (5*lambda/e)i
+        tympan::spectrum_add(opLambda.data(), unTiers, denominateur.data()); // 1/3 + (5*lambda/e)i
+        tympan::spectrum_div(C.getTabValReel(), denominateur.data(), C.getTabValReel()); // (1 + (5*lambda/e)i) / (1/3 + (5*lambda/epaisseur)i)
     }
 
     C.setType(SPECTRE_TYPE_AUTRE);  // Ni Attenuation, ni Absorption
@@ -964,10 +985,6 @@ OSpectre TYAcousticModel::calculAttDiffraction(const OSegment3D& rayon, const OS
 {
     double rd;
 
-    OSpectre s;
-
-    OSpectre C = calculC(epaisseur); // Facteur correctif lie a l'epaisseur de l'ecran
-
     // Si le chemin comporte une reflexion sur le sol (et une seule), on prend le trajet source image recepteur
     if (miroir)
     {
@@ -1022,11 +1039,23 @@ OSpectre TYAcousticModel::calculAttDiffraction(const OSegment3D& rayon, const OS
     double delta = re - rd ; // difference de marche
     delta = delta <= 0 ? 0.0 : delta;
 
+    return _attenuationCache.getDiffraction(delta, epaisseur, vertical,
+                                            [this, vertical](double d, double e) { return computeAttDiffraction(d, e, vertical); });
+}
+
+OSpectre TYAcousticModel::computeAttDiffraction(double delta, double epaisseur, bool vertical) const
+{
+    OSpectre s = OSpectre::getEmptyLinSpectre();
+
+    OSpectre C = calculC(epaisseur); // Facteur correctif lie a l'epaisseur de l'ecran
+
     // Attenuation apportee par la diffraction = sqrt(3 + (40 * C * delta)/lambda)
+    // (lambda est strictement positif et la valeur superieure a 3 : pas de cas invalide)
 
-    s = _lambda.invMult(40 * delta); // =40*delta/lambda
-    s = s.mult(C); // 40*delta*C/lambda
-    s = s.sum(3.0);
+    const tympan::SpectrumValues delta40(40 * delta);
+    tympan::spectrum_div(delta40.data(), _lambda.getTabValReel(), s.getTabValReel()); // =40*delta/lambda
+    tympan::spectrum_mul(s.getTabValReel(), C.getTabValReel(), s.getTabValReel()); // 40*delta*C/lambda
+    tympan::spectrum_add(s.getTabValReel(), 3.0, s.getTabValReel());
 
     // Si la diffraction a lieu dans le plan vertical (arete horizontale),
     // les attenuations minimales et maximales sont limitees respectivement
@@ -1037,8 +1066,9 @@ OSpectre TYAcousticModel::calculAttDiffraction(const OSegment3D& rayon, const OS
     }
 
     s.setType(SPECTRE_TYPE_ATT);
+    tympan::spectrum_sqrt(s.getTabValReel(), s.getTabValReel());
 
-    return s.racine();
+    return s;
 }
 
 OSpectre TYAcousticModel::limAttDiffraction(const OSpectre& sNC, const OSpectre& C) const
@@ -1050,27 +1080,16 @@ OSpectre TYAcousticModel::limAttDiffraction(const OSpectre& sNC, const OSpectre&
     double lim25dB = pow(10.0, (25.0 / 10.0));
     double lim0dB = pow(10.0, (0.0 / 10.0));
 
-    double valeur;
-
-    for (unsigned int i = 0 ; i < sNC.getNbValues() ; i++)
+    // Limite haute : 20 dB en ecran mince, 25 dB en ecran epais ou multiple
+    tympan::SpectrumValues limMax;
+    for (unsigned int i = 0 ; i < TY_SPECTRE_DEFAULT_NB_ELMT ; i++)
     {
-        valeur = sNC.getTabValReel()[i];
-
-        valeur = valeur < lim0dB ? lim0dB : valeur ;  // L'attenuation ne peut etre inferieure a 1
-
-        if ((C.getTabValReel()[i] - 1) <= 1e-2) // Comportement ecran mince
-        {
-            valeur = valeur > lim20dB ? lim20dB : valeur;
-        }
-        else    // Comportement ecran epais ou multiple
-        {
-            valeur = valeur > lim25dB ? lim25dB : valeur;
-        }
-
-        s.getTabValReel()[i] = valeur;
-
+        limMax[i] = (C.getTabValReel()[i] - 1) <= 1e-2 ? lim20dB : lim25dB;
     }
 
+    // L'attenuation ne peut etre inferieure a 1
+    tympan::spectrum_clamp(sNC.getTabValReel(), lim0dB, limMax.data(), s.getTabValReel());
+
     return s;
 }
 
@@ -1090,14 +1109,9 @@ bool TYAcousticModel::solve(TYTrajet& trajet)
     SLp = trajet.asrc.spectrum.mult(divGeom);
 
     //  (W.rho.c/4.pi.Rdi)*Attenuations du trajet
-    if (_interference)
-    {
-        SLp = SLp.mult(trajet.getPInterference(*pSolverAtmos));
-    }
-    else
-    {
-        SLp = SLp.mult(trajet.getPEnergetique(*pSolverAtmos));
-    }
+    const OSpectre attenuation = _interference ? trajet.getPInterference(*pSolverAtmos) :
+                                                 trajet.getPEnergetique(*pSolverAtmos);
+    tympan::spectrum_mul(SLp.getTabValReel(), attenuation.getTabValReel(), SLp.getTabValReel());
     SLp.setType(SPECTRE_TYPE_LP); //Le spectre au point est bien un spectre de pression !
 
     return true;
@@ -1114,7 +1128,7 @@ OSpectreComplex TYAcousticModel::getReflexionSpectrumAt(const OSegment3D& incide
     Ray ray1( start, vec3(0., 0., -1.) );
     ray1.setMaxt ( 20000 );
 
-    std::list<Intersection> LI;
+    IntersectionBuffer LI;
 
     static_cast<double>( _solver.getScene()->getAccelerator()->traverse( &ray1, LI ) );
 
@@ -1137,7 +1151,7 @@ OSpectreComplex TYAcousticModel::getReflexionSpectrumAt(const OSegment3D& incide
             _solver.getTabPolygon()[indexFace].tabPoint[2]._z) ;
         Ray ray(start, vec3(0,0,-1));
         ray.setMaxt ( 20000 );
-        std::list<Intersection> LI2;
+        IntersectionBuffer LI2;
         static_cast<double>( _solver.getScene()->getAccelerator()->traverse( &ray, LI2 ) );
         assert( !LI2.empty() );
         indexFace = LI2.begin()->p->getPrimitiveId();
@@ -1153,27 +1167,41 @@ OSpectreComplex TYAcousticModel::getReflexionSpectrumAt(const OSegment3D& incide
     //angle = ABS(M_PI/2. - angle);
     double angle = (direction*-1).angle(OVector3D(incident._ptB, segPente._ptA));
     // Compute reflexion spectrum
-    spectre = mat->get_absorption(angle, length);
+    spectre = _attenuationCache.getReflexion(*mat, angle, length);
 
     return spectre;
 }
 
-void TYAcousticModel::meanSlope(const OSegment3D& director, OSegment3D& slope) const
+void TYAcousticModel::meanSlope(const OSegment3D& director, OSegment3D& slope, const TYSourceData* sourceData) const
 {
     // Search for primitives under the two segment extremities
 
     // To begin : initialize slope
     slope = director;
 
-    // first one
-    OPoint3D pt = director._ptA;
+    // first one (the source: known once per task if sourceData is given)
+    double distance1 = sourceData ? sourceData->groundDistance : groundDistance(director._ptA);
+
+    // Second one
+    double distance2 = groundDistance(director._ptB);
+
+    // Compute projection on the ground of segment points suppose sol is under the points ...
+    slope._ptA._z = director._ptA._z - (distance1-1000.);
+    slope._ptB._z = director._ptB._z - (distance2-1000.);
+}
+
+
+double TYAcousticModel::groundDistance(const OPoint3D& point) const
+{
+    OPoint3D pt = point;
     pt._z += 1000.;
     vec3 start = OPoint3Dtovec3(pt);
     Ray ray1( start, vec3(0., 0., -1.) );
 
-    std::list<Intersection> LI;
+    IntersectionBuffer LI;
 
     double distance1 = static_cast<double>( _solver.getScene()->getAccelerator()->traverse( &ray1, LI ) );
+    // An error can occur if some elements are outside of the grip (emprise)
     assert( distance1 > 0. );
     assert(!LI.empty());
 
@@ -1185,46 +1213,14 @@ void TYAcousticModel::meanSlope(const OSegment3D& director, OSegment3D& slope) c
             _solver.getTabPolygon()[indexFace].tabPoint[2]._z) ;
         Ray ray(start, vec3(0,0,-1));
         ray.setMaxt ( 20000 );
-        std::list<Intersection> LI2;
+        IntersectionBuffer LI2;
         double distance = static_cast<double>( _solver.getScene()->getAccelerator()->traverse( &ray, LI2 ) );
         assert(distance > 0.);
         if (LI2.empty())
             break;
         distance1 += distance;
         indexFace = LI2.begin()->p->getPrimitiveId();
-	}
-
-    // Second one
-    LI.clear();
-    pt = director._ptB;
-    pt._z += 1000.;
-    start = OPoint3Dtovec3(pt);
-    Ray ray2( start, vec3(0., 0., -1.) );
-
-    double distance2 = static_cast<double>( _solver.getScene()->getAccelerator()->traverse( &ray2, LI ) );
-    // An error can occur if some elements are outside of the grip (emprise)
-    assert( distance2 > 0. );
-    assert(!LI.empty());
-
-    indexFace = LI.begin()->p->getPrimitiveId();
-
-    // Avoid cases where the extremities are above infrastructure elements
-    while(_solver.getTabPolygon()[indexFace].is_infra()){
-        start.z = (decimal)min(min(_solver.getTabPolygon()[indexFace].tabPoint[0]._z, _solver.getTabPolygon()[indexFace].tabPoint[1]._z),
-            _solver.getTabPolygon()[indexFace].tabPoint[2]._z) ;
-        Ray ray(start, vec3(0,0,-1));
-        ray.setMaxt ( 20000 );
-        std::list<Intersection> LI2;
-        double distance = static_cast<double>( _solver.getScene()->getAccelerator()->traverse( &ray, LI2 ) );
-        assert(distance > 0.);
-        if (LI2.empty())
-            break;
-        distance2 += distance;
-        indexFace = LI2.begin()->p->getPrimitiveId();
-        }
+    }
 
-    // Compute projection on the ground of segment points suppose sol is under the points ...
-    slope._ptA._z = director._ptA._z - (distance1-1000.);
-    slope._ptB._z = director._ptB._z - (distance2-1000.);
+    return distance1;
 }
-
@@ -19,6 +19,7 @@
 #include "Tympan/core/interfaces.h"
 #include "Tympan/solvers/DefaultSolver/TYChemin.h"
 #include "Tympan/solvers/DefaultSolver/TYSolverDefines.h"
+#include "Tympan/solvers/DefaultSolver/TYAttenuationCache.h"
 #include <gtest/gtest_prod.h>
 
 class TYTrajet;
@@ -34,13 +35,20 @@ public:
     TYAcousticModel(TYSolver& solver); //<! Constructor
     virtual ~TYAcousticModel();	//<! Destructor
 
+    /**
+     * @brief Compute the paths and the spectrum of a journey
+     * @param sourceData Data of the source of the journey (computed if NULL)
+     */
     virtual void compute(const std::deque<TYSIntersection>& tabIntersect,
                          TYTrajet& trajet, TabPoint3D& ptsTop, TabPoint3D& ptsLeft,
-                         TabPoint3D& ptsRight );
+                         TabPoint3D& ptsRight, const TYSourceData* sourceData = NULL);
 
     /// Initialize the acoustic model
     void init();
 
+    /// Compute the data of a source used by all its journeys (ground under the source)
+    void initSourceData(const tympan::AcousticSource& source, TYSourceData& sourceData) const;
+
     /**
      * @brief Compute the segment path from the list of the points of the TYTrajet journey. It takes in account the ground reflection.
      * @param [in] rayon A segment describing the acoustic ray.
@@ -49,13 +57,15 @@ public:
      * @param [in] vertical boolean to indicate we deal with the vertical plane
      * @param [out] TabChemins Paths list of the journey
      * @param [out] distance Journey distance
+     * @param [in] penteCalculee Mean slope of the journey (computed if NULL)
      *
      * @return <code>true</code> if succeeds;
      *         <code>false</code> otherwise.
      */
     virtual bool computeCheminsAvecEcran(const OSegment3D& rayon, const tympan::AcousticSource& source,
                                          const TabPoint3D& pts, const bool vertical,
-                                         TYTabChemin& TabChemins, double distance, bool conditionFav = false) const;
+                                         TYTabChemin& TabChemins, double distance, bool conditionFav = false,
+                                         const OSegment3D* penteCalculee = NULL) const;
 
     /**
      * @brief Compute the list of path generated by reflection on the vertical walls.
@@ -97,8 +107,10 @@ public:
      * @param [in] source The acoustic source.
      * @param [out] TabChemins Paths list of the journey generated (1 or 2 under favorables conditions).
      * @param [out] distance Journey distance
+     * @param [in] penteCalculee Mean slope of the journey (computed if NULL)
      */
-    void computeCheminSansEcran(const OSegment3D& rayon, const tympan::AcousticSource& source, TYTabChemin& TabChemins, double distance, bool conditionFav = false) const;
+    void computeCheminSansEcran(const OSegment3D& rayon, const tympan::AcousticSource& source, TYTabChemin& TabChemins, double distance, bool conditionFav = false,
+                                const OSegment3D* penteCalculee = NULL) const;
 
     /**
      * @brief Compute the list of paths for a perfectly flat and reflective ground.
@@ -106,8 +118,10 @@ public:
      * @param [in] source The acoustic source.
      * @param [out] TabChemins Paths list of the journey generated.
      * @param [out] distance Journey distance
+     * @param [in] penteCalculee Mean slope of the journey (computed if NULL)
      */
-    void computeCheminAPlat(const OSegment3D& rayon, const tympan::AcousticSource& source, TYTabChemin& TabChemins, double distance) const;
+    void computeCheminAPlat(const OSegment3D& rayon, const tympan::AcousticSource& source, TYTabChemin& TabChemins, double distance,
+                            const OSegment3D* penteCalculee = NULL) const;
 
 
     /**
@@ -170,7 +184,15 @@ public:
      */
     bool solve(TYTrajet& trajet);
 
+    /// Cache of the attenuation spectra (hit and miss counters)
+    const TYAttenuationCache& getAttenuationCache() const { return _attenuationCache; }
+
 private :
+    /*!
+     * \brief Compute the attenuation from the diffraction for a walking difference (see calculAttDiffraction)
+     */
+    OSpectre computeAttDiffraction(double delta, double epaisseur, bool vertical) const;
+
     /*!
      * \brief Find Reflexion spectrum at point defined by the end of an incident segment.
      */
@@ -178,8 +200,14 @@ private :
 
     /*!
      * \brief Create a segment corresponding to the projection of "director" segment on the ground
+     * \param sourceData If not NULL, ground under the start of the segment (the source)
      */
-    void meanSlope(const OSegment3D& director, OSegment3D& slope) const;
+    void meanSlope(const OSegment3D& director, OSegment3D& slope, const TYSourceData* sourceData = NULL) const;
+
+    /*!
+     * \brief Distance from 1000 m above a point down to the ground under it (infrastructure faces are skipped)
+     */
+    double groundDistance(const OPoint3D& point) const;
 
 private:
     FRIEND_TEST(test_TYAcousticModel, calculAttDiffraction);
@@ -198,6 +226,9 @@ private:
     OSpectre _lambda;
     OSpectreComplex _absoNulle;
 
+    /// Attenuation spectra shared by the paths of the computation
+    mutable TYAttenuationCache _attenuationCache;
+
 
     /// Reference to the solver
     TYSolver& _solver;
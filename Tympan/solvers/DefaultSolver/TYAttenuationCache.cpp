@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <cmath>
+#include <cstring>
+
+#include "Tympan/models/common/atmospheric_conditions.h"
+#include "Tympan/models/solver/entities.hpp"
+#include "Tympan/models/solver/solver_stats.hpp"
+#include "TYAttenuationCache.h"
+
+/// Maximum number of spectra stored by kind (the spectra are still computed beyond)
+static const size_t TY_ATTENUATION_CACHE_MAX_ENTRIES = 16384;
+
+/// Names of the kinds in the solver statistics
+static const char* const TY_ATTENUATION_CACHE_KIND_NAMES[] = { "atmospheric", "reflexion", "diffraction" };
+
+TYAttenuationCache::TYAttenuationCache() : _enabled(false), _tolerance(0.), _logStep(0.)
+{
+    clear();
+}
+
+TYAttenuationCache::~TYAttenuationCache()
+{
+}
+
+void TYAttenuationCache::setTolerance(double tolerance)
+{
+    _tolerance = tolerance > 0. ? tolerance : 0.;
+    _logStep = std::log1p(_tolerance);
+}
+
+template <class Spectrum>
+void TYAttenuationCache::clearShards(Shard<Spectrum>* shards)
+{
+    for (unsigned int i = 0; i < NB_SHARDS; i++)
+    {
+        TY_OMUTEXLOCKER_MUTEX(shards[i].mutex)
+        shards[i].map.clear();
+    }
+}
+
+template <class Spectrum>
+size_t TYAttenuationCache::countEntries(const Shard<Spectrum>* shards)
+{
+    size_t nbEntries = 0;
+    for (unsigned int i = 0; i < NB_SHARDS; i++)
+    {
+        TY_OMUTEXLOCKER_MUTEX(shards[i].mutex)
+        nbEntries += shards[i].map.size();
+    }
+    return nbEntries;
+}
+
+void TYAttenuationCache::clear()
+{
+    clearShards(_atmospheric);
+    clearShards(_reflexion);
+    clearShards(_diffraction);
+    for (int i = 0; i < NB_KINDS; i++)
+    {
+        _hits[i] = 0;
+        _misses[i] = 0;
+    }
+}
+
+double TYAttenuationCache::quantize(double value) const
+{
+    if ( (_logStep <= 0.) || !(value > 0.) )
+    {
+        return value;
+    }
+
+    // The rounded value only depends on the grid index so that all the values
+    // of a cell share exactly the same key and the same spectrum
+    return std::exp(std::floor(std::log(value) / _logStep + 0.5) * _logStep);
+}
+
+size_t TYAttenuationCache::KeyHash::operator()(const Key& key) const
+{
+    // FNV-1a like combination of the key fields
+    uint64_t h = 14695981039346656037ULL;
+    const uint64_t fields[4] = { static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key.owner)),
+                                 key.a, key.b, static_cast<uint64_t>(key.flag) };
+    for (int i = 0; i < 4; i++)
+    {
+        h = (h ^ fields[i]) * 1099511628211ULL;
+        h ^= h >> 32;
+    }
+    return static_cast<size_t>(h);
+}
+
+TYAttenuationCache::Key TYAttenuationCache::makeKey(const void* owner, double a, double b, int flag)
+{
+    Key key;
+    key.owner = owner;
+    std::memcpy(&key.a, &a, sizeof(key.a));
+    std::memcpy(&key.b, &b, sizeof(key.b));
+    key.flag = flag;
+    return key;
+}
+
+template <class Spectrum>
+Spectrum TYAttenuationCache::lookup(Shard<Spectrum>* shards, Kind kind, const Key& key,
+                                    const std::function<Spectrum()>& compute)
+{
+    // The high bits of the hash select the shard, the low ones the bucket
+    const size_t hash = KeyHash()(key);
+    Shard<Spectrum>& shard = shards[(hash >> 28) % NB_SHARDS];
+    {
+        TY_OMUTEXLOCKER_MUTEX(shard.mutex)
+        typename std::unordered_map<Key, Spectrum, KeyHash>::const_iterator it = shard.map.find(key);
+        if (it != shard.map.end())
+        {
+            _hits[kind].fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    _misses[kind].fetch_add(1, std::memory_order_relaxed);
+
+    // Computed outside of the lock: another thread may compute the same
+    // spectrum meanwhile, both results being identical
+    Spectrum spectrum = compute();
+
+    TY_OMUTEXLOCKER_MUTEX(shard.mutex)
+    if (shard.map.size() < TY_ATTENUATION_CACHE_MAX_ENTRIES / NB_SHARDS)
+    {
+        shard.map.insert(std::make_pair(key, spectrum));
+    }
+    return spectrum;
+}
+
+OSpectre TYAttenuationCache::getAtmosphericAbsorption(const AtmosphericConditions& atmos, double length)
+{
+    if (!_enabled) { return atmos.compute_length_absorption(length); }
+
+    const double qLength = quantize(length);
+    return lookup<OSpectre>(_atmospheric, ATMOSPHERIC, makeKey(&atmos, qLength, 0., 0),
+                            [&atmos, qLength]() { return atmos.compute_length_absorption(qLength); });
+}
+
+OSpectreComplex TYAttenuationCache::getReflexion(tympan::AcousticMaterialBase& material, double angle, double length)
+{
+    if (!_enabled) { return material.get_absorption(angle, length); }
+
+    const double qAngle = quantize(angle);
+    const double qLength = quantize(length);
+    return lookup<OSpectreComplex>(_reflexion, REFLEXION, makeKey(&material, qAngle, qLength, 0),
+                                   [&material, qAngle, qLength]() { return material.get_absorption(qAngle, qLength); });
+}
+
+OSpectre TYAttenuationCache::getDiffraction(double delta, double epaisseur, bool vertical,
+                                            const std::function<OSpectre(double, double)>& compute)
+{
+    if (!_enabled) { return compute(delta, epaisseur); }
+
+    const double qDelta = quantize(delta);
+    const double qEpaisseur = quantize(epaisseur);
+    return lookup<OSpectre>(_diffraction, DIFFRACTION, makeKey(NULL, qDelta, qEpaisseur, vertical ? 1 : 0),
+                            [&compute, qDelta, qEpaisseur]() { return compute(qDelta, qEpaisseur); });
+}
+
+unsigned long long TYAttenuationCache::getHits(Kind kind) const
+{
+    return _hits[kind].load(std::memory_order_relaxed);
+}
+
+unsigned long long TYAttenuationCache::getMisses(Kind kind) const
+{
+    return _misses[kind].load(std::memory_order_relaxed);
+}
+
+size_t TYAttenuationCache::getNbEntries(Kind kind) const
+{
+    switch (kind)
+    {
+        case ATMOSPHERIC : return countEntries(_atmospheric);
+        case REFLEXION : return countEntries(_reflexion);
+        case DIFFRACTION : return countEntries(_diffraction);
+        default : return 0;
+    }
+}
+
+void TYAttenuationCache::report(tympan::SolverStats& stats) const
+{
+    if (!_enabled) { return; }
+
+    for (int kind = 0; kind < NB_KINDS; kind++)
+    {
+        const std::string name(TY_ATTENUATION_CACHE_KIND_NAMES[kind]);
+        stats.add_count("attenuation_cache_hits/" + name, getHits(static_cast<Kind>(kind)));
+        stats.add_count("attenuation_cache_misses/" + name, getMisses(static_cast<Kind>(kind)));
+    }
+}
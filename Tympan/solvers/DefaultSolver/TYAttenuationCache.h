@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef __TY_ATTENUATION_CACHE__
+#define __TY_ATTENUATION_CACHE__
+
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+#include "Tympan/models/common/spectre.h"
+#include "threading.h"
+
+class AtmosphericConditions;
+namespace tympan
+{
+class AcousticMaterialBase;
+class SolverStats;
+}
+
+/**
+ * \class TYAttenuationCache
+ * \brief Memoization of the attenuation spectra computed by the default acoustic model
+ *
+ * The atmospheric absorption (by length), the ground reflection spectra (by
+ * material, incidence angle and length) and the diffraction attenuations (by
+ * walking difference, screen thickness and plane) are stored once computed and
+ * shared between the paths of the computation. The cache is thread safe: the
+ * entries are spread over shards chosen by key hash, each with its own mutex,
+ * and the counters are atomic.
+ *
+ * With a null tolerance (exact mode), keys are the exact input values and the
+ * results are identical to the ones computed without the cache. With a positive
+ * tolerance, distances and angles are rounded to a geometric grid of relative
+ * step tolerance and the spectra are computed at the rounded values. Exact keys
+ * rarely repeat on real sites, so the cache is only worth enabling with a
+ * tolerance; it is disabled by default.
+ *
+ * At most TY_ATTENUATION_CACHE_MAX_ENTRIES spectra are stored by kind (a few
+ * megabytes), the spectra being still computed beyond.
+ */
+class TYAttenuationCache
+{
+public:
+    /// Kinds of cached spectra
+    enum Kind
+    {
+        ATMOSPHERIC = 0,    //!< Atmospheric absorption
+        REFLEXION,          //!< Ground reflection spectrum
+        DIFFRACTION,        //!< Diffraction attenuation
+        NB_KINDS
+    };
+
+    TYAttenuationCache();  //!< Constructor
+    ~TYAttenuationCache(); //!< Destructor
+
+    /// Enable or disable the cache (spectra are always computed when disabled)
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool isEnabled() const { return _enabled; }
+
+    /// Set the relative tolerance on the keys (0 for exact keys)
+    void setTolerance(double tolerance);
+    double getTolerance() const { return _tolerance; }
+
+    /// Remove all the cached spectra and reset the counters
+    void clear();
+
+    /**
+     * \brief Round a positive value to the tolerance grid
+     * \return the value itself in exact mode or if it is not strictly positive
+     */
+    double quantize(double value) const;
+
+    /// Atmospheric absorption for a path of the given length
+    OSpectre getAtmosphericAbsorption(const AtmosphericConditions& atmos, double length);
+
+    /// Reflection spectrum of a material for the given incidence angle and path length
+    OSpectreComplex getReflexion(tympan::AcousticMaterialBase& material, double angle, double length);
+
+    /**
+     * \brief Diffraction attenuation for a walking difference and a screen thickness
+     * \param compute Function computing the spectrum from the (rounded) walking difference and thickness
+     */
+    OSpectre getDiffraction(double delta, double epaisseur, bool vertical,
+                            const std::function<OSpectre(double, double)>& compute);
+
+    /// Number of spectra found in the cache
+    unsigned long long getHits(Kind kind) const;
+    /// Number of spectra computed
+    unsigned long long getMisses(Kind kind) const;
+    /// Number of spectra stored
+    size_t getNbEntries(Kind kind) const;
+
+    /// Add the hits and misses counters by kind to the solver statistics
+    void report(tympan::SolverStats& stats) const;
+
+private:
+    /// Key of a cached spectrum (bit patterns of the rounded values)
+    struct Key
+    {
+        const void* owner;
+        uint64_t a;
+        uint64_t b;
+        int flag;
+
+        bool operator==(const Key& other) const
+        {
+            return owner == other.owner && a == other.a && b == other.b && flag == other.flag;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    /// Number of shards of each kind
+    static const unsigned int NB_SHARDS = 16;
+
+    /// Part of the entries of a kind, protected by its own mutex
+    template <class Spectrum>
+    struct Shard
+    {
+        std::unordered_map<Key, Spectrum, KeyHash> map;
+        TY_MUTEX(mutex)
+    };
+
+    static Key makeKey(const void* owner, double a, double b, int flag);
+
+    template <class Spectrum>
+    Spectrum lookup(Shard<Spectrum>* shards, Kind kind, const Key& key,
+                    const std::function<Spectrum()>& compute);
+
+    template <class Spectrum>
+    static void clearShards(Shard<Spectrum>* shards);
+
+    template <class Spectrum>
+    static size_t countEntries(const Shard<Spectrum>* shards);
+
+    bool _enabled;
+    double _tolerance;
+    double _logStep; //!< log(1 + tolerance)
+
+    Shard<OSpectre> _atmospheric[NB_SHARDS];
+    Shard<OSpectreComplex> _reflexion[NB_SHARDS];
+    Shard<OSpectre> _diffraction[NB_SHARDS];
+
+    std::atomic<unsigned long long> _hits[NB_KINDS];
+    std::atomic<unsigned long long> _misses[NB_KINDS];
+};
+
+#endif // __TY_ATTENUATION_CACHE__
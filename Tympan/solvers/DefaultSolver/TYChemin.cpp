@@ -15,6 +15,7 @@
 
 #include "TYChemin.h"
 #include "Tympan/models/solver/config.h"
+#include "TYAttenuationCache.h"
 
 
 TYChemin::TYChemin() :  _typeChemin(CHEMIN_DIRECT), _longueur(0.0), _distance(0.0), _eq_path(nullptr)
@@ -68,10 +69,14 @@ bool TYChemin::operator!=(const TYChemin& other) const
     return !operator==(other);
 }
 
-void TYChemin::calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericConditions& atmos)
+void TYChemin::calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericConditions& atmos, TYAttenuationCache* cache)
 {
     unsigned int i;
 
+    // Attenuation atmospherique sur la longueur du chemin
+    OSpectre absoAtmos = cache ? cache->getAtmosphericAbsorption(atmos, _longueur)
+                               : atmos.compute_length_absorption(_longueur);
+
     OSpectre phase = OSpectre::getEmptyLinSpectre(); //Reference de phase
 
     switch (_typeChemin)
@@ -79,7 +84,7 @@ void TYChemin::calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericCon
         case CHEMIN_DIRECT: // S*A*e^(i.k.Rd) avec A =attenuation atmosphere et S=directivite de la source
             _attenuation = tabEtapes[0]._Absorption; //directivite de la source (S)
 //            _attenuation = _attenuation.mult(atmos.getAtt(_longueur)); // S*A (A = attenuation atmospherique)
-            _attenuation = _attenuation.mult(atmos.compute_length_absorption(_longueur)); // S*A (A = attenuation atmospherique)
+            _attenuation = _attenuation.mult(absoAtmos); // S*A (A = attenuation atmospherique)
 
 //            phase = atmos.getKAcoust().mult(_longueur); // = kRd
             phase = atmos.get_k().mult(_longueur); // = kRd
@@ -89,7 +94,7 @@ void TYChemin::calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericCon
 
         case CHEMIN_SOL: //S*A*Q*e^(i.k.Rr)/Rr  //avec Q absorption du sol
             _attenuation = tabEtapes[0]._Absorption; //directivite de la source (S)
-            _attenuation = _attenuation.mult(atmos.compute_length_absorption(_longueur));// S*A (A = attenuation atmospherique)
+            _attenuation = _attenuation.mult(absoAtmos);// S*A (A = attenuation atmospherique)
 
             _attenuation = _attenuation.mult(tabEtapes[1]._Absorption); // S*A*Q
             _attenuation = _attenuation.mult(_distance / _longueur) ; //S*A*Q*Rd / Rr
@@ -103,7 +108,7 @@ void TYChemin::calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericCon
 
         case CHEMIN_ECRAN: //= S*A*Q/D*e^(i.k.Rd + eps) avec Q=module du coefficient de reflexion du sol et D=attenuation diffraction
             _attenuation = tabEtapes[0]._Absorption; // S = Directivite de la source
-            _attenuation = _attenuation.mult(atmos.compute_length_absorption(_longueur)); // S*A (A = attenuation atmospherique)
+            _attenuation = _attenuation.mult(absoAtmos); // S*A (A = attenuation atmospherique)
 
             phase = atmos.get_k().mult(_longueur); // = kRr
 
@@ -122,7 +127,7 @@ void TYChemin::calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericCon
 
         case CHEMIN_REFLEX:// S*A*Q*e^(i.k.Rr + eps)/Rr avec Q coefficient de reflexion de la paroi, eps = 0
             _attenuation = tabEtapes[0]._Absorption; // S = Directivite de la source
-            _attenuation = _attenuation.mult(atmos.compute_length_absorption(_longueur));// S*A (A = attenuation atmospherique)
+            _attenuation = _attenuation.mult(absoAtmos);// S*A (A = attenuation atmospherique)
 
             phase = atmos.get_k().mult(_longueur); // = kRr
 
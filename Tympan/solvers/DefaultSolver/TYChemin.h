@@ -22,6 +22,8 @@
 #include "Tympan/models/common/atmospheric_conditions.h"
 #include "Tympan/models/common/acoustic_path.h"
 
+class TYAttenuationCache;
+
 /**
  * \file TYChemin.h
  * \brief Representation of one of the most optimal path between source and receptor: S--->R
@@ -63,10 +65,11 @@ public:
     bool operator!=(const TYChemin& other) const;
 
     /**
-     * \fn void calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericConditions & atmos)
+     * \fn void calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericConditions & atmos, TYAttenuationCache* cache)
      * \brief Compute the global attenuation on the path
+     * \param cache If not NULL, cache used for the atmospheric absorption
      */
-    void calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericConditions& atmos);
+    void calcAttenuation(const TYTabEtape& tabEtapes, const AtmosphericConditions& atmos, TYAttenuationCache* cache = NULL);
 
     /**
      * \fn OSpectreComplex& getAttenuation()
@@ -17,6 +17,9 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "Tympan/core/defines.h"
 #include "Tympan/models/common/plan.h"
 #include "Tympan/models/solver/entities.hpp"
@@ -24,8 +27,14 @@
 #include "TYTrajet.h"
 #include "TYSolver.h"
 
+// Mean number of faces per cell of the spatial index
+static const double FACES_PER_CELL = 4.0;
+
+// Maximal number of cells of the spatial index along each axis
+static const unsigned int MAX_CELLS_PER_AXIS = 1024;
+
 TYFaceSelector::TYFaceSelector(TYSolver& solver)
-    : _solver(solver)
+    : _solver(solver), _nx(0), _ny(0), _nbIndexedFaces(0)
 {
 
 }
@@ -35,7 +44,153 @@ TYFaceSelector::~TYFaceSelector()
 
 }
 
-void TYFaceSelector::selectFaces(std::deque<TYSIntersection>& tabIntersect, const TYTrajet& rayon)
+void TYFaceSelector::init()
+{
+    const std::vector<TYStructSurfIntersect>& tabPolygon = _solver.getTabPolygon();
+    size_t nbFaces = tabPolygon.size();
+
+    _faceBoxes.clear();
+    _cells.clear();
+    _levelBoxes.clear();
+    _levelUsed.clear();
+    _nx = _ny = 0;
+    _nbIndexedFaces = 0;
+
+    if (nbFaces == 0) { return; }
+
+    // Bounding box of each face and of the whole scene
+    _faceBoxes.resize(nbFaces);
+    OPoint3D sceneMin, sceneMax;
+    bool first = true;
+    for (size_t i = 0; i < nbFaces; i++)
+    {
+        const TabPoint3D& pts = tabPolygon[i].tabPoint;
+        if (pts.empty()) { continue; } // Such a face never cuts a plane
+
+        OPoint3D ptMin = pts[0], ptMax = pts[0];
+        for (size_t j = 1; j < pts.size(); j++)
+        {
+            ptMin._x = std::min(ptMin._x, pts[j]._x); ptMax._x = std::max(ptMax._x, pts[j]._x);
+            ptMin._y = std::min(ptMin._y, pts[j]._y); ptMax._y = std::max(ptMax._y, pts[j]._y);
+            ptMin._z = std::min(ptMin._z, pts[j]._z); ptMax._z = std::max(ptMax._z, pts[j]._z);
+        }
+        _faceBoxes[i] = OBox(ptMin, ptMax);
+
+        if (first) { sceneMin = ptMin; sceneMax = ptMax; first = false; }
+        sceneMin._x = std::min(sceneMin._x, ptMin._x); sceneMax._x = std::max(sceneMax._x, ptMax._x);
+        sceneMin._y = std::min(sceneMin._y, ptMin._y); sceneMax._y = std::max(sceneMax._y, ptMax._y);
+    }
+
+    // Grid dimensions: about FACES_PER_CELL faces per cell
+    double width = std::max(sceneMax._x - sceneMin._x, 1.0);
+    double depth = std::max(sceneMax._y - sceneMin._y, 1.0);
+    double cellSize = std::sqrt(width * depth * FACES_PER_CELL / static_cast<double>(nbFaces));
+    unsigned int nx = std::min(MAX_CELLS_PER_AXIS, static_cast<unsigned int>(width / cellSize) + 1);
+    unsigned int ny = std::min(MAX_CELLS_PER_AXIS, static_cast<unsigned int>(depth / cellSize) + 1);
+    double dx = width / nx;
+    double dy = depth / ny;
+
+    // The cells are the leaves of a quadtree of side 2^(levels-1)
+    unsigned int side = 1;
+    size_t nbLevels = 1;
+    while (side < std::max(nx, ny)) { side *= 2; nbLevels++; }
+
+    _nx = nx;
+    _ny = ny;
+    _cells.resize(nx * ny);
+    _levelBoxes.resize(nbLevels);
+    _levelUsed.resize(nbLevels);
+    for (size_t l = 0; l < nbLevels; l++)
+    {
+        unsigned int levelSide = side >> l;
+        _levelBoxes[l].resize(levelSide * levelSide);
+        _levelUsed[l].assign(levelSide * levelSide, 0);
+    }
+    std::vector<OBox>& cellBoxes = _levelBoxes[0];
+    std::vector<char>& cellUsed = _levelUsed[0];
+
+    // Register each face in the cells overlapped by its footprint
+    for (size_t i = 0; i < nbFaces; i++)
+    {
+        if (tabPolygon[i].tabPoint.empty()) { continue; }
+
+        const OBox& box = _faceBoxes[i];
+        unsigned int ix0 = std::min(nx - 1, static_cast<unsigned int>((box._min._x - sceneMin._x) / dx));
+        unsigned int ix1 = std::min(nx - 1, static_cast<unsigned int>((box._max._x - sceneMin._x) / dx));
+        unsigned int iy0 = std::min(ny - 1, static_cast<unsigned int>((box._min._y - sceneMin._y) / dy));
+        unsigned int iy1 = std::min(ny - 1, static_cast<unsigned int>((box._max._y - sceneMin._y) / dy));
+
+        for (unsigned int iy = iy0; iy <= iy1; iy++)
+        {
+            for (unsigned int ix = ix0; ix <= ix1; ix++)
+            {
+                unsigned int c = iy * side + ix;
+                if (!cellUsed[c])
+                {
+                    cellBoxes[c] = box;
+                    cellUsed[c] = 1;
+                }
+                else
+                {
+                    mergeBox(cellBoxes[c], box);
+                }
+                _cells[iy * nx + ix].push_back(static_cast<unsigned int>(i));
+            }
+        }
+    }
+
+    // Upper levels of the quadtree: union of the 4 children
+    for (size_t l = 1; l < nbLevels; l++)
+    {
+        unsigned int levelSide = side >> l;
+        for (unsigned int iy = 0; iy < levelSide; iy++)
+        {
+            for (unsigned int ix = 0; ix < levelSide; ix++)
+            {
+                unsigned int n = iy * levelSide + ix;
+                for (unsigned int k = 0; k < 4; k++)
+                {
+                    unsigned int child = (2 * iy + k / 2) * (2 * levelSide) + 2 * ix + k % 2;
+                    if (!_levelUsed[l - 1][child]) { continue; }
+                    if (!_levelUsed[l][n])
+                    {
+                        _levelBoxes[l][n] = _levelBoxes[l - 1][child];
+                        _levelUsed[l][n] = 1;
+                    }
+                    else
+                    {
+                        mergeBox(_levelBoxes[l][n], _levelBoxes[l - 1][child]);
+                    }
+                }
+            }
+        }
+    }
+
+    _nbIndexedFaces = nbFaces;
+}
+
+bool TYFaceSelector::isSkipped(const TYStructSurfIntersect& face, const string& source_id)
+{
+    // FIX issue #18 (obstacles are not detected correctly)
+    if ( (face.volume_id.size() != 0) && (source_id.size() != 0) )
+    {
+        if ((face.volume_id == source_id) || (face.tabPoint.size() == 0)) { return true; }
+    }
+    return false;
+}
+
+void TYFaceSelector::initSourceData(const tympan::AcousticSource& source, TYSourceData& sourceData) const
+{
+    const std::vector<TYStructSurfIntersect>& faces = _solver.getTabPolygon();
+    sourceData.skippedFaces.resize(faces.size());
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        sourceData.skippedFaces[i] = isSkipped(faces[i], source.volume_id);
+    }
+}
+
+void TYFaceSelector::selectFaces(std::deque<TYSIntersection>& tabIntersect, const TYTrajet& rayon,
+                                 const TYSourceData* sourceData)
 {
 
     // Construction des plans de coupe
@@ -44,26 +199,38 @@ void TYFaceSelector::selectFaces(std::deque<TYSIntersection>& tabIntersect, cons
     rayon.getPtSetPtRfromOSeg3D(seg);
     buildPlans(plan, seg);
 
+    const OPlan plans[2] = { OPlan(plan[0].pt1, plan[0].pt2, plan[0].pt3),
+                             OPlan(plan[1].pt1, plan[1].pt2, plan[1].pt3) };
+
     size_t nbFaces = _solver.getTabPolygon().size();
 
-    // Recuperation de l'ID de la source
-    const string source_id = rayon.asrc.volume_id;
+    // Preselection des faces dont la boite englobante coupe l'un des plans
+    // (toutes les faces si l'index spatial n'a pas ete construit pour ces faces)
+    std::vector<unsigned int> candidates;
+    if (_nbIndexedFaces == nbFaces)
+    {
+        findCandidateFaces(plans, candidates);
+    }
+    else
+    {
+        candidates.resize(nbFaces);
+        for (unsigned int i = 0; i < nbFaces; i++) { candidates[i] = i; }
+    }
+
+    // Faces ignorees pour la source (calculees une fois par tache si fournies)
+    const bool useSourceData = sourceData && (sourceData->skippedFaces.size() == nbFaces);
 
     // Test des faces qui coupent le plan vertical
-    for (unsigned i = 0; i < nbFaces; i++)
+    for (size_t k = 0; k < candidates.size(); k++)
     {
-        const TYStructSurfIntersect& SI = _solver.getTabPolygon()[i];
+        const TYStructSurfIntersect& SI = _solver.getTabPolygon()[candidates[k]];
 
-        // FIX issue #18 (obstacles are not detected correctly)
-        if ( (SI.volume_id.size() != 0) && (source_id.size() != 0) )
-        {
-            if ((SI.volume_id == source_id) || (SI.tabPoint.size() == 0)) { continue; }
-        }
+        if (useSourceData ? sourceData->skippedFaces[candidates[k]] : isSkipped(SI, rayon.asrc.volume_id)) { continue; }
 
         // Plan vertical = 0 / Plan horizontal = 1
         TYSIntersection intersection;
-        bool bVertical = CalculSegmentCoupe(SI, intersection, plan[0].pt1, plan[0].pt2, plan[0].pt3, 0);
-        bool bHorizontal = CalculSegmentCoupe(SI, intersection, plan[1].pt1, plan[1].pt2, plan[1].pt3, 1);
+        bool bVertical = CalculSegmentCoupe(SI, intersection, plans[0], 0);
+        bool bHorizontal = CalculSegmentCoupe(SI, intersection, plans[1], 1);
 
         if (bVertical || bHorizontal) { tabIntersect.push_back(intersection); }
     }
@@ -71,6 +238,77 @@ void TYFaceSelector::selectFaces(std::deque<TYSIntersection>& tabIntersect, cons
     reorder_intersect(tabIntersect); // Put infrastructure elements on top
 }
 
+void TYFaceSelector::findCandidateFaces(const OPlan* plans, std::vector<unsigned int>& candidates) const
+{
+    // Descent from the root: only the nodes whose box is cut by a plane are visited,
+    // i.e. the cells along the vertical plane of the path and those straddling its horizontal plane
+    visitNode(_levelBoxes.size() - 1, 0, 0, plans, candidates);
+
+    // Keep the faces order of the solver (faces overlapping several cells are found several times)
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+void TYFaceSelector::visitNode(size_t level, unsigned int ix, unsigned int iy, const OPlan* plans, std::vector<unsigned int>& candidates) const
+{
+    unsigned int levelSide = 1u << (_levelBoxes.size() - 1 - level);
+    unsigned int n = iy * levelSide + ix;
+    if ( !_levelUsed[level][n] ||
+         ( !boxCutsPlan(_levelBoxes[level][n], plans[0]) && !boxCutsPlan(_levelBoxes[level][n], plans[1]) ) )
+    {
+        return;
+    }
+
+    if (level > 0)
+    {
+        for (unsigned int k = 0; k < 4; k++)
+        {
+            visitNode(level - 1, 2 * ix + k % 2, 2 * iy + k / 2, plans, candidates);
+        }
+        return;
+    }
+
+    // Cell of the grid
+    const std::vector<unsigned int>& cell = _cells[iy * _nx + ix];
+    for (size_t k = 0; k < cell.size(); k++)
+    {
+        const OBox& box = _faceBoxes[cell[k]];
+        if ( boxCutsPlan(box, plans[0]) || boxCutsPlan(box, plans[1]) )
+        {
+            candidates.push_back(cell[k]);
+        }
+    }
+}
+
+void TYFaceSelector::mergeBox(OBox& box, const OBox& other)
+{
+    box._min._x = std::min(box._min._x, other._min._x); box._max._x = std::max(box._max._x, other._max._x);
+    box._min._y = std::min(box._min._y, other._min._y); box._max._y = std::max(box._max._y, other._max._y);
+    box._min._z = std::min(box._min._z, other._min._z); box._max._z = std::max(box._max._z, other._max._z);
+}
+
+bool TYFaceSelector::boxCutsPlan(const OBox& box, const OPlan& plan)
+{
+    // Extreme values of a.x + b.y + c.z + d on the box
+    double fMin = plan._d, fMax = plan._d, scale = std::fabs(plan._d);
+
+    double coef[3] = { plan._a, plan._b, plan._c };
+    for (int i = 0; i < 3; i++)
+    {
+        double lo = coef[i] * box._min._value[i];
+        double hi = coef[i] * box._max._value[i];
+        if (lo > hi) { std::swap(lo, hi); }
+        fMin += lo;
+        fMax += hi;
+        scale += std::max(std::fabs(lo), std::fabs(hi));
+    }
+
+    // Tolerance on rounding errors so that the test stays conservative
+    double tolerance = 1.e-9 * scale + 1.e-12;
+
+    return (fMin <= tolerance) && (fMax >= -tolerance);
+}
+
 void TYFaceSelector::reorder_intersect(std::deque<TYSIntersection>& tabIntersect)
 {
     std::deque<unsigned int> indices;
@@ -157,7 +395,7 @@ bool TYFaceSelector::buildPlans(TYSPlan* plan, const OSegment3D& rayon)
 
 bool TYFaceSelector::CalculSegmentCoupe( const TYStructSurfIntersect& FaceCourante,
                                          TYSIntersection& Intersect,
-                                         OPoint3D& pt1, OPoint3D& pt2, OPoint3D& pt3,
+                                         const OPlan& planRayon,
                                          const int& indice) const
 {
     bool bRes = false;
@@ -167,7 +405,6 @@ bool TYFaceSelector::CalculSegmentCoupe( const TYStructSurfIntersect& FaceCouran
     Intersect.bIntersect[indice] = false;
 
     OSegment3D segInter;
-    OPlan planRayon(pt1, pt2, pt3);
     if ( planRayon.intersectsSurface(FaceCourante.tabPoint, segInter) )
     {
         Intersect.bIntersect[indice] = true;
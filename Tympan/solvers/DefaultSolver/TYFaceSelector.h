@@ -17,7 +17,9 @@
 #ifndef __TYFACESELECTOR__
 #define __TYFACESELECTOR__
 
+#include <vector>
 #include "Tympan/models/solver/TYFaceSelectorInterface.h"
+#include "Tympan/models/common/plan.h"
 #include "TYSolverDefines.h"
 
 class TYSolver;
@@ -32,20 +34,60 @@ public:
     TYFaceSelector(TYSolver& solver);
     virtual ~TYFaceSelector();
 
+    /**
+     * \brief Build the spatial index (2D grid) of the solver faces.
+     * Should be called once per resolution, after the faces have been built
+     * (otherwise selectFaces tests all the faces)
+     */
+    virtual void init();
+
+    /**
+     * \brief Mark the faces the selection ignores for a source (faces of its own volume)
+     * \param source Acoustic source
+     * \param sourceData Data of the source, its skippedFaces are filled
+     */
+    void initSourceData(const tympan::AcousticSource& source, TYSourceData& sourceData) const;
+
     /**
      * \brief Build the array of intersections
      * \param tabIntersect Array of intersections
      * \param rayon Ray path
+     * \param sourceData Data of the source of the path (computed if NULL)
      */
-    virtual void selectFaces(std::deque<TYSIntersection>& tabIntersect, const TYTrajet& rayon);
+    virtual void selectFaces(std::deque<TYSIntersection>& tabIntersect, const TYTrajet& rayon,
+                             const TYSourceData* sourceData = NULL);
 
 protected :
     TYSolver& _solver; //!< Reference to the solver
 
 private  :
     bool buildPlans(TYSPlan* plan, const OSegment3D& rayon);
-    bool CalculSegmentCoupe(const TYStructSurfIntersect& FaceCourante, TYSIntersection& Intersect, OPoint3D& pt1, OPoint3D& pt2, OPoint3D& pt3, const int& indice) const;
+    bool CalculSegmentCoupe(const TYStructSurfIntersect& FaceCourante, TYSIntersection& Intersect, const OPlan& planRayon, const int& indice) const;
     void reorder_intersect(std::deque<TYSIntersection>& tabIntersect); //!< put infrastructure faces on top
+
+    /// True if the face is ignored for the source of volume source_id
+    static bool isSkipped(const TYStructSurfIntersect& face, const string& source_id);
+
+    /**
+     * \brief Get the (sorted) indices of the faces whose bounding box is cut by one of the two planes
+     * \param plans Vertical and horizontal planes
+     * \param candidates Indices of the faces which may cut the planes
+     */
+    void findCandidateFaces(const OPlan* plans, std::vector<unsigned int>& candidates) const;
+
+    /// Visit the node (ix, iy) of a level of the quadtree of cells and its children cut by the planes
+    void visitNode(size_t level, unsigned int ix, unsigned int iy, const OPlan* plans, std::vector<unsigned int>& candidates) const;
+
+    static bool boxCutsPlan(const OBox& box, const OPlan& plan); //!< Conservative test of the intersection of a box with a plane
+    static void mergeBox(OBox& box, const OBox& other); //!< Extend box to contain other
+
+    std::vector<OBox> _faceBoxes;                       //!< Bounding box of each face
+    std::vector< std::vector<unsigned int> > _cells;    //!< Indices of the faces overlapping each cell of the 2D grid
+    unsigned int _nx;                                   //!< Number of cells of the grid along x
+    unsigned int _ny;                                   //!< Number of cells of the grid along y
+    std::vector< std::vector<OBox> > _levelBoxes;       //!< Quadtree of the cells: bounding box of the faces of each node, per level (0 = cells)
+    std::vector< std::vector<char> > _levelUsed;        //!< Quadtree of the cells: true if the node holds faces, per level
+    size_t _nbIndexedFaces;                             //!< Number of faces in the index
 };
 
 #endif // __TYFACESELECTOR__
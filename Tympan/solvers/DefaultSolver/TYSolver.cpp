@@ -13,6 +13,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <algorithm>
 #include "Tympan/core/logging.h"
 #include "Tympan/models/common/spectrum_matrix.h"
 #include "Tympan/models/solver/config.h"
@@ -28,6 +29,11 @@
 #include "TYFaceSelector.h"
 #include "TYTask.h"
 
+/// Minimum number of tasks per thread (load balancing)
+static const size_t TY_SOLVER_TASKS_PER_THREAD = 8;
+/// Maximum number of receptors computed by a task
+static const size_t TY_SOLVER_MAX_RECEPTORS_PER_TASK = 64;
+
 TYSolver::TYSolver()
 {
     // Creation du face selector
@@ -54,11 +60,6 @@ TYSolver::~TYSolver()
         delete _pool;
     }
     _pool = NULL;
-    
-    if(_tabTrajets.size() > 0)
-    {
-        _tabTrajets.clear();
-    }
 }
 
 
@@ -66,14 +67,15 @@ TYSolver::~TYSolver()
 bool TYSolver::solve(const tympan::AcousticProblemModel& aproblem,
                      tympan::AcousticResultModel& aresult, tympan::LPSolverConfiguration configuration)
 {
-    int nbTrajectsForOneSource = 0;
-    int nbTrajectsTotal = 0;
     tympan::SolverConfiguration::set(configuration);
-    // Use grid accelerating structure instead of KDTree (default value)
-    OMessageManager::get()->warning(
-            "Overwriting Acccelerator solver parameter to 1 (grid accelerating structure)");
-    tympan::SolverConfiguration::get()->Accelerator = 1;
+    // Les statistiques ne portent que sur ce calcul
+    tympan::SolverStats& stats = aresult.get_stats();
+    stats.clear();
+    tympan::ScopedTimer solveTimer(stats, "solve");
+    tympan::ScopedTimer sceneTimer(stats, "scene_build");
+
     // Creation de la collection de thread
+    if (_pool) { delete _pool; }
     _pool = new OThreadPool(tympan::SolverConfiguration::get()->NbThreads);
 
     // Creation du face selector
@@ -95,78 +97,68 @@ bool TYSolver::solve(const tympan::AcousticProblemModel& aproblem,
         return false;
     }
 
+    // Initialisation du face selector (index spatial des faces)
+    _faceSelector->init();
+
     // Initialisation du path finder
     _acousticPathFinder->init();
 
     // Initialisation du acoustic model
     _acousticModel->init();
+    sceneTimer.stop();
 
-    tympan::SpectrumMatrix& matrix = aresult.get_data();
-    matrix.resize(aproblem.nreceptors(), aproblem.nsources());
-    tab_acoustic_path& tabRays = aresult.get_path_data();
-    tabRays.clear();
-    int nbSource = aproblem.nsources();
-    int nbRecepteur = aproblem.nreceptors();
+    // Une tache calcule une source sur un bloc de recepteurs consecutifs
+    const size_t blockSize = receptorsPerTask(aproblem.nsources(), aproblem.nreceptors(), _pool->size());
+    const size_t nbBlocks = (aproblem.nreceptors() + blockSize - 1) / blockSize;
 
-    //construction trajets et ajout des taches associees
-    for(unsigned int i=0; i< aproblem.nsources(); i++)
-    {
-        // On reset la thread pool
-        _pool->begin(aproblem.nreceptors());
-        //reset deque and liberate memory
-        _tabTrajets.clear();
-        nbTrajectsForOneSource =0;
+    // Les resultats sont stockes ou transmis au fil du calcul
+    // (les rayons de chaque tache dans son emplacement, remis dans l'ordre des taches a la fin)
+    aresult.get_path_data().clear();
+    aresult.begin(aproblem.nreceptors(), aproblem.nsources(), aproblem.nsources() * nbBlocks);
 
-        for (unsigned int j = 0; j<aproblem.nreceptors(); j++)
-        {
-            TYTrajet *trajet = new TYTrajet(const_cast<tympan::AcousticProblemModel&>(aproblem).source(i), const_cast<tympan::AcousticProblemModel&>(aproblem).receptor(j));
-            trajet->asrc_idx = i;
-            trajet->arcpt_idx = j;
-            _tabTrajets.push_back(trajet);
-
-            _pool->push(new TYTask(*this, aproblem.nodes(), aproblem.triangles(), aproblem.materials(),*_tabTrajets.at(nbTrajectsForOneSource),nbTrajectsTotal + 1));
-            nbTrajectsTotal++;
-            nbTrajectsForOneSource++;
-        }
-
-        //launch threads
-        _pool->startPool();
-
-        if (!_pool->end())
-        {
-            return false;
-        }
+    // On reset la thread pool pour l'ensemble des taches du calcul
+    _pool->begin(static_cast<unsigned int>(aproblem.nsources() * nbBlocks));
 
-        // Displaying rays in the GUI
-        bool keepRays = tympan::SolverConfiguration::get()->Anime3DKeepRays;
-        if (keepRays == true)
+    //construction des taches
+    int nbTasks = 0;
+    for (unsigned int i = 0; i < aproblem.nsources(); i++)
+    {
+        for (size_t first = 0; first < aproblem.nreceptors(); first += blockSize)
         {
-            for (unsigned int i=0; i<_tabTrajets.size(); i++)
-            {
-                for (size_t j=0; j<_tabTrajets.at(i)->get_tab_rays().size(); j++)
-                {
-                    tabRays.push_back(_tabTrajets.at(i)->get_tab_rays()[j]);
-                }
-            }
+            const size_t nbReceptors = std::min(blockSize, aproblem.nreceptors() - first);
+            _pool->push(new TYTask(*this, aproblem.nodes(), aproblem.triangles(), aproblem.materials(),
+                                   const_cast<tympan::AcousticProblemModel&>(aproblem), i, first, nbReceptors,
+                                   aresult, ++nbTasks));
         }
+    }
 
-        for (unsigned int i=0; i<nbTrajectsForOneSource; i++)
-        {
-            tympan::source_idx sidx = _tabTrajets.at(i)->asrc_idx;
-            tympan::receptor_idx ridx = _tabTrajets.at(i)->arcpt_idx;
-
-            matrix(ridx, sidx) = _tabTrajets.at(i)->getSpectre();
-        }
+    //launch threads (no barrier between the sources: idle threads steal the pending tasks)
+    _pool->startPool();
 
-        for(int cnt = 0 ; cnt < _tabTrajets.size();cnt++)
-        {
-            delete _tabTrajets.at(cnt);
-        }
+    if (!_pool->end())
+    {
+        aresult.end();
+        return false;
     }
+    _acousticModel->getAttenuationCache().report(stats);
+
+    tympan::ScopedTimer exportTimer(stats, "result_export");
+    aresult.end();
 
     return true;
 }
 
+size_t TYSolver::receptorsPerTask(size_t nbSources, size_t nbReceptors, size_t nbThreads)
+{
+    // Enough tasks for the threads to balance their load, each task being
+    // large enough for its setup to be shared between several receptors
+    const size_t minTasks = TY_SOLVER_TASKS_PER_THREAD * std::max<size_t>(nbThreads, 1);
+    const size_t nbBlocks = (minTasks + nbSources - 1) / std::max<size_t>(nbSources, 1);
+    size_t blockSize = nbReceptors / std::max<size_t>(nbBlocks, 1);
+    blockSize = std::min<size_t>(blockSize, TY_SOLVER_MAX_RECEPTORS_PER_TASK);
+    return std::max<size_t>(blockSize, 1);
+}
+
 std::unique_ptr<TYFaceSelector> TYSolver::make_face_selector()
 {
     return std::unique_ptr<TYFaceSelector>( new TYFaceSelector(*this) );
@@ -251,7 +243,8 @@ bool TYSolver::appendTriangleToScene()
         }
     }
 
-    _scene->finish(); // Build accelerating structure
+    // Build accelerating structure (configured one) with the threads of the solver
+    _scene->finish(tympan::SolverConfiguration::get()->Accelerator, leafTreatment::FIRST, tympan::SolverConfiguration::get()->NbThreads);
 
     return true;
 }
\ No newline at end of file
@@ -61,6 +61,14 @@ public:
 
     const Scene* getScene() const { return _scene.get(); }     //!< Get the Scene
 
+    /**
+     * \brief Number of receptors computed by each task for a source
+     * \param nbSources Number of sources
+     * \param nbReceptors Number of receptors
+     * \param nbThreads Number of threads of the computation
+     */
+    static size_t receptorsPerTask(size_t nbSources, size_t nbReceptors, size_t nbThreads);
+
 protected:
     std::unique_ptr<TYFaceSelector> make_face_selector();		//!< TYFaceSelector builder
     std::unique_ptr<TYAcousticPathFinder> make_path_finder();	//!< TYAcousticPathFinder builder
@@ -84,8 +92,6 @@ private:
     // TODO replace with a std::deque or similar container.
     std::vector<TYStructSurfIntersect> _tabPolygon; //!< Vector of TYStructSurfIntersect
 
-	std::vector<TYTrajet*> _tabTrajets; //!< Vector of TYTrajet
-
     OThreadPool* _pool;
 
 private:
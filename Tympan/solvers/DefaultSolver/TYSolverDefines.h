@@ -24,6 +24,7 @@
 #define __TY_SOLVERDEFINES__
 
 #include <deque>
+#include <vector>
 
 #include "Tympan/models/common/3d.h"
 #include "Tympan/models/solver/entities.hpp"
@@ -65,6 +66,18 @@ struct TYSIntersection
     tympan::AcousticMaterialBase* material; //!< Pointer to a material
 };
 
+/**
+ * \brief Data depending on the source only, computed once per task and
+ * shared by the journeys to the receptors of its block
+ */
+struct TYSourceData
+{
+    TYSourceData() : groundDistance(0.) {}
+
+    std::vector<char> skippedFaces; //!< Faces ignored by the face selection for this source (by face index)
+    double groundDistance;          //!< Distance from 1000 m above the source down to the ground (see TYAcousticModel::meanSlope)
+};
+
 /**
  * \brief Structure to describe a plan defined with 3 points
  */
@@ -18,12 +18,26 @@
 #include "TYFaceSelector.h"
 #include "TYSolver.h"
 #include "TYTask.h"
+#include "Tympan/models/solver/acoustic_problem_model.hpp"
+#include "Tympan/models/solver/acoustic_result_model.hpp"
+#include "Tympan/models/solver/config.h"
 #include "Tympan/solvers/DefaultSolver/TYTrajet.h"
 
-TYTask::TYTask(TYSolver& solver, const tympan::nodes_pool_t& nodes, const tympan::triangle_pool_t& triangles, const tympan::material_pool_t& materials, TYTrajet& trajet, int nNbTrajets)
-    : _solver(solver), 
-    _trajet(trajet), 
-    _nNbTrajets(nNbTrajets), 
+TYTask::TYTask(TYSolver& solver, const tympan::nodes_pool_t& nodes, const tympan::triangle_pool_t& triangles, const tympan::material_pool_t& materials,
+               tympan::AcousticProblemModel& problem, tympan::source_idx source, tympan::receptor_idx firstReceptor, size_t nbReceptors,
+               tympan::AcousticResultModel& result, int nNbTrajets)
+    : _solver(solver),
+    _problem(problem),
+    _source(source),
+    _firstReceptor(firstReceptor),
+    _nbReceptors(nbReceptors),
+    _result(result),
+    _nNbTrajets(nNbTrajets),
+    _timed(false),
+    _faceSelectionTime(0.),
+    _pathFindingTime(0.),
+    _acousticModelTime(0.),
+    _nbFaces(0),
     _nodes(nodes),
     _triangles(triangles),
     _materials(materials)
@@ -37,26 +51,79 @@ TYTask::~TYTask()
 
 void TYTask::main()
 {
-    TabPoint3D ptsTop;
-    TabPoint3D ptsLeft;
-    TabPoint3D ptsRight;
+    tympan::AcousticSource& source = _problem.source(_source);
+    const bool keepRays = tympan::SolverConfiguration::get()->Anime3DKeepRays;
+    std::vector<acoustic_path*> tabRays;
+    tympan::SolverStats& stats = _result.get_stats();
+    _timed = stats.is_enabled();
 
-    // Construction du rayon SR
-    OSegment3D rayon;
-    _trajet.getPtSetPtRfromOSeg3D(rayon);
+    // Donnees ne dependant que de la source, communes aux recepteurs du bloc
+    TYSourceData sourceData;
+    _solver.getFaceSelector()->initSourceData(source, sourceData);
+    _solver.getAcousticModel()->initSourceData(source, sourceData);
+
+    for (size_t j = 0; j < _nbReceptors; j++)
+    {
+        const tympan::receptor_idx receptor = _firstReceptor + j;
+        TYTrajet trajet(source, _problem.receptor(receptor));
+        trajet.asrc_idx = _source;
+        trajet.arcpt_idx = receptor;
+
+        computeTrajet(trajet, sourceData);
+
+        _result.push_spectrum(receptor, _source, trajet.getSpectre());
+
+        if (keepRays)
+        {
+            const std::vector<acoustic_path*>& rays = trajet.get_tab_rays();
+            tabRays.insert(tabRays.end(), rays.begin(), rays.end());
+        }
+    }
+
+    // Les rayons du bloc sont transmis ensemble, dans l'emplacement de la tache
+    // (les taches sont numerotees a partir de 1)
+    _result.push_paths(_nNbTrajets - 1, tabRays);
+
+    // Les statistiques de la tache sont ajoutees en une fois
+    if (_timed)
+    {
+        stats.add_time("face_selection", _faceSelectionTime);
+        stats.add_time("path_finding", _pathFindingTime);
+        stats.add_time("acoustic_model", _acousticModelTime);
+    }
+    stats.add_count("tasks");
+    stats.add_count("source_receptor_pairs", _nbReceptors);
+    stats.add_count("faces_selected", _nbFaces);
+}
+
+double TYTask::lap()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - _clock).count();
+    _clock = now;
+    return elapsed;
+}
+
+void TYTask::computeTrajet(TYTrajet& trajet, const TYSourceData& sourceData)
+{
+    if (_timed) { _clock = std::chrono::steady_clock::now(); }
 
     // On selectionne les faces de la scene concernes par le calcul acoustique pour la paire concernee
-    _solver.getFaceSelector()->selectFaces(_tabIntersect, _trajet);
+    _solver.getFaceSelector()->selectFaces(_tabIntersect, trajet, &sourceData);
+    _nbFaces += _tabIntersect.size();
+    if (_timed) { _faceSelectionTime += lap(); }
 
     // On calcul les trajets acoustiques horizontaux et verticaux reliant la paire source/recepteur
-    _solver.getAcousticPathFinder()->computePath(_tabIntersect, _trajet, ptsTop, ptsLeft, ptsRight);
+    _solver.getAcousticPathFinder()->computePath(_tabIntersect, trajet, _ptsTop, _ptsLeft, _ptsRight);
+    if (_timed) { _pathFindingTime += lap(); }
 
     // On effectue les calculs acoustiques en utilisant les formules du modele acoustique
-    _solver.getAcousticModel()->compute(_tabIntersect, _trajet, ptsTop, ptsLeft, ptsRight);
-
-    ptsTop.clear();
-    ptsLeft.clear();
-    ptsRight.clear();
-    _tabIntersect.clear();
+    _solver.getAcousticModel()->compute(_tabIntersect, trajet, _ptsTop, _ptsLeft, _ptsRight, &sourceData);
+    if (_timed) { _acousticModelTime += lap(); }
 
+    // Les tableaux sont vides mais gardent leur capacite pour le recepteur suivant
+    _ptsTop.clear();
+    _ptsLeft.clear();
+    _ptsRight.clear();
+    _tabIntersect.clear();
 }
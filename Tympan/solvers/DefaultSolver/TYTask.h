@@ -17,16 +17,33 @@
 #define __TY_TASK__
 
 #include <deque>
+#include <vector>
+#include <chrono>
 #include "threading.h"
+#include "Tympan/models/solver/entities.hpp"
+#include "TYSolverDefines.h"
 
 class TYSolver;
 class TYTrajet;
 class nodes_pool_t;
 class triangle_pool_t;
 class material_pool_t;
+class acoustic_path;
+namespace tympan
+{
+class AcousticProblemModel;
+class AcousticResultModel;
+}
 
 /**
  * \brief Task of a thread collection for Tympan
+ *
+ * A task computes the contributions of one source to a block of consecutive
+ * receptors: the data depending on the source only (faces of its own volume,
+ * ground under it) are computed once, the journeys are built in turn on the
+ * stack, the working arrays are reused from one receptor to the next and each
+ * spectrum is pushed to the result model as soon as it is computed, the rays
+ * once the block is done.
  */
 class TYTask : public OTask
 {
@@ -37,27 +54,49 @@ public:
      * \param nodes  Nodes
      * \param triangles Triangles
      * \param materials Materials
-     * \param trajet Path
-     * \param nNbTrajets Path number
+     * \param problem Acoustic problem (sources and receptors)
+     * \param source Index of the source
+     * \param firstReceptor Index of the first receptor of the block
+     * \param nbReceptors Number of receptors of the block
+     * \param result Result model receiving the spectra and the rays
+     * \param nNbTrajets Task number
      */
-    TYTask(TYSolver& solver, const tympan::nodes_pool_t& nodes, const tympan::triangle_pool_t& triangles, const tympan::material_pool_t& materials, TYTrajet& trajet, int nNbTrajets);
+    TYTask(TYSolver& solver, const tympan::nodes_pool_t& nodes, const tympan::triangle_pool_t& triangles, const tympan::material_pool_t& materials,
+           tympan::AcousticProblemModel& problem, tympan::source_idx source, tympan::receptor_idx firstReceptor, size_t nbReceptors,
+           tympan::AcousticResultModel& result, int nNbTrajets);
 
     ~TYTask(); //!< Destructor
 
     void main(); //!< Main procedure to run the task
 
 private:
+    /// Compute the journey from the source to the receptor
+    void computeTrajet(TYTrajet& trajet, const TYSourceData& sourceData);
 
     TYSolver& _solver; //!< Reference to the solver
 
+    tympan::AcousticProblemModel& _problem; //!< Sources and receptors of the computation
+    tympan::source_idx _source;             //!< Index of the source
+    tympan::receptor_idx _firstReceptor;    //!< Index of the first receptor of the block
+    size_t _nbReceptors;                    //!< Number of receptors of the block
+    tympan::AcousticResultModel& _result;   //!< Result model
 
-    TYTrajet& _trajet; //!< Reference to the path
-
+    unsigned int _nNbTrajets;  //!< Task number
 
-    unsigned int _nNbTrajets;  //!< Path number
+    bool _timed;                    //!< Record the timings (statistics of the result model enabled)
+    std::chrono::steady_clock::time_point _clock; //!< Start of the phase being timed
+    double _faceSelectionTime;      //!< Time spent selecting the faces (s)
+    double _pathFindingTime;        //!< Time spent finding the paths (s)
+    double _acousticModelTime;      //!< Time spent in the acoustic model (s)
+    unsigned long long _nbFaces;    //!< Number of faces selected for the journeys of the task
 
+    /// Time elapsed since the start of the phase (s), then start the next phase
+    double lap();
 
     std::deque<TYSIntersection> _tabIntersect; //!< Array of intersections
+    TabPoint3D _ptsTop;     //!< Points of the vertical path
+    TabPoint3D _ptsLeft;    //!< Points of the left path
+    TabPoint3D _ptsRight;   //!< Points of the right path
 
     const tympan::nodes_pool_t& _nodes;
     const tympan::triangle_pool_t& _triangles;
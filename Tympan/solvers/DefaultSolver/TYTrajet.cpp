@@ -14,8 +14,25 @@
 */
 
 #include "TYTrajet.h"
+#include "Tympan/models/common/spectrum_kernels.h"
 #include "Tympan/models/solver/config.h"
 
+/// Ajoute le carre du module de l'attenuation att a acc
+static void addCarreModule(OSpectre& acc, const OSpectre& att)
+{
+    const double* module = att.getTabValReel();
+    tympan::spectrum_add_product(acc.getTabValReel(), module, module);
+}
+
+/// Ajoute le produit croise 2 * |att_i| * |att_j| * correction a acc
+static void addProduitCroise(OSpectre& acc, const OSpectre& att_i, const OSpectre& att_j, const OSpectre& correction)
+{
+    tympan::SpectrumValues produit;
+    tympan::spectrum_mul(att_j.getTabValReel(), 2.0, produit.data());
+    tympan::spectrum_mul(att_i.getTabValReel(), produit.data(), produit.data());
+    tympan::spectrum_add_product(acc.getTabValReel(), produit.data(), correction.getTabValReel());
+}
+
 
 TYTrajet::TYTrajet(tympan::AcousticSource& asrc_, tympan::AcousticReceptor& arcpt_) :
     asrc(asrc_),
@@ -111,7 +128,6 @@ OSpectre TYTrajet::getPNoOp()
 OSpectre TYTrajet::getPEnergetique(const AtmosphericConditions& atmos)
 {
     OSpectre s = OSpectre::getEmptyLinSpectre();
-    OSpectreComplex sTemp;
     int firstReflex = -1;
     unsigned int indiceDebutEffetEcran = 0;
     unsigned int i;
@@ -125,8 +141,7 @@ OSpectre TYTrajet::getPEnergetique(const AtmosphericConditions& atmos)
             firstReflex = i;
             break;
         }
-        sTemp = _chemins[i].getAttenuation();
-        s     = s.sum(sTemp.mult(sTemp)); // somme des carres des modules
+        addCarreModule(s, _chemins[i].getAttenuation()); // somme des carres des modules
     }
 
     // Dans le cas d'un ecran, on compare l'attenuation obtenue a celle du trajet direct
@@ -137,8 +152,7 @@ OSpectre TYTrajet::getPEnergetique(const AtmosphericConditions& atmos)
 
         for (i = 0; i < _cheminsDirect.size() ; i++)
         {
-            sTemp = _cheminsDirect[i].getAttenuation();
-            attDirect = attDirect.sum(sTemp.mult(sTemp));
+            addCarreModule(attDirect, _cheminsDirect[i].getAttenuation());
         }
 
         // On regarde l'attenuation globale obtenue pour chaque frequence,
@@ -159,9 +173,8 @@ OSpectre TYTrajet::getPEnergetique(const AtmosphericConditions& atmos)
             // 1. Aux chemins normaux et aux chemins directs
             for (i = firstReflex ; i < _chemins.size() ; i++)
             {
-                sTemp = _chemins[i].getAttenuation().mult(_chemins[i].getAttenuation());
-                s = s.sum(sTemp);
-                attDirect = attDirect.sum(sTemp);
+                addCarreModule(s, _chemins[i].getAttenuation());
+                addCarreModule(attDirect, _chemins[i].getAttenuation());
             }
 
             // On remplace la contribution du trajet direct pour toutes les frequences ou cela est necessaire
@@ -203,7 +216,6 @@ OSpectre TYTrajet::getPInterference(const AtmosphericConditions& atmos)
 
     OSpectre sCarreModule = OSpectre::getEmptyLinSpectre();
     OSpectre sProduitCroise = OSpectre::getEmptyLinSpectre();
-    OSpectre sTemp;
 
     for (i = 0 ; i < _chemins.size(); i++)
     {
@@ -215,7 +227,7 @@ OSpectre TYTrajet::getPInterference(const AtmosphericConditions& atmos)
             break;
         }
         // on fait la somme du carre des modules
-        sCarreModule = sCarreModule.sum(tabSpectreAtt[i].mult(tabSpectreAtt[i]));
+        addCarreModule(sCarreModule, tabSpectreAtt[i]);
 
         // on calcule les produits croises avec les autres chemins
         for (j = i + 1; j < _chemins.size(); j++)
@@ -223,9 +235,7 @@ OSpectre TYTrajet::getPInterference(const AtmosphericConditions& atmos)
             // On procedera aux produits croise avec les chemins reflechis plus loin ...
             if (ecranFound && (_chemins[j].getType() == CHEMIN_REFLEX)) { continue ; }
 
-            sTemp = tabSpectreAtt[i].mult(tabSpectreAtt[j].mult(2.0));
-            sTemp = sTemp.mult(correctTiers(tabSpectreAtt[i], tabSpectreAtt[j], atmos, tabLongueur[i], tabLongueur[j]));
-            sProduitCroise = sProduitCroise.sum(sTemp);
+            addProduitCroise(sProduitCroise, tabSpectreAtt[i], tabSpectreAtt[j], correctTiers(tabSpectreAtt[i], tabSpectreAtt[j], atmos, tabLongueur[i], tabLongueur[j]));
         }
     }
 
@@ -249,14 +259,12 @@ OSpectre TYTrajet::getPInterference(const AtmosphericConditions& atmos)
         for (i = 0 ; i < _cheminsDirect.size(); i++)
         {
             // on fait la somme du carre des modules
-            sCarreModuleDirect = sCarreModuleDirect.sum(tabSpectreAttDirect[i].mult(tabSpectreAttDirect[i]));
+            addCarreModule(sCarreModuleDirect, tabSpectreAttDirect[i]);
 
             // on calcule les produits croises avec les autres chemins
             for (j = i + 1; j < _cheminsDirect.size(); j++)
             {
-                sTemp = tabSpectreAttDirect[i].mult(tabSpectreAttDirect[j].mult(2.0));
-                sTemp = sTemp.mult(correctTiers(tabSpectreAttDirect[i], tabSpectreAttDirect[j], atmos, tabLongueurDirect[i], tabLongueurDirect[j]));
-                sProduitCroiseDirect = sProduitCroiseDirect.sum(sTemp);
+                addProduitCroise(sProduitCroiseDirect, tabSpectreAttDirect[i], tabSpectreAttDirect[j], correctTiers(tabSpectreAttDirect[i], tabSpectreAttDirect[j], atmos, tabLongueurDirect[i], tabLongueurDirect[j]));
             }
         }
 
@@ -281,16 +289,14 @@ OSpectre TYTrajet::getPInterference(const AtmosphericConditions& atmos)
             // 1. aux chemins "normaux"
             for (i = firstReflex; i < _chemins.size() ; i++)
             {
-                sCarreModule = sCarreModule.sum(tabSpectreAtt[i].mult(tabSpectreAtt[i]));
+                addCarreModule(sCarreModule, tabSpectreAtt[i]);
 
                 // on calcule les produits croises avec les autres chemins
                 for (j = 0 ; j < _chemins.size(); j++)
                 {
                     if (j == i) { continue; } // pas avec lui meme
 
-                    sTemp = tabSpectreAtt[i].mult(tabSpectreAtt[j].mult(2.0));
-                    sTemp = sTemp.mult(correctTiers(tabSpectreAtt[i], tabSpectreAtt[j], atmos, tabLongueur[i], tabLongueur[j]));
-                    sProduitCroise = sProduitCroise.sum(sTemp);
+                    addProduitCroise(sProduitCroise, tabSpectreAtt[i], tabSpectreAtt[j], correctTiers(tabSpectreAtt[i], tabSpectreAtt[j], atmos, tabLongueur[i], tabLongueur[j]));
                 }
 
             }
@@ -300,21 +306,17 @@ OSpectre TYTrajet::getPInterference(const AtmosphericConditions& atmos)
             //      // 2. au chemins "direct"
             for (i = firstReflex; i < _chemins.size() ; i++)
             {
-                sCarreModuleDirect = sCarreModuleDirect.sum(tabSpectreAtt[i].mult(tabSpectreAtt[i]));
+                addCarreModule(sCarreModuleDirect, tabSpectreAtt[i]);
 
                 // Produit croise avec les chemins directs
                 for (j = 0; j < _cheminsDirect.size() ; j++)
                 {
-                    sTemp = tabSpectreAtt[i].mult(tabSpectreAttDirect[j].mult(2.0));
-                    sTemp = sTemp.mult(correctTiers(tabSpectreAtt[i], tabSpectreAttDirect[j], atmos, tabLongueur[i], tabLongueurDirect[j]));
-                    sProduitCroiseDirect = sProduitCroiseDirect.sum(sTemp);
+                    addProduitCroise(sProduitCroiseDirect, tabSpectreAtt[i], tabSpectreAttDirect[j], correctTiers(tabSpectreAtt[i], tabSpectreAttDirect[j], atmos, tabLongueur[i], tabLongueurDirect[j]));
                 }
                 // Produit croise avec les autres chemins reflechis
                 for (j = i + 1; j < _chemins.size(); j++)
                 {
-                    sTemp = tabSpectreAtt[i].mult(tabSpectreAtt[j].mult(2.0));
-                    sTemp = sTemp.mult(correctTiers(tabSpectreAtt[i], tabSpectreAtt[j], atmos, tabLongueur[i], tabLongueur[j]));
-                    sProduitCroiseDirect = sProduitCroiseDirect.sum(sTemp);
+                    addProduitCroise(sProduitCroiseDirect, tabSpectreAtt[i], tabSpectreAtt[j], correctTiers(tabSpectreAtt[i], tabSpectreAtt[j], atmos, tabLongueur[i], tabLongueur[j]));
                 }
 
             }
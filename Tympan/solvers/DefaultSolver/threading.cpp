@@ -17,31 +17,25 @@
 
 #include "threading.h"
 
-OSlaveThread::OSlaveThread(OThreadPool* pool)
-    : _pool(pool)
+OSlaveThread::OSlaveThread(OThreadPool* pool, unsigned int index)
+    : _pool(pool), _index(index)
 {
     _bToEnd = false;
 }
 
 OSlaveThread::~OSlaveThread()
 {
-    this->terminate();
+    _bToEnd = true;
+    this->wait();
 }
 
 void OSlaveThread::run()
 {
-    while (isRunning() && !_bToEnd)
+    while (!_bToEnd)
     {
-        // Wait for available task.
-        TY_LOCK_SHARED_MUTEX(_pool)
-        if (isRunning() && !_bToEnd && !_pool->_tasks.empty())
+        LPOTask task;
+        if (_pool->takeTask(_index, task))
         {
-            // Dequeue next task.
-            LPOTask task = _pool->_tasks.front();
-            _pool->_tasks.pop();
-
-            TY_UNLOCK_SHARED_MUTEX(_pool)
-
             // Signal all that task is running.
             TY_LOCK_SHARED_MUTEX(task)
             task->_running = true;
@@ -56,13 +50,45 @@ void OSlaveThread::run()
             TY_UNLOCK_SHARED_MUTEX(task)
 
             // Increment pool counter
-            TY_LOCK_SHARED_MUTEX(_pool)
-            _pool->_counter++;
-            TY_UNLOCK_SHARED_MUTEX(_pool)
+            _pool->taskDone();
         }
         else
+        {
+            // Wait for available task.
+            TY_LOCK_SHARED_MUTEX(_pool)
+            if (!_bToEnd && (_pool->_pending == 0))
+            {
+                _pool->wait(_pool, 10);
+            }
             TY_UNLOCK_SHARED_MUTEX(_pool)
         }
+    }
+}
+
+bool OSlaveThread::popTask(LPOTask& task)
+{
+    TY_OMUTEXLOCKER_MUTEX(_tasksMutex)
+    if (_tasks.empty())
+    {
+        return false;
+    }
+
+    task = _tasks.back();
+    _tasks.pop_back();
+    return true;
+}
+
+bool OSlaveThread::stealTask(LPOTask& task)
+{
+    TY_OMUTEXLOCKER_MUTEX(_tasksMutex)
+    if (_tasks.empty())
+    {
+        return false;
+    }
+
+    task = _tasks.front();
+    _tasks.pop_front();
+    return true;
 }
 
 
@@ -106,42 +132,25 @@ void OTask::reset()
 
 
 OThreadPool::OThreadPool(unsigned int slaves)
-    : _totalCount(0), _counter(0)
+    : _totalCount(0), _counter(0), _pending(0), _nextQueue(0)
 {
+    if (slaves == 0) { slaves = 1; }
+
     // Allocate slave threads.
     for (unsigned int i = 0 ; i < slaves ; ++i)
     {
-        OSlaveThread* thread = new OSlaveThread(this);
+        OSlaveThread* thread = new OSlaveThread(this, i);
         push_back(thread);
     }
 }
 
 OThreadPool::~OThreadPool()
 {
-    TY_LOCK_SHARED_MUTEX(this)
-
-    // Wait for queue to become empty.
-    while (!_tasks.empty())
-    {
-        // Wait for last task in queue to at least start running.
-        LPOTask task = _tasks.back();
-        task->_completed = true;
-        task->_canceled = true;
-    }
-
-    // Now terminate all threads.
-    unsigned int i = 0;
-    for (i = 0 ; i < size() ; ++i)
-    {
-        (*this)[i]->_bToEnd = true;
-        (*this)[i]->terminate();
-    }
-
-    // Signal them to wake up.
-    TY_UNLOCK_SHARED_MUTEX(this)
+    // Cancel the pending tasks and end the threads.
+    stop();
 
     // Then delete them (the thread destructor will wait for thread completion).
-    for (i = 0 ; i < size() ; ++i)
+    for (unsigned int i = 0 ; i < size() ; ++i)
     {
         delete(*this)[i];
     }
@@ -153,12 +162,56 @@ void OThreadPool::push(OTask* task)
     // Reset task flags.
     task->reset();
 
-    // Push task onto queue and signal availability.
+    // Spread the tasks between the slaves queues.
+    TY_LOCK_SHARED_MUTEX(this)
+    OSlaveThread* slave = (*this)[_nextQueue];
+    _nextQueue = (_nextQueue + 1) % size();
+    TY_UNLOCK_SHARED_MUTEX(this)
+
+    _pending++;
+    TY_LOCK_MUTEX(slave->_tasksMutex)
+    slave->_tasks.push_back(task);
+    TY_UNLOCK_MUTEX(slave->_tasksMutex)
+
+    // Signal availability.
     TY_LOCK_SHARED_MUTEX(this)
-    _tasks.push(task);
+    wakeOne();
     TY_UNLOCK_SHARED_MUTEX(this)
 }
 
+bool OThreadPool::takeTask(unsigned int index, LPOTask& task)
+{
+    // Own queue first
+    if ((*this)[index]->popTask(task))
+    {
+        _pending--;
+        return true;
+    }
+
+    // Then steal from the other slaves
+    for (unsigned int i = 1 ; i < size() ; ++i)
+    {
+        if ((*this)[(index + i) % size()]->stealTask(task))
+        {
+            _pending--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void OThreadPool::taskDone()
+{
+    // The last task wakes up the thread waiting in end()
+    if (++_counter >= getTotalCount())
+    {
+        TY_LOCK_SHARED_MUTEX(this)
+        wakeAll();
+        TY_UNLOCK_SHARED_MUTEX(this)
+    }
+}
+
 unsigned int OThreadPool::getTotalCount() const
 {
     TY_OMUTEXLOCKER_SHARED_MUTEX(this);
@@ -167,7 +220,6 @@ unsigned int OThreadPool::getTotalCount() const
 
 unsigned int OThreadPool::getCount() const
 {
-    TY_OMUTEXLOCKER_SHARED_MUTEX(this);
     return _counter;
 }
 
@@ -179,63 +231,61 @@ void OThreadPool::begin(unsigned int count)
     TY_UNLOCK_SHARED_MUTEX(this);
 }
 
-void OThreadPool::startPool(){
-
-    for (int i = 0 ; i < size() ; ++i)
-    {
-        (*this)[i]->_bToEnd = false;
-        (*this)[i]->start();
-    }
-}
-
-
+void OThreadPool::startPool()
+{
+    for (unsigned int i = 0 ; i < size() ; ++i)
+    {
+        (*this)[i]->_bToEnd = false;
+        (*this)[i]->start();
+    }
+}
 
 bool OThreadPool::end()
 {
-    unsigned int totalCount = getTotalCount();
-
-    unsigned int last = 0;
-    bool cancel = false;
-    while (last < totalCount)
+    // Wait for the completion of all the tasks
+    TY_LOCK_SHARED_MUTEX(this)
+    while (_counter < _totalCount)
     {
-        unsigned int current = getCount();
-        last = current;
-        OSleeper::msleep(5);
+        wait(this, 50);
     }
+    TY_UNLOCK_SHARED_MUTEX(this)
+
     stop();
     return true;
 }
 
 void OThreadPool::stop()
 {
-    TY_LOCK_SHARED_MUTEX(this);
-
-    // For each task
-    for (size_t i = 0; i < _tasks.size(); ++i)
+    // Cancel the tasks still waiting in the queues
+    for (unsigned int i = 0 ; i < size() ; ++i)
     {
-        // Dequeue next task
-        LPOTask task = _tasks.front();
-        _tasks.pop();
+        LPOTask task;
+        while ((*this)[i]->stealTask(task))
+        {
+            _pending--;
 
-        // Cancel task
-        TY_LOCK_SHARED_MUTEX(task)
-        task->_canceled = true;
-        TY_UNLOCK_SHARED_MUTEX(task)
+            // Cancel task
+            TY_LOCK_SHARED_MUTEX(task)
+            task->_canceled = true;
+            task->wakeAll();
+            TY_UNLOCK_SHARED_MUTEX(task)
 
-        // Increment counter
-        _counter++;
+            // Increment counter
+            _counter++;
+        }
     }
 
-    for (int i = 0 ; i < size() ; ++i)
-    {
-        (*this)[i]->_bToEnd = true;
+    TY_LOCK_SHARED_MUTEX(this);
+    for (unsigned int i = 0 ; i < size() ; ++i)
+    {
+        (*this)[i]->_bToEnd = true;
     }
-
+    wakeAll();
     TY_UNLOCK_SHARED_MUTEX(this);
 
     // Waiting for thread termination
-    while (getCount() < getTotalCount())
+    for (unsigned int i = 0 ; i < size() ; ++i)
     {
-        OSleeper::msleep(1);
+        (*this)[i]->wait();
     }
 }
@@ -17,8 +17,9 @@
 #define TY_THREADING
 
 
-#include <queue>
+#include <deque>
 #include <vector>
+#include <atomic>
 
 #include "Tympan/core/smartptr.h"
 
@@ -114,37 +115,6 @@ inline OMutexLocker::~OMutexLocker()
 }
 
 
-class OThreadPool;
-
-/**
- * \file threading.h
- * \class OSlaveThread
- * \brief This class defines a thread for running tasks in a threads collection. Slave thread for the threads collection.
- * \author Projet_Tympan
- */
-class OSlaveThread : public QThread
-{
-public:
-    /// Build a slave thread for a threads collection
-    OSlaveThread(OThreadPool* pool);
-
-    /// Destroy the slave thread; wait for the end of the thread.
-    ~OSlaveThread();
-
-    bool _bToEnd;
-
-protected:
-    /// Pointer on the parent threads collection
-    OThreadPool* _pool;
-
-    /**
-     * \fn void run();
-     * \brief Run a waiting task.
-     */
-    void run();
-};
-
-
 /**
  * \file threading.h
  * \class OTask
@@ -217,12 +187,74 @@ protected:
 typedef SmartPtr<OTask> LPOTask;
 
 
+class OThreadPool;
+
+/**
+ * \file threading.h
+ * \class OSlaveThread
+ * \brief This class defines a thread for running tasks in a threads collection. Slave thread for the threads collection.
+ *
+ * Each slave thread owns a deque of tasks. It runs the tasks from the back of its own deque
+ * and, when it is empty, steals tasks from the front of the deques of the other slaves.
+ *
+ * \author Projet_Tympan
+ */
+class OSlaveThread : public QThread
+{
+public:
+    /// Build the slave thread number "index" of a threads collection
+    OSlaveThread(OThreadPool* pool, unsigned int index);
+
+    /// Destroy the slave thread; wait for the end of the thread.
+    ~OSlaveThread();
+
+    /// End request flag
+    std::atomic<bool> _bToEnd;
+
+protected:
+    /// Pointer on the parent threads collection
+    OThreadPool* _pool;
+
+    /// Index of the thread in the threads collection
+    unsigned int _index;
+
+    /// Tasks queue of this thread
+    std::deque<LPOTask> _tasks;
+
+    /// Mutex protecting the tasks queue
+    QMutex _tasksMutex;
+
+    /**
+     * \fn void run();
+     * \brief Run the waiting tasks.
+     */
+    void run();
+
+    /**
+     * \fn bool popTask(LPOTask& task);
+     * \brief Take the last task of the queue. Return false if the queue is empty.
+     */
+    bool popTask(LPOTask& task);
+
+    /**
+     * \fn bool stealTask(LPOTask& task);
+     * \brief Take the first task of the queue (called by the other slaves). Return false if the queue is empty.
+     */
+    bool stealTask(LPOTask& task);
+
+    friend class OThreadPool;
+};
+
+
 /**
  * \file threading.h
  * \class OThreadPool
  * \brief Slave threads collection.
  *
- * This class define a slave threads collection which run tasks pending in a queue.
+ * This class define a slave threads collection which run tasks pending in queues.
+ * The tasks are spread between the queues of the slave threads when they are pushed
+ * and an idle slave thread steals the tasks of the others (work stealing), so that all
+ * the tasks of a calculation can be pushed at once without global lock contention.
  * A task is a simple object which contains the Task::main method.
  * Simple example :
  *
@@ -241,10 +273,10 @@ typedef SmartPtr<OTask> LPOTask;
  *  int main(int argc, char** argv)
  *  {
  *      OThreadPool pool(10);
- *      MyTask task;
- *      pool.push(task);
- *      ...
- *      task.wait();
+ *      pool.begin(1);
+ *      pool.push(new MyTask());
+ *      pool.startPool();
+ *      pool.end();
  *      return 0;
  *  }
  *
@@ -254,7 +286,7 @@ typedef SmartPtr<OTask> LPOTask;
 class OThreadPool : public std::vector<OSlaveThread*>, public QWaitCondition, public QMutex
 {
 public:
-    /// Build a threads collection and allocate "slaves" thread
+    /// Build a threads collection and allocate "slaves" thread (at least one)
     OThreadPool(unsigned int slaves);
 
     /// Destructor
@@ -262,7 +294,7 @@ public:
 
     /**
      * \fn virtual void push(OTask* task);
-     * \brief Add a task to the queue
+     * \brief Add a task to the queue of a slave thread
      */
     virtual void push(OTask* task);
 
@@ -284,11 +316,11 @@ public:
      */
     void begin(unsigned int count);
 
-    void startPool();
+    void startPool();
 
     /**
      * \fn bool end();
-     * \brief End solver
+     * \brief End solver : wait for the completion of all the tasks
      */
     bool end();
 
@@ -296,14 +328,23 @@ protected:
     /// Cancel the pending tasks
     void stop();
 
-    /// Tasks queue
-    std::queue<LPOTask> _tasks;
+    /// Find a task for the slave thread "index" (its own queue first, then the other ones)
+    bool takeTask(unsigned int index, LPOTask& task);
+
+    /// Signal the completion of a task
+    void taskDone();
 
     /// Total number of tasks to run
     unsigned int _totalCount;
 
     /// Total number of ended tasks
-    unsigned int _counter;
+    std::atomic<unsigned int> _counter;
+
+    /// Number of tasks waiting in the queues
+    std::atomic<unsigned int> _pending;
+
+    /// Queue receiving the next pushed task
+    unsigned int _nextQueue;
 
     friend class OSlaveThread;
 };
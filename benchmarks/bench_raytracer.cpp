@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+/**
+ * \file bench_raytracer.cpp
+ * \brief Benchmark of the AcousticRaytracer accelerators and engines
+ *
+ * For each scene (PLY files read with Scene::import_from_ply, or a synthetic
+ * site when no file is given), the benchmark:
+ * + builds each accelerator and traverses the same seeded random rays with
+ *   DefaultEngine::runStructureBenchmark(),
+ * + runs a full ray tracing with each engine (one source, a grid of receptors).
+ *
+ * The results are written as JSON on the standard output (or in --output).
+ * The program exits with 1 if a scene can not be loaded.
+ *
+ * Usage: bench_raytracer [--rays N] [--seed S] [--rays-per-source N]
+ *                        [--threads N] [--accelerators 0,1,2,3]
+ *                        [--output file.json] [scene.ply ...]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Engine/Simulation.h"
+#include "Engine/DefaultEngine.h"
+#include "Engine/AcousticRaytracerConfiguration.h"
+#include "Accelerator/BvhAccelerator.h"
+#include "Acoustic/Solver.h"
+#include "Geometry/UniformSphericSampler2.h"
+
+namespace
+{
+
+const char* accelerator_names[] = { "brute_force", "grid", "bvh", "kdtree" };
+const char* engine_names[] = { "default", "parallel_default" };
+
+/// Benchmark parameters read from the command line
+struct Options
+{
+    Options() : nbRays(100000), seed(0), nbRaysPerSource(10000), nbThreads(0) {}
+
+    unsigned int nbRays;                //!< Random rays traversed per accelerator
+    unsigned int seed;                  //!< Seed of the random rays
+    unsigned int nbRaysPerSource;       //!< Rays shot by the source in the engine runs
+    unsigned int nbThreads;             //!< Threads of the parallel engine and of the BVH build (0: hardware threads)
+    std::vector<int> accelerators;      //!< Accelerators benchmarked
+    std::string output;                 //!< JSON output file (standard output if empty)
+    std::vector<std::string> scenes;    //!< PLY scenes
+};
+
+double seconds_since(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double ratio(double a, double b) { return b > 0. ? a / b : 0.; }
+
+/// Quoted JSON string
+std::string json_string(const std::string& value)
+{
+    std::string quoted("\"");
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        const unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c == '"' || c == '\\') { quoted += '\\'; quoted += c; }
+        else if (c < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        }
+        else { quoted += c; }
+    }
+    return quoted + "\"";
+}
+
+/// Synthetic site: a square ground of n x n cells with a box building every other cell
+void build_synthetic_scene(Scene* scene, unsigned int n)
+{
+    Material* m = new Material();
+    const decimal cell = 20.;
+    std::vector<unsigned int> ground((n + 1) * (n + 1));
+    for (unsigned int j = 0; j <= n; j++)
+        for (unsigned int i = 0; i <= n; i++)
+        {
+            scene->addVertex(vec3(i * cell, j * cell, 0.), ground[j * (n + 1) + i]);
+        }
+    for (unsigned int j = 0; j < n; j++)
+        for (unsigned int i = 0; i < n; i++)
+        {
+            unsigned int a = ground[j * (n + 1) + i], b = ground[j * (n + 1) + i + 1];
+            unsigned int c = ground[(j + 1) * (n + 1) + i + 1], d = ground[(j + 1) * (n + 1) + i];
+            scene->addTriangle(a, b, c, m, true);
+            scene->addTriangle(a, c, d, m, true);
+            if ( (i + j) % 2 ) { continue; }
+
+            // Building of height 5 to 15 m inside the cell
+            decimal h = 5. + 10. * ((i * 7 + j * 3) % 5) / 4.;
+            vec3 pMin(i * cell + 5., j * cell + 5., 0.), pMax(i * cell + 15., j * cell + 15., h);
+            unsigned int v[8];
+            for (unsigned int k = 0; k < 8; k++)
+            {
+                scene->addVertex(vec3(k & 1 ? pMax.x : pMin.x, k & 2 ? pMax.y : pMin.y, k & 4 ? pMax.z : pMin.z), v[k]);
+            }
+            const unsigned int faces[10][3] = { {0, 1, 5}, {0, 5, 4}, {1, 3, 7}, {1, 7, 5}, {3, 2, 6},
+                                                {3, 6, 7}, {2, 0, 4}, {2, 4, 6}, {4, 5, 7}, {4, 7, 6} };
+            for (unsigned int k = 0; k < 10; k++)
+            {
+                scene->addTriangle(v[faces[k][0]], v[faces[k][1]], v[faces[k][2]], m, false);
+            }
+        }
+}
+
+/// Load a scene (false if the PLY file can not be read or has no triangle)
+bool load_scene(Scene* scene, const std::string& name)
+{
+    if (name == "synthetic")
+    {
+        build_synthetic_scene(scene, 50);
+        return true;
+    }
+
+    // Scene::import_from_ply does not check that the file exists
+    std::ifstream file(name.c_str());
+    std::string keyword;
+    if ( !(file >> keyword) || (keyword != "ply") ) { return false; }
+    file.close();
+    scene->import_from_ply(name);
+    return !scene->getShapes()->empty();
+}
+
+/// Accelerators structure benchmark on a scene
+bool bench_accelerators(const Options& options, const std::string& name, std::ostream& out)
+{
+    Simulation simulation;
+    Scene* scene = simulation.getScene();
+    if (!load_scene(scene, name)) { return false; }
+    out << "      \"triangles\": " << scene->getShapes()->size() << ",\n";
+    out << "      \"accelerators\": [";
+
+    for (size_t k = 0; k < options.accelerators.size(); k++)
+    {
+        int accelerator = options.accelerators[k];
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        scene->finish(accelerator);
+        double buildTime = seconds_since(start);
+
+        simulation.setEngine(DEFAULT);
+        BenchmarkResult result = simulation.runBenchmark(options.nbRays, options.seed);
+
+        out << (k ? ",\n" : "\n") << "        { \"name\": \"" << accelerator_names[accelerator] << "\""
+            << ", \"build_time\": " << buildTime;
+        BvhAccelerator* bvh = dynamic_cast<BvhAccelerator*>(scene->getAccelerator());
+        if (bvh) { out << ", \"nodes\": " << bvh->getNbNodes(); }
+        out << ", \"rays\": " << result.nbRays
+            << ", \"time\": " << result.elapsed
+            << ", \"rays_per_second\": " << ratio(result.nbRays, result.elapsed)
+            << ", \"intersections_per_ray\": " << ratio(result.nbIntersections, result.nbRays)
+            << ", \"hit_ratio\": " << ratio(result.nbHits, result.nbRays) << " }";
+    }
+    out << "\n      ],\n";
+    return true;
+}
+
+/// Full ray tracing of a scene with an engine
+bool bench_engine(const Options& options, const std::string& name, engineChoice engine, std::ostream& out)
+{
+    Simulation simulation;
+    Scene* scene = simulation.getScene();
+    if (!load_scene(scene, name)) { return false; }
+    BBox box = scene->getGlobalBox();
+    vec3 center = (box.pMin + box.pMax) * 0.5;
+    vec3 size = box.pMax - box.pMin;
+
+    // One source in the middle of the scene, 2 m above the ground
+    Source source("source");
+    source.setPosition(vec3(center.x, center.y, box.pMin.z + 2.));
+    source.setSampler(new UniformSphericSampler2(options.nbRaysPerSource));
+    source.setInitialRayCount(options.nbRaysPerSource);
+    simulation.addSource(source);
+
+    // A 5 x 5 grid of receptors
+    for (unsigned int j = 0; j < 5; j++)
+        for (unsigned int i = 0; i < 5; i++)
+        {
+            Recepteur receptor(vec3(box.pMin.x + size.x * (i + 0.5) / 5., box.pMin.y + size.y * (j + 0.5) / 5., box.pMin.z + 2.), 1.);
+            simulation.addRecepteur(receptor);
+        }
+
+    BasicSolver solver;
+    solver.postTreatmentScene(scene, simulation.getSources(), simulation.getRecepteurs());
+    simulation.setSolver(&solver);
+    scene->finish(2);
+    simulation.get_receptors_landscape()->finish(2);
+    simulation.setEngine(engine);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    simulation.launchSimulation();
+    double elapsed = seconds_since(start);
+
+    unsigned long long int nbTraced = dynamic_cast<DefaultEngine*>(simulation.getEngine())->getNbRayonsTraites();
+    out << "        { \"name\": \"" << engine_names[engine] << "\""
+        << ", \"accelerator\": \"bvh\""
+        << ", \"rays_per_source\": " << options.nbRaysPerSource
+        << ", \"receptors\": 25"
+        << ", \"time\": " << elapsed
+        << ", \"traced_rays\": " << nbTraced
+        << ", \"rays_per_second\": " << ratio(nbTraced, elapsed)
+        << ", \"valid_rays\": " << solver.getValidRays()->size() << " }";
+    return true;
+}
+
+bool parse_options(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--rays" && hasValue) { options.nbRays = std::atoi(argv[++i]); }
+        else if (arg == "--seed" && hasValue) { options.seed = std::atoi(argv[++i]); }
+        else if (arg == "--rays-per-source" && hasValue) { options.nbRaysPerSource = std::atoi(argv[++i]); }
+        else if (arg == "--threads" && hasValue) { options.nbThreads = std::atoi(argv[++i]); }
+        else if (arg == "--output" && hasValue) { options.output = argv[++i]; }
+        else if (arg == "--accelerators" && hasValue)
+        {
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ','))
+            {
+                int accelerator = std::atoi(item.c_str());
+                if (accelerator < 0 || accelerator > 3) { return false; }
+                options.accelerators.push_back(accelerator);
+            }
+        }
+        else if (arg.compare(0, 2, "--") == 0) { return false; }
+        else { options.scenes.push_back(arg); }
+    }
+    if (options.accelerators.empty())
+    {
+        for (int k = 0; k < 4; k++) { options.accelerators.push_back(k); }
+    }
+    if (options.scenes.empty()) { options.scenes.push_back("synthetic"); }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--rays N] [--seed S] [--rays-per-source N] [--threads N]"
+                  << " [--accelerators 0,1,2,3] [--output file.json] [scene.ply ...]" << std::endl;
+        return 1;
+    }
+
+    // Check the scenes before writing the results
+    for (size_t s = 0; s < options.scenes.size(); s++)
+    {
+        Scene scene;
+        if (!load_scene(&scene, options.scenes[s]))
+        {
+            std::cerr << "Can not load the scene " << options.scenes[s] << std::endl;
+            return 1;
+        }
+    }
+
+    AcousticRaytracerConfiguration* config = AcousticRaytracerConfiguration::get();
+    config->NbThreads = options.nbThreads;
+
+    std::ofstream file;
+    if (!options.output.empty()) { file.open(options.output.c_str()); }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+
+    out << "{\n  \"rays\": " << options.nbRays << ",\n  \"seed\": " << options.seed
+        << ",\n  \"threads\": " << options.nbThreads << ",\n  \"scenes\": [";
+    for (size_t s = 0; s < options.scenes.size(); s++)
+    {
+        const std::string& name = options.scenes[s];
+        out << (s ? ",\n" : "\n") << "    {\n      \"name\": " << json_string(name) << ",\n";
+        bool ok = bench_accelerators(options, name, out);
+        out << "      \"engines\": [\n";
+        ok = ok && bench_engine(options, name, DEFAULT, out);
+        out << ",\n";
+        ok = ok && bench_engine(options, name, PARALLELDEFAULT, out);
+        out << "\n      ]\n    }";
+        if (!ok)
+        {
+            std::cerr << "Can not load the scene " << name << std::endl;
+            return 1;
+        }
+    }
+    out << "\n  ]\n}\n";
+
+    return 0;
+}
@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) <2012> <EDF-R&D> <FRANCE>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+/**
+ * \file bench_solver.cpp
+ * \brief End-to-end benchmark of the solvers over synthetic sites of growing size
+ *
+ * Each case generates an AcousticProblemModel procedurally: a terrain grid
+ * of T x T cells, B box buildings, S sources and a grid of R receptors. It is
+ * solved through SolverInterface::solve by each solver and each thread count
+ * given. Each case runs in a child process (where fork() is available), so
+ * that its peak RSS is its own. The wall time, the peak RSS and the time of
+ * each phase are written as JSON on the standard output (or in --output).
+ *
+ * Usage: bench_solver [--solvers default,anime3d] [--threads 1,2,4]
+ *                     [--seed S] [--output file.json] [--size T:B:S:R ...]
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "Tympan/core/interfaces.h"
+#include "Tympan/models/solver/acoustic_problem_model.hpp"
+#include "Tympan/models/solver/acoustic_result_model.hpp"
+#include "Tympan/models/solver/config.h"
+#include "Tympan/solvers/DefaultSolver/TYSolver.h"
+#include "Tympan/solvers/ANIME3DSolver/TYANIME3DSolver.h"
+
+namespace
+{
+
+/// Size of a synthetic site
+struct SiteSize
+{
+    SiteSize() : nbCells(20), nbBuildings(10), nbSources(2), nbReceptors(25) {}
+
+    unsigned int nbCells;       //!< Terrain cells along each side (20 m each)
+    unsigned int nbBuildings;   //!< Box buildings
+    unsigned int nbSources;     //!< Sources
+    unsigned int nbReceptors;   //!< Receptors (on a square grid)
+};
+
+/// Benchmark parameters read from the command line
+struct Options
+{
+    Options() : seed(0) {}
+
+    std::vector<std::string> solvers;   //!< Solvers benchmarked ("default", "anime3d")
+    std::vector<unsigned int> threads;  //!< Thread counts
+    std::vector<SiteSize> sizes;        //!< Site sizes
+    unsigned int seed;                  //!< Seed of the site generator
+    std::string output;                 //!< JSON output file (standard output if empty)
+};
+
+const double cell_size = 20.;
+
+double seconds_since(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+#ifndef _WIN32
+/// Peak resident set size (kB) of a resource usage
+long peak_rss(const struct rusage& usage)
+{
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+#endif
+
+/// Altitude of the synthetic terrain
+double terrain_z(double x, double y)
+{
+    return 2. * std::sin(x / 150.) * std::cos(y / 110.);
+}
+
+/// Build a synthetic site in the problem
+void build_site(const SiteSize& size, unsigned int seed, tympan::AcousticProblemModel& problem)
+{
+    std::mt19937 generator(seed);
+    const double extent = size.nbCells * cell_size;
+    std::uniform_real_distribution<double> position(0.1 * extent, 0.9 * extent);
+
+    // Terrain
+    tympan::material_ptr_t ground = problem.make_material("grass", 300., 0., 1.);
+    const unsigned int n = size.nbCells;
+    std::vector<tympan::node_idx> nodes((n + 1) * (n + 1));
+    for (unsigned int j = 0; j <= n; j++)
+        for (unsigned int i = 0; i <= n; i++)
+        {
+            double x = i * cell_size, y = j * cell_size;
+            nodes[j * (n + 1) + i] = problem.make_node(x, y, terrain_z(x, y));
+        }
+    for (unsigned int j = 0; j < n; j++)
+        for (unsigned int i = 0; i < n; i++)
+        {
+            tympan::node_idx a = nodes[j * (n + 1) + i], b = nodes[j * (n + 1) + i + 1];
+            tympan::node_idx c = nodes[(j + 1) * (n + 1) + i + 1], d = nodes[(j + 1) * (n + 1) + i];
+            problem.triangle(problem.make_triangle(a, b, c)).made_of = ground;
+            problem.triangle(problem.make_triangle(a, c, d)).made_of = ground;
+        }
+
+    // Buildings: walls and roof of boxes standing on the terrain
+    tympan::material_ptr_t concrete = problem.make_material("concrete", OSpectreComplex(TYComplex(0.8, 0.)));
+    std::uniform_real_distribution<double> side(8., 30.), height(5., 25.);
+    const unsigned int faces[10][3] = { {0, 1, 5}, {0, 5, 4}, {1, 3, 7}, {1, 7, 5}, {3, 2, 6},
+                                        {3, 6, 7}, {2, 0, 4}, {2, 4, 6}, {4, 5, 7}, {4, 7, 6} };
+    for (unsigned int k = 0; k < size.nbBuildings; k++)
+    {
+        double x = position(generator), y = position(generator);
+        double dx = side(generator), dy = side(generator), h = height(generator);
+        double z = terrain_z(x, y) - 1.;
+        tympan::node_idx v[8];
+        for (unsigned int m = 0; m < 8; m++)
+        {
+            v[m] = problem.make_node(m & 1 ? x + dx : x, m & 2 ? y + dy : y, m & 4 ? z + h : z);
+        }
+        std::ostringstream volume;
+        volume << "building_" << k;
+        for (unsigned int f = 0; f < 10; f++)
+        {
+            tympan::AcousticTriangle& triangle = problem.triangle(problem.make_triangle(v[faces[f][0]], v[faces[f][1]], v[faces[f][2]]));
+            triangle.made_of = concrete;
+            triangle.volume_id = volume.str();
+        }
+    }
+
+    // Sources 2 m above the terrain
+    tympan::Spectrum spectrum;
+    spectrum.setDefaultValue(90.);
+    for (unsigned int k = 0; k < size.nbSources; k++)
+    {
+        double x = position(generator), y = position(generator);
+        problem.make_source(tympan::Point(x, y, terrain_z(x, y) + 2.), spectrum.toGPhy(), new tympan::SphericalSourceDirectivity());
+    }
+
+    // Receptors on a square grid, 1.5 m above the terrain
+    unsigned int side_count = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(size.nbReceptors))));
+    for (unsigned int k = 0; k < size.nbReceptors; k++)
+    {
+        double x = extent * ((k % side_count) + 0.5) / side_count;
+        double y = extent * ((k / side_count) + 0.5) / side_count;
+        problem.make_receptor(tympan::Point(x, y, terrain_z(x, y) + 1.5));
+    }
+}
+
+SolverInterface* make_solver(const std::string& name)
+{
+    if (name == "anime3d") { return new TYANIME3DSolver(); }
+    return new TYSolver();
+}
+
+/// Solve one case and write its JSON record, but the peak RSS and the closing brace
+void bench_case(const std::string& solverName, unsigned int nbThreads, const SiteSize& size,
+                unsigned int seed, std::ostream& out)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    tympan::AcousticProblemModel problem;
+    build_site(size, seed, problem);
+    double buildTime = seconds_since(start);
+
+    tympan::LPSolverConfiguration configuration = tympan::SolverConfiguration::get();
+    configuration->NbThreads = nbThreads;
+
+    std::unique_ptr<SolverInterface> solver(make_solver(solverName));
+    tympan::AcousticResultModel result;
+    std::chrono::steady_clock::time_point solveStart = std::chrono::steady_clock::now();
+    bool success = solver->solve(problem, result, configuration);
+    double solveTime = seconds_since(solveStart);
+    solver->purge();
+
+    out << "    { \"solver\": \"" << solverName << "\""
+        << ", \"threads\": " << nbThreads
+        << ", \"terrain_cells\": " << size.nbCells
+        << ", \"buildings\": " << size.nbBuildings
+        << ", \"triangles\": " << problem.ntriangles()
+        << ", \"sources\": " << problem.nsources()
+        << ", \"receptors\": " << problem.nreceptors()
+        << ", \"success\": " << (success ? "true" : "false")
+        << ", \"wall_time\": " << seconds_since(start)
+        << ", \"phases\": { \"build_problem\": " << buildTime << ", \"solve\": " << solveTime;
+    // Phases timed by the solver itself (its own "solve" is the one above)
+    const std::map<std::string, double> times = result.get_stats().times();
+    for (std::map<std::string, double>::const_iterator it = times.begin(); it != times.end(); ++it)
+    {
+        if (it->first != "solve") { out << ", \"" << it->first << "\": " << it->second; }
+    }
+    out << " }, \"counters\": {";
+    const std::map<std::string, unsigned long long> counts = result.get_stats().counts();
+    for (std::map<std::string, unsigned long long>::const_iterator it = counts.begin(); it != counts.end(); ++it)
+    {
+        out << (it == counts.begin() ? " \"" : ", \"") << it->first << "\": " << it->second;
+    }
+    out << " }";
+}
+
+/// Solve one case in a child process and write its JSON record with the peak RSS of the child
+/// (without fork(), the case is solved in this process and the record has no peak RSS)
+void run_case(const std::string& solverName, unsigned int nbThreads, const SiteSize& size,
+              unsigned int seed, std::ostream& out)
+{
+#ifndef _WIN32
+    int fds[2];
+    if (pipe(fds) == 0)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            // Child: solve and send the record to the parent
+            close(fds[0]);
+            std::ostringstream record;
+            bench_case(solverName, nbThreads, size, seed, record);
+            const std::string text = record.str();
+            for (size_t done = 0; done < text.size(); )
+            {
+                ssize_t n = write(fds[1], text.data() + done, text.size() - done);
+                if (n <= 0) { _exit(1); }
+                done += n;
+            }
+            close(fds[1]);
+            _exit(0);
+        }
+        close(fds[1]);
+        if (pid > 0)
+        {
+            std::string text;
+            char buffer[4096];
+            ssize_t n;
+            while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) { text.append(buffer, n); }
+            close(fds[0]);
+
+            int status = 0;
+            struct rusage usage;
+            if (wait4(pid, &status, 0, &usage) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+            {
+                out << text << ", \"peak_rss_kb\": " << peak_rss(usage) << " }";
+            }
+            else
+            {
+                out << "    { \"solver\": \"" << solverName << "\""
+                    << ", \"threads\": " << nbThreads
+                    << ", \"terrain_cells\": " << size.nbCells
+                    << ", \"buildings\": " << size.nbBuildings
+                    << ", \"success\": false }";
+            }
+            return;
+        }
+        close(fds[0]);
+    }
+#endif
+    bench_case(solverName, nbThreads, size, seed, out);
+    out << " }";
+}
+
+bool parse_list(const char* arg, std::vector<std::string>& items)
+{
+    std::stringstream list(arg);
+    std::string item;
+    while (std::getline(list, item, ',')) { items.push_back(item); }
+    return !items.empty();
+}
+
+bool parse_options(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (i + 1 >= argc) { return false; }
+        std::vector<std::string> items;
+        if (arg == "--solvers")
+        {
+            if (!parse_list(argv[++i], options.solvers)) { return false; }
+            for (size_t k = 0; k < options.solvers.size(); k++)
+            {
+                if (options.solvers[k] != "default" && options.solvers[k] != "anime3d") { return false; }
+            }
+        }
+        else if (arg == "--threads" && parse_list(argv[++i], items))
+        {
+            for (size_t k = 0; k < items.size(); k++) { options.threads.push_back(std::atoi(items[k].c_str())); }
+        }
+        else if (arg == "--seed") { options.seed = std::atoi(argv[++i]); }
+        else if (arg == "--output") { options.output = argv[++i]; }
+        else if (arg == "--size")
+        {
+            SiteSize size;
+            char sep[3];
+            std::istringstream value(argv[++i]);
+            if (!(value >> size.nbCells >> sep[0] >> size.nbBuildings >> sep[1] >> size.nbSources >> sep[2] >> size.nbReceptors)) { return false; }
+            if (size.nbCells == 0) { return false; }
+            options.sizes.push_back(size);
+        }
+        else { return false; }
+    }
+    if (options.solvers.empty()) { options.solvers.push_back("default"); options.solvers.push_back("anime3d"); }
+    if (options.threads.empty()) { options.threads.push_back(1); }
+    if (options.sizes.empty())
+    {
+        // Default matrix: sizes growing together
+        for (unsigned int k = 1; k <= 3; k++)
+        {
+            SiteSize size;
+            size.nbCells = 10 * k;
+            size.nbBuildings = 5 * k * k;
+            size.nbSources = k;
+            size.nbReceptors = 9 * k * k;
+            options.sizes.push_back(size);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--solvers default,anime3d] [--threads 1,2,4]"
+                  << " [--seed S] [--output file.json] [--size T:B:S:R ...]" << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!options.output.empty()) { file.open(options.output.c_str()); }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+
+    out << "{\n  \"seed\": " << options.seed << ",\n  \"cases\": [";
+    bool first = true;
+    for (size_t z = 0; z < options.sizes.size(); z++)
+        for (size_t s = 0; s < options.solvers.size(); s++)
+            for (size_t t = 0; t < options.threads.size(); t++)
+            {
+                out << (first ? "\n" : ",\n");
+                first = false;
+                run_case(options.solvers[s], options.threads[t], options.sizes[z], options.seed, out);
+                out.flush();
+            }
+    out << "\n  ]\n}\n";
+
+    return 0;
+}
@@ -15,6 +15,8 @@ option(TYMPAN_BUILD_TEST "Build Tympan tests" ON)
 option(TYMPAN_BUILD_PYTHON "Build Python / Cython related components" ON)
 option(TYMPAN_DEBUG_CMAKE "Verbose information messages from CMake" ON)
 option(TYMPAN_USE_NMPB2008 "Use NMPB 2008 library" OFF)
+option(TYMPAN_USE_AVX2 "Build the spectrum kernels with AVX2 instructions" OFF)
+option(TYMPAN_BUILD_BENCHMARK "Build Tympan benchmarks" OFF)
 
 # Configure where to fetch 3rd party dependencies
 # Please cf. the file "3rdparty/README"
@@ -10,6 +10,12 @@ set(IGNORED_WARNINGS "-Wno-sign-compare -Wno-cpp -Wno-unused-function -Wno-stric
 set(WARNINGS_SETTINGS "-Werror -Wall ${IGNORED_WARNINGS} -Winvalid-pch")
 set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} --std=c++11 -frounding-math ${WARNINGS_SETTINGS}")
 
+# The spectrum kernels (Tympan/models/common/spectrum_kernels.h) are vectorized
+# when compiled for AVX2; the resulting binaries need an AVX2 capable CPU.
+if(TYMPAN_USE_AVX2)
+  set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mavx2")
+endif(TYMPAN_USE_AVX2)
+
 ## Building as static libs on Linux mess-up the GUI, maybe because
 ## widget parenting problems related to singletons.
 ## We thus choose to force the 'working' way to compile depending on
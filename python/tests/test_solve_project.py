@@ -11,7 +11,8 @@ import numpy as np
 from utils import TympanTC, TEST_DATA_DIR, TEST_SOLVERS_DIR, PROJECT_BASE
 import tympan.solve_project as tysolve
 from tympan.models import Spectrum
-from tympan.models.solver import Solver, Model, Source
+from tympan.models.solver import Solver, Model, Source, read_results
+from tympan.models.rays import RaysFile
 
 
 class TestSolveProject(TympanTC):
@@ -71,6 +72,21 @@ class TestSolveProject(TympanTC):
                               'TEST_SOURCE_PONCTUELLE_NO_RESU.xml')
         self.run_solve(input_proj)
 
+    def test_solver_project_result_file(self):
+        input_proj = osp.join(TEST_DATA_DIR, 'projects-panel',
+                              'TEST_SOURCE_PONCTUELLE_NO_RESU.xml')
+        output_proj, output_mesh = self.build_tempfiles()
+        with tempfile.NamedTemporaryFile(suffix='.bin', delete=False) as output:
+            fname = output.name
+        try:
+            tysolve.solve(input_proj, output_proj.name, output_mesh.name,
+                          TEST_SOLVERS_DIR, result_file=fname)
+            result = read_results(fname)
+            self.assertGreater(result.nreceptors, 0)
+            self.assertGreater(result.nsources, 0)
+        finally:
+            os.unlink(fname)
+
     def test_solver_config_errors(self):
         input_proj = osp.join(TEST_DATA_DIR, 'empty_site_config_ko.xml')
         with self.assertRaises(configparser.Error) as cm:
@@ -134,6 +150,56 @@ class ProjectResultsTC(TympanTC):
             np.testing.assert_almost_equal(
                 combined_spectra[rec, :], expected_spectra, decimal=4)
 
+    def test_export_rays(self):
+        project = self.load_project(osp.join('projects-panel', 'TEST_CUBE_NO_RESU.xml'))
+        model = Model.from_project(project, set_sources=False)
+        model.add_source(Source((-20, -30, 2), Spectrum.constant(100.0)))
+        solver = Solver.from_project(project, solverdir=TEST_SOLVERS_DIR)
+        solver.anime3D_keep_rays = True
+        try:
+            result = solver.solve(model)
+        finally:
+            solver.anime3D_keep_rays = False
+        with tempfile.NamedTemporaryFile(suffix='.bin', delete=False) as output:
+            fname = output.name
+        try:
+            for quantum in (0., 1e-3):
+                result.export_rays(fname, quantum)
+                rays = RaysFile(fname)
+                self.assertGreater(len(rays), 0)
+                self.assertEqual(rays.quantized, quantum > 0)
+                self.assertEqual(rays.offsets[0], 0)
+                self.assertEqual(rays.offsets[-1], rays.nevents)
+                self.assertTrue((rays.sources < model.nsources).all())
+                self.assertTrue((rays.receptors < model.nreceptors).all())
+                types, positions = rays.events(0)
+                self.assertEqual(positions.shape, (len(types), 3))
+                del rays, types, positions
+        finally:
+            os.unlink(fname)
+
+    def test_result_file(self):
+        project = self.load_project(osp.join('projects-panel', 'TEST_CUBE_NO_RESU.xml'))
+        model = Model.from_project(project, set_sources=False)
+        model.add_source(Source((-20, -30, 2), Spectrum.constant(100.0)))
+        solver = Solver.from_project(project, solverdir=TEST_SOLVERS_DIR)
+        expected = solver.solve(model)
+        with tempfile.NamedTemporaryFile(suffix='.bin', delete=False) as output:
+            fname = output.name
+        try:
+            streamed = solver.solve(model, fname)
+            # The spectra are in the file only
+            self.assertEqual(streamed.nreceptors, 0)
+            self.assertIn('solve', streamed.stats['times'])
+            result = read_results(fname)
+            self.assertEqual(result.nreceptors, model.nreceptors)
+            self.assertEqual(result.nsources, model.nsources)
+            np.testing.assert_allclose(result.spectra(), expected.spectra())
+        finally:
+            os.unlink(fname)
+        with self.assertRaises(IOError):
+            read_results(fname)
+
 
 if __name__ == '__main__':
     import unittest
@@ -173,15 +173,10 @@ cdef class Business2SolverConverter:
             receptor = cy.declare(cy.pointer(tybusiness.TYPointCalcul))
             receptor = tybusiness.downcast_point_calcul(
                 deref(self.instances_mapping.find(brec_id)).second)
-            # retrieve receptor spectra
-            spectra = cy.declare(vector[tycommon.OSpectre])
-            spectra = self.transitional_result_matrix[0].by_receptor(
-                self.bus2solv_receptors[brec_id])
-            # receptor cumulative spectrum
+            # receptor cumulative spectrum (sum of the spectra of all the sources)
             cumul_spectrum = cy.declare(tycommon.OSpectre)
-            cumul_spectrum.setDefaultValue(0.0)
-            for spectrum in spectra:
-                cumul_spectrum = cumul_spectrum.sum(spectrum)
+            cumul_spectrum = self.transitional_result_matrix[0].sum_sources(
+                self.bus2solv_receptors[brec_id])
             # enum TYSpectreType from OSpectre
             cumul_spectrum.setType(tycommon.SPECTRE_TYPE_LP)
             # The values retrieved from the solver are linear. We want to convert
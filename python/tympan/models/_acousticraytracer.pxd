@@ -253,6 +253,7 @@ cdef extern from "Tympan/geometric_methods/AcousticRaytracer/Engine/AcousticRayt
         unsigned int NbRaysPerSource
         unsigned int Discretization
         unsigned int Accelerator
+        unsigned int ReceptorAccelerator
         unsigned int MaxTreeDepth
         unsigned int NbRayWithDiffraction
         unsigned int MaxProfondeur
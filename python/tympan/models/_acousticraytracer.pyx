@@ -74,7 +74,7 @@ cdef class cySimulation:
         accelerator_id = self.getConfiguration().Accelerator
         scene.finish(accelerator_id, FIRST)
         receptors_scene = self.thisptr.get().get_receptors_landscape()
-        receptors_scene.finish(accelerator_id, ALL)
+        receptors_scene.finish(self.getConfiguration().ReceptorAccelerator, ALL)
 
     def setEngine(self):
         """Set the engine"""
@@ -305,6 +305,13 @@ cdef class cyAcousticRaytracerConfiguration:
         return self.thisptr.Accelerator
     Accelerator = property(getAccelerator, setAccelerator)
 
+    def setReceptorAccelerator(self, value):
+        self.thisptr.ReceptorAccelerator = value
+
+    def getReceptorAccelerator(self):
+        return self.thisptr.ReceptorAccelerator
+    ReceptorAccelerator = property(getReceptorAccelerator, setReceptorAccelerator)
+
     def setMaxTreeDepth(self, value):
         self.thisptr.MaxTreeDepth = value
 
@@ -12,7 +12,9 @@ cdef extern from "Tympan/models/common/spectrum_matrix.h" namespace "tympan":
     cdef cppclass SpectrumMatrix:
         SpectrumMatrix()
         SpectrumMatrix(const SpectrumMatrix & matrix)
-        const vector[OSpectre] & by_receptor(size_t receptor_idx) const
+        vector[OSpectre] by_receptor(size_t receptor_idx) const
+        vector[OSpectre] by_source(size_t sources_idx) const
+        OSpectre sum_sources(size_t receptor_idx) const
         OSpectre & element "operator()"(size_t receptor_idx, size_t sources_idx)
         void setSpectre(size_t receptor_idx, size_t sources_idx, OSpectre spectrum)
         void resize(size_t nb_receptors, size_t nb_sources)
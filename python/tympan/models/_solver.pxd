@@ -5,6 +5,7 @@ from libcpp cimport bool
 from libcpp.string cimport string
 from libcpp.vector cimport vector
 from libcpp.deque cimport deque
+from libcpp.map cimport map
 
 from tympan._core cimport SolverInterface
 from tympan.models._common cimport(OPoint3D, OSpectre, OSpectreComplex,
@@ -63,9 +64,25 @@ cdef extern from "Tympan/models/solver/acoustic_problem_model.hpp" namespace "ty
         size_t make_receptor(const OPoint3D & point_)
 
 cdef extern from "Tympan/models/solver/acoustic_result_model.hpp" namespace "tympan":
+    cdef cppclass SolverStats:
+        map[string, double] times()
+        map[string, unsigned long long] counts()
+
+    cdef cppclass ResultSink:
+        pass
+
+    cdef cppclass BinaryResultSink(ResultSink):
+        BinaryResultSink(const string & file_name, bool keep_paths)
+        bool good()
+
+    bool read_binary_results(const string & file_name, SpectrumMatrix & matrix)
+
     cdef cppclass AcousticResultModel:
+        void set_sink(shared_ptr[ResultSink] sink_)
+        SolverStats & get_stats()
         SpectrumMatrix & get_data()
         vector[acoustic_path * ] & get_path_data()
+        bool export_path_data(const string & file_name, double quantum)
 
 cdef extern from "Tympan/models/solver/data_model_common.hpp":
     cdef cppclass BaseEntity:
@@ -141,12 +158,15 @@ cdef extern from "Tympan/models/solver/config.h" namespace "tympan":
         bool UsePathDifValidation
         int Discretization
         int Accelerator
+        int ReceptorAccelerator
         int NbRaysPerSource
         float MaxLength
         float AngleDiffMin
         bool UsePostFilters
         int NbRayWithDiffraction
         bool ModSummation
+        bool UseAttenuationCache
+        float AttenuationCacheTolerance
         bool UseLateralDiffraction
         bool UseRealGround
         int NbThreads
@@ -159,6 +179,8 @@ cdef extern from "Tympan/models/solver/config.h" namespace "tympan":
         float H1parameter
         double AnalyticTMax
         double AnalyticH
+        bool AnalyticAdaptiveStep
+        double AnalyticTolerance
         int AnalyticNbRay
         float FinalAngleTheta
         double AnalyticDMax
@@ -210,6 +210,18 @@ cdef class ResultModel:
     def __cinit__(self):
         self.thisptr = shared_ptr[AcousticResultModel](new AcousticResultModel())
 
+    @staticmethod
+    def from_file(file_name):
+        """Load the spectra of a results file written by Solver.solve_problem()
+
+        Raises an IOError if the file can not be read or is not complete.
+        """
+        result = cy.declare(ResultModel, ResultModel())
+        if not read_binary_results(file_name.encode('utf-8'),
+                                   result.thisptr.get().get_data()):
+            raise IOError('could not read the results from %s' % file_name)
+        return result
+
     def spectrum(self, id_receptor, id_source):
         """Return the power spectrum received by a receptor from a source
         """
@@ -246,22 +258,59 @@ cdef class ResultModel:
             return np.zeros((self.nreceptors, 31))
         return self.spectra().sum(axis=1)
 
+    def export_rays(self, file_name, quantum=0.):
+        """Export the rays kept by the solver to a columnar binary file
+
+        The positions are rounded to a multiple of 'quantum' (if not 0) and
+        stored on 32 bits. Use tympan.models.rays.RaysFile to read the file.
+        Raises an IOError if the file can not be written.
+        """
+        if not self.thisptr.get().export_path_data(file_name.encode('utf-8'), quantum):
+            raise IOError('could not export the rays to %s' % file_name)
+
+    @property
+    def stats(self):
+        """Statistics of the last computation: a dict with the 'times' spent in
+        each phase (in seconds) and the 'counts' of each counter (rays traced,
+        intersections, rejections per selector...)
+        """
+        times = self.thisptr.get().get_stats().times()
+        counts = self.thisptr.get().get_stats().counts()
+        return {'times': {name.decode('utf-8'): value for name, value in times.items()},
+                'counts': {name.decode('utf-8'): value for name, value in counts.items()}}
+
 
 cdef class Solver:
 
     @cy.locals(model=ProblemModel)
     @cy.returns((bool, ResultModel))
-    def solve_problem(self, model):
+    def solve_problem(self, model, result_file=None, keep_paths=True):
         """Run a computation based on the solver model given in argument
 
-        Raises a RuntimeError in case of computation failure.
+        If 'result_file' is given, the results are streamed to this binary
+        file as they are computed instead of being stored in the returned
+        result, which then only holds the statistics (the paths are written
+        too if 'keep_paths'). Use ResultModel.from_file() to load the file.
+
+        Raises a RuntimeError in case of computation failure, an IOError if
+        the results file can not be written.
         """
         result = ResultModel()
+        sink = cy.declare(cy.pointer(BinaryResultSink), NULL)
+        if result_file is not None:
+            sink = new BinaryResultSink(result_file.encode('utf-8'), keep_paths)
+            result.thisptr.get().set_sink(shared_ptr[ResultSink](sink))
         if not self.thisptr.solve(model.thisptr.get()[0],
                                   result.thisptr.get()[0], get()):
             raise RuntimeError(
                 'Computation failed (C++ SolverInterface::solve() method '
                 'returned false)')
+        if sink != NULL:
+            written = sink.good()
+            # Close the file
+            result.thisptr.get().set_sink(shared_ptr[ResultSink]())
+            if not written:
+                raise IOError('could not write the results to %s' % result_file)
         return result
 
     def purge(self):
@@ -541,6 +590,13 @@ cdef class Configuration:
         self.thisptr.getRealPointer().Accelerator = value
     Accelerator = property(getAccelerator, setAccelerator)
 
+    def getReceptorAccelerator(self):
+        return self.thisptr.getRealPointer().ReceptorAccelerator
+
+    def setReceptorAccelerator(self, value):
+        self.thisptr.getRealPointer().ReceptorAccelerator = value
+    ReceptorAccelerator = property(getReceptorAccelerator, setReceptorAccelerator)
+
     def getNbRaysPerSource(self):
         return self.thisptr.getRealPointer().NbRaysPerSource
 
@@ -584,6 +640,20 @@ cdef class Configuration:
         self.thisptr.getRealPointer().ModSummation = value
     ModSummation = property(getModSummation, setModSummation)
 
+    def getUseAttenuationCache(self):
+        return self.thisptr.getRealPointer().UseAttenuationCache
+
+    def setUseAttenuationCache(self, value):
+        self.thisptr.getRealPointer().UseAttenuationCache = value
+    UseAttenuationCache = property(getUseAttenuationCache, setUseAttenuationCache)
+
+    def getAttenuationCacheTolerance(self):
+        return self.thisptr.getRealPointer().AttenuationCacheTolerance
+
+    def setAttenuationCacheTolerance(self, value):
+        self.thisptr.getRealPointer().AttenuationCacheTolerance = value
+    AttenuationCacheTolerance = property(getAttenuationCacheTolerance, setAttenuationCacheTolerance)
+
     def getUseLateralDiffraction(self):
         return self.thisptr.getRealPointer().UseLateralDiffraction
 
@@ -669,6 +739,20 @@ cdef class Configuration:
         self.thisptr.getRealPointer().AnalyticH = value
     AnalyticH = property(getAnalyticH, setAnalyticH)
 
+    def getAnalyticAdaptiveStep(self):
+        return self.thisptr.getRealPointer().AnalyticAdaptiveStep
+
+    def setAnalyticAdaptiveStep(self, value):
+        self.thisptr.getRealPointer().AnalyticAdaptiveStep = value
+    AnalyticAdaptiveStep = property(getAnalyticAdaptiveStep, setAnalyticAdaptiveStep)
+
+    def getAnalyticTolerance(self):
+        return self.thisptr.getRealPointer().AnalyticTolerance
+
+    def setAnalyticTolerance(self, value):
+        self.thisptr.getRealPointer().AnalyticTolerance = value
+    AnalyticTolerance = property(getAnalyticTolerance, setAnalyticTolerance)
+
     def getAnalyticNbRay(self):
         return self.thisptr.getRealPointer().AnalyticNbRay
 
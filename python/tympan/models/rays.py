@@ -0,0 +1,85 @@
+"""Read the rays exported by ResultModel.export_rays
+
+The file is made of columns (see Tympan/models/common/acoustic_path_columns.h):
+the events of all the rays are stored in contiguous arrays and the events of
+the ray i are in the range [offsets[i], offsets[i+1]). Each array is padded
+to a multiple of 8 bytes. The arrays are memory mapped: opening a file does not
+read the events.
+"""
+
+import numpy as np
+
+MAGIC = b'TYRP'
+VERSION = 2
+QUANTIZED = 1
+
+_HEADER = np.dtype([('magic', 'S4'), ('version', '<u4'), ('flags', '<u4'),
+                    ('unused', '<u4'), ('npaths', '<u8'), ('nevents', '<u8'),
+                    ('origin', '<f8', (3,)), ('quantum', '<f8')])
+
+# Event types (ACOUSTIC_EVENT_TYPES)
+DIFFRACTION = 1
+REFLECTION = 2
+GROUND_REFLECTION = 4
+REFRACTION = 8
+SOURCE = 16
+RECEPTOR = 32
+
+
+class RaysFile(object):
+    """Memory mapped rays file
+
+    Attributes:
+
+    - offsets: first event of each ray (npaths + 1 values)
+    - sources, receptors: source and receptor indices of each ray
+    - types, faces: type and face id of each event
+    - raw_positions: positions as stored (nevents x 3, int32 if quantized)
+    """
+
+    def __init__(self, file_name):
+        header = np.fromfile(file_name, dtype=_HEADER, count=1)
+        if len(header) != 1 or header['magic'][0] != MAGIC:
+            raise IOError('%s is not a rays file' % file_name)
+        if header['version'][0] != VERSION:
+            raise IOError('unsupported rays file version %d' % header['version'][0])
+        self.npaths = int(header['npaths'][0])
+        self.nevents = int(header['nevents'][0])
+        self.quantized = bool(header['flags'][0] & QUANTIZED)
+        self.origin = header['origin'][0].copy()
+        self.quantum = float(header['quantum'][0])
+
+        offset = _HEADER.itemsize
+
+        def column(dtype, shape):
+            nonlocal offset
+            size = int(np.prod(shape))
+            array = np.memmap(file_name, dtype=dtype, mode='r', offset=offset, shape=shape) \
+                if size else np.empty(shape, dtype=dtype)
+            offset += (size * np.dtype(dtype).itemsize + 7) // 8 * 8
+            return array
+
+        self.offsets = column('<u8', (self.npaths + 1,))
+        self.sources = column('<u4', (self.npaths,))
+        self.receptors = column('<u4', (self.npaths,))
+        self.types = column('<i4', (self.nevents,))
+        self.faces = column('<i4', (self.nevents,))
+        self.raw_positions = column('<i4' if self.quantized else '<f8', (self.nevents, 3))
+
+    def __len__(self):
+        return self.npaths
+
+    @property
+    def positions(self):
+        """Positions of the events (nevents x 3 array of floats)"""
+        if self.quantized:
+            return self.origin + self.quantum * self.raw_positions
+        return self.raw_positions
+
+    def events(self, idx):
+        """Return the (types, positions) of the events of the ray 'idx'"""
+        start, stop = self.offsets[idx], self.offsets[idx + 1]
+        positions = self.raw_positions[start:stop]
+        if self.quantized:
+            positions = self.origin + self.quantum * positions
+        return self.types[start:stop], positions
@@ -200,9 +200,18 @@ class Solver(object):
         capital_name = 'set' + ''.join(s[0].upper() + s[1:] for s in name.split('_'))
         return getattr(cysolver.Configuration.get(),capital_name)(value)
 
-    def solve(self, model):
-        """Solve the acoustic problem described in the model (run a computation)"""
-        return self._solver.solve_problem(model._model)
+    def solve(self, model, result_file=None):
+        """Solve the acoustic problem described in the model (run a computation)
+
+        If result_file is given, the results are streamed to this binary file
+        (see read_results()) and the returned result only holds the statistics.
+        """
+        return self._solver.solve_problem(model._model, result_file)
+
+
+def read_results(result_file):
+    """Load the results written by Solver.solve(model, result_file)"""
+    return cysolver.ResultModel.from_file(result_file)
 
 
 def fetch_solverdir():
@@ -5,11 +5,12 @@ logging.basicConfig(filename='tympan.log', level=logging.DEBUG,
                     format='%(levelname)s:%(asctime)s - %(name)s - %(message)s')
 
 from tympan.models.project import Project
-from tympan.models.solver import Model, Solver
+from tympan.models.solver import Model, Solver, read_results
 
 
 def solve(input_project, output_project, output_mesh, solverdir, parameters={},
-          multithreading_on=True, interactive=False, verbose=False, altimetry_parameters={}):
+          multithreading_on=True, interactive=False, verbose=False, altimetry_parameters={},
+          result_file=None):
     """ Solve an acoustic problem with Code_TYMPAN from
 
         Keywords arguments:
@@ -33,6 +34,9 @@ def solve(input_project, output_project, output_mesh, solverdir, parameters={},
         nb_threads, use_real_ground, use_screen, use_lateral_diffraction, use_reflection, propa_conditions, h1parameter, mod_summation, use_meteo,
         use_fresnel_area, anime3D_sigma, anime3D_forceC, anime3D_keep_rays, debug_use_close_event_selector, debug_use_diffraction_angle_selector,
         debug_use_diffraction_path_selector, debug_use_fermat_selector, debug_use_face_selector
+        result_file -- binary file the solver streams its results to instead of keeping
+        them in memory (see tympan.models.solver.read_results). The results are read
+        back from it to update the project.
     -------
         optional (debug):
         multithreading_on -- set it to False to solve the acoustic problem with only
@@ -75,14 +79,21 @@ def solve(input_project, output_project, output_mesh, solverdir, parameters={},
     _check_solver_model(model, project.site)
     logging.debug("Calling C++ SolverInterface::solve() method")
     try:
-        solver_result = solver.solve(model)
+        solver_result = solver.solve(model, result_file)
     except RuntimeError as exc:
         logging.error(str(exc))
         logging.info("It doesn't work", str(exc))
         raise
     logging.info("Solver computation done !")
+    stats = solver_result.stats
+    for phase, seconds in sorted(stats['times'].items()):
+        logging.info("Solver phase %s: %.3f s", phase, seconds)
+    for counter, value in sorted(stats['counts'].items()):
+        logging.info("Solver counter %s: %d", counter, value)
     # Export solver results to the business model
     logging.info("Loading results from solver ...")
+    if result_file is not None:
+        solver_result = read_results(result_file)
     project.import_result(model, solver_result)
     # Reserialize project
     try:
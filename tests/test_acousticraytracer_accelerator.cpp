@@ -13,12 +13,13 @@
 #include "Tympan/geometric_methods/AcousticRaytracer/Accelerator/BvhAccelerator.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Accelerator/KdtreeAccelerator.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Geometry/Triangle.h"
+#include "Tympan/geometric_methods/AcousticRaytracer/Geometry/TriangleBuffer.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Geometry/Cylindre.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Acoustic/Recepteur.h"
 
 
 // comparison between intersections (used to sort them by their t attribute)
-bool compareIntersections(const Intersection& first, Intersection& second)
+bool compareIntersections(const Intersection& first, const Intersection& second)
 {
 	return ( first.t < second.t );
 }
@@ -125,11 +126,11 @@ TEST(test_accelerator, brute_force)
 	accelerator.setIntersectionChoice(leafTreatment::ALL); //keep all intersections found
 
 	//ray1's intersections
-	std::list<Intersection> result;
+	IntersectionBuffer result;
 	accelerator.traverse(rays.at(0),result); //traverse the accelerating structure to find intersections
 	result.sort(compareIntersections);		 //sort intersections by their distance (t attribute)
 
-	std::list<Intersection>::iterator inter=result.begin();
+	IntersectionBuffer::iterator inter=result.begin();
 	ASSERT_EQ(3,result.size());				  //should find 3 intersections
 	EXPECT_EQ("t1", inter->p->getName());     //intersect the first triangle
 	EXPECT_EQ("t2", (++inter)->p->getName()); //then intersect the second triangle
@@ -194,11 +195,11 @@ TEST(test_accelerator, grid)
 	accelerator.setIntersectionChoice(leafTreatment::ALL); //keep all intersections found
 
 	//ray1's intersections
-	std::list<Intersection> result;
+	IntersectionBuffer result;
 	accelerator.traverse(rays.at(0),result); //traverse the accelerating structure to find intersections
 	result.sort(compareIntersections);		 //sort intersections by their distance (t attribute)
 
-	std::list<Intersection>::iterator inter=result.begin();
+	IntersectionBuffer::iterator inter=result.begin();
 	ASSERT_EQ(5,result.size());				  //should find 5 intersections (because one primitive can be contained in multiple cells of the grid)
 	EXPECT_EQ("t1", inter->p->getName());     //intersect the first triangle
 	EXPECT_EQ("t1", (++inter)->p->getName()); //intersect the first triangle a second time
@@ -269,11 +270,11 @@ TEST(test_accelerator, bvh)
 	accelerator.setIntersectionChoice(leafTreatment::ALL); //keep all intersections found
 
 	//ray1's intersections
-	std::list<Intersection> result;
+	IntersectionBuffer result;
 	accelerator.traverse(rays.at(0),result); //traverse the accelerating structure to find intersections
 	result.sort(compareIntersections);		 //sort intersections by their distance (t attribute)
 
-	std::list<Intersection>::iterator inter=result.begin();
+	IntersectionBuffer::iterator inter=result.begin();
 	ASSERT_EQ(3,result.size());				  //should find 3 intersections
 	EXPECT_EQ("t1", inter->p->getName());     //intersect the first triangle
 	EXPECT_EQ("t2", (++inter)->p->getName()); //then intersect the second triangle
@@ -337,11 +338,11 @@ TEST(test_accelerator, kdtree)
 	accelerator.setIntersectionChoice(leafTreatment::ALL); //keep all intersections found
 
 	//ray1's intersections
-	std::list<Intersection> result;
+	IntersectionBuffer result;
 	accelerator.traverse(rays.at(0),result); //traverse the accelerating structure to find intersections
 	result.sort(compareIntersections);		 //sort intersections by their distance (t attribute)
 
-	std::list<Intersection>::iterator inter=result.begin();
+	IntersectionBuffer::iterator inter=result.begin();
 	ASSERT_EQ(5,result.size());				  //should find 5 intersections (because a split can occure on a primitive)
 	EXPECT_EQ("t1", inter->p->getName());     //intersect the first triangle
 	EXPECT_EQ("t1", (++inter)->p->getName()); //intersect the first triangle a second time
@@ -387,6 +388,202 @@ TEST(test_accelerator, kdtree)
 	EXPECT_EQ("r5", (++inter)->p->getName());//and finally intersect the fifth receptor
 }
 
+TEST(test_accelerator, bvh_packet)
+{
+	std::vector<Shape*> shapes;
+	std::vector<Ray*> rays;
+
+	initShapesAndRays(shapes,rays);
+
+	//Add rays in all direction octants, thrown from the same point
+	for(int i=0; i < 12; i++) {
+		vec3 dir=vec3((decimal)cos(i*0.55),(decimal)sin(i*0.55),(decimal)(i%3-1)*(decimal)0.4);
+		dir.normalize();
+		rays.push_back(new Ray(vec3(2,2,1),dir));
+	}
+	ASSERT_EQ((size_t)Accelerator::MAX_PACKET_SIZE,rays.size());
+
+	BBox globalBbox;
+	for(unsigned int i=0; i < shapes.size();i++) {
+		globalBbox=globalBbox.Union(shapes.at(i)->getBBox());
+	}
+
+	BvhAccelerator accelerator(&shapes,globalBbox,1);
+	ASSERT_TRUE(accelerator.build());
+
+	leafTreatment::treatment choices[2] = { leafTreatment::FIRST, leafTreatment::ALL };
+	for(int c=0; c < 2; c++) {
+		accelerator.setIntersectionChoice(choices[c]);
+
+		//The packet traversal should give the same results as the ray by ray traversal
+		IntersectionBuffer results[Accelerator::MAX_PACKET_SIZE];
+		decimal tmins[Accelerator::MAX_PACKET_SIZE];
+		accelerator.traversePacket(&rays[0],rays.size(),results,tmins);
+
+		for(unsigned int i=0; i < rays.size(); i++) {
+			IntersectionBuffer result;
+			EXPECT_EQ(accelerator.traverse(rays.at(i),result),tmins[i]);
+			ASSERT_EQ(result.size(),results[i].size());
+			IntersectionBuffer::iterator it=results[i].begin();
+			for(IntersectionBuffer::iterator inter=result.begin(); inter != result.end(); inter++, it++) {
+				EXPECT_EQ(inter->p,it->p);
+				EXPECT_EQ(inter->t,it->t);
+			}
+		}
+	}
+}
+
+
+// The SAH BVH built by several threads should be the same as the one built by a single thread,
+// and both should find the same closest intersections as the brute force accelerator
+TEST(test_accelerator, bvh_sah_parallel_build)
+{
+	Material material;
+	std::vector<Shape*> shapes;
+	BBox globalBbox;
+
+	//Small triangles scattered over a terrain-like area
+	srand(42);
+	for(unsigned int i=0; i < 20000; i++) {
+		vec3 p((decimal)(rand()%2000),(decimal)(rand()%2000),(decimal)(rand()%20));
+		Triangle* t=new Triangle(p,p+vec3(3,0,(decimal)(rand()%3)),p+vec3(0,3,1),&material);
+		shapes.push_back(t);
+		globalBbox=globalBbox.Union(t->getBBox());
+	}
+
+	BruteForceAccelerator bruteForce(&shapes,globalBbox);
+	BvhAccelerator bvh(&shapes,globalBbox,12,"sah");
+	bvh.setNbBuildThreads(1);
+	BvhAccelerator parallelBvh(&shapes,globalBbox,12,"sah");
+	parallelBvh.setNbBuildThreads(4);
+	ASSERT_TRUE(bruteForce.build());
+	ASSERT_TRUE(bvh.build());
+	ASSERT_TRUE(parallelBvh.build());
+	EXPECT_EQ(bvh.getNbNodes(),parallelBvh.getNbNodes());
+	EXPECT_LT(bvh.getNbNodes(),2*shapes.size());
+
+	for(unsigned int i=0; i < 200; i++) {
+		vec3 dir((decimal)(rand()%200-100),(decimal)(rand()%200-100),(decimal)(-rand()%100-1));
+		dir.normalize();
+		Ray ray(vec3((decimal)(rand()%2000),(decimal)(rand()%2000),50),dir);
+
+		IntersectionBuffer expected, result, parallelResult;
+		decimal tmin=bruteForce.traverse(&ray,expected);
+		EXPECT_EQ(tmin,bvh.traverse(&ray,result));
+		EXPECT_EQ(tmin,parallelBvh.traverse(&ray,parallelResult));
+		ASSERT_EQ(expected.size(),result.size());
+		ASSERT_EQ(expected.size(),parallelResult.size());
+		if(!expected.empty()) {
+			EXPECT_EQ(expected.back().p,result.back().p);
+			EXPECT_EQ(expected.back().p,parallelResult.back().p);
+		}
+	}
+
+	for(unsigned int i=0; i < shapes.size(); i++) {
+		delete shapes[i];
+	}
+}
+
+TEST(test_accelerator, triangle_buffer)
+{
+	std::vector<Shape*> shapes;
+	std::vector<Ray*> rays;
+
+	initShapesAndRays(shapes,rays);
+
+	TriangleBuffer triangles;
+	triangles.build(shapes);
+
+	//Only the triangles are stored in the buffer
+	for(unsigned int i=0; i < shapes.size(); i++) {
+		EXPECT_EQ(shapes.at(i)->form()==TRIANGLE,triangles.contains(i));
+	}
+	EXPECT_FALSE(triangles.contains(shapes.size()));
+
+	//The buffer should give the same intersections as the triangles
+	for(unsigned int i=0; i < shapes.size(); i++) {
+		if(!triangles.contains(i)) continue;
+		for(unsigned int j=0; j < rays.size(); j++) {
+			Intersection expected, inter;
+			bool found=shapes.at(i)->getIntersection(*rays.at(j),expected);
+			ASSERT_EQ(found,triangles.getIntersection(i,*rays.at(j),inter));
+			if(found) {
+				EXPECT_EQ(expected.t,inter.t);
+				EXPECT_EQ(expected.p,inter.p);
+				EXPECT_EQ(TRIANGLE,inter.forme);
+			}
+		}
+	}
+
+	//An accelerator using the buffer should find the same intersections
+	BBox globalBbox;
+	for(unsigned int i=0; i < shapes.size();i++) {
+		globalBbox=globalBbox.Union(shapes.at(i)->getBBox());
+	}
+	BruteForceAccelerator accelerator(&shapes,globalBbox);
+	accelerator.setIntersectionChoice(leafTreatment::ALL);
+	BruteForceAccelerator flat_accelerator(&shapes,globalBbox);
+	flat_accelerator.setIntersectionChoice(leafTreatment::ALL);
+	flat_accelerator.setTriangleBuffer(&triangles);
+	for(unsigned int j=0; j < rays.size(); j++) {
+		IntersectionBuffer expected, result;
+		accelerator.traverse(rays.at(j),expected);
+		flat_accelerator.traverse(rays.at(j),result);
+		ASSERT_EQ(expected.size(),result.size());
+		IntersectionBuffer::iterator it=result.begin();
+		for(IntersectionBuffer::iterator inter=expected.begin(); inter != expected.end(); inter++, it++) {
+			EXPECT_EQ(inter->p,it->p);
+			EXPECT_EQ(inter->t,it->t);
+		}
+	}
+}
+
+
+
+TEST(test_intersection_buffer, grow_erase_and_swap)
+{
+	IntersectionBuffer buffer;
+	EXPECT_TRUE(buffer.empty());
+
+	//Store more intersections than the inline capacity
+	for(int i=0; i < 20; i++) {
+		Intersection inter;
+		inter.t=(decimal)i;
+		buffer.push_back(inter);
+	}
+	ASSERT_EQ(20,buffer.size());
+	for(int i=0; i < 20; i++) {
+		EXPECT_EQ((decimal)i,buffer[i].t);
+	}
+
+	//Erase the odd ones, the order is kept
+	IntersectionBuffer::iterator it=buffer.begin();
+	while(it != buffer.end()) {
+		if(((int)it->t)%2 == 1)
+			it=buffer.erase(it);
+		else
+			it++;
+	}
+	ASSERT_EQ(10,buffer.size());
+	for(int i=0; i < 10; i++) {
+		EXPECT_EQ((decimal)(2*i),buffer[i].t);
+	}
+
+	//Swap with a buffer using its inline storage
+	IntersectionBuffer other;
+	Intersection inter;
+	inter.t=100;
+	other.push_back(inter);
+	buffer.swap(other);
+	ASSERT_EQ(1,buffer.size());
+	EXPECT_EQ((decimal)100,buffer.front().t);
+	ASSERT_EQ(10,other.size());
+	EXPECT_EQ((decimal)18,other.back().t);
+
+	buffer.clear();
+	EXPECT_TRUE(buffer.empty());
+}
+
 
 
 /***********************************************************************
@@ -396,7 +593,7 @@ TEST(test_accelerator, kdtree)
 TEST(test_leaf_treatment, keep_first)
 {
 
-	std::list<Intersection> intersections;
+	IntersectionBuffer intersections;
 
 	Intersection inter1;
 	inter1.t=-1;
@@ -435,7 +632,7 @@ TEST(test_leaf_treatment, keep_first)
 TEST(test_leaf_treatment, keep_all_before_triangle)
 {
 
-	std::list<Intersection> intersections;
+	IntersectionBuffer intersections;
 
 	Intersection inter1;
 	inter1.t=2;
@@ -491,7 +688,7 @@ TEST(test_leaf_treatment, keep_all_before_triangle)
 TEST(test_leaf_treatment, keep_all_before_visible)
 {
 
-	std::list<Intersection> intersections;
+	IntersectionBuffer intersections;
 
 	Intersection inter1;
 	inter1.t=2;
@@ -547,7 +744,7 @@ TEST(test_leaf_treatment, keep_all_before_visible)
 TEST(test_leaf_treatment, keep_all)
 {
 
-	std::list<Intersection> intersections;
+	IntersectionBuffer intersections;
 
 	Intersection inter1;
 	inter1.t=2;
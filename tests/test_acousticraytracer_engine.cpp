@@ -61,4 +61,38 @@ TEST(test_engine, test_genray)
     
     EXPECT_TRUE(new_ray_null==NULL);
 
+}
+TEST(test_engine, test_structure_benchmark)
+{
+    // A ground of 2 triangles under a box of rays
+    Simulation simu;
+    Scene* scene = simu.getScene();
+    Material* m = new Material();
+    unsigned int a, b, c, d, e;
+    scene->addVertex(vec3(-10, -10, 0), a);
+    scene->addVertex(vec3(10, -10, 0), b);
+    scene->addVertex(vec3(10, 10, 0), c);
+    scene->addVertex(vec3(-10, 10, 0), d);
+    scene->addVertex(vec3(0, 0, 10), e);
+    scene->addTriangle(a, b, c, m, true);
+    scene->addTriangle(a, c, d, m, true);
+    scene->addTriangle(a, b, e, m, false);
+
+    // Every accelerator finds the same intersections for the same seed
+    BenchmarkResult expected;
+    for (int accelerator = 0; accelerator < 4; accelerator++)
+    {
+        scene->finish(accelerator);
+        BenchmarkResult result = simu.runBenchmark(2000, 42);
+        EXPECT_EQ(2000, result.nbRays);
+        EXPECT_GT(result.nbHits, 0);
+        EXPECT_LE(result.nbHits, result.nbIntersections);
+        if (accelerator == 0) { expected = result; continue; }
+        EXPECT_EQ(expected.nbHits, result.nbHits);
+        EXPECT_EQ(expected.nbIntersections, result.nbIntersections);
+    }
+
+    // Another seed gives other rays
+    BenchmarkResult other = simu.runBenchmark(2000, 43);
+    EXPECT_NE(expected.nbHits, other.nbHits);
 }
\ No newline at end of file
@@ -569,15 +569,118 @@ TEST(test_ray, signature)
     signature sig = ray->getSignature();
 
     // first and last events are specular reflections => code = 1001 which is equal to 9 in base 10
-    unsigned int SR = sig.first, SD = sig.second;
-    EXPECT_EQ(9, SD);
+    bitSet SR = sig.first, SD = sig.second;
+    EXPECT_EQ(9u, SD);
 
     // check the source's id
-    unsigned int S = SR >> 20;
-    EXPECT_EQ(1536, S);
+    unsigned int S = static_cast<unsigned int>(SR >> 32);
+    EXPECT_EQ(1536u, S);
+    EXPECT_EQ(1536u, Ray::getSourceId(SR));
 
     // check the receptor's id
-    unsigned int R = (SR << 12) >> 12;
-    EXPECT_EQ(5435, R);
+    unsigned int R = static_cast<unsigned int>(SR & 0xFFFFFFFFULL);
+    EXPECT_EQ(5435u, R);
+    EXPECT_EQ(5435u, Ray::getReceptorId(SR));
+
+    // ids beyond 4096 sources and 1M receptors are kept
+    src->setId(250000);
+    rcpt->setId(40000000);
+    sig = ray->getSignature();
+    EXPECT_EQ(250000u, Ray::getSourceId(sig.first));
+    EXPECT_EQ(40000000u, Ray::getReceptorId(sig.first));
+    EXPECT_NE(sig.first, ray->getSRBitSet(250001, 40000000));
+    EXPECT_NE(sig.first, ray->getSRBitSet(250000, 40000001));
+}
+
+// Test the copy-on-write history of the events shared by the copies of a ray
+TEST(test_ray, shared_event_history)
+{
+    Ray* ray = new Ray();
+
+    Event* ev0 = new Event();
+    ev0->setType(SPECULARREFLEXION);
+    boost::shared_ptr<Event> SPE0(ev0);
+    ray->getEvents()->push_back(SPE0);
+
+    // The copy shares the events storage of the original ray
+    Ray* copy = new Ray(ray);
+    EXPECT_TRUE(ray->getEvents()->isShared());
+    EXPECT_TRUE(copy->getEvents()->isShared());
+    EXPECT_EQ(1, copy->getEvents()->size());
+
+    // Adding an event to the copy leaves the original ray untouched
+    Event* ev1 = new Event();
+    ev1->setType(DIFFRACTION);
+    boost::shared_ptr<Event> SPE1(ev1);
+    copy->getEvents()->push_back(SPE1);
+    EXPECT_FALSE(ray->getEvents()->isShared());
+    EXPECT_EQ(1, ray->getEvents()->size());
+    EXPECT_EQ(2, copy->getEvents()->size());
+    EXPECT_EQ(ev0, copy->getEvents()->at(0).get());
+    EXPECT_EQ(ev1, copy->getEvents()->back().get());
+
+    // Erasing in a shared history leaves the other copy untouched as well
+    Ray* copy2 = new Ray(*copy);
+    copy2->getEvents()->erase(copy2->getEvents()->begin());
+    EXPECT_EQ(1, copy2->getEvents()->size());
+    EXPECT_EQ(ev1, copy2->getEvents()->front().get());
+    EXPECT_EQ(2, copy->getEvents()->size());
+
+    // The events survive the deletion of the ray which has created them
+    delete ray;
+    EXPECT_EQ(SPECULARREFLEXION, copy->getEvents()->at(0)->getType());
+
+    delete copy;
+    delete copy2;
+}
+
+// Test the reuse of the blocks released to the rays pool
+TEST(test_ray, pool_allocation)
+{
+    std::vector<Ray*> rays;
+    for (unsigned int i = 0; i < 1000; i++)
+    {
+        rays.push_back(new Ray());
+        rays.back()->setConstructId(i);
+    }
+    for (unsigned int i = 0; i < rays.size(); i++)
+    {
+        EXPECT_EQ(i, rays[i]->getConstructId());
+    }
+
+    Ray* released = rays.back();
+    delete released;
+    rays.pop_back();
+
+    // The last released block is the first one given again
+    Ray* ray = new Ray();
+    EXPECT_EQ(released, ray);
+    rays.push_back(ray);
+
+    for (unsigned int i = 0; i < rays.size(); i++)
+    {
+        delete rays[i];
+    }
+}
 
+
+// Test that the memory of the pool can be released once the rays are deleted
+TEST(test_ray, pool_release)
+{
+    std::vector<Ray*> rays;
+    for (unsigned int i = 0; i < 1000; i++) { rays.push_back(new Ray()); }
+
+    // Living rays keep the slabs
+    Ray::releasePoolMemory();
+    rays[10]->setLongueur(12.);
+    EXPECT_EQ(12., rays[10]->getLongueur());
+
+    for (unsigned int i = 0; i < rays.size(); i++) { delete rays[i]; }
+    Ray::releasePoolMemory();
+
+    // The pool allocates new slabs afterwards
+    Ray* ray = new Ray();
+    ray->setLongueur(3.);
+    EXPECT_EQ(3., ray->getLongueur());
+    delete ray;
 }
\ No newline at end of file
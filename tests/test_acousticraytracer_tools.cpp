@@ -1673,6 +1673,44 @@ TEST(test_FaceSelector_insertWithTest, history_face_mode)
 	EXPECT_FALSE(selector.insertWithTest(r4)); // same primitiveId sequence as r3 but with longer length => response should return FALSE
 }
 
+//Test the HistoryTable used by the FaceSelector
+TEST(test_HistoryTable, find_and_insert)
+{
+	HistoryTable<int> table;
+	std::vector<unsigned int> history(3);
+
+	// Enough histories to grow the table several times
+	for (unsigned int i = 0; i < 1000; i++)
+	{
+		history[0] = i % 7; history[1] = i; history[2] = i / 3;
+		unsigned long long hash = HistoryTable<int>::hashOf(history);
+		ASSERT_TRUE(table.find(history, hash) == NULL);
+		table.insert(history, hash, static_cast<int>(i));
+	}
+	EXPECT_EQ(1000u, table.size());
+
+	for (unsigned int i = 0; i < 1000; i++)
+	{
+		history[0] = i % 7; history[1] = i; history[2] = i / 3;
+		HistoryTable<int>::Entry* entry = table.find(history, HistoryTable<int>::hashOf(history));
+		ASSERT_TRUE(entry != NULL);
+		EXPECT_EQ(static_cast<int>(i), entry->value);
+	}
+
+	// Histories with the same hash are told apart by their ids
+	std::vector<unsigned int> other(2, 5);
+	history.assign(2, 4);
+	table.insert(history, 42, 1);
+	EXPECT_TRUE(table.find(other, 42) == NULL);
+	table.insert(other, 42, 2);
+	EXPECT_EQ(1, table.find(history, 42)->value);
+	EXPECT_EQ(2, table.find(other, 42)->value);
+
+	table.clear();
+	EXPECT_EQ(0u, table.size());
+	EXPECT_TRUE(table.find(history, 42) == NULL);
+}
+
 
 
 
@@ -2719,7 +2757,7 @@ TEST(test_ReflectionSelector_canBeInserted, ground_reflection)
 	response=selector.canBeInserted(r,replace);
 	EXPECT_EQ(SELECTOR_ACCEPT,response); //selector set to accept ground reflexions => response should be SELECTOR_ACCEPT
 
-	r->getEvents()->at(0)=SPE3; //replace first reflexion by a diffraction
+	r->getEvents()->set(0, SPE3); //replace first reflexion by a diffraction
 	selector.setGroundAccepted(false); //refuse ground reflexion
 	response=selector.canBeInserted(r,replace);
 	EXPECT_EQ(SELECTOR_ACCEPT,response); //the event interacting with the ground is a diffraction => response should be SELECTOR_ACCEPT
@@ -2861,7 +2899,7 @@ TEST(test_ReflectionSelector_insertWithTest, ground_reflection)
 	selector.setGroundAccepted(true); //accept ground reflexion
 	EXPECT_TRUE(selector.insertWithTest(r)); //selector set to accept ground reflexions => should return TRUE
 
-	r->getEvents()->at(0)=SPE3; //replace first reflexion by a diffraction
+	r->getEvents()->set(0, SPE3); //replace first reflexion by a diffraction
 	selector.setGroundAccepted(false); //refuse ground reflexion
 	EXPECT_TRUE(selector.insertWithTest(r)); //the event interacting with the ground is a diffraction => should return TRUE
 }
@@ -3068,6 +3106,12 @@ TEST(test_SelectorManager, appendData)
 	it++;
 	EXPECT_EQ("R3",it->second->getName()); // second selected ray shopuld be R3
 
+	// r4 has been rejected by the face selector, the count is kept by reset()
+	const std::string name = faceSelector->getSelectorName();
+	EXPECT_EQ(1u, manager.getRejections().size());
+	EXPECT_EQ(1u, manager.getRejections()[name]);
+	manager.reset();
+	EXPECT_EQ(1u, manager.getRejections()[name]);
 }
 
 
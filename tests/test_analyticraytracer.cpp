@@ -10,10 +10,12 @@
 #include <cstdlib>
 #include <map>
 
+#include "Tympan/core/exceptions.h"
 #include "Tympan/geometric_methods/AnalyticRayTracer/RayCourb.h"
 #include "Tympan/geometric_methods/AnalyticRayTracer/meteoLin.h"
 #include "Tympan/geometric_methods/AnalyticRayTracer/meteo.h"
 #include "Tympan/geometric_methods/AnalyticRayTracer/Lancer.h"
+#include "Tympan/geometric_methods/AnalyticRayTracer/geometry_modifier.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Geometry/Latitude2DSampler.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Geometry/Longitude2DSampler.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Geometry/UniformSphericSampler.h"
@@ -583,4 +585,180 @@ TEST(test_analyticraytracer, lancer_eq_ray)
 	Lancer lancer;
 	lancer.setMeteo(weather);
 	
-}
\ No newline at end of file
+}
+
+// Shoot the rays of the test scene with the given number of threads
+static void shoot_rays(Lancer& lancer, vec3* ground, unsigned int nbThreads)
+{
+	dynamic_cast<meteoLin*>(lancer._weather)->setGradC(0.1);
+	dynamic_cast<meteoLin*>(lancer._weather)->setGradV(0.2);
+	lancer._weather->setWindAngle(45.);
+	lancer.wantOutFile = false;
+	lancer.setTMax(1.);
+	lancer.setTimeStep(0.005);
+	lancer.setNbRay(50);
+	lancer.initialAnglePhi = 0.;
+	lancer.finalAnglePhi = 360.;
+	lancer.initialAngleTheta = -10.;
+	lancer.setLaunchType(1);
+	lancer.setTriangle(ground);
+	lancer.addSource(vec3(0., 0., 5.));
+	lancer.addSource(vec3(10., -5., 2.));
+	lancer.setNbThreads(nbThreads);
+	lancer.run();
+}
+
+// test that the rays shot in parallel are the same as the rays shot by one thread
+TEST(test_analyticraytracer, lancer_parallel_rays)
+{
+	vec3 ground[3] = { vec3(-1000., -1000., 0.), vec3(1000., -1000., 0.), vec3(0., 1000., 0.) };
+
+	Lancer sequential, parallel;
+	shoot_rays(sequential, ground, 1);
+	shoot_rays(parallel, ground, 4);
+
+	ASSERT_EQ(2, parallel.MatRes.size());
+	int nbReflex = 0;
+	for (unsigned int s = 0; s < 2; s++)
+	{
+		for (unsigned int k = 0; k < parallel.nbRay; k++)
+		{
+			const RayCourb& expected = sequential.MatRes[s][k];
+			const RayCourb& ray = parallel.MatRes[s][k];
+			ASSERT_EQ(expected.etapes.size(), ray.etapes.size());
+			EXPECT_GT(ray.etapes.size(), 1);
+			for (size_t i = 0; i < ray.etapes.size(); i++)
+			{
+				EXPECT_EQ(expected.etapes[i].pos.x, ray.etapes[i].pos.x);
+				EXPECT_EQ(expected.etapes[i].pos.y, ray.etapes[i].pos.y);
+				EXPECT_EQ(expected.etapes[i].pos.z, ray.etapes[i].pos.z);
+			}
+			EXPECT_EQ(expected.nbReflex, ray.nbReflex);
+			EXPECT_EQ(expected.position, ray.position);
+			nbReflex += ray.nbReflex;
+		}
+	}
+	EXPECT_GT(nbReflex, 0); // Some rays are reflected by the ground
+}
+
+
+// Shoot rays towards the ground with a sound speed gradient and some wind
+static void shoot_adaptive(Lancer& lancer, vec3* ground, bool adaptive, double h)
+{
+	dynamic_cast<meteoLin*>(lancer._weather)->setGradC(0.05);
+	dynamic_cast<meteoLin*>(lancer._weather)->setGradV(0.1);
+	lancer._weather->setWindAngle(30.);
+	lancer.wantOutFile = false;
+	lancer.setTMax(1.);
+	lancer.setDMax(10000.);
+	lancer.setTimeStep(h);
+	lancer.setNbRay(20);
+	lancer.initialAnglePhi = 0.;
+	lancer.finalAnglePhi = 360.;
+	lancer.initialAngleTheta = -5.;
+	lancer.setLaunchType(1);
+	lancer.setTriangle(ground);
+	lancer.addSource(vec3(0., 0., 10.));
+	lancer.setAdaptiveStep(adaptive);
+	lancer.setTolerance(1e-4);
+	lancer.run();
+}
+
+// test the adaptive step integration against the fixed step one
+TEST(test_analyticraytracer, lancer_adaptive_step)
+{
+	vec3 ground[3] = { vec3(-10000., -10000., 0.), vec3(10000., -10000., 0.), vec3(0., 10000., 0.) };
+
+	// Same sky rays (no reflection) with far less steps
+	vec3 sky[3] = { vec3(-10000., -10000., -100.), vec3(10000., -10000., -100.), vec3(0., 10000., -100.) };
+	Lancer fixed, adaptive;
+	shoot_adaptive(fixed, sky, false, 0.001);
+	shoot_adaptive(adaptive, sky, true, 0.001);
+	EXPECT_LT(adaptive.getNbIntegrationSteps() * 5, fixed.getNbIntegrationSteps());
+	for (unsigned int k = 0; k < adaptive.nbRay; k++)
+	{
+		const RayCourb& expected = fixed.MatRes[0][k];
+		const RayCourb& ray = adaptive.MatRes[0][k];
+		ASSERT_EQ(expected.etapes.size(), ray.etapes.size());
+		for (size_t i = 0; i < ray.etapes.size(); i++)
+		{
+			EXPECT_NEAR(0., expected.etapes[i].pos.distance(ray.etapes[i].pos), 0.05);
+		}
+	}
+
+	// The rays are reflected exactly on the ground
+	Lancer reflected;
+	shoot_adaptive(reflected, ground, true, 0.01);
+	int nbReflex = 0;
+	for (unsigned int k = 0; k < reflected.nbRay; k++)
+	{
+		const RayCourb& ray = reflected.MatRes[0][k];
+		for (size_t i = 0; i < ray.position.size(); i++)
+		{
+			EXPECT_NEAR(0., ray.etapes[ray.position[i] + 1].pos.z, 1e-3);
+			EXPECT_GT(ray.etapes[ray.position[i] + 1].norm.z, 0.); // Going up
+		}
+		for (size_t i = 0; i < ray.etapes.size(); i++)
+		{
+			EXPECT_GT(ray.etapes[i].pos.z, -1e-3);
+		}
+		nbReflex += ray.nbReflex;
+	}
+	EXPECT_GT(nbReflex, 0);
+}
+
+// test the rays are not shot without a linear weather
+TEST(test_analyticraytracer, lancer_not_linear_weather)
+{
+	meteo weather;
+	Lancer lancer;
+	lancer.setMeteo(&weather);
+	lancer.wantOutFile = false;
+	lancer.addSource(vec3(0., 0., 5.));
+
+	EXPECT_THROW(lancer.run(), tympan::invalid_data);
+	EXPECT_THROW(lancer.EqRay(Step()), tympan::invalid_data);
+}
+
+TEST(test_analyticraytracer, geometry_modifier_height_field)
+{
+	vec3 sky[3] = { vec3(-10000., -10000., -100.), vec3(10000., -10000., -100.), vec3(0., 10000., -100.) };
+	Lancer shot;
+	shoot_adaptive(shot, sky, false, 0.01);
+
+	geometry_modifier_z_correction transformer;
+	transformer.buildNappe(shot);
+
+	// The height field gives the nappe found with a vertical ray cast
+	std::vector<vec3> points;
+	for (int i = -10; i <= 10; i++)
+	{
+		for (int j = -10; j <= 10; j++)
+		{
+			points.push_back( vec3(i * 15., j * 15., 5.) );
+		}
+	}
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		const vec3& P = points[i];
+		Ray ray( vec3(P.x, P.y, P.z + 2000.), vec3(0., 0., -1.) );
+		IntersectionBuffer LI;
+		double h = (P.z + 2000.) - transformer.get_scene()->getAccelerator()->traverse(&ray, LI);
+		EXPECT_NEAR(P.z + h, transformer.fonction_h(P).z, 1e-2);
+		EXPECT_NEAR(P.z - h, transformer.fonction_h_inverse(P).z, 1e-2);
+	}
+
+	// Batched evaluation gives the same points
+	std::vector<vec3> transformed(points);
+	transformer.fonction_h_points(transformed);
+	std::vector<vec3> restored(transformed);
+	transformer.fonction_h_inverse_points(restored);
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		vec3 expected = transformer.fonction_h(points[i]);
+		EXPECT_EQ(expected.x, transformed[i].x);
+		EXPECT_EQ(expected.y, transformed[i].y);
+		EXPECT_NEAR(expected.z, transformed[i].z, 1e-4);
+		EXPECT_NEAR(points[i].z, restored[i].z, 1e-4);
+	}
+}
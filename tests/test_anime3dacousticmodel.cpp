@@ -0,0 +1,302 @@
+/**
+ * @brief Tests of the TYANIME3DAcousticModel class
+ */
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "Tympan/models/common/acoustic_path.h"
+#include "Tympan/models/common/atmospheric_conditions.h"
+#include "Tympan/models/solver/acoustic_problem_model.hpp"
+#include "Tympan/models/solver/config.h"
+#include "Tympan/models/solver/entities.hpp"
+#include "Tympan/solvers/ANIME3DSolver/TYANIME3DAcousticModel.h"
+#include "Tympan/solvers/ANIME3DSolver/TYANIME3DSolver.h"
+
+/**
+ * @brief TYANIME3DAcousticModel giving access to the effective pressure of the rays
+ */
+class TestANIME3DAcousticModel : public TYANIME3DAcousticModel
+{
+public:
+    TestANIME3DAcousticModel(tab_acoustic_path& tabRayons,
+                             const tympan::AcousticProblemModel& aproblem,
+                             AtmosphericConditions& atmos,
+                             TYANIME3DStructSurfIntersect* tabStruct = NULL) :
+        TYANIME3DAcousticModel(tabRayons, tabStruct, aproblem, atmos) {}
+
+    void setPressionAcoustEff(int ray, const OSpectreComplex& pressure) { _pressAcoustEff[ray] = pressure; }
+    const OSpectreComplex& getPressionAcoustEff(int ray) const { return _pressAcoustEff[ray]; }
+
+    /// Run the per-ray stages one after another on all the rays
+    void ComputeStages()
+    {
+        ComputeAbsAtm();
+        ComputeAbsRefl();
+        ComputeAbsDiff();
+        ComputePressionAcoustEff();
+    }
+};
+
+/// Restore the global solver configuration fields changed by a test
+class ConfigurationGuard
+{
+public:
+    ConfigurationGuard() :
+        config(tympan::SolverConfiguration::get()),
+        nbThreads(config->NbThreads),
+        anime3DForceC(config->Anime3DForceC) {}
+    ~ConfigurationGuard()
+    {
+        config->NbThreads = nbThreads;
+        config->Anime3DForceC = anime3DForceC;
+    }
+
+private:
+    tympan::LPSolverConfiguration config;
+    int nbThreads;
+    int anime3DForceC;
+};
+
+/// Ray of the given length from a source to a receptor
+static acoustic_path* make_path(unsigned int source_idx, unsigned int receptor_idx, double length)
+{
+    acoustic_path* path = new acoustic_path();
+    path->setSource(source_idx);
+    path->setRecepteur(receptor_idx);
+    acoustic_event* ev = new acoustic_event(OPoint3D(0., 0., 0.));
+    ev->distNextEvent = length;
+    path->addEvent(ev);
+    return path;
+}
+
+/// Ray going through the given events, with the distances the acoustic model reads
+static acoustic_path* make_linked_path(const std::vector<acoustic_event*>& events)
+{
+    acoustic_path* path = new acoustic_path();
+    path->setSource(0);
+    path->setRecepteur(0);
+    for (size_t e = 0; e < events.size(); e++)
+    {
+        if (e + 1 < events.size())
+        {
+            events[e]->distNextEvent = events[e]->pos.distFrom(events[e + 1]->pos);
+        }
+        path->addEvent(events[e]);
+    }
+    path->build_links_between_events();
+    for (size_t e = 0; e + 1 < events.size(); e++)
+    {
+        events[e]->distEndEvent = events[e]->pos.distFrom(events[e]->endEvent->pos);
+    }
+    return path;
+}
+
+/// Delete a ray built by make_linked_path (an event deletes the events it is linked to)
+static void delete_linked_path(acoustic_path* path)
+{
+    for (size_t e = 0; e < path->getEvents().size(); e++)
+    {
+        path->getEvents()[e]->previous = NULL;
+        path->getEvents()[e]->next = NULL;
+        path->getEvents()[e]->endEvent = NULL;
+    }
+    delete path;
+}
+
+/// Reference computation: go through all the rays for each source-receptor couple
+static OTab2DSpectreComplex reference_total_level(tab_acoustic_path& rays,
+                                                  const std::vector<OSpectreComplex>& pressures,
+                                                  int nbSources, int nbRecepteurs,
+                                                  const OSpectre& K, double sigma)
+{
+    const OSpectre K2 = K * K;
+    const OSpectre un = OSpectre(1.0);
+    double cst = (pow(2., 1. / 6.) - pow(2., -1. / 6.)) * (pow(2., 1. / 6.) - pow(2., -1. / 6.)) / 3.0 + sigma * sigma;
+    OTab2DSpectreComplex result(nbSources, OTabSpectreComplex(nbRecepteurs));
+    for (int i = 0; i < nbSources; i++)
+    {
+        for (int j = 0; j < nbRecepteurs; j++)
+        {
+            OSpectreComplex sum1 = OSpectreComplex(0.0, 0.0);
+            OSpectre sum2 = OSpectreComplex(0.0, 0.0);
+            for (size_t k = 0; k < rays.size(); k++)
+            {
+                if (rays[k]->getSource_idx() != i || rays[k]->getRecepteur_idx() != j) { continue; }
+                double length = rays[k]->getLength();
+                OSpectre mod = pressures[k].getModule();
+                OSpectre C = (K2 * length * length * (-1) * cst).exp();
+                sum1 = sum1 + pressures[k] * C;
+                sum2 = sum2 + mod * mod * (un - C * C);
+            }
+            sum1 = sum1.getModule() * sum1.getModule();
+            result[i][j] = sum1 + sum2;
+        }
+    }
+    return result;
+}
+
+TEST(test_anime3d_acoustic_model, total_level_by_pair)
+{
+    ConfigurationGuard guard;
+    tympan::LPSolverConfiguration config = tympan::SolverConfiguration::get();
+    config->Anime3DForceC = 2; // partial coherence
+    AtmosphericConditions atmos(101325., 20., 50.);
+
+    const int nbSources = 3, nbRecepteurs = 50;
+    tympan::AcousticProblemModel problem;
+    for (int i = 0; i < nbSources; i++)
+    {
+        problem.make_source(OPoint3D(i, 0., 0.), OSpectre(1.), NULL);
+    }
+    for (int j = 0; j < nbRecepteurs; j++)
+    {
+        problem.make_receptor(OPoint3D(0., j, 0.));
+    }
+
+    // Rays in a shuffled source-receptor order, some couples without ray
+    tab_acoustic_path rays;
+    std::vector<OSpectreComplex> pressures;
+    for (int k = 0; k < 1000; k++)
+    {
+        rays.push_back(make_path((k * 7) % nbSources, (k * 13) % (nbRecepteurs - 5), 10. + k % 17));
+        pressures.push_back(OSpectreComplex(OSpectre(1.e-3 * (1 + k % 11)), OSpectre(0.1 * (k % 5))));
+    }
+
+    TestANIME3DAcousticModel model(rays, problem, atmos);
+    std::vector<size_t> pairOffsets;
+    std::vector<int> pairRays;
+    model.SortRaysByPair(nbSources, nbRecepteurs, pairOffsets, pairRays);
+    ASSERT_EQ(static_cast<size_t>(nbSources * nbRecepteurs + 1), pairOffsets.size());
+    ASSERT_EQ(rays.size(), pairRays.size());
+    for (int p = 0; p < nbSources * nbRecepteurs; p++)
+    {
+        for (size_t n = pairOffsets[p]; n < pairOffsets[p + 1]; n++)
+        {
+            EXPECT_EQ(static_cast<unsigned int>(p / nbRecepteurs), rays[pairRays[n]]->getSource_idx());
+            EXPECT_EQ(static_cast<unsigned int>(p % nbRecepteurs), rays[pairRays[n]]->getRecepteur_idx());
+            if (n > pairOffsets[p]) { EXPECT_LT(pairRays[n - 1], pairRays[n]); }
+        }
+    }
+
+    for (size_t k = 0; k < rays.size(); k++)
+    {
+        model.setPressionAcoustEff(k, pressures[k]);
+    }
+    OTab2DSpectreComplex expected = reference_total_level(rays, pressures, nbSources, nbRecepteurs,
+                                                          atmos.get_k(), config->Anime3DSigma);
+
+    const int nbThreads[] = {1, 4};
+    for (int t = 0; t < 2; t++)
+    {
+        config->NbThreads = nbThreads[t];
+        OTab2DSpectreComplex result = model.ComputePressionAcoustTotalLevel();
+        ASSERT_EQ(static_cast<size_t>(nbSources), result.size());
+        for (int i = 0; i < nbSources; i++)
+        {
+            ASSERT_EQ(static_cast<size_t>(nbRecepteurs), result[i].size());
+            for (int j = 0; j < nbRecepteurs; j++)
+            {
+                for (unsigned int f = 0; f < TY_SPECTRE_DEFAULT_NB_ELMT; f++)
+                {
+                    const double ref = expected[i][j].getTabValReel()[f];
+                    EXPECT_NEAR(ref, result[i][j].getTabValReel()[f], 1e-12 * std::fabs(ref) + 1e-300);
+                }
+            }
+        }
+    }
+
+    for (size_t k = 0; k < rays.size(); k++)
+    {
+        delete rays[k];
+    }
+}
+
+TEST(test_anime3d_acoustic_model, parallel_rays_model)
+{
+    ConfigurationGuard guard;
+    tympan::LPSolverConfiguration config = tympan::SolverConfiguration::get();
+    AtmosphericConditions atmos(101325., 20., 50.);
+
+    tympan::AcousticProblemModel problem;
+    tympan::SphericalSourceDirectivity directivity;
+    problem.make_source(OPoint3D(0., 0., 2.), OSpectre(90.), &directivity);
+    problem.make_receptor(OPoint3D(0., 0., 0.));
+
+    // Faces hit by the rays: the ground, a building face and the second face of its edge
+    tympan::AcousticGroundMaterial ground("ground", 20000., 0.01, 0.1);
+    tympan::AcousticBuildingMaterial wall("wall", OSpectreComplex(OSpectre(0.8), OSpectre(0.1)));
+    TYANIME3DStructSurfIntersect faces[3];
+    faces[0].normal = OVector3D(0., 0., 1.);
+    faces[0].material = &ground;
+    faces[1].normal = OVector3D(-1., 0., 0.);
+    faces[1].material = &wall;
+    faces[2].normal = OVector3D(0., 0., 1.);
+    faces[2].material = &wall;
+
+    // Direct, wall reflected, ground reflected and diffracted rays of different lengths
+    tab_acoustic_path rays;
+    for (int k = 0; k < 2000; k++)
+    {
+        const double x = 10. + k;
+        std::vector<acoustic_event*> events;
+        events.push_back(new acoustic_event(OPoint3D(0., 0., 2.)));
+        events[0]->type = TYSOURCE;
+        acoustic_event* ev = NULL;
+        switch (k % 4)
+        {
+            case 1:
+                ev = new acoustic_event(OPoint3D(x, 0., 1.));
+                ev->type = TYREFLEXION;
+                ev->idFace1 = 1;
+                ev->angle = 0.1 + 0.001 * k;
+                break;
+            case 2:
+                ev = new acoustic_event(OPoint3D(x / 2., 0., 0.));
+                ev->type = TYREFLEXIONSOL;
+                ev->idFace1 = 0;
+                ev->angle = std::atan(2. / (x / 2.));
+                break;
+            case 3:
+                ev = new acoustic_event(OPoint3D(x / 2., 0., 5.));
+                ev->type = TYDIFFRACTION;
+                ev->idFace1 = 1;
+                ev->idFace2 = 2;
+                break;
+        }
+        if (ev) { events.push_back(ev); }
+        events.push_back(new acoustic_event(OPoint3D(k % 4 == 1 ? 0. : x, 0., 0.)));
+        events.back()->type = TYRECEPTEUR;
+        rays.push_back(make_linked_path(events));
+    }
+
+    // Reference: the stages one after another
+    config->NbThreads = 1;
+    TestANIME3DAcousticModel serial_model(rays, problem, atmos, faces);
+    serial_model.ComputeStages();
+    OTab2DSpectreComplex expected = serial_model.ComputePressionAcoustTotalLevel();
+    EXPECT_LT(0., expected[0][0].getTabValReel()[10]);
+
+    config->NbThreads = 4;
+    TestANIME3DAcousticModel parallel_model(rays, problem, atmos, faces);
+    OTab2DSpectreComplex result = parallel_model.ComputeAcousticModel();
+    for (size_t k = 0; k < rays.size(); k++)
+    {
+        for (unsigned int f = 0; f < TY_SPECTRE_DEFAULT_NB_ELMT; f++)
+        {
+            EXPECT_EQ(serial_model.getPressionAcoustEff(k).getTabValReel()[f],
+                      parallel_model.getPressionAcoustEff(k).getTabValReel()[f]);
+            EXPECT_EQ(serial_model.getPressionAcoustEff(k).getTabValImag()[f],
+                      parallel_model.getPressionAcoustEff(k).getTabValImag()[f]);
+        }
+    }
+    for (unsigned int f = 0; f < TY_SPECTRE_DEFAULT_NB_ELMT; f++)
+    {
+        EXPECT_DOUBLE_EQ(expected[0][0].getTabValReel()[f], result[0][0].getTabValReel()[f]);
+    }
+
+    for (size_t k = 0; k < rays.size(); k++)
+    {
+        delete_linked_path(rays[k]);
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * @brief Tests of the TYANIME3DSolver class
+ */
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "Tympan/models/solver/acoustic_problem_model.hpp"
+#include "Tympan/models/solver/acoustic_result_model.hpp"
+#include "Tympan/models/solver/config.h"
+#include "Tympan/solvers/ANIME3DSolver/TYANIME3DSolver.h"
+
+/// Sink taking some time to close the results
+class SlowSink: public tympan::ResultSink
+{
+public:
+    virtual void push_spectrum(tympan::receptor_idx receptor, tympan::source_idx source, const tympan::Spectrum& spectrum) {}
+    virtual void push_path(acoustic_path* path) { delete path; }
+    virtual void end() { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+};
+
+// The phases timed by the solver are disjoint parts of the "solve" phase
+TEST(test_anime3d_solver, phase_times)
+{
+    tympan::LPSolverConfiguration config = tympan::SolverConfiguration::get();
+    const bool useMeteo = config->UseMeteo;
+    const bool keepRays = config->Anime3DKeepRays;
+    config->UseMeteo = true;
+    config->Anime3DKeepRays = true;
+
+    // Ground and a wall between the source and the receptors
+    tympan::AcousticProblemModel problem;
+    tympan::material_ptr_t ground = problem.make_material("grass", 300., 0., 1.);
+    tympan::material_ptr_t concrete = problem.make_material("concrete", OSpectreComplex(TYComplex(0.8, 0.)));
+    tympan::node_idx g0 = problem.make_node(-200., -200., 0.);
+    tympan::node_idx g1 = problem.make_node(200., -200., 0.);
+    tympan::node_idx g2 = problem.make_node(200., 200., 0.);
+    tympan::node_idx g3 = problem.make_node(-200., 200., 0.);
+    tympan::node_idx w0 = problem.make_node(20., -10., 0.);
+    tympan::node_idx w1 = problem.make_node(20., 10., 0.);
+    tympan::node_idx w2 = problem.make_node(20., 10., 6.);
+    tympan::node_idx w3 = problem.make_node(20., -10., 6.);
+    const tympan::node_idx tri[4][3] = { {g0, g1, g2}, {g0, g2, g3}, {w0, w1, w2}, {w0, w2, w3} };
+    for (int t = 0; t < 4; t++)
+    {
+        problem.triangle(problem.make_triangle(tri[t][0], tri[t][1], tri[t][2])).made_of = t < 2 ? ground : concrete;
+    }
+
+    tympan::Spectrum spectrum;
+    spectrum.setDefaultValue(90.);
+    problem.make_source(tympan::Point(0., 0., 2.), spectrum.toGPhy(), new tympan::SphericalSourceDirectivity());
+    for (int j = 0; j < 4; j++)
+    {
+        problem.make_receptor(tympan::Point(40. + 10. * j, -15. + 10. * j, 1.5));
+    }
+
+    // The time spent by the sink would be counted twice by overlapping phases
+    TYANIME3DSolver solver;
+    tympan::AcousticResultModel result;
+    result.set_sink(tympan::result_sink_ptr_t(new SlowSink()));
+    ASSERT_TRUE(solver.solve(problem, result, config));
+    config->UseMeteo = useMeteo;
+    config->Anime3DKeepRays = keepRays;
+
+    const std::map<std::string, double> times = result.get_stats().times();
+    ASSERT_TRUE(times.count("solve"));
+    EXPECT_TRUE(times.count("ray_tracing"));
+    EXPECT_TRUE(times.count("acoustic_model"));
+    EXPECT_TRUE(times.count("acoustic_post_processing"));
+    ASSERT_TRUE(times.count("result_export"));
+    EXPECT_GE(times.find("result_export")->second, 0.05);
+    double phases = 0.;
+    for (std::map<std::string, double>::const_iterator it = times.begin(); it != times.end(); ++it)
+    {
+        if (it->first != "solve") { phases += it->second; }
+    }
+    EXPECT_LE(phases, times.find("solve")->second);
+}
@@ -0,0 +1,116 @@
+/**
+ * \file test_m_c_acousticpathcolumns.cpp
+ * \test Testing of the columnar storage and export of the acoustic paths
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "gtest/gtest.h"
+#include "Tympan/models/common/acoustic_path_columns.h"
+#include "testpaths.h"
+
+class AcousticPathColumnsTest: public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        paths.push_back(make_path(0, 2, 2, 0.));
+        paths.push_back(make_path(1, 0, 4, -100.));
+        paths.push_back(make_path(3, 1, 3, 250.));
+        columns.append(paths);
+    }
+
+    virtual void TearDown()
+    {
+        for (size_t i = 0; i < paths.size(); i++) { delete paths[i]; }
+    }
+
+    void expect_same_paths(const AcousticPathColumns& read, double precision)
+    {
+        ASSERT_EQ(paths.size(), read.nb_paths());
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            acoustic_path* path = read.make_path(i);
+            EXPECT_EQ(paths[i]->getSource_idx(), path->getSource_idx());
+            EXPECT_EQ(paths[i]->getRecepteur_idx(), path->getRecepteur_idx());
+            const tab_acoustic_events& expected = paths[i]->getEvents();
+            ASSERT_EQ(expected.size(), path->getEvents().size());
+            for (size_t e = 0; e < expected.size(); e++)
+            {
+                const acoustic_event* event = path->getEvents()[e];
+                EXPECT_EQ(expected[e]->type, event->type);
+                EXPECT_EQ(expected[e]->idFace1, event->idFace1);
+                EXPECT_NEAR(expected[e]->pos._x, event->pos._x, precision);
+                EXPECT_NEAR(expected[e]->pos._y, event->pos._y, precision);
+                EXPECT_NEAR(expected[e]->pos._z, event->pos._z, precision);
+            }
+            delete path;
+        }
+    }
+
+    tab_acoustic_path paths;
+    AcousticPathColumns columns;
+};
+
+TEST_F(AcousticPathColumnsTest, columns)
+{
+    EXPECT_EQ(3u, columns.nb_paths());
+    EXPECT_EQ(9u, columns.nb_events());
+    ASSERT_EQ(4u, columns.offsets().size());
+    EXPECT_EQ(0u, columns.offsets()[0]);
+    EXPECT_EQ(2u, columns.offsets()[1]);
+    EXPECT_EQ(6u, columns.offsets()[2]);
+    EXPECT_EQ(9u, columns.offsets()[3]);
+    EXPECT_EQ(27u, columns.positions().size());
+    expect_same_paths(columns, 0.);
+
+    columns.clear();
+    EXPECT_EQ(0u, columns.nb_paths());
+    EXPECT_EQ(1u, columns.offsets().size());
+}
+
+TEST_F(AcousticPathColumnsTest, file)
+{
+    const std::string file_name = "test_acousticpathcolumns.bin";
+    ASSERT_TRUE(columns.write(file_name));
+
+    // Every array starts on 8 bytes, even with odd numbers of paths and events
+    std::ifstream in(file_name.c_str(), std::ios::binary | std::ios::ate);
+    EXPECT_EQ(0, in.tellg() % 8);
+    in.close();
+
+    AcousticPathColumns read;
+    ASSERT_TRUE(read.read(file_name));
+    std::remove(file_name.c_str());
+    EXPECT_EQ(columns.offsets(), read.offsets());
+    EXPECT_EQ(columns.positions(), read.positions());
+    expect_same_paths(read, 0.);
+}
+
+TEST_F(AcousticPathColumnsTest, quantized_file)
+{
+    const std::string file_name = "test_acousticpathcolumns_quantized.bin";
+    ASSERT_TRUE(columns.write(file_name, 1e-3));
+    AcousticPathColumns read;
+    ASSERT_TRUE(read.read(file_name));
+    expect_same_paths(read, 0.5e-3 + 1e-9);
+
+    // The extent of the positions does not fit in 32 bits
+    EXPECT_FALSE(columns.write(file_name, 1e-8));
+
+    // Truncated file
+    ASSERT_TRUE(columns.write(file_name));
+    {
+        std::ifstream in(file_name.c_str(), std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::ofstream out(file_name.c_str(), std::ios::binary | std::ios::trunc);
+        out.write(content.data(), content.size() - 8);
+    }
+    EXPECT_FALSE(read.read(file_name));
+    EXPECT_EQ(0u, read.nb_paths());
+    EXPECT_FALSE(read.read("no_such_file.bin"));
+    std::remove(file_name.c_str());
+}
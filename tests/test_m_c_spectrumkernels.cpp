@@ -0,0 +1,144 @@
+/**
+ * \file test_m_c_spectrumkernels.cpp
+ * \test Testing of the fixed-size spectrum kernels against the OSpectre operations
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "Tympan/models/common/spectre.h"
+#include "Tympan/models/common/spectrum_kernels.h"
+
+using tympan::SpectrumValues;
+
+// Spectrum with values depending on the band index
+static OSpectre make_spectrum(double offset, double step)
+{
+    OSpectre s;
+    s.setEtat(SPECTRE_ETAT_LIN);
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        s.getTabValReel()[i] = offset + step * i;
+    }
+    return s;
+}
+
+TEST(test_spectrum_kernels, arithmetic)
+{
+    const OSpectre a = make_spectrum(1.5, 0.25);
+    const OSpectre b = make_spectrum(-2., 0.5);
+
+    const OSpectre sum = a + b;
+    const OSpectre diff = a - b;
+    const OSpectre prod = a * b;
+    const OSpectre scaled = a * 3.;
+    const OSpectre shifted = a + 2.;
+
+    SpectrumValues out;
+    tympan::spectrum_add(a.getTabValReel(), b.getTabValReel(), out.data());
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_EQ(sum.getTabValReel()[i], out[i]); }
+    tympan::spectrum_sub(a.getTabValReel(), b.getTabValReel(), out.data());
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_EQ(diff.getTabValReel()[i], out[i]); }
+    tympan::spectrum_mul(a.getTabValReel(), b.getTabValReel(), out.data());
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_EQ(prod.getTabValReel()[i], out[i]); }
+    tympan::spectrum_mul(a.getTabValReel(), 3., out.data());
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_EQ(scaled.getTabValReel()[i], out[i]); }
+    tympan::spectrum_add(a.getTabValReel(), 2., out.data());
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_EQ(shifted.getTabValReel()[i], out[i]); }
+
+    // acc += a * b, the accumulator being also the output of a previous kernel
+    SpectrumValues acc(a);
+    tympan::spectrum_add_product(acc.data(), a.getTabValReel(), b.getTabValReel());
+    const OSpectre expected = a + a * b;
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_EQ(expected.getTabValReel()[i], acc[i]); }
+
+    OSpectre stored;
+    acc.store(stored);
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_EQ(acc[i], stored.getTabValReel()[i]); }
+}
+
+TEST(test_spectrum_kernels, division_root_clamp)
+{
+    const OSpectre a = make_spectrum(0.5, 0.75);
+    const OSpectre b = make_spectrum(2., 0.25);
+
+    SpectrumValues out;
+    tympan::spectrum_div(a.getTabValReel(), b.getTabValReel(), out.data());
+    const OSpectre quotient = a.div(b);
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_EQ(quotient.getTabValReel()[i], out[i]); }
+
+    tympan::spectrum_sqrt(a.getTabValReel(), out.data());
+    const OSpectre root = a.racine();
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_EQ(root.getTabValReel()[i], out[i]); }
+
+    // Values clamped between 2 and a bound of 10 or 20 depending on the band
+    SpectrumValues high;
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { high[i] = (i % 2) ? 10. : 20.; }
+    tympan::spectrum_clamp(a.getTabValReel(), 2., high.data(), out.data());
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        EXPECT_EQ(std::min(std::max(a.getTabValReel()[i], 2.), high[i]), out[i]);
+    }
+}
+
+TEST(test_spectrum_kernels, transcendental)
+{
+    const OSpectre a = make_spectrum(0.1, 0.05);
+
+    SpectrumValues out;
+    tympan::spectrum_exp(a.getTabValReel(), -2., out.data());
+    const OSpectre expected_exp = (a * -2.).exp();
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_DOUBLE_EQ(expected_exp.getTabValReel()[i], out[i]); }
+
+    EXPECT_TRUE(tympan::spectrum_log(a.getTabValReel(), 10., out.data()));
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_DOUBLE_EQ(std::log10(a.getTabValReel()[i]), out[i]); }
+
+    // A non positive value stops the computation
+    OSpectre invalid = a;
+    invalid.getTabValReel()[3] = 0.;
+    EXPECT_FALSE(tympan::spectrum_log(invalid.getTabValReel(), 10., out.data()));
+    EXPECT_EQ(1E20, out[3]);
+    EXPECT_FALSE(invalid.log().isValid());
+
+    // Round trip linear -> dB -> linear
+    SpectrumValues dB, lin;
+    tympan::spectrum_to_dB(a.getTabValReel(), 4e-10, 1e-20, dB.data());
+    tympan::spectrum_to_linear(dB.data(), 4e-10, lin.data());
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_NEAR(a.getTabValReel()[i], lin[i], 1e-12); }
+
+    // Values below the floor
+    SpectrumValues zero(0.);
+    tympan::spectrum_to_dB(zero.data(), 1., 1e-20, dB.data());
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++) { EXPECT_DOUBLE_EQ(-200., dB[i]); }
+}
+
+TEST(test_spectrum_kernels, complex)
+{
+    const OSpectreComplex a(make_spectrum(1., 0.1), make_spectrum(0.2, 0.03));
+    const OSpectreComplex b(make_spectrum(2., -0.05), make_spectrum(-0.5, 0.07));
+
+    // Module / phase product
+    SpectrumValues mod, phase;
+    tympan::spectrum_complex_mul(a.getTabValReel(), a.getTabValImag(), b.getTabValReel(), b.getTabValImag(),
+                                 mod.data(), phase.data());
+    const OSpectreComplex prod = a * b;
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        EXPECT_EQ(prod.getTabValReel()[i], mod[i]);
+        EXPECT_EQ(prod.getTabValImag()[i], phase[i]);
+    }
+
+    // Cartesian accumulation of the two spectra, then square of the module
+    SpectrumValues re(0.), im(0.), coef(1.), norm2;
+    tympan::spectrum_add_polar(re.data(), im.data(), a.getTabValReel(), a.getTabValImag(), coef.data());
+    tympan::spectrum_add_polar(re.data(), im.data(), b.getTabValReel(), b.getTabValImag(), coef.data());
+    tympan::spectrum_norm2(re.data(), im.data(), norm2.data());
+    const OSpectre module = (a + b).getModule();
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        const double expected = module.getTabValReel()[i] * module.getTabValReel()[i];
+        EXPECT_NEAR(expected, norm2[i], 1e-12 * expected);
+    }
+}
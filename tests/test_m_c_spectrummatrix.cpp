@@ -0,0 +1,116 @@
+/**
+ * \file test_m_c_spectrummatrix.cpp
+ * \test Testing of the SpectrumMatrix storage and bulk accessors
+ */
+
+#include "gtest/gtest.h"
+
+#include "Tympan/models/common/spectrum_matrix.h"
+
+using tympan::Spectrum;
+using tympan::SpectrumMatrix;
+
+// Spectrum with all its values set to val
+static Spectrum make_spectrum(double val)
+{
+    Spectrum s(val);
+    s.setType(SPECTRE_TYPE_LP);
+    s.setEtat(SPECTRE_ETAT_LIN);
+    return s;
+}
+
+TEST(test_spectrum_matrix, layout)
+{
+    SpectrumMatrix matrix(3, 2);
+    EXPECT_EQ(3u, matrix.nb_receptors());
+    EXPECT_EQ(2u, matrix.nb_sources());
+
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 2; j++)
+        {
+            matrix.setSpectre(i, j, make_spectrum(10. * i + j));
+        }
+
+    // Spectra of a receptor are contiguous
+    const Spectrum* row = matrix.receptor_row(1);
+    EXPECT_EQ(&matrix(1, 0), row);
+    EXPECT_EQ(&matrix(1, 1), row + 1);
+    EXPECT_EQ(&matrix(2, 0), row + 2);
+
+    std::vector<Spectrum> by_receptor = matrix.by_receptor(2);
+    ASSERT_EQ(2u, by_receptor.size());
+    EXPECT_DOUBLE_EQ(21., by_receptor[1].getTabValReel()[0]);
+
+    std::vector<Spectrum> by_source = matrix.by_source(1);
+    ASSERT_EQ(3u, by_source.size());
+    EXPECT_DOUBLE_EQ(1., by_source[0].getTabValReel()[5]);
+    EXPECT_DOUBLE_EQ(11., by_source[1].getTabValReel()[5]);
+    EXPECT_DOUBLE_EQ(21., by_source[2].getTabValReel()[5]);
+
+    std::vector<double> band = matrix.by_band(TY_SPECTRE_DEFAULT_NB_ELMT - 1);
+    ASSERT_EQ(6u, band.size());
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 2; j++)
+        {
+            EXPECT_DOUBLE_EQ(10. * i + j, band[i * 2 + j]);
+        }
+
+    SpectrumMatrix copy(matrix);
+    EXPECT_EQ(3u, copy.nb_receptors());
+    EXPECT_DOUBLE_EQ(20., copy(2, 0).getTabValReel()[3]);
+
+    matrix.clearReceptor(2);
+    EXPECT_EQ(3u, matrix.nb_receptors());
+    EXPECT_DOUBLE_EQ(0., matrix(2, 0).getTabValReel()[3]);
+    EXPECT_DOUBLE_EQ(10., matrix(1, 0).getTabValReel()[3]);
+
+    matrix.resize(1, 4);
+    EXPECT_EQ(1u, matrix.nb_receptors());
+    EXPECT_EQ(4u, matrix.nb_sources());
+    EXPECT_DOUBLE_EQ(0., matrix(0, 3).getTabValReel()[0]);
+
+    matrix.clear();
+    EXPECT_EQ(0u, matrix.nb_receptors());
+}
+
+TEST(test_spectrum_matrix, bulk_operations)
+{
+    SpectrumMatrix matrix(2, 3);
+    for (size_t j = 0; j < 3; j++)
+    {
+        matrix.setSpectre(0, j, make_spectrum(1.e-6 * (j + 1)));
+        matrix.setSpectre(1, j, make_spectrum(2.e-6));
+    }
+
+    // Compare with the sum computed spectrum by spectrum
+    std::vector<Spectrum> sums = matrix.sum_sources();
+    ASSERT_EQ(2u, sums.size());
+    for (size_t i = 0; i < 2; i++)
+    {
+        Spectrum expected(0.);
+        for (size_t j = 0; j < 3; j++)
+        {
+            expected = expected.sum(matrix(i, j));
+        }
+        EXPECT_EQ(SPECTRE_ETAT_LIN, sums[i].getEtat());
+        EXPECT_EQ(SPECTRE_TYPE_LP, sums[i].getType());
+        for (unsigned int k = 0; k < TY_SPECTRE_DEFAULT_NB_ELMT; k++)
+        {
+            EXPECT_DOUBLE_EQ(expected.getTabValReel()[k], sums[i].getTabValReel()[k]);
+        }
+    }
+
+    Spectrum expected_dB = matrix(0, 2).toDB();
+    matrix.to_dB();
+    EXPECT_EQ(SPECTRE_ETAT_DB, matrix(0, 2).getEtat());
+    EXPECT_DOUBLE_EQ(expected_dB.getTabValReel()[0], matrix(0, 2).getTabValReel()[0]);
+
+    // Already in dB: nothing changes
+    matrix.to_dB();
+    EXPECT_DOUBLE_EQ(expected_dB.getTabValReel()[0], matrix(0, 2).getTabValReel()[0]);
+
+    matrix.to_linear();
+    EXPECT_EQ(SPECTRE_ETAT_LIN, matrix(1, 1).getEtat());
+    EXPECT_NEAR(3.e-6, matrix(0, 2).getTabValReel()[0], 1.e-12);
+    EXPECT_NEAR(2.e-6, matrix(1, 1).getTabValReel()[7], 1.e-12);
+}
@@ -0,0 +1,205 @@
+/**
+ * \file test_m_s_resultsink.cpp
+ * \test Testing of the result sinks of the acoustic result model
+ */
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Tympan/models/solver/acoustic_result_model.hpp"
+#include "testpaths.h"
+
+using namespace tympan;
+
+/// Sink counting what it receives
+class CountingSink: public ResultSink
+{
+public:
+    CountingSink() : nb_begin(0), nb_end(0), nb_spectra(0), nb_paths(0) {}
+
+    virtual void begin(size_t nb_receptors, size_t nb_sources) { nb_begin++; }
+    virtual void push_spectrum(receptor_idx receptor, source_idx source, const Spectrum& spectrum) { nb_spectra++; }
+    virtual void push_path(acoustic_path* path) { nb_paths++; delete path; }
+    virtual void end() { nb_end++; }
+
+    int nb_begin, nb_end, nb_spectra, nb_paths;
+};
+
+TEST(test_ResultSink, in_memory)
+{
+    // Without sink, the results are stored in the model
+    AcousticResultModel result;
+    result.begin(3, 2);
+    Spectrum spectrum;
+    spectrum.setDefaultValue(42.);
+    result.push_spectrum(2, 1, spectrum);
+    result.push_path(make_path(1, 2, 3, 0.));
+    result.end();
+
+    EXPECT_EQ(3u, result.get_data().nb_receptors());
+    EXPECT_EQ(2u, result.get_data().nb_sources());
+    EXPECT_DOUBLE_EQ(42., result.get_data()(2, 1).getTabValReel()[0]);
+    EXPECT_DOUBLE_EQ(0., result.get_data()(0, 0).getTabValReel()[0]);
+    ASSERT_EQ(1u, result.get_path_data().size());
+    delete result.get_path_data()[0];
+    result.get_path_data().clear();
+}
+
+TEST(test_ResultSink, path_slots)
+{
+    // Paths pushed by slot in any order are stored in the slots order
+    AcousticResultModel result;
+    result.begin(4, 1, 4);
+    std::vector<std::thread> threads;
+    for (unsigned int slot = 0; slot < 4; slot++)
+    {
+        threads.push_back(std::thread([&result, slot]()
+        {
+            std::vector<acoustic_path*> paths;
+            paths.push_back(make_path(0, slot, 3, 0.));
+            paths.push_back(make_path(0, slot, 3, 1.));
+            result.push_paths(3 - slot, paths);
+            EXPECT_TRUE(paths.empty());
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++) { threads[t].join(); }
+    EXPECT_TRUE(result.get_path_data().empty());
+    result.end();
+
+    ASSERT_EQ(8u, result.get_path_data().size());
+    for (size_t i = 0; i < result.get_path_data().size(); i++)
+    {
+        EXPECT_EQ(3 - i / 2, result.get_path_data()[i]->getRecepteur_idx());
+        delete result.get_path_data()[i];
+    }
+    result.get_path_data().clear();
+}
+
+TEST(test_ResultSink, custom_sink)
+{
+    // With a sink, nothing is stored but the paths flushed from the model
+    AcousticResultModel result;
+    CountingSink* sink = new CountingSink();
+    result.set_sink(result_sink_ptr_t(sink));
+    result.begin(3, 2);
+    Spectrum spectrum;
+    result.push_spectrum(0, 0, spectrum);
+    result.push_spectrum(1, 0, spectrum);
+    result.push_path(make_path(0, 1, 3, 0.));
+    result.get_path_data().push_back(make_path(0, 0, 3, 0.));
+    result.flush_path_data();
+    result.end();
+
+    EXPECT_EQ(0u, result.get_data().nb_receptors());
+    EXPECT_TRUE(result.get_path_data().empty());
+    EXPECT_EQ(1, sink->nb_begin);
+    EXPECT_EQ(2, sink->nb_spectra);
+    EXPECT_EQ(2, sink->nb_paths);
+    EXPECT_EQ(1, sink->nb_end);
+}
+
+TEST(test_ResultSink, binary_round_trip)
+{
+    const std::string file_name = "test_resultsink.bin";
+
+    AcousticResultModel result;
+    BinaryResultSink* sink = new BinaryResultSink(file_name);
+    result.set_sink(result_sink_ptr_t(sink));
+    result.begin(4, 3);
+    for (size_t i = 0; i < 3; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            Spectrum spectrum;
+            for (unsigned int f = 0; f < TY_SPECTRE_DEFAULT_NB_ELMT; f++)
+            {
+                spectrum.getTabValReel()[f] = 1e-3 * (i + 1) * (j + 1) + f;
+            }
+            spectrum.setType(SPECTRE_TYPE_LP);
+            result.push_spectrum(j, i, spectrum);
+        }
+    }
+    result.push_path(make_path(2, 3, 3, 10.));
+    result.push_path(make_path(0, 1, 3, 20.));
+    result.end();
+    EXPECT_TRUE(sink->good());
+    EXPECT_EQ(12u, sink->nb_spectra());
+    EXPECT_EQ(2u, sink->nb_paths());
+
+    SpectrumMatrix matrix;
+    tab_acoustic_path paths;
+    ASSERT_TRUE(read_binary_results(file_name, matrix, &paths));
+    std::remove(file_name.c_str());
+
+    ASSERT_EQ(4u, matrix.nb_receptors());
+    ASSERT_EQ(3u, matrix.nb_sources());
+    for (size_t i = 0; i < 3; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            EXPECT_EQ(SPECTRE_TYPE_LP, matrix(j, i).getType());
+            for (unsigned int f = 0; f < TY_SPECTRE_DEFAULT_NB_ELMT; f++)
+            {
+                EXPECT_EQ(1e-3 * (i + 1) * (j + 1) + f, matrix(j, i).getTabValReel()[f]);
+            }
+        }
+    }
+
+    ASSERT_EQ(2u, paths.size());
+    EXPECT_EQ(2u, paths[0]->getSource_idx());
+    EXPECT_EQ(3u, paths[0]->getRecepteur_idx());
+    EXPECT_EQ(0u, paths[1]->getSource_idx());
+    EXPECT_EQ(1u, paths[1]->getRecepteur_idx());
+    ASSERT_EQ(3u, paths[1]->getEvents().size());
+    EXPECT_EQ(TYREFLEXION, paths[1]->getEvents()[1]->type);
+    EXPECT_EQ(21., paths[1]->getEvents()[1]->pos._x);
+    EXPECT_EQ(0.25, paths[1]->getEvents()[1]->pos._y);
+    EXPECT_EQ(10, paths[1]->getEvents()[1]->idFace1);
+    for (size_t i = 0; i < paths.size(); i++) { delete paths[i]; }
+}
+
+TEST(test_ResultSink, binary_paths_records)
+{
+    // The paths are written in several records
+    const std::string file_name = "test_resultsink_paths.bin";
+    const size_t nb_paths = 2 * BinaryResultSink::PATHS_PER_RECORD + 3;
+    {
+        BinaryResultSink sink(file_name);
+        sink.begin(1, 1);
+        for (size_t i = 0; i < nb_paths; i++)
+        {
+            sink.push_path(make_path(static_cast<unsigned int>(i), 0, 2 + i % 3, 0.));
+        }
+        sink.end();
+    }
+
+    SpectrumMatrix matrix;
+    tab_acoustic_path paths;
+    ASSERT_TRUE(read_binary_results(file_name, matrix, &paths));
+    std::remove(file_name.c_str());
+    ASSERT_EQ(nb_paths, paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        EXPECT_EQ(i, paths[i]->getSource_idx());
+        EXPECT_EQ(2 + i % 3, paths[i]->getEvents().size());
+        delete paths[i];
+    }
+}
+
+TEST(test_ResultSink, truncated_file)
+{
+    const std::string file_name = "test_resultsink_truncated.bin";
+    {
+        BinaryResultSink sink(file_name);
+        sink.begin(1, 1);
+        sink.push_spectrum(0, 0, Spectrum());
+        // No end record
+    }
+
+    SpectrumMatrix matrix;
+    EXPECT_FALSE(read_binary_results(file_name, matrix));
+    EXPECT_FALSE(read_binary_results("no_such_file.bin", matrix));
+    std::remove(file_name.c_str());
+}
@@ -0,0 +1,90 @@
+/**
+ * \file test_m_s_solverstats.cpp
+ * \test Testing of the solver statistics (phase times and counters)
+ */
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Tympan/models/solver/acoustic_result_model.hpp"
+
+using namespace tympan;
+
+TEST(SolverStatsTest, times_and_counters)
+{
+    SolverStats stats;
+    EXPECT_EQ(0., stats.time("solve"));
+    EXPECT_EQ(0u, stats.count("rays_traced"));
+
+    stats.add_time("solve", 1.5);
+    stats.add_time("solve", 0.5);
+    stats.add_count("rays_traced", 10);
+    stats.add_count("rays_traced");
+
+    EXPECT_DOUBLE_EQ(2., stats.time("solve"));
+    EXPECT_EQ(11u, stats.count("rays_traced"));
+    EXPECT_EQ(1u, stats.times().size());
+    EXPECT_EQ(1u, stats.counts().size());
+
+    stats.clear();
+    EXPECT_TRUE(stats.times().empty());
+    EXPECT_TRUE(stats.counts().empty());
+}
+
+TEST(SolverStatsTest, disabled)
+{
+    SolverStats stats;
+    stats.set_enabled(false);
+    EXPECT_FALSE(stats.is_enabled());
+    stats.add_count("tasks");
+    {
+        ScopedTimer timer(stats, "solve");
+    }
+    EXPECT_TRUE(stats.times().empty());
+    EXPECT_TRUE(stats.counts().empty());
+
+    // A NULL destination is ignored
+    ScopedTimer timer(static_cast<SolverStats*>(NULL), "solve");
+    timer.stop();
+}
+
+TEST(SolverStatsTest, scoped_timer)
+{
+    SolverStats stats;
+    {
+        ScopedTimer timer(stats, "scene_build");
+        timer.stop();
+        timer.stop(); // Only added once
+    }
+    EXPECT_EQ(1u, stats.times().size());
+    EXPECT_GE(stats.time("scene_build"), 0.);
+}
+
+TEST(SolverStatsTest, concurrent_updates)
+{
+    SolverStats stats;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([&stats]()
+        {
+            for (int i = 0; i < 1000; i++)
+            {
+                stats.add_count("tasks");
+                stats.add_time("path_finding", 0.001);
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++) { threads[t].join(); }
+
+    EXPECT_EQ(4000u, stats.count("tasks"));
+    EXPECT_NEAR(4., stats.time("path_finding"), 1e-9);
+}
+
+TEST(SolverStatsTest, result_model)
+{
+    AcousticResultModel result;
+    result.get_stats().add_count("tasks", 3);
+    EXPECT_EQ(3u, result.get_stats().count("tasks"));
+}
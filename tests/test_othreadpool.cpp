@@ -0,0 +1,79 @@
+/**
+*
+* @brief Functional tests of the OThreadPool class (work-stealing threads collection of the default solver)
+*
+*/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Tympan/solvers/DefaultSolver/threading.h"
+
+/**
+* @brief Task counting how many times it has been run
+*/
+class CountingTask : public OTask
+{
+public:
+    CountingTask(std::vector<int>& runs, unsigned int index, unsigned int work)
+        : _runs(runs), _index(index), _work(work) { }
+
+    void main()
+    {
+        // Uneven amount of work, so that idle threads steal tasks from the others
+        volatile double sum = 0.;
+        for (unsigned int i = 0; i < _work; i++) { sum += i; }
+        _runs[_index]++;
+    }
+
+private:
+    std::vector<int>& _runs;
+    unsigned int _index;
+    unsigned int _work;
+};
+
+// Testing that every pushed task is run exactly once
+TEST(OThreadPoolTest, run_all_tasks)
+{
+    const unsigned int nbTasks = 1000;
+    std::vector<int> runs(nbTasks, 0);
+
+    OThreadPool pool(4);
+    pool.begin(nbTasks);
+    for (unsigned int i = 0; i < nbTasks; i++)
+    {
+        pool.push(new CountingTask(runs, i, (i % 10) * 10000));
+    }
+    pool.startPool();
+
+    EXPECT_TRUE(pool.end());
+    EXPECT_EQ(nbTasks, pool.getCount());
+    for (unsigned int i = 0; i < nbTasks; i++)
+    {
+        EXPECT_EQ(1, runs[i]);
+    }
+}
+
+// Testing the pool can be used for several calculations
+TEST(OThreadPoolTest, reuse_pool)
+{
+    const unsigned int nbTasks = 100;
+    std::vector<int> runs(nbTasks, 0);
+
+    OThreadPool pool(3);
+    for (unsigned int calc = 0; calc < 2; calc++)
+    {
+        pool.begin(nbTasks);
+        for (unsigned int i = 0; i < nbTasks; i++)
+        {
+            pool.push(new CountingTask(runs, i, 1000));
+        }
+        pool.startPool();
+        EXPECT_TRUE(pool.end());
+    }
+
+    for (unsigned int i = 0; i < nbTasks; i++)
+    {
+        EXPECT_EQ(2, runs[i]);
+    }
+}
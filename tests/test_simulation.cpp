@@ -12,6 +12,7 @@
 #include <time.h> 
 #include <iostream>
 #include <sstream>
+#include <set>
 
 #include "gtest/gtest.h"
 #include "Tympan/geometric_methods/AcousticRaytracer/Engine/Simulation.h"
@@ -479,7 +480,7 @@ TEST(test_simulation_1source_1recepteur, test_reflection1){
 	EXPECT_TRUE(ray->getDirection().compare(dir_right));			// Test ray final direction									
 	EXPECT_EQ(35,ray->getLongueur());								// Test ray length
 
-	std::vector<boost::shared_ptr<Event> >* events=ray->getEvents();
+	EventHistory* events=ray->getEvents();
 
 	// Test number of events
 	EXPECT_EQ(config->MaxReflexion,ray->getNbEvents());						
@@ -576,7 +577,7 @@ TEST(test_simulation_1source_1recepteur, test_reflection2){
 	EXPECT_TRUE(ray->getDirection().compare(dir_down));	// Test ray final direction									
 	EXPECT_EQ(40,ray->getLongueur());					// Test ray length
 
-	std::vector<boost::shared_ptr<Event> >* events=ray->getEvents();
+	EventHistory* events=ray->getEvents();
 
 	// Test number of events
 	EXPECT_EQ(3,ray->getNbEvents());						
@@ -1043,6 +1044,164 @@ TEST(test_simulation_random_init, test_debug_rays_nbRaysPerSource_random){
 	simu.clean();
 }
 
+// Build a 50m wide box (10 triangles) in the scene of a simulation
+void build_box(Simulation* simu, Material* material)
+{
+	unsigned int p1,p2,p3,p4,p5,p6,p7,p8;
+
+	simu->getScene()->addVertex(vec3(0,0,0), p1);
+	simu->getScene()->addVertex(vec3(50,0,0), p2);
+	simu->getScene()->addVertex(vec3(0,0,50), p3);
+	simu->getScene()->addVertex(vec3(50,0,50), p4);
+
+	simu->getScene()->addVertex(vec3(0,50,0), p5);
+	simu->getScene()->addVertex(vec3(50,50,0), p6);
+	simu->getScene()->addVertex(vec3(0,50,50), p7);
+	simu->getScene()->addVertex(vec3(50,50,50), p8);
+
+	simu->getScene()->addTriangle(p2,p1,p5,material);
+	simu->getScene()->addTriangle(p2,p5,p6,material);
+	simu->getScene()->addTriangle(p4,p6,p8,material);
+	simu->getScene()->addTriangle(p4,p2,p6,material);
+	simu->getScene()->addTriangle(p3,p4,p8,material);
+	simu->getScene()->addTriangle(p3,p8,p7,material);
+	simu->getScene()->addTriangle(p1,p7,p5,material);
+	simu->getScene()->addTriangle(p1,p3,p7,material);
+	simu->getScene()->addTriangle(p7,p8,p5,material);
+	simu->getScene()->addTriangle(p5,p8,p6,material);
+}
+
+// Describe the valid rays of a simulation independently of the order in which they were found
+std::multiset<std::string> valid_rays_description(Simulation* simu)
+{
+	std::multiset<std::string> description;
+	std::deque<Ray*>* valid_rays=simu->getSolver()->getValidRays();
+	for(unsigned int i=0;i<valid_rays->size();i++){
+		Ray* ray=valid_rays->at(i);
+		std::ostringstream s;
+		s << ray->getSource()->getName() << "->" << static_cast<Recepteur*>(ray->getRecepteur())->getName() << ":";
+		std::vector<unsigned int> history=ray->getPrimitiveHistory();
+		for(unsigned int j=0;j<history.size();j++){
+			s << " " << history[j];
+		}
+		description.insert(s.str());
+	}
+	return description;
+}
+
+// Test the ParallelDefaultEngine finds the same valid rays as the DefaultEngine, with rays traced one at a time or by packets
+TEST(test_simulation_parallel_engine, same_valid_rays){
+
+	std::vector<vec3> src_pos;
+	src_pos.push_back(vec3(-10.f,50.2f,25.f));
+	src_pos.push_back(vec3(25.f,60.f,25.f));
+	std::vector<vec3> rcpt_pos;
+	rcpt_pos.push_back(vec3(60.f,50.2f,25.f));
+	rcpt_pos.push_back(vec3(25.f,-10.f,10.f));
+
+	Material material;
+
+	// Sequential ray tracing
+	Simulation simu;
+	build_box(&simu,&material);
+	setup(&simu,2000,2,src_pos,rcpt_pos,leafTreatment::ALL_BEFORE_VISIBLE);
+	simu.launchSimulation();
+
+	std::multiset<std::string> expected=valid_rays_description(&simu);
+	EXPECT_FALSE(expected.empty());
+
+	// Parallel ray tracing
+	unsigned int packet_sizes[]={1,8};
+	for(unsigned int i=0;i<2;i++){
+		Simulation parallel_simu;
+		parallel_simu.getConfiguration()->NbThreads=4;
+		parallel_simu.getConfiguration()->RayPacketSize=packet_sizes[i];
+		build_box(&parallel_simu,&material);
+		setup(&parallel_simu,2000,2,src_pos,rcpt_pos,leafTreatment::ALL_BEFORE_VISIBLE);
+		parallel_simu.setEngine(PARALLELDEFAULT);
+		parallel_simu.launchSimulation();
+
+		EXPECT_EQ(expected,valid_rays_description(&parallel_simu)) << "packet size " << packet_sizes[i];
+		EXPECT_EQ(simu.getSolver()->getDebugRays()->size(),parallel_simu.getSolver()->getDebugRays()->size());
+
+		parallel_simu.getConfiguration()->NbThreads=0;
+		parallel_simu.getConfiguration()->RayPacketSize=8;
+		parallel_simu.clean();
+	}
+	simu.clean();
+}
+
+// Test the rays traced by packets give the same valid rays, with the same identifiers, as the rays traced one at a time
+TEST(test_simulation_ray_packets, same_valid_rays){
+
+	std::vector<vec3> src_pos;
+	src_pos.push_back(vec3(-10.f,50.2f,25.f));
+	src_pos.push_back(vec3(25.f,30.f,25.f));
+	std::vector<vec3> rcpt_pos;
+	rcpt_pos.push_back(vec3(60.f,50.2f,25.f));
+	rcpt_pos.push_back(vec3(25.f,10.f,10.f));
+
+	Material material;
+
+	Simulation simu;
+	simu.getConfiguration()->RayPacketSize=1;
+	build_box(&simu,&material);
+	setup(&simu,2000,2,src_pos,rcpt_pos,leafTreatment::ALL_BEFORE_VISIBLE);
+	simu.launchSimulation();
+
+	Simulation packet_simu;
+	packet_simu.getConfiguration()->RayPacketSize=8;
+	build_box(&packet_simu,&material);
+	setup(&packet_simu,2000,2,src_pos,rcpt_pos,leafTreatment::ALL_BEFORE_VISIBLE);
+	packet_simu.launchSimulation();
+
+	std::deque<Ray*>* valid_rays=simu.getSolver()->getValidRays();
+	std::deque<Ray*>* packet_valid_rays=packet_simu.getSolver()->getValidRays();
+	EXPECT_FALSE(valid_rays->empty());
+	ASSERT_EQ(valid_rays->size(),packet_valid_rays->size());
+	for(unsigned int i=0;i<valid_rays->size();i++){
+		EXPECT_EQ(valid_rays->at(i)->getConstructId(),packet_valid_rays->at(i)->getConstructId());
+		EXPECT_EQ(valid_rays->at(i)->getPrimitiveHistory(),packet_valid_rays->at(i)->getPrimitiveHistory());
+	}
+	EXPECT_EQ(simu.getSolver()->getDebugRays()->size(),packet_simu.getSolver()->getDebugRays()->size());
+
+	simu.clean();
+	packet_simu.clean();
+}
+
+// Test the receptors found through each accelerating structure give the same valid rays as the brute force search
+TEST(test_simulation_receptor_accelerator, same_valid_rays){
+
+	std::vector<vec3> src_pos;
+	src_pos.push_back(vec3(10.f,25.f,25.f));
+	std::vector<vec3> rcpt_pos;
+	for(unsigned int i=0;i<6;i++){
+		for(unsigned int j=0;j<6;j++){
+			rcpt_pos.push_back(vec3(5.f+8.f*i,5.f+8.f*j,2.f));
+		}
+	}
+
+	Material material;
+	std::multiset<std::string> expected;
+
+	for(unsigned int accelerator=0;accelerator<4;accelerator++){
+		Simulation simu;
+		build_box(&simu,&material);
+		setup(&simu,2000,2,src_pos,rcpt_pos,leafTreatment::ALL_BEFORE_VISIBLE);
+		simu.get_receptors_landscape()->finish(accelerator,leafTreatment::ALL);
+		simu.launchSimulation();
+
+		if(accelerator==0){
+			expected=valid_rays_description(&simu);
+			EXPECT_FALSE(expected.empty());
+		}
+		else{
+			EXPECT_EQ(expected,valid_rays_description(&simu)) << "accelerator " << accelerator;
+		}
+		simu.clean();
+	}
+}
+
 typedef std::pair<unsigned int, unsigned int> segment;
 typedef std::map<unsigned int , segment > mapColinearSegments;
 
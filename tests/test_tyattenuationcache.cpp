@@ -0,0 +1,133 @@
+/**
+ * \file test_tyattenuationcache.cpp
+ * \test Testing of the TYAttenuationCache memoization of the attenuation spectra
+ */
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Tympan/models/common/atmospheric_conditions.h"
+#include "Tympan/models/solver/entities.hpp"
+#include "Tympan/models/solver/solver_stats.hpp"
+#include "Tympan/solvers/DefaultSolver/TYAttenuationCache.h"
+
+static void expect_same_spectrum(const OSpectre& expected, const OSpectre& actual)
+{
+    for (unsigned int i = 0; i < TY_SPECTRE_DEFAULT_NB_ELMT; i++)
+    {
+        EXPECT_EQ(expected.getTabValReel()[i], actual.getTabValReel()[i]);
+    }
+}
+
+TEST(test_TYAttenuationCache, exact_mode)
+{
+    AtmosphericConditions atmos(101325., 20., 50.);
+    tympan::AcousticBuildingMaterial material("wall", OSpectreComplex(TYComplex(0.5, 0.1)));
+
+    TYAttenuationCache cache;
+    EXPECT_FALSE(cache.isEnabled());
+    cache.setEnabled(true);
+    EXPECT_EQ(0., cache.getTolerance());
+    EXPECT_EQ(123.456, cache.quantize(123.456));
+
+    // Same spectra as without the cache, the second call being a hit
+    for (int n = 0; n < 2; n++)
+    {
+        expect_same_spectrum(atmos.compute_length_absorption(123.456), cache.getAtmosphericAbsorption(atmos, 123.456));
+        expect_same_spectrum(material.get_absorption(0.3, 50.), cache.getReflexion(material, 0.3, 50.));
+    }
+    EXPECT_EQ(1u, cache.getMisses(TYAttenuationCache::ATMOSPHERIC));
+    EXPECT_EQ(1u, cache.getHits(TYAttenuationCache::ATMOSPHERIC));
+    EXPECT_EQ(1u, cache.getMisses(TYAttenuationCache::REFLEXION));
+    EXPECT_EQ(1u, cache.getHits(TYAttenuationCache::REFLEXION));
+
+    // A slightly different length is another entry
+    cache.getAtmosphericAbsorption(atmos, 123.457);
+    EXPECT_EQ(2u, cache.getNbEntries(TYAttenuationCache::ATMOSPHERIC));
+
+    // The diffraction entries also depend on the plane
+    int nbComputations = 0;
+    auto compute = [&nbComputations](double delta, double epaisseur) { nbComputations++; return OSpectre(delta + epaisseur); };
+    expect_same_spectrum(OSpectre(3.), cache.getDiffraction(2., 1., true, compute));
+    expect_same_spectrum(OSpectre(3.), cache.getDiffraction(2., 1., true, compute));
+    cache.getDiffraction(2., 1., false, compute);
+    EXPECT_EQ(2, nbComputations);
+    EXPECT_EQ(1u, cache.getHits(TYAttenuationCache::DIFFRACTION));
+
+    cache.clear();
+    EXPECT_EQ(0u, cache.getNbEntries(TYAttenuationCache::ATMOSPHERIC));
+    EXPECT_EQ(0u, cache.getHits(TYAttenuationCache::REFLEXION));
+}
+
+TEST(test_TYAttenuationCache, tolerance)
+{
+    AtmosphericConditions atmos(101325., 20., 50.);
+
+    TYAttenuationCache cache;
+    cache.setEnabled(true);
+    cache.setTolerance(1e-3);
+
+    // Values closer than the tolerance share the same rounded value
+    const double q = cache.quantize(100.);
+    EXPECT_NEAR(100., q, 1e-3 * 100.);
+    EXPECT_EQ(q, cache.quantize(q * 1.0001));
+    EXPECT_EQ(q, cache.quantize(q / 1.0001));
+    EXPECT_NE(q, cache.quantize(101.));
+    EXPECT_EQ(0., cache.quantize(0.));
+
+    // The spectrum is computed at the rounded value, whatever the first length asked
+    expect_same_spectrum(atmos.compute_length_absorption(q), cache.getAtmosphericAbsorption(atmos, q * 1.0001));
+    expect_same_spectrum(atmos.compute_length_absorption(q), cache.getAtmosphericAbsorption(atmos, q / 1.0001));
+    EXPECT_EQ(1u, cache.getMisses(TYAttenuationCache::ATMOSPHERIC));
+    EXPECT_EQ(1u, cache.getHits(TYAttenuationCache::ATMOSPHERIC));
+
+    // Disabled cache: always computed, nothing stored
+    cache.setEnabled(false);
+    expect_same_spectrum(atmos.compute_length_absorption(100.01), cache.getAtmosphericAbsorption(atmos, 100.01));
+    EXPECT_EQ(1u, cache.getNbEntries(TYAttenuationCache::ATMOSPHERIC));
+}
+
+TEST(test_TYAttenuationCache, concurrent_access)
+{
+    AtmosphericConditions atmos(101325., 20., 50.);
+    TYAttenuationCache cache;
+    cache.setEnabled(true);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([&cache, &atmos]()
+        {
+            for (int n = 0; n < 1000; n++)
+            {
+                cache.getAtmosphericAbsorption(atmos, 10. + n % 50);
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++) { threads[t].join(); }
+
+    EXPECT_EQ(50u, cache.getNbEntries(TYAttenuationCache::ATMOSPHERIC));
+    EXPECT_EQ(4000u, cache.getHits(TYAttenuationCache::ATMOSPHERIC) + cache.getMisses(TYAttenuationCache::ATMOSPHERIC));
+    expect_same_spectrum(atmos.compute_length_absorption(42.), cache.getAtmosphericAbsorption(atmos, 42.));
+}
+
+TEST(test_TYAttenuationCache, report)
+{
+    AtmosphericConditions atmos(101325., 20., 50.);
+    TYAttenuationCache cache;
+
+    // Nothing reported by a disabled cache
+    tympan::SolverStats stats;
+    cache.report(stats);
+    EXPECT_TRUE(stats.counts().empty());
+
+    cache.setEnabled(true);
+    cache.getAtmosphericAbsorption(atmos, 10.);
+    cache.getAtmosphericAbsorption(atmos, 10.);
+    cache.getAtmosphericAbsorption(atmos, 20.);
+    cache.report(stats);
+    EXPECT_EQ(1u, stats.count("attenuation_cache_hits/atmospheric"));
+    EXPECT_EQ(2u, stats.count("attenuation_cache_misses/atmospheric"));
+    EXPECT_EQ(0u, stats.count("attenuation_cache_hits/reflexion"));
+}
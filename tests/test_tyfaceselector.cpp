@@ -120,3 +120,79 @@ TEST(test_TYFaceSelector, selectFaces)
 
     tabIntersect.clear();
 }
+
+// Testing that the spatial index built by TYFaceSelector::init selects the same faces as the linear scan
+TEST(test_TYFaceSelector, spatial_index_matches_linear_scan)
+{
+    // Terrain of 20 x 20 cells with random heights and 30 random vertical walls
+    tympan::AcousticProblemModel problem;
+    srand(7);
+    const int n = 20;
+    const double step = 10.0;
+    std::vector<tympan::node_idx> grid;
+    for (int j = 0; j <= n; j++)
+    {
+        for (int i = 0; i <= n; i++)
+        {
+            grid.push_back(problem.make_node(i * step, j * step, 3.0 * rand() / RAND_MAX));
+        }
+    }
+    for (int j = 0; j < n; j++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            tympan::node_idx a = grid[j * (n + 1) + i], b = grid[j * (n + 1) + i + 1];
+            tympan::node_idx c = grid[(j + 1) * (n + 1) + i], d = grid[(j + 1) * (n + 1) + i + 1];
+            problem.make_triangle(a, b, d);
+            problem.make_triangle(a, d, c);
+        }
+    }
+    for (int k = 0; k < 30; k++)
+    {
+        double x = n * step * rand() / RAND_MAX, y = n * step * rand() / RAND_MAX;
+        double dx = 20.0 * rand() / RAND_MAX - 10.0, dy = 20.0 * rand() / RAND_MAX - 10.0;
+        double h = 5.0 + 15.0 * rand() / RAND_MAX;
+        tympan::node_idx a = problem.make_node(x, y, 0.0), b = problem.make_node(x + dx, y + dy, 0.0);
+        tympan::node_idx c = problem.make_node(x + dx, y + dy, h), d = problem.make_node(x, y, h);
+        problem.make_triangle(a, b, c);
+        problem.make_triangle(a, c, d);
+    }
+
+    TYSolver solver;
+    tympan::AcousticResultModel result;
+    ASSERT_TRUE(solver.solve(problem, result, tympan::SolverConfiguration::get()));
+
+    TYFaceSelector indexed(solver), linear(solver);
+    indexed.init();
+
+    tympan::Spectrum spectrum;
+    spectrum.setDefaultValue(90);
+    for (int k = 0; k < 200; k++)
+    {
+        OPoint3D S(n * step * rand() / RAND_MAX, n * step * rand() / RAND_MAX, 1.0 + 10.0 * rand() / RAND_MAX);
+        OPoint3D R(n * step * rand() / RAND_MAX, n * step * rand() / RAND_MAX, 1.0 + 10.0 * rand() / RAND_MAX);
+        tympan::AcousticSource source(S, spectrum, new tympan::SphericalSourceDirectivity());
+        tympan::AcousticReceptor receptor(R);
+        TYTrajet path(source, receptor);
+        OSegment3D segSR(S, R);
+        path.setPtSetPtRfromOSeg3D(segSR);
+
+        std::deque<TYSIntersection> fromIndex, fromScan;
+        indexed.selectFaces(fromIndex, path);
+        linear.selectFaces(fromScan, path);
+
+        ASSERT_EQ(fromScan.size(), fromIndex.size());
+        for (size_t i = 0; i < fromScan.size(); i++)
+        {
+            for (int p = 0; p < 2; p++)
+            {
+                ASSERT_EQ(fromScan[i].bIntersect[p], fromIndex[i].bIntersect[p]);
+                if (fromScan[i].bIntersect[p])
+                {
+                    EXPECT_EQ(fromScan[i].segInter[p]._ptA, fromIndex[i].segInter[p]._ptA);
+                    EXPECT_EQ(fromScan[i].segInter[p]._ptB, fromIndex[i].segInter[p]._ptB);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * \file test_tysolver.cpp
+ * \test Testing of the TYSolver tasks (one source against a block of receptors)
+ */
+
+#include <cstdio>
+
+#include "gtest/gtest.h"
+#include "Tympan/models/solver/acoustic_problem_model.hpp"
+#include "Tympan/models/solver/acoustic_result_model.hpp"
+#include "Tympan/models/solver/config.h"
+#include "Tympan/solvers/DefaultSolver/TYAcousticModel.h"
+#include "Tympan/solvers/DefaultSolver/TYAcousticPathFinder.h"
+#include "Tympan/solvers/DefaultSolver/TYFaceSelector.h"
+#include "Tympan/solvers/DefaultSolver/TYSolver.h"
+#include "Tympan/solvers/DefaultSolver/TYTrajet.h"
+
+TEST(test_TYSolver, receptorsPerTask)
+{
+    // Each receptor is in a block and there are enough tasks for the threads
+    const size_t nbSources[] = {1, 3, 100};
+    const size_t nbReceptors[] = {1, 7, 1000, 20000};
+    for (size_t s = 0; s < 3; s++)
+    {
+        for (size_t r = 0; r < 4; r++)
+        {
+            const size_t blockSize = TYSolver::receptorsPerTask(nbSources[s], nbReceptors[r], 4);
+            EXPECT_GE(blockSize, 1u);
+            EXPECT_LE(blockSize, 64u);
+            const size_t nbTasks = nbSources[s] * ((nbReceptors[r] + blockSize - 1) / blockSize);
+            EXPECT_GE(nbTasks, std::min<size_t>(32, nbSources[s] * nbReceptors[r]));
+        }
+    }
+    EXPECT_EQ(1u, TYSolver::receptorsPerTask(0, 0, 0));
+}
+
+TEST(test_TYSolver, source_receptors_blocks)
+{
+    tympan::AcousticProblemModel problem;
+
+    // Reflecting ground and a wall between the sources and some receptors
+    tympan::material_ptr_t ground = problem.make_material("grass", 300., 0., 1.);
+    tympan::material_ptr_t concrete = problem.make_material("concrete", OSpectreComplex(TYComplex(0.8, 0.)));
+    tympan::node_idx g0 = problem.make_node(-500., -500., 0.);
+    tympan::node_idx g1 = problem.make_node(500., -500., 0.);
+    tympan::node_idx g2 = problem.make_node(500., 500., 0.);
+    tympan::node_idx g3 = problem.make_node(-500., 500., 0.);
+    tympan::node_idx w0 = problem.make_node(20., -10., 0.);
+    tympan::node_idx w1 = problem.make_node(20., 10., 0.);
+    tympan::node_idx w2 = problem.make_node(20., 10., 6.);
+    tympan::node_idx w3 = problem.make_node(20., -10., 6.);
+    const tympan::node_idx tri[4][3] = { {g0, g1, g2}, {g0, g2, g3}, {w0, w1, w2}, {w0, w2, w3} };
+    for (int t = 0; t < 4; t++)
+    {
+        problem.triangle(problem.make_triangle(tri[t][0], tri[t][1], tri[t][2])).made_of = t < 2 ? ground : concrete;
+    }
+
+    tympan::Spectrum spectrum;
+    spectrum.setDefaultValue(90.);
+    for (int i = 0; i < 3; i++)
+    {
+        problem.make_source(tympan::Point(0., -5. + 5. * i, 2.), spectrum.toGPhy(), new tympan::SphericalSourceDirectivity());
+    }
+    for (int j = 0; j < 50; j++)
+    {
+        problem.make_receptor(tympan::Point(10. + 3. * j, -20. + (j % 9) * 5., 1.5));
+    }
+
+    tympan::LPSolverConfiguration configuration = tympan::SolverConfiguration::get();
+    configuration->NbThreads = 4;
+    configuration->UseReflection = true;
+
+    TYSolver solver;
+    tympan::AcousticResultModel result;
+    ASSERT_TRUE(solver.solve(problem, result, configuration));
+
+    // Phases and counters recorded during the computation
+    const tympan::SolverStats& stats = result.get_stats();
+    EXPECT_GT(stats.count("tasks"), 0u);
+    EXPECT_EQ(problem.nsources() * problem.nreceptors(), stats.count("source_receptor_pairs"));
+    EXPECT_GT(stats.time("solve"), 0.);
+    EXPECT_GE(stats.time("face_selection"), 0.);
+
+    // Same spectra as the journeys computed one by one
+    tympan::SpectrumMatrix& matrix = result.get_data();
+    ASSERT_EQ(problem.nreceptors(), matrix.nb_receptors());
+    ASSERT_EQ(problem.nsources(), matrix.nb_sources());
+    EXPECT_GT(matrix(0, 0).getTabValReel()[10], 0.);
+    for (size_t i = 0; i < problem.nsources(); i++)
+    {
+        for (size_t j = 0; j < problem.nreceptors(); j++)
+        {
+            TYTrajet trajet(problem.source(i), problem.receptor(j));
+            std::deque<TYSIntersection> tabIntersect;
+            TabPoint3D ptsTop, ptsLeft, ptsRight;
+            solver.getFaceSelector()->selectFaces(tabIntersect, trajet);
+            solver.getAcousticPathFinder()->computePath(tabIntersect, trajet, ptsTop, ptsLeft, ptsRight);
+            solver.getAcousticModel()->compute(tabIntersect, trajet, ptsTop, ptsLeft, ptsRight);
+
+            for (unsigned int f = 0; f < TY_SPECTRE_DEFAULT_NB_ELMT; f++)
+            {
+                EXPECT_EQ(trajet.getSpectre().getTabValReel()[f], matrix(j, i).getTabValReel()[f]);
+            }
+        }
+    }
+
+    // Same spectra when they are streamed to a file
+    const std::string file_name = "test_tysolver_results.bin";
+    tympan::AcousticResultModel streamed;
+    tympan::BinaryResultSink* sink = new tympan::BinaryResultSink(file_name);
+    streamed.set_sink(tympan::result_sink_ptr_t(sink));
+    ASSERT_TRUE(solver.solve(problem, streamed, configuration));
+    EXPECT_TRUE(sink->good());
+    EXPECT_EQ(problem.nsources() * problem.nreceptors(), sink->nb_spectra());
+    EXPECT_EQ(0u, streamed.get_data().nb_receptors());
+    streamed.set_sink(tympan::result_sink_ptr_t());
+
+    tympan::SpectrumMatrix loaded;
+    ASSERT_TRUE(tympan::read_binary_results(file_name, loaded));
+    std::remove(file_name.c_str());
+    ASSERT_EQ(problem.nreceptors(), loaded.nb_receptors());
+    for (size_t i = 0; i < problem.nsources(); i++)
+    {
+        for (size_t j = 0; j < problem.nreceptors(); j++)
+        {
+            for (unsigned int f = 0; f < TY_SPECTRE_DEFAULT_NB_ELMT; f++)
+            {
+                EXPECT_EQ(matrix(j, i).getTabValReel()[f], loaded(j, i).getTabValReel()[f]);
+            }
+        }
+    }
+}
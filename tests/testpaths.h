@@ -0,0 +1,34 @@
+/**
+ * @file testpaths.h
+ *
+ * @brief Acoustic paths used by the tests of the results storage.
+ */
+
+#ifndef TY_TESTPATHS
+#define TY_TESTPATHS
+
+#include "Tympan/models/common/acoustic_path.h"
+
+/**
+ * @brief Build a path of nbEvents events from a source to a receptor
+ *
+ * The first event is the emission, the last one the reception and the others
+ * are reflections on the faces 10, 20... The event i is at (x + i, 0.25 i, 1.5 - 0.1 i).
+ * The caller owns the path.
+ */
+inline acoustic_path* make_path(unsigned int source, unsigned int receptor, size_t nbEvents, double x)
+{
+    acoustic_path* path = new acoustic_path();
+    for (size_t i = 0; i < nbEvents; i++)
+    {
+        acoustic_event* event = new acoustic_event(OPoint3D(x + i, 0.25 * i, 1.5 - 0.1 * i));
+        event->type = i == 0 ? TYSOURCE : (i + 1 == nbEvents ? TYRECEPTEUR : TYREFLEXION);
+        event->idFace1 = static_cast<int>(10 * i);
+        path->addEvent(event);
+    }
+    path->setSource(source);
+    path->setRecepteur(receptor);
+    return path;
+}
+
+#endif /* TY_TESTPATHS */